@@ -1,6 +1,6 @@
 from pydantic import BaseModel
 from enum import Enum
-from typing import Optional
+from typing import Literal, Optional
 
 
 class AtomResponse(BaseModel):
@@ -44,6 +44,10 @@ class DFTSettings(BaseModel):
     basis_set: str = "6-31g*"
     charge: int = 0
     spin: int = 0
+    uff_preoptimize: bool = False  # relax with UFF before DFT optimization
+    # DFT optimization driver: "geometric", or "engine" for the engine's
+    # L-BFGS preconditioned by a UFF model Hessian
+    optimizer_driver: Literal["geometric", "engine"] = "geometric"
 
 
 class CalculationRequest(BaseModel):
@@ -68,6 +72,7 @@ class CalculationStatus(str, Enum):
     RUNNING = "running"
     COMPLETED = "completed"
     FAILED = "failed"
+    CANCELLED = "cancelled"
 
 
 class DFTPropertiesResponse(BaseModel):
@@ -87,6 +92,19 @@ class FrequencyResponse(BaseModel):
     normal_modes: list[list[float]]  # each mode is [dx1,dy1,dz1,dx2,dy2,dz2,...]
 
 
+class PreoptimizationResponse(BaseModel):
+    """UFF pre-optimization stage of a DFT optimization and what followed."""
+    converged: Optional[bool] = None
+    iterations: Optional[int] = None
+    initial_energy: Optional[float] = None  # UFF, kcal/mol
+    final_energy: Optional[float] = None
+    rms_displacement: Optional[float] = None  # Angstrom
+    wall_time_s: Optional[float] = None
+    dft_iterations: Optional[int] = None
+    dft_wall_time_s: Optional[float] = None
+    error: Optional[str] = None  # stage skipped; DFT ran on the input geometry
+
+
 class CalculationResponse(BaseModel):
     id: str
     molecule_id: str
@@ -100,6 +118,7 @@ class CalculationResponse(BaseModel):
     iterations: Optional[int] = None
     final_grad_norm: Optional[float] = None
     optimized_positions: Optional[list[float]] = None
+    preoptimization: Optional[PreoptimizationResponse] = None
     error: Optional[str] = None
 
 
@@ -121,6 +140,7 @@ class CompletionMessage(BaseModel):
     final_grad_norm: float
     energy_components: Optional[EnergyComponentsResponse] = None
     dft_properties: Optional[DFTPropertiesResponse] = None
+    preoptimization: Optional[PreoptimizationResponse] = None
     positions: list[float]
 
 
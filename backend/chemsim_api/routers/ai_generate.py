@@ -7,8 +7,9 @@ from pydantic import BaseModel
 import chemsim_engine
 
 from chemsim_api.models.schemas import MoleculeResponse
-from chemsim_api.routers.molecules import molecule_to_response
+from chemsim_api.routers.molecules import molecule_json_response
 from chemsim_api.services.ai_generate import get_smiles, smiles_to_xyz
+from chemsim_api.services.engine_jobs import run_engine
 from chemsim_api.store import store_molecule
 
 router = APIRouter(prefix="/api/ai", tags=["ai"])
@@ -38,7 +39,7 @@ async def generate_molecule(req: GenerateRequest):
 
     # Step 3: Parse into our engine
     try:
-        mol = chemsim_engine.parse_xyz(xyz_text)
+        mol = await run_engine(chemsim_engine.parse_xyz, xyz_text)
     except Exception as e:
         raise HTTPException(status_code=422, detail=f"Failed to parse generated XYZ: {e}")
 
@@ -47,4 +48,4 @@ async def generate_molecule(req: GenerateRequest):
     mol.name = name
     store_molecule(mol_id, mol, name)
 
-    return molecule_to_response(mol_id, mol, name)
+    return molecule_json_response(mol_id, mol, name)
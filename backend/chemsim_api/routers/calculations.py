@@ -7,12 +7,14 @@ from fastapi import APIRouter, HTTPException
 from chemsim_api.models.schemas import (
     CalculationRequest, CalculationResponse, CalculationStatus,
     CalculationMethod, EnergyComponentsResponse,
-    DFTPropertiesResponse, FrequencyResponse,
+    DFTPropertiesResponse, FrequencyResponse, PreoptimizationResponse,
 )
 from chemsim_api.store import (
     store_calculation, get_calculation, get_molecule, get_dft_result,
 )
-from chemsim_api.services.computation import create_queue
+from chemsim_api.services.computation import (
+    create_queue, create_cancel_token, cancel_calculation,
+)
 from chemsim_api.services.dft_runner import (
     start_dft_energy, start_dft_optimization, start_dft_frequency,
 )
@@ -34,6 +36,7 @@ async def create_calculation(request: CalculationRequest):
         "method": request.method.value,
         "status": CalculationStatus.PENDING,
     })
+    create_cancel_token(calc_id)
 
     if request.method == CalculationMethod.DFT_ENERGY:
         ds = request.dft_settings or _default_dft()
@@ -49,6 +52,7 @@ async def create_calculation(request: CalculationRequest):
             calc_id, request.molecule_id,
             ds.functional, ds.basis_set, ds.charge, ds.spin,
             request.max_iterations, request.grad_tolerance,
+            preoptimize=ds.uff_preoptimize, driver=ds.optimizer_driver,
         )
 
     elif request.method == CalculationMethod.DFT_FREQUENCY:
@@ -62,6 +66,16 @@ async def create_calculation(request: CalculationRequest):
     return _calc_data_to_response(data)
 
 
+@router.post("/{calc_id}/cancel", response_model=CalculationResponse)
+async def cancel_calculation_by_id(calc_id: str):
+    data = get_calculation(calc_id)
+    if data is None:
+        raise HTTPException(status_code=404, detail="Calculation not found")
+    if not cancel_calculation(calc_id):
+        raise HTTPException(status_code=409, detail="Calculation is not running")
+    return _calc_data_to_response(data)
+
+
 @router.get("/{calc_id}", response_model=CalculationResponse)
 async def get_calculation_by_id(calc_id: str):
     data = get_calculation(calc_id)
@@ -121,6 +135,11 @@ def _calc_data_to_response(data: dict) -> CalculationResponse:
     if freq:
         freq_resp = FrequencyResponse(**freq)
 
+    preopt = data.get("preoptimization")
+    preopt_resp = None
+    if preopt:
+        preopt_resp = PreoptimizationResponse(**preopt)
+
     return CalculationResponse(
         id=data["id"],
         molecule_id=data["molecule_id"],
@@ -134,5 +153,6 @@ def _calc_data_to_response(data: dict) -> CalculationResponse:
         iterations=data.get("iterations"),
         final_grad_norm=data.get("final_grad_norm"),
         optimized_positions=data.get("optimized_positions"),
+        preoptimization=preopt_resp,
         error=data.get("error"),
     )
@@ -1,43 +1,58 @@
 """Molecule upload and retrieval endpoints."""
+import json
 import uuid
 from fastapi import APIRouter, UploadFile, File, HTTPException
+from fastapi.encoders import jsonable_encoder
+from fastapi.responses import JSONResponse, Response
 
 import chemsim_engine
 
 from chemsim_api.models.schemas import (
     MoleculeResponse, MoleculeListItem, AtomResponse, BondResponse,
 )
+from chemsim_api.services.engine_jobs import run_engine
 from chemsim_api.store import store_molecule, get_molecule, get_molecule_name, list_molecules
 
 router = APIRouter(prefix="/api/molecules", tags=["molecules"])
 
 
 def molecule_to_response(mol_id: str, mol: chemsim_engine.Molecule, name: str) -> MoleculeResponse:
-    atoms = []
-    for i in range(mol.num_atoms()):
-        a = mol.atom(i)
-        atoms.append(AtomResponse(
-            index=i,
-            symbol=a.symbol,
-            atomic_number=a.atomic_number,
-            position=list(a.position),
-        ))
-    bonds = []
-    for i in range(mol.num_bonds()):
-        b = mol.bond(i)
-        bonds.append(BondResponse(atom_i=b.atom_i, atom_j=b.atom_j, order=b.order))
+    symbols = mol.symbols()
+    numbers = mol.atomic_numbers().tolist()
+    positions = mol.positions.tolist()
+    atoms = [
+        AtomResponse(index=i, symbol=symbols[i], atomic_number=numbers[i], position=positions[i])
+        for i in range(len(symbols))
+    ]
+    bonds = [
+        BondResponse(atom_i=i, atom_j=j, order=order)
+        for i, j, order in mol.bonds_array().tolist()
+    ]
 
     return MoleculeResponse(
         id=mol_id,
         name=name,
         comment=mol.comment,
-        num_atoms=mol.num_atoms(),
-        num_bonds=mol.num_bonds(),
+        num_atoms=len(atoms),
+        num_bonds=len(bonds),
         atoms=atoms,
         bonds=bonds,
     )
 
 
+def molecule_json_response(mol_id: str, mol: chemsim_engine.Molecule, name: str) -> Response:
+    """MoleculeResponse serialized by the engine, skipping per-atom models."""
+    if mol.name != name:
+        return JSONResponse(jsonable_encoder(molecule_to_response(mol_id, mol, name)))
+    try:
+        body = mol.to_json()
+    except RuntimeError as e:
+        # Non-finite coordinates have no JSON form
+        raise HTTPException(status_code=422, detail=str(e))
+    return Response(content='{"id":' + json.dumps(mol_id) + "," + body[1:],
+                    media_type="application/json")
+
+
 @router.post("", response_model=MoleculeResponse)
 async def upload_molecule(file: UploadFile = File(...)):
     content = await file.read()
@@ -46,9 +61,9 @@ async def upload_molecule(file: UploadFile = File(...)):
 
     try:
         if filename.endswith(".sdf") or filename.endswith(".mol"):
-            mol = chemsim_engine.parse_sdf(text)
+            mol = await run_engine(chemsim_engine.parse_sdf, text)
         else:
-            mol = chemsim_engine.parse_xyz(text)
+            mol = await run_engine(chemsim_engine.parse_xyz, text)
     except Exception as e:
         raise HTTPException(status_code=400, detail=f"Parse error: {str(e)}")
 
@@ -57,7 +72,7 @@ async def upload_molecule(file: UploadFile = File(...)):
     mol.name = name
     store_molecule(mol_id, mol, name)
 
-    return molecule_to_response(mol_id, mol, name)
+    return molecule_json_response(mol_id, mol, name)
 
 
 @router.get("", response_model=list[MoleculeListItem])
@@ -77,4 +92,4 @@ async def get_molecule_by_id(mol_id: str):
     if mol is None:
         raise HTTPException(status_code=404, detail="Molecule not found")
     name = get_molecule_name(mol_id)
-    return molecule_to_response(mol_id, mol, name)
+    return molecule_json_response(mol_id, mol, name)
@@ -3,7 +3,7 @@ import asyncio
 import json
 from fastapi import APIRouter, WebSocket, WebSocketDisconnect
 
-from chemsim_api.services.computation import get_queue, remove_queue
+from chemsim_api.services.computation import get_queue, remove_queue, cancel_calculation
 
 router = APIRouter()
 
@@ -28,9 +28,10 @@ async def calculation_ws(websocket: WebSocket, calc_id: str):
 
             await websocket.send_json(msg)
 
-            if msg.get("type") in ("completed", "error"):
+            if msg.get("type") in ("completed", "error", "cancelled"):
                 break
     except WebSocketDisconnect:
-        pass
+        # Nobody is watching any more; free the worker
+        cancel_calculation(calc_id)
     finally:
         remove_queue(calc_id)
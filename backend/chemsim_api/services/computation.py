@@ -2,6 +2,8 @@
 import asyncio
 from typing import Optional
 
+import chemsim_engine
+
 
 # Active calculation queues for WebSocket streaming
 _calculation_queues: dict[str, asyncio.Queue] = {}
@@ -19,3 +21,41 @@ def create_queue(calc_id: str) -> asyncio.Queue:
 
 def remove_queue(calc_id: str):
     _calculation_queues.pop(calc_id, None)
+
+
+# Cancellation tokens of calculations that have not finished. Engine calls
+# take the token in their settings; Python-side runners poll it.
+_cancel_tokens: dict[str, chemsim_engine.CancellationToken] = {}
+
+
+class CalculationCancelled(Exception):
+    pass
+
+
+def create_cancel_token(calc_id: str) -> chemsim_engine.CancellationToken:
+    token = chemsim_engine.CancellationToken()
+    _cancel_tokens[calc_id] = token
+    return token
+
+
+def get_cancel_token(calc_id: str) -> Optional[chemsim_engine.CancellationToken]:
+    return _cancel_tokens.get(calc_id)
+
+
+def remove_cancel_token(calc_id: str):
+    _cancel_tokens.pop(calc_id, None)
+
+
+def cancel_calculation(calc_id: str) -> bool:
+    """Request cancellation; False if the calculation is not running."""
+    token = _cancel_tokens.get(calc_id)
+    if token is None:
+        return False
+    token.cancel()
+    return True
+
+
+def check_cancelled(calc_id: str):
+    token = _cancel_tokens.get(calc_id)
+    if token is not None and token.cancelled:
+        raise CalculationCancelled()
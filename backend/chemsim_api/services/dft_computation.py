@@ -1,5 +1,6 @@
 """PySCF DFT computation wrapper."""
 import base64
+import time
 import numpy as np
 from pyscf import gto, dft, hessian
 from pyscf.geomopt.geometric_solver import optimize as geometric_optimize
@@ -9,6 +10,7 @@ import chemsim_engine
 # Bohr to Angstrom conversion
 BOHR_TO_ANG = 0.529177249
 HARTREE_TO_EV = 27.211386245988
+HARTREE_TO_KCAL = 627.509474
 
 
 def chemsim_mol_to_pyscf(mol: chemsim_engine.Molecule, charge: int = 0,
@@ -33,6 +35,44 @@ def chemsim_mol_to_pyscf(mol: chemsim_engine.Molecule, charge: int = 0,
     return pmol
 
 
+def uff_preoptimize(mol: chemsim_engine.Molecule, max_iterations: int = 2000,
+                    grad_tolerance: float = 0.1, cancel=None):
+    """Relax a copy of mol with UFF before handing it to DFT.
+
+    The loose gradient tolerance (kcal/mol/A) only has to remove gross
+    distortions; DFT does the final convergence. Returns (relaxed copy,
+    stage report). A cancelled run returns the partly relaxed copy; callers
+    check their token afterwards.
+    """
+    start = time.perf_counter()
+    relaxed = chemsim_engine.Molecule.from_bytes(mol.to_bytes())
+    ff = chemsim_engine.UFFForceField()
+    if cancel is not None:
+        ff.setup(relaxed, True, cancel)
+    else:
+        ff.setup(relaxed)
+    initial_energy = ff.calculate_energy(relaxed)
+
+    settings = chemsim_engine.OptSettings()
+    settings.max_iterations = max_iterations
+    settings.grad_tolerance = grad_tolerance
+    settings.store_trajectory = False
+    if cancel is not None:
+        settings.cancel = cancel
+    result = chemsim_engine.optimize_geometry(relaxed, ff, settings)
+
+    displacement = relaxed.positions - mol.positions
+    return relaxed, {
+        "converged": bool(result.converged),
+        "iterations": int(result.iterations),
+        "initial_energy": float(initial_energy),
+        "final_energy": float(result.final_energy),
+        "rms_displacement": float(np.sqrt((displacement ** 2).sum(axis=1).mean()))
+        if mol.num_atoms() > 0 else 0.0,
+        "wall_time_s": time.perf_counter() - start,
+    }
+
+
 def run_dft_energy(pmol: gto.Mole, functional: str = "b3lyp"):
     """Run DFT single-point energy calculation. Returns (mf, energy)."""
     if pmol.spin > 0:
@@ -84,7 +124,10 @@ def extract_properties(mf, pmol: gto.Mole) -> dict:
 def run_dft_optimization(pmol: gto.Mole, functional: str = "b3lyp",
                          max_iterations: int = 100, grad_tolerance: float = 1e-4,
                          progress_callback=None):
-    """Run DFT geometry optimization using geomeTRIC. Returns (mf, optimized_pmol)."""
+    """Run DFT geometry optimization using geomeTRIC.
+
+    Returns (mf, optimized_pmol, number of geometry steps).
+    """
     if pmol.spin > 0:
         mf = dft.UKS(pmol)
     else:
@@ -115,7 +158,66 @@ def run_dft_optimization(pmol: gto.Mole, functional: str = "b3lyp",
     }
 
     opt_pmol = geometric_optimize(mf, callback=callback, **conv_params)
-    return mf, opt_pmol
+    return mf, opt_pmol, iteration_count[0]
+
+
+def run_engine_dft_optimization(mol: chemsim_engine.Molecule, pmol: gto.Mole,
+                                functional: str = "b3lyp", max_iterations: int = 100,
+                                grad_tolerance: float = 1e-4, progress_callback=None,
+                                cancel=None):
+    """Run DFT geometry optimization with the engine's L-BFGS driver.
+
+    PySCF supplies energies and gradients; a UFF model Hessian of the same
+    molecule preconditions the steps when UFF can type it. grad_tolerance is
+    the RMS gradient (Hartree/Bohr), as for geomeTRIC. Returns
+    (mf, optimized_pmol, number of geometry steps, converged).
+    """
+    if pmol.spin > 0:
+        mf = dft.UKS(pmol)
+    else:
+        mf = dft.RKS(pmol)
+    mf.xc = functional
+    mf.verbose = 0
+    scanner = mf.nuc_grad_method().as_scanner()
+    grad_to_kcal = HARTREE_TO_KCAL / BOHR_TO_ANG
+
+    def energy_and_gradient(positions):
+        energy, grad = scanner(pmol.set_geom_(positions, unit="Angstrom", inplace=False))
+        return energy * HARTREE_TO_KCAL, grad.ravel() * grad_to_kcal
+
+    work = chemsim_engine.Molecule.from_bytes(mol.to_bytes())
+    preconditioner = None
+    try:
+        ff = chemsim_engine.UFFForceField()
+        ff.setup(work)
+        preconditioner = chemsim_engine.ModelHessian(work, ff)
+    except Exception:
+        pass  # no UFF types: unpreconditioned L-BFGS
+
+    settings = chemsim_engine.OptSettings()
+    settings.max_iterations = max_iterations
+    # The engine converges on |g| / sqrt(N) = sqrt(3) * RMS gradient
+    settings.grad_tolerance = grad_tolerance * np.sqrt(3.0) * grad_to_kcal
+    # Required together with the gradient criterion, as in geomeTRIC
+    settings.energy_tolerance = 1e-6 * HARTREE_TO_KCAL
+    if cancel is not None:
+        settings.cancel = cancel
+
+    callback = None
+    if progress_callback:
+        sqrt_atoms = np.sqrt(work.num_atoms())
+
+        def callback(prog):
+            progress_callback(prog.iteration + 1, prog.energy / HARTREE_TO_KCAL,
+                              prog.grad_norm * sqrt_atoms / grad_to_kcal,
+                              prog.positions.ravel().tolist())
+
+    result = chemsim_engine.optimize_geometry(
+        work, chemsim_engine.FunctionProvider(energy_and_gradient), settings,
+        preconditioner=preconditioner, callback=callback,
+    )
+    opt_pmol = pmol.set_geom_(work.positions, unit="Angstrom", inplace=False)
+    return mf, opt_pmol, int(result.iterations), bool(result.converged)
 
 
 def run_frequency_analysis(mf, pmol: gto.Mole) -> dict:
@@ -1,20 +1,34 @@
 """Async DFT computation orchestrator."""
 import asyncio
+import time
 from concurrent.futures import ThreadPoolExecutor
 
 from chemsim_api.store import (
     get_molecule, update_calculation, cache_dft_result,
 )
 from chemsim_api.models.schemas import CalculationStatus
-from chemsim_api.services.computation import get_queue, create_queue
+from chemsim_api.services.computation import (
+    get_queue, create_queue, CalculationCancelled, check_cancelled,
+    get_cancel_token, remove_cancel_token,
+)
 from chemsim_api.services.dft_computation import (
     chemsim_mol_to_pyscf, run_dft_energy, extract_properties,
-    run_dft_optimization, run_frequency_analysis,
+    run_dft_optimization, run_engine_dft_optimization, run_frequency_analysis,
+    uff_preoptimize,
 )
+import chemsim_engine
 
 _dft_executor = ThreadPoolExecutor(max_workers=1)
 
 
+def _tracked(run, calc_id: str, *args):
+    """Run a calculation, dropping its cancel token when it ends."""
+    try:
+        run(calc_id, *args)
+    finally:
+        remove_cancel_token(calc_id)
+
+
 def run_dft_energy_calc(calc_id: str, molecule_id: str,
                         functional: str, basis_set: str,
                         charge: int, spin: int):
@@ -26,6 +40,7 @@ def run_dft_energy_calc(calc_id: str, molecule_id: str,
         return
 
     try:
+        check_cancelled(calc_id)
         update_calculation(calc_id, status=CalculationStatus.RUNNING)
         pmol = chemsim_mol_to_pyscf(mol, charge, spin, basis_set)
         mf, energy = run_dft_energy(pmol, functional)
@@ -39,6 +54,8 @@ def run_dft_energy_calc(calc_id: str, molecule_id: str,
             energy=float(energy),
             dft_properties=props,
         )
+    except CalculationCancelled:
+        update_calculation(calc_id, status=CalculationStatus.CANCELLED)
     except Exception as e:
         update_calculation(calc_id, status=CalculationStatus.FAILED, error=str(e))
 
@@ -47,8 +64,15 @@ def run_dft_optimize_calc(calc_id: str, molecule_id: str,
                           functional: str, basis_set: str,
                           charge: int, spin: int,
                           max_iterations: int, grad_tolerance: float,
-                          loop: asyncio.AbstractEventLoop):
-    """Run DFT geometry optimization in a thread, pushing progress to queue."""
+                          loop: asyncio.AbstractEventLoop,
+                          preoptimize: bool = False, driver: str = "geometric"):
+    """Run DFT geometry optimization in a thread, pushing progress to queue.
+
+    With preoptimize, UFF relaxes the structure first and the stage report
+    (UFF iterations and time, then DFT steps and time) is stored as
+    "preoptimization". driver "engine" replaces geomeTRIC with the engine's
+    UFF-preconditioned L-BFGS on PySCF gradients.
+    """
     mol = get_molecule(molecule_id)
     if mol is None:
         update_calculation(calc_id, status=CalculationStatus.FAILED,
@@ -62,11 +86,24 @@ def run_dft_optimize_calc(calc_id: str, molecule_id: str,
         return
 
     try:
+        check_cancelled(calc_id)
         update_calculation(calc_id, status=CalculationStatus.RUNNING)
+        preopt = None
+        if preoptimize:
+            try:
+                mol, preopt = uff_preoptimize(mol, cancel=get_cancel_token(calc_id))
+            except chemsim_engine.OperationCancelled:
+                raise CalculationCancelled()
+            except Exception as e:
+                # Untypeable elements and the like: DFT starts from the input
+                preopt = {"error": str(e)}
+            check_cancelled(calc_id)
         pmol = chemsim_mol_to_pyscf(mol, charge, spin, basis_set)
         q = get_queue(calc_id)
 
         def progress_callback(iteration, energy, grad_norm, positions):
+            # Abort between geometry steps once cancelled
+            check_cancelled(calc_id)
             if q:
                 msg = {
                     "type": "progress",
@@ -78,9 +115,21 @@ def run_dft_optimize_calc(calc_id: str, molecule_id: str,
                 }
                 loop.call_soon_threadsafe(q.put_nowait, msg)
 
-        mf, opt_pmol = run_dft_optimization(
-            pmol, functional, max_iterations, grad_tolerance, progress_callback
-        )
+        dft_start = time.perf_counter()
+        if driver == "engine":
+            mf, opt_pmol, dft_iterations, converged = run_engine_dft_optimization(
+                mol, pmol, functional, max_iterations, grad_tolerance, progress_callback,
+                cancel=get_cancel_token(calc_id),
+            )
+        else:
+            mf, opt_pmol, dft_iterations = run_dft_optimization(
+                pmol, functional, max_iterations, grad_tolerance, progress_callback
+            )
+            converged = True
+        check_cancelled(calc_id)
+        if preopt is not None:
+            preopt["dft_iterations"] = dft_iterations
+            preopt["dft_wall_time_s"] = time.perf_counter() - dft_start
 
         # geometric_optimize doesn't update mf with final SCF results,
         # so re-run a single-point on the optimized geometry
@@ -101,24 +150,33 @@ def run_dft_optimize_calc(calc_id: str, molecule_id: str,
             status=CalculationStatus.COMPLETED,
             energy=energy,
             dft_properties=props,
-            converged=True,
-            iterations=0,  # geometric doesn't easily report iteration count
+            converged=converged,
+            iterations=dft_iterations,
             final_grad_norm=0.0,
             optimized_positions=positions,
+            preoptimization=preopt,
         )
 
         if q:
             loop.call_soon_threadsafe(q.put_nowait, {
                 "type": "completed",
                 "calculation_id": calc_id,
-                "converged": True,
-                "iterations": 0,
+                "converged": converged,
+                "iterations": dft_iterations,
                 "final_energy": energy,
                 "final_grad_norm": 0.0,
                 "dft_properties": props,
                 "positions": positions,
+                "preoptimization": preopt,
             })
 
+    except CalculationCancelled:
+        update_calculation(calc_id, status=CalculationStatus.CANCELLED)
+        q = get_queue(calc_id)
+        if q:
+            loop.call_soon_threadsafe(q.put_nowait, {
+                "type": "cancelled", "calculation_id": calc_id,
+            })
     except Exception as e:
         update_calculation(calc_id, status=CalculationStatus.FAILED, error=str(e))
         q = get_queue(calc_id)
@@ -139,10 +197,12 @@ def run_dft_frequency_calc(calc_id: str, molecule_id: str,
         return
 
     try:
+        check_cancelled(calc_id)
         update_calculation(calc_id, status=CalculationStatus.RUNNING)
         pmol = chemsim_mol_to_pyscf(mol, charge, spin, basis_set)
         mf, energy = run_dft_energy(pmol, functional)
         props = extract_properties(mf, pmol)
+        check_cancelled(calc_id)
         freq_result = run_frequency_analysis(mf, pmol)
 
         cache_dft_result(calc_id, mf, pmol)
@@ -154,6 +214,8 @@ def run_dft_frequency_calc(calc_id: str, molecule_id: str,
             dft_properties=props,
             frequencies=freq_result,
         )
+    except CalculationCancelled:
+        update_calculation(calc_id, status=CalculationStatus.CANCELLED)
     except Exception as e:
         update_calculation(calc_id, status=CalculationStatus.FAILED, error=str(e))
 
@@ -165,7 +227,7 @@ async def start_dft_energy(calc_id: str, molecule_id: str,
     loop = asyncio.get_event_loop()
     loop.run_in_executor(
         _dft_executor,
-        run_dft_energy_calc,
+        _tracked, run_dft_energy_calc,
         calc_id, molecule_id, functional, basis_set, charge, spin,
     )
 
@@ -173,14 +235,15 @@ async def start_dft_energy(calc_id: str, molecule_id: str,
 async def start_dft_optimization(calc_id: str, molecule_id: str,
                                  functional: str, basis_set: str,
                                  charge: int, spin: int,
-                                 max_iterations: int, grad_tolerance: float):
+                                 max_iterations: int, grad_tolerance: float,
+                                 preoptimize: bool = False, driver: str = "geometric"):
     """Start DFT optimization in background thread."""
     loop = asyncio.get_event_loop()
     loop.run_in_executor(
         _dft_executor,
-        run_dft_optimize_calc,
+        _tracked, run_dft_optimize_calc,
         calc_id, molecule_id, functional, basis_set, charge, spin,
-        max_iterations, grad_tolerance, loop,
+        max_iterations, grad_tolerance, loop, preoptimize, driver,
     )
 
 
@@ -191,6 +254,6 @@ async def start_dft_frequency(calc_id: str, molecule_id: str,
     loop = asyncio.get_event_loop()
     loop.run_in_executor(
         _dft_executor,
-        run_dft_frequency_calc,
+        _tracked, run_dft_frequency_calc,
         calc_id, molecule_id, functional, basis_set, charge, spin,
     )
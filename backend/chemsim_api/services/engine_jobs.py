@@ -0,0 +1,81 @@
+"""Await chemsim_engine calls from the event loop.
+
+Calls run on the engine's own worker pool (chemsim_engine.JobQueue) and
+complete through a file descriptor watched with loop.add_reader, so no
+Python thread is tied up per job.
+"""
+import asyncio
+from typing import Any, Callable, Optional
+
+import chemsim_engine
+
+
+class EngineExecutor:
+    def __init__(self, num_threads: int = 0):
+        self._queue = chemsim_engine.JobQueue(num_threads)
+        self._futures: dict[int, asyncio.Future] = {}
+        self._loop: Optional[asyncio.AbstractEventLoop] = None
+
+    def _attach(self, loop: asyncio.AbstractEventLoop):
+        if self._loop is loop:
+            return
+        if self._loop is not None and not self._loop.is_closed():
+            self._loop.remove_reader(self._queue.fileno())
+        loop.add_reader(self._queue.fileno(), self._drain)
+        self._loop = loop
+
+    def _drain(self):
+        for job_id, ok, value in self._queue.completed():
+            fut = self._futures.pop(job_id, None)
+            if fut is None or fut.done():
+                continue
+            if ok:
+                fut.set_result(value)
+            else:
+                fut.set_exception(value)
+
+    async def run(self, fn: Callable[..., Any], *args, **kwargs) -> Any:
+        """Run fn(*args, **kwargs) on the engine pool and await its result."""
+        loop = asyncio.get_running_loop()
+        self._attach(loop)
+        fut = loop.create_future()
+        self._futures[self._queue.submit(fn, *args, **kwargs)] = fut
+        return await fut
+
+
+_executor: Optional[EngineExecutor] = None
+
+
+def get_engine_executor() -> EngineExecutor:
+    global _executor
+    if _executor is None:
+        _executor = EngineExecutor()
+    return _executor
+
+
+async def run_engine(fn: Callable[..., Any], *args, **kwargs) -> Any:
+    return await get_engine_executor().run(fn, *args, **kwargs)
+
+
+def watch_progress(channel: "chemsim_engine.ProgressChannel",
+                   on_records: Callable[[list], None],
+                   batch_size: int = 64) -> Callable[[], None]:
+    """Deliver ProgressChannel records to on_records in batches on the running
+    event loop. Returns a function that stops watching and delivers any
+    records still queued."""
+    loop = asyncio.get_running_loop()
+
+    def drain():
+        records = channel.drain(batch_size)
+        if records:
+            on_records(records)
+
+    loop.add_reader(channel.fileno(), drain)
+
+    def stop():
+        loop.remove_reader(channel.fileno())
+        records = channel.drain()
+        if records:
+            on_records(records)
+
+    return stop
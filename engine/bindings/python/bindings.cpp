@@ -2,17 +2,155 @@
 #include <pybind11/stl.h>
 #include <pybind11/eigen.h>
 #include <pybind11/functional.h>
+#include <pybind11/numpy.h>
+
+#include <algorithm>
+#include <cstring>
 
 #include "chemsim/core/molecule.h"
 #include "chemsim/core/element_data.h"
+#include "chemsim/core/geometry.h"
+#include "chemsim/core/perception.h"
+#include "chemsim/core/spatial_index.h"
+#include "chemsim/core/job_queue.h"
 #include "chemsim/io/xyz_parser.h"
 #include "chemsim/io/sdf_parser.h"
+#include "chemsim/io/molecule_library.h"
+#include "chemsim/io/pdb_parser.h"
+#include "chemsim/io/text_writer.h"
+#include "chemsim/io/serialization.h"
+#include "chemsim/io/json_writer.h"
 #include "chemsim/ff/uff_energy.h"
 #include "chemsim/ff/uff_typing.h"
 #include "chemsim/opt/optimizer.h"
+#include "chemsim/opt/energy_provider.h"
+#include "chemsim/opt/model_hessian.h"
+#include "chemsim/opt/progress_channel.h"
+#include "chemsim/opt/dihedral_scan.h"
+#include "chemsim/opt/neb.h"
+#include "chemsim/md/dynamics.h"
+#include "chemsim/analysis/rmsd.h"
+#include "chemsim/analysis/vibrations.h"
+#include "chemsim/analysis/clustering.h"
+#include "chemsim/conf/conformer_search.h"
+#include "chemsim/conf/embedding.h"
 
 namespace py = pybind11;
 
+namespace {
+
+// Read-only (N, 3) array over flat 3N storage owned by base, no copy
+py::array_t<double> positions_array(const std::vector<double>& flat, py::handle base) {
+    py::array_t<double> arr({static_cast<py::ssize_t>(flat.size() / 3), py::ssize_t{3}},
+                            flat.data(), base);
+    arr.attr("setflags")(py::arg("write") = false);
+    return arr;
+}
+
+// (F, N, 3) array of the positions of each frame, one memcpy per frame
+template <typename Frame>
+py::array_t<double> stack_positions(const std::vector<Frame>& frames) {
+    py::ssize_t n = frames.empty() ? 0 : static_cast<py::ssize_t>(frames[0].positions.size() / 3);
+    py::array_t<double> out({static_cast<py::ssize_t>(frames.size()), n, py::ssize_t{3}});
+    double* dst = out.mutable_data();
+    for (const auto& f : frames) {
+        if (static_cast<py::ssize_t>(f.positions.size()) != 3 * n) {
+            throw std::runtime_error("Trajectory frames differ in atom count");
+        }
+        std::copy(f.positions.begin(), f.positions.end(), dst);
+        dst += 3 * n;
+    }
+    return out;
+}
+
+// Deserialize from any contiguous buffer (bytes, a shared memory segment's
+// memoryview) in place, without the GIL
+template <typename T>
+T load_blob(const py::buffer& buf, T (*load)(std::string_view)) {
+    py::buffer_info info = buf.request();
+    if (info.ndim > 1 || (info.ndim == 1 && info.strides[0] != info.itemsize)) {
+        throw std::runtime_error("Serialized data must be a contiguous buffer");
+    }
+    std::string_view data(static_cast<const char*>(info.ptr), info.size * info.itemsize);
+    py::gil_scoped_release release;
+    return load(data);
+}
+
+// Copy a blob into a new multiprocessing.shared_memory.SharedMemory segment;
+// the caller owns it (close() and unlink() when done)
+py::object share_blob(const std::string& blob) {
+    py::object shm = py::module_::import("multiprocessing.shared_memory").attr("SharedMemory")(
+        py::arg("create") = true, py::arg("size") = std::max<size_t>(blob.size(), 1));
+    py::buffer_info info = py::buffer(shm.attr("buf")).request(true);
+    std::memcpy(info.ptr, blob.data(), blob.size());
+    return shm;
+}
+
+// Attach to a segment by name and deserialize straight from the mapping
+template <typename T>
+T attach_blob(const std::string& name, T (*load)(std::string_view)) {
+    py::object shm = py::module_::import("multiprocessing.shared_memory").attr("SharedMemory")(name);
+    T value = [&]() {
+        py::buffer buf = shm.attr("buf");
+        return load_blob(buf, load);
+    }();
+    shm.attr("close")();
+    return value;
+}
+
+// A Python call queued on a JobQueue. Its objects are only touched with
+// the GIL held, including when the last owner is a worker thread.
+struct PyJob {
+    py::object fn, args, kwargs, result;
+    bool failed = false;
+
+    ~PyJob() {
+        py::gil_scoped_acquire gil;
+        fn = args = kwargs = result = py::object();
+    }
+};
+
+// JobQueue holding the Python side of each job until it is collected
+struct PyJobQueue {
+    std::unique_ptr<chemsim::JobQueue> queue;
+    std::unordered_map<uint64_t, std::shared_ptr<PyJob>> jobs;
+
+    explicit PyJobQueue(int num_threads)
+        : queue(std::make_unique<chemsim::JobQueue>(num_threads)) {}
+
+    ~PyJobQueue() {
+        // Queued jobs need the GIL to run
+        py::gil_scoped_release release;
+        queue.reset();
+    }
+};
+
+// Python object shared by copies of a std::function that may be copied or
+// destroyed on threads without the GIL
+std::shared_ptr<py::object> share_object(py::object obj) {
+    return std::shared_ptr<py::object>(new py::object(std::move(obj)), [](py::object* p) {
+        py::gil_scoped_acquire gil;
+        delete p;
+    });
+}
+
+// optimize_geometry's progress sink: a ProgressChannel, a Python callable
+// (called with the GIL), or neither
+chemsim::ProgressCallback progress_callback(const py::object& callback, chemsim::ProgressChannel* channel) {
+    if (channel) {
+        if (!callback.is_none()) throw std::runtime_error("Pass either callback or channel");
+        return channel->callback();
+    }
+    if (callback.is_none()) return nullptr;
+    auto fn = share_object(callback);
+    return [fn](const chemsim::OptProgress& prog) {
+        py::gil_scoped_acquire acquire;
+        (*fn)(prog);
+    };
+}
+
+} // namespace
+
 PYBIND11_MODULE(chemsim_engine, m) {
     m.doc() = "ChemSim computational chemistry engine";
 
@@ -35,7 +173,8 @@ PYBIND11_MODULE(chemsim_engine, m) {
         .def(py::init<int, const std::string&, const Eigen::Vector3d&>())
         .def_readwrite("atomic_number", &chemsim::Atom::atomic_number)
         .def_readwrite("symbol", &chemsim::Atom::symbol)
-        .def_readwrite("position", &chemsim::Atom::position);
+        .def_readwrite("position", &chemsim::Atom::position)
+        .def_readwrite("formal_charge", &chemsim::Atom::formal_charge);
 
     // Bond
     py::class_<chemsim::Bond>(m, "Bond")
@@ -48,32 +187,138 @@ PYBIND11_MODULE(chemsim_engine, m) {
     // Molecule
     py::class_<chemsim::Molecule>(m, "Molecule")
         .def(py::init<>())
+        // Binary images for pickling, process pools and shared memory
+        .def(py::pickle([](const chemsim::Molecule& mol) { return py::bytes(chemsim::serialize(mol)); },
+                        [](const py::buffer& state) {
+                            return load_blob(state, &chemsim::deserialize_molecule);
+                        }))
+        .def("to_bytes", [](const chemsim::Molecule& mol) { return py::bytes(chemsim::serialize(mol)); })
+        .def_static("from_bytes", [](const py::buffer& data) {
+            return load_blob(data, &chemsim::deserialize_molecule);
+        }, py::arg("data"))
+        .def("to_shared_memory", [](const chemsim::Molecule& mol) {
+            return share_blob(chemsim::serialize(mol));
+        })
+        .def_static("from_shared_memory", [](const std::string& name) {
+            return attach_blob(name, &chemsim::deserialize_molecule);
+        }, py::arg("name"))
         .def("add_atom", &chemsim::Molecule::add_atom)
         .def("add_bond", &chemsim::Molecule::add_bond)
         .def("perceive_bonds", &chemsim::Molecule::perceive_bonds,
-             py::arg("tolerance") = 0.45)
+             py::arg("tolerance") = 0.45, py::arg("num_threads") = 1,
+             py::call_guard<py::gil_scoped_release>())
         .def("num_atoms", &chemsim::Molecule::num_atoms)
         .def("num_bonds", &chemsim::Molecule::num_bonds)
-        .def("atom", py::overload_cast<int>(&chemsim::Molecule::atom),
-             py::return_value_policy::reference_internal)
+        // Atoms come back as copies; write coordinates through positions
+        .def("atom", [](const chemsim::Molecule& mol, int i) -> chemsim::Atom {
+            if (i < 0 || i >= mol.num_atoms()) throw py::index_error("atom index out of range");
+            return mol.atom(i);
+        }, py::arg("i"))
         .def("bond", &chemsim::Molecule::bond,
              py::return_value_policy::reference_internal)
-        .def("atoms", &chemsim::Molecule::atoms,
-             py::return_value_policy::reference_internal)
+        .def("atoms", [](const chemsim::Molecule& mol) {
+            std::vector<chemsim::Atom> atoms;
+            atoms.reserve(mol.num_atoms());
+            for (const auto& atom : mol.atoms()) atoms.push_back(atom);
+            return atoms;
+        })
         .def("bonds", &chemsim::Molecule::bonds,
              py::return_value_policy::reference_internal)
-        .def("get_positions", &chemsim::Molecule::get_positions)
-        .def("set_positions", &chemsim::Molecule::set_positions)
+        // Writable (N, 3) view of the molecule's coordinates, no copy. The
+        // array co-owns the buffer, so it never dangles: it outlives the
+        // molecule, and after add_atom it keeps the old coordinates while
+        // the molecule moves to a new buffer.
+        .def_property("positions", [](chemsim::Molecule& mol) {
+            auto shared = new std::shared_ptr<double>(mol.share_coordinates());
+            py::capsule owner(shared, [](void* p) { delete static_cast<std::shared_ptr<double>*>(p); });
+            return py::array_t<double>({static_cast<py::ssize_t>(mol.num_atoms()), py::ssize_t{3}},
+                                       shared->get(), owner);
+        }, [](chemsim::Molecule& mol, py::array_t<double, py::array::c_style | py::array::forcecast> pos) {
+            if (pos.ndim() != 2 || pos.shape(0) != mol.num_atoms() || pos.shape(1) != 3) {
+                throw std::runtime_error("positions must have shape (num_atoms, 3)");
+            }
+            std::copy(pos.data(), pos.data() + pos.size(), mol.coordinates());
+        })
+        // Flat 3N copy
+        .def("get_positions", [](const chemsim::Molecule& mol) {
+            py::ssize_t n = 3 * static_cast<py::ssize_t>(mol.num_atoms());
+            return py::array_t<double>(n, mol.coordinates());
+        })
+        // Any array or sequence with 3N values
+        .def("set_positions", [](chemsim::Molecule& mol,
+                                 py::array_t<double, py::array::c_style | py::array::forcecast> pos) {
+            if (pos.size() != 3 * static_cast<py::ssize_t>(mol.num_atoms())) {
+                throw std::runtime_error("Position vector size mismatch");
+            }
+            std::copy(pos.data(), pos.data() + pos.size(), mol.coordinates());
+        })
+        // Bulk per-atom and per-bond exports, one call instead of N
+        .def("atomic_numbers", [](const chemsim::Molecule& mol) {
+            py::array_t<int32_t> out(mol.num_atoms());
+            int32_t* dst = out.mutable_data();
+            for (const auto& atom : mol.atoms()) *dst++ = atom.atomic_number;
+            return out;
+        })
+        .def("formal_charges", [](const chemsim::Molecule& mol) {
+            py::array_t<int32_t> out(mol.num_atoms());
+            int32_t* dst = out.mutable_data();
+            for (const auto& atom : mol.atoms()) *dst++ = atom.formal_charge;
+            return out;
+        })
+        .def("symbols", [](const chemsim::Molecule& mol) {
+            py::list out(mol.num_atoms());
+            for (int i = 0; i < mol.num_atoms(); ++i) out[i] = py::str(mol.atom(i).symbol);
+            return out;
+        })
+        // (M, 3) rows of atom_i, atom_j, order
+        .def("bonds_array", [](const chemsim::Molecule& mol) {
+            py::array_t<int32_t> out({static_cast<py::ssize_t>(mol.num_bonds()), py::ssize_t{3}});
+            int32_t* dst = out.mutable_data();
+            for (const auto& bond : mol.bonds()) {
+                *dst++ = bond.atom_i;
+                *dst++ = bond.atom_j;
+                *dst++ = bond.order;
+            }
+            return out;
+        })
+        .def("to_json", [](const chemsim::Molecule& mol) {
+            std::string json;
+            {
+                py::gil_scoped_release release;
+                json = chemsim::write_json(mol);
+            }
+            return py::str(json);
+        })
         .def("degree", &chemsim::Molecule::degree)
         .def("bonded_to", &chemsim::Molecule::bonded_to)
         .def("bond_order_between", &chemsim::Molecule::bond_order_between)
         .def_readwrite("name", &chemsim::Molecule::name)
         .def_readwrite("comment", &chemsim::Molecule::comment);
 
+    // Geometry
+    m.def("dihedral_angle", &chemsim::dihedral_angle);
+    m.def("set_dihedral", &chemsim::set_dihedral);
+
     // Parsers
-    m.def("parse_xyz", &chemsim::parse_xyz, "Parse XYZ format string");
-    m.def("write_xyz", &chemsim::write_xyz, "Write molecule to XYZ format");
-    m.def("parse_sdf", &chemsim::parse_sdf, "Parse SDF/MOL format string");
+    m.def("parse_xyz", [](const std::string& content, bool perceive_bonds) {
+        chemsim::XYZOptions options;
+        options.perceive_bonds = perceive_bonds;
+        return chemsim::parse_xyz(content, options);
+    }, py::arg("content"), py::arg("perceive_bonds") = true, "Parse XYZ format string",
+       py::call_guard<py::gil_scoped_release>());
+    m.def("write_xyz", py::overload_cast<const chemsim::Molecule&, int>(&chemsim::write_xyz),
+          py::arg("mol"), py::arg("precision") = 6, "Write molecule to XYZ format",
+          py::call_guard<py::gil_scoped_release>());
+    m.def("write_json", [](const chemsim::Molecule& mol) {
+        std::string json;
+        {
+            py::gil_scoped_release release;
+            json = chemsim::write_json(mol);
+        }
+        return py::str(json);
+    }, py::arg("mol"), "Write molecule as compact JSON (API response shape)");
+    m.def("parse_sdf", &chemsim::parse_sdf, "Parse SDF/MOL format string",
+          py::call_guard<py::gil_scoped_release>());
 
     // EnergyComponents
     py::class_<chemsim::EnergyComponents>(m, "EnergyComponents")
@@ -81,35 +326,97 @@ PYBIND11_MODULE(chemsim_engine, m) {
         .def_readonly("angle_bend", &chemsim::EnergyComponents::angle_bend)
         .def_readonly("torsion", &chemsim::EnergyComponents::torsion)
         .def_readonly("vdw", &chemsim::EnergyComponents::vdw)
+        .def_readonly("restraint", &chemsim::EnergyComponents::restraint)
         .def_readonly("total", &chemsim::EnergyComponents::total);
 
     // UFFForceField
     py::class_<chemsim::UFFForceField>(m, "UFFForceField")
         .def(py::init<>())
-        .def("setup", &chemsim::UFFForceField::setup)
-        .def("calculate_energy", &chemsim::UFFForceField::calculate_energy)
+        // Images carry the term tables, so receivers skip setup()
+        .def(py::pickle([](const chemsim::UFFForceField& ff) { return py::bytes(chemsim::serialize(ff)); },
+                        [](const py::buffer& state) {
+                            return load_blob(state, &chemsim::deserialize_force_field);
+                        }))
+        .def("to_bytes", [](const chemsim::UFFForceField& ff) { return py::bytes(chemsim::serialize(ff)); })
+        .def_static("from_bytes", [](const py::buffer& data) {
+            return load_blob(data, &chemsim::deserialize_force_field);
+        }, py::arg("data"))
+        .def("to_shared_memory", [](const chemsim::UFFForceField& ff) {
+            return share_blob(chemsim::serialize(ff));
+        })
+        .def_static("from_shared_memory", [](const std::string& name) {
+            return attach_blob(name, &chemsim::deserialize_force_field);
+        }, py::arg("name"))
+        .def("setup", py::overload_cast<const chemsim::Molecule&, bool>(
+                 &chemsim::UFFForceField::setup),
+             py::arg("mol"), py::arg("use_cache") = true,
+             py::call_guard<py::gil_scoped_release>())
+        .def("setup", py::overload_cast<const chemsim::Molecule&, bool,
+                                        const chemsim::CancellationToken&>(
+                 &chemsim::UFFForceField::setup),
+             py::arg("mol"), py::arg("use_cache"), py::arg("cancel"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("calculate_energy", &chemsim::UFFForceField::calculate_energy,
+             py::call_guard<py::gil_scoped_release>())
+        // Returned Eigen vectors are moved into NumPy arrays, not copied
         .def("calculate_gradient", [](const chemsim::UFFForceField& ff,
                                        const chemsim::Molecule& mol) {
-            Eigen::VectorXd grad = ff.calculate_gradient(mol);
-            return std::vector<double>(grad.data(), grad.data() + grad.size());
-        })
-        .def("calculate_energy_components", &chemsim::UFFForceField::calculate_energy_components)
-        .def("atom_types", &chemsim::UFFForceField::atom_types);
+            return ff.calculate_gradient(mol);
+        }, py::call_guard<py::gil_scoped_release>())
+        .def("hessian_vector_product", [](const chemsim::UFFForceField& ff,
+                                           const chemsim::Molecule& mol,
+                                           const Eigen::VectorXd& v) {
+            return ff.hessian_vector_product(mol, v);
+        }, py::call_guard<py::gil_scoped_release>())
+        .def("calculate_energy_components", &chemsim::UFFForceField::calculate_energy_components,
+             py::call_guard<py::gil_scoped_release>())
+        .def("atom_types", &chemsim::UFFForceField::atom_types)
+        .def("add_dihedral_restraint", &chemsim::UFFForceField::add_dihedral_restraint,
+             py::arg("i"), py::arg("j"), py::arg("k"), py::arg("l"),
+             py::arg("target_degrees"), py::arg("force_constant"))
+        .def("clear_restraints", &chemsim::UFFForceField::clear_restraints);
+
+    // Cooperative cancellation: keep a reference, pass it in settings and
+    // call cancel() from any thread
+    py::register_exception<chemsim::OperationCancelled>(m, "OperationCancelled");
+    py::class_<chemsim::CancellationToken>(m, "CancellationToken")
+        .def(py::init<>())
+        .def("cancel", &chemsim::CancellationToken::cancel)
+        .def_property_readonly("cancelled", &chemsim::CancellationToken::cancelled);
+
+    py::enum_<chemsim::OptStatus>(m, "OptStatus")
+        .value("CONVERGED", chemsim::OptStatus::converged)
+        .value("MAX_ITERATIONS", chemsim::OptStatus::max_iterations)
+        .value("LINE_SEARCH_FAILED", chemsim::OptStatus::line_search_failed)
+        .value("CANCELLED", chemsim::OptStatus::cancelled)
+        .value("TIMED_OUT", chemsim::OptStatus::timed_out);
 
     // OptProgress
     py::class_<chemsim::OptProgress>(m, "OptProgress")
         .def_readonly("iteration", &chemsim::OptProgress::iteration)
         .def_readonly("energy", &chemsim::OptProgress::energy)
         .def_readonly("grad_norm", &chemsim::OptProgress::grad_norm)
-        .def_readonly("positions", &chemsim::OptProgress::positions);
+        .def_property_readonly("positions", [](py::object self) {
+            return positions_array(self.cast<const chemsim::OptProgress&>().positions, self);
+        });
 
     // OptResult
     py::class_<chemsim::OptResult>(m, "OptResult")
+        .def_readonly("status", &chemsim::OptResult::status)
         .def_readonly("converged", &chemsim::OptResult::converged)
         .def_readonly("iterations", &chemsim::OptResult::iterations)
         .def_readonly("final_energy", &chemsim::OptResult::final_energy)
         .def_readonly("final_grad_norm", &chemsim::OptResult::final_grad_norm)
-        .def_readonly("trajectory", &chemsim::OptResult::trajectory);
+        .def_readonly("trajectory", &chemsim::OptResult::trajectory)
+        .def_property_readonly("trajectory_positions", [](const chemsim::OptResult& r) {
+            return stack_positions(r.trajectory);
+        })
+        .def_property_readonly("trajectory_energies", [](const chemsim::OptResult& r) {
+            py::array_t<double> out(r.trajectory.size());
+            double* dst = out.mutable_data();
+            for (const auto& p : r.trajectory) *dst++ = p.energy;
+            return out;
+        });
 
     // OptSettings
     py::class_<chemsim::OptSettings>(m, "OptSettings")
@@ -118,22 +425,615 @@ PYBIND11_MODULE(chemsim_engine, m) {
         .def_readwrite("grad_tolerance", &chemsim::OptSettings::grad_tolerance)
         .def_readwrite("energy_tolerance", &chemsim::OptSettings::energy_tolerance)
         .def_readwrite("method", &chemsim::OptSettings::method)
-        .def_readwrite("store_trajectory", &chemsim::OptSettings::store_trajectory);
+        .def_readwrite("max_cg_iterations", &chemsim::OptSettings::max_cg_iterations)
+        .def_readwrite("store_trajectory", &chemsim::OptSettings::store_trajectory)
+        .def_readwrite("cancel", &chemsim::OptSettings::cancel)
+        .def_readwrite("time_budget", &chemsim::OptSettings::time_budget);
+
+    // Lock-free progress: the optimizer publishes into a ring and never calls
+    // into Python. Watch fileno() (e.g. loop.add_reader) and drain in batches.
+    py::class_<chemsim::ProgressChannel>(m, "ProgressChannel")
+        .def(py::init<size_t, int>(), py::arg("capacity") = 256, py::arg("decimation") = 1)
+        .def("fileno", &chemsim::ProgressChannel::fd)
+        .def("drain", &chemsim::ProgressChannel::drain,
+             py::arg("max_records") = static_cast<size_t>(-1))
+        .def_property_readonly("decimation", &chemsim::ProgressChannel::decimation)
+        .def_property_readonly("published", &chemsim::ProgressChannel::published)
+        .def_property_readonly("dropped", &chemsim::ProgressChannel::dropped);
 
     // Optimizer
     m.def("optimize_geometry", [](chemsim::Molecule& mol, chemsim::UFFForceField& ff,
                                    const chemsim::OptSettings& settings,
-                                   py::object callback) {
-        chemsim::ProgressCallback cpp_callback = nullptr;
+                                   py::object callback, chemsim::ProgressChannel* channel) {
+        chemsim::ProgressCallback cpp_callback = progress_callback(callback, channel);
+        py::gil_scoped_release release;
+        return chemsim::optimize_geometry(mol, ff, settings, cpp_callback);
+    }, py::arg("mol"), py::arg("ff"),
+       py::arg("settings") = chemsim::OptSettings{},
+       py::arg("callback") = py::none(), py::arg("channel") = nullptr);
+
+    // Energy providers run the engine's L-BFGS on any surface. A
+    // FunctionProvider calls fn(positions) with an (N, 3) array in Angstrom
+    // and expects (energy in kcal/mol, gradient with 3N values in
+    // kcal/mol/Angstrom), e.g. converted PySCF gradients.
+    py::class_<chemsim::EnergyProvider>(m, "EnergyProvider")
+        .def("evaluate", [](chemsim::EnergyProvider& provider, const chemsim::Molecule& mol) {
+            Eigen::VectorXd grad;
+            double energy = provider.evaluate(mol, grad);
+            return py::make_tuple(energy, grad);
+        }, py::arg("mol"));
+    py::class_<chemsim::UFFProvider, chemsim::EnergyProvider>(m, "UFFProvider")
+        .def(py::init<const chemsim::UFFForceField&>(), py::arg("ff"), py::keep_alive<1, 2>());
+    py::class_<chemsim::FunctionProvider, chemsim::EnergyProvider>(m, "FunctionProvider")
+        .def(py::init([](py::function fn) {
+            auto shared = share_object(std::move(fn));
+            return std::make_unique<chemsim::FunctionProvider>(
+                [shared](const chemsim::Molecule& mol, Eigen::VectorXd& grad) {
+                    py::gil_scoped_acquire acquire;
+                    py::array_t<double> pos({static_cast<py::ssize_t>(mol.num_atoms()), py::ssize_t{3}},
+                                            mol.coordinates());
+                    auto out = (*shared)(pos).cast<py::tuple>();
+                    if (out.size() != 2) throw std::runtime_error("FunctionProvider: expected (energy, gradient)");
+                    auto g = out[1].cast<py::array_t<double, py::array::c_style | py::array::forcecast>>();
+                    grad = Eigen::Map<const Eigen::VectorXd>(g.data(), g.size());
+                    return out[0].cast<double>();
+                });
+        }), py::arg("fn"));
+
+    // UFF model Hessian for preconditioning provider optimizations
+    py::class_<chemsim::ModelHessian>(m, "ModelHessian")
+        .def(py::init<const chemsim::Molecule&, const chemsim::UFFForceField&, double, int>(),
+             py::arg("mol"), py::arg("ff"), py::arg("min_curvature") = 10.0,
+             py::arg("num_threads") = 0, py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("dimension", &chemsim::ModelHessian::dimension)
+        .def_property_readonly("matrix", [](const chemsim::ModelHessian& h) {
+            return Eigen::MatrixXd(h.matrix());
+        })
+        .def("solve", &chemsim::ModelHessian::solve, py::arg("v"),
+             py::call_guard<py::gil_scoped_release>());
+
+    m.def("optimize_geometry", [](chemsim::Molecule& mol, chemsim::EnergyProvider& provider,
+                                   const chemsim::OptSettings& settings,
+                                   const chemsim::ModelHessian* preconditioner,
+                                   py::object callback, chemsim::ProgressChannel* channel) {
+        chemsim::ProgressCallback cpp_callback = progress_callback(callback, channel);
+        py::gil_scoped_release release;
+        return chemsim::optimize_geometry(mol, provider, settings, preconditioner, cpp_callback);
+    }, py::arg("mol"), py::arg("provider"),
+       py::arg("settings") = chemsim::OptSettings{}, py::arg("preconditioner") = nullptr,
+       py::arg("callback") = py::none(), py::arg("channel") = nullptr);
+
+    // MDFrame
+    py::class_<chemsim::MDFrame>(m, "MDFrame")
+        .def_readonly("step", &chemsim::MDFrame::step)
+        .def_readonly("time", &chemsim::MDFrame::time)
+        .def_readonly("potential_energy", &chemsim::MDFrame::potential_energy)
+        .def_readonly("kinetic_energy", &chemsim::MDFrame::kinetic_energy)
+        .def_readonly("temperature", &chemsim::MDFrame::temperature)
+        .def_property_readonly("positions", [](py::object self) {
+            return positions_array(self.cast<const chemsim::MDFrame&>().positions, self);
+        });
+
+    // MDResult
+    py::class_<chemsim::MDResult>(m, "MDResult")
+        .def_readonly("steps", &chemsim::MDResult::steps)
+        .def_readonly("wall_time", &chemsim::MDResult::wall_time)
+        .def_readonly("steps_per_second", &chemsim::MDResult::steps_per_second)
+        .def_readonly("ns_per_day", &chemsim::MDResult::ns_per_day)
+        .def_readonly("trajectory", &chemsim::MDResult::trajectory)
+        .def_property_readonly("trajectory_positions", [](const chemsim::MDResult& r) {
+            return stack_positions(r.trajectory);
+        });
+
+    // MDSettings
+    py::class_<chemsim::MDSettings>(m, "MDSettings")
+        .def(py::init<>())
+        .def_readwrite("num_steps", &chemsim::MDSettings::num_steps)
+        .def_readwrite("timestep", &chemsim::MDSettings::timestep)
+        .def_readwrite("temperature", &chemsim::MDSettings::temperature)
+        .def_readwrite("thermostat", &chemsim::MDSettings::thermostat)
+        .def_readwrite("friction", &chemsim::MDSettings::friction)
+        .def_readwrite("thermostat_period", &chemsim::MDSettings::thermostat_period)
+        .def_readwrite("output_interval", &chemsim::MDSettings::output_interval)
+        .def_readwrite("store_trajectory", &chemsim::MDSettings::store_trajectory)
+        .def_readwrite("seed", &chemsim::MDSettings::seed);
+
+    // Molecular dynamics
+    m.def("run_dynamics", [](chemsim::Molecule& mol, const chemsim::UFFForceField& ff,
+                              const chemsim::MDSettings& settings,
+                              py::object callback) {
+        chemsim::MDProgressCallback cpp_callback = nullptr;
         if (!callback.is_none()) {
-            cpp_callback = [callback](const chemsim::OptProgress& prog) {
+            cpp_callback = [callback](const chemsim::MDFrame& frame) {
                 py::gil_scoped_acquire acquire;
-                callback(prog);
+                callback(frame);
             };
         }
         py::gil_scoped_release release;
-        return chemsim::optimize_geometry(mol, ff, settings, cpp_callback);
+        return chemsim::run_dynamics(mol, ff, settings, cpp_callback);
     }, py::arg("mol"), py::arg("ff"),
-       py::arg("settings") = chemsim::OptSettings{},
+       py::arg("settings") = chemsim::MDSettings{},
        py::arg("callback") = py::none());
+
+    // RMSD
+    m.def("kabsch_rmsd", py::overload_cast<const std::vector<double>&,
+                                           const std::vector<double>&>(&chemsim::kabsch_rmsd),
+          "RMSD after optimal superposition", py::call_guard<py::gil_scoped_release>());
+
+    // Conformer
+    py::class_<chemsim::Conformer>(m, "Conformer")
+        .def_property_readonly("positions", [](py::object self) {
+            return positions_array(self.cast<const chemsim::Conformer&>().positions, self);
+        })
+        .def_readonly("energy", &chemsim::Conformer::energy)
+        .def_readonly("relative_energy", &chemsim::Conformer::relative_energy)
+        .def_readonly("converged", &chemsim::Conformer::converged);
+
+    // ConformerSearchSettings
+    py::class_<chemsim::ConformerSearchSettings>(m, "ConformerSearchSettings")
+        .def(py::init<>())
+        .def_readwrite("method", &chemsim::ConformerSearchSettings::method)
+        .def_readwrite("torsion_step", &chemsim::ConformerSearchSettings::torsion_step)
+        .def_readwrite("max_candidates", &chemsim::ConformerSearchSettings::max_candidates)
+        .def_readwrite("energy_window", &chemsim::ConformerSearchSettings::energy_window)
+        .def_readwrite("rmsd_threshold", &chemsim::ConformerSearchSettings::rmsd_threshold)
+        .def_readwrite("include_hydrogens", &chemsim::ConformerSearchSettings::include_hydrogens)
+        .def_readwrite("num_threads", &chemsim::ConformerSearchSettings::num_threads)
+        .def_readwrite("seed", &chemsim::ConformerSearchSettings::seed)
+        .def_readwrite("opt", &chemsim::ConformerSearchSettings::opt);
+
+    // Conformer search
+    m.def("find_rotatable_bonds", &chemsim::find_rotatable_bonds, py::call_guard<py::gil_scoped_release>());
+    m.def("search_conformers", &chemsim::search_conformers,
+          py::arg("mol"), py::arg("ff"),
+          py::arg("settings") = chemsim::ConformerSearchSettings{},
+          py::call_guard<py::gil_scoped_release>());
+
+    // ScanDihedral
+    py::class_<chemsim::ScanDihedral>(m, "ScanDihedral")
+        .def(py::init<>())
+        .def(py::init([](int i, int j, int k, int l, double start, double step, int num_points) {
+            return chemsim::ScanDihedral{i, j, k, l, start, step, num_points};
+        }), py::arg("i"), py::arg("j"), py::arg("k"), py::arg("l"),
+            py::arg("start") = -180.0, py::arg("step") = 15.0, py::arg("num_points") = 24)
+        .def_readwrite("i", &chemsim::ScanDihedral::i)
+        .def_readwrite("j", &chemsim::ScanDihedral::j)
+        .def_readwrite("k", &chemsim::ScanDihedral::k)
+        .def_readwrite("l", &chemsim::ScanDihedral::l)
+        .def_readwrite("start", &chemsim::ScanDihedral::start)
+        .def_readwrite("step", &chemsim::ScanDihedral::step)
+        .def_readwrite("num_points", &chemsim::ScanDihedral::num_points);
+
+    // ScanSettings
+    py::class_<chemsim::ScanSettings>(m, "ScanSettings")
+        .def(py::init<>())
+        .def_readwrite("force_constant", &chemsim::ScanSettings::force_constant)
+        .def_readwrite("store_geometries", &chemsim::ScanSettings::store_geometries)
+        .def_readwrite("num_threads", &chemsim::ScanSettings::num_threads)
+        .def_readwrite("opt", &chemsim::ScanSettings::opt);
+
+    // ScanResult
+    py::class_<chemsim::ScanResult>(m, "ScanResult")
+        .def_readonly("angles1", &chemsim::ScanResult::angles1)
+        .def_readonly("angles2", &chemsim::ScanResult::angles2)
+        .def_readonly("energies", &chemsim::ScanResult::energies)
+        .def_readonly("converged", &chemsim::ScanResult::converged)
+        .def_readonly("geometries", &chemsim::ScanResult::geometries);
+
+    // Relaxed scans
+    m.def("relaxed_scan", &chemsim::relaxed_scan,
+          py::arg("mol"), py::arg("ff"), py::arg("dihedral"),
+          py::arg("settings") = chemsim::ScanSettings{},
+          py::call_guard<py::gil_scoped_release>());
+    m.def("relaxed_scan_2d", &chemsim::relaxed_scan_2d,
+          py::arg("mol"), py::arg("ff"), py::arg("dihedral1"), py::arg("dihedral2"),
+          py::arg("settings") = chemsim::ScanSettings{},
+          py::call_guard<py::gil_scoped_release>());
+
+    // NEBSettings
+    py::class_<chemsim::NEBSettings>(m, "NEBSettings")
+        .def(py::init<>())
+        .def_readwrite("num_images", &chemsim::NEBSettings::num_images)
+        .def_readwrite("interpolation", &chemsim::NEBSettings::interpolation)
+        .def_readwrite("method", &chemsim::NEBSettings::method)
+        .def_readwrite("climbing_image", &chemsim::NEBSettings::climbing_image)
+        .def_readwrite("climb_threshold", &chemsim::NEBSettings::climb_threshold)
+        .def_readwrite("spring_constant", &chemsim::NEBSettings::spring_constant)
+        .def_readwrite("max_iterations", &chemsim::NEBSettings::max_iterations)
+        .def_readwrite("force_tolerance", &chemsim::NEBSettings::force_tolerance)
+        .def_readwrite("max_step", &chemsim::NEBSettings::max_step)
+        .def_readwrite("num_threads", &chemsim::NEBSettings::num_threads);
+
+    // NEBResult
+    py::class_<chemsim::NEBResult>(m, "NEBResult")
+        .def_readonly("converged", &chemsim::NEBResult::converged)
+        .def_readonly("iterations", &chemsim::NEBResult::iterations)
+        .def_readonly("images", &chemsim::NEBResult::images)
+        .def_readonly("energies", &chemsim::NEBResult::energies)
+        .def_readonly("climbing_image", &chemsim::NEBResult::climbing_image)
+        .def_readonly("barrier", &chemsim::NEBResult::barrier)
+        .def_readonly("max_force", &chemsim::NEBResult::max_force);
+
+    // Nudged elastic band
+    m.def("interpolate_images", &chemsim::interpolate_images,
+          py::arg("reactant"), py::arg("product"), py::arg("num_images"),
+          py::arg("method") = "idpp", py::arg("num_threads") = 0,
+          py::call_guard<py::gil_scoped_release>());
+    m.def("run_neb", &chemsim::run_neb,
+          py::arg("reactant"), py::arg("product"), py::arg("ff"),
+          py::arg("settings") = chemsim::NEBSettings{},
+          py::call_guard<py::gil_scoped_release>());
+
+    // VibrationalSettings
+    py::class_<chemsim::VibrationalSettings>(m, "VibrationalSettings")
+        .def(py::init<>())
+        .def_readwrite("step", &chemsim::VibrationalSettings::step)
+        .def_readwrite("solver", &chemsim::VibrationalSettings::solver)
+        .def_readwrite("num_modes", &chemsim::VibrationalSettings::num_modes)
+        .def_readwrite("num_threads", &chemsim::VibrationalSettings::num_threads);
+
+    // VibrationalResult
+    py::class_<chemsim::VibrationalResult>(m, "VibrationalResult")
+        .def_readonly("frequencies", &chemsim::VibrationalResult::frequencies)
+        .def_readonly("normal_modes", &chemsim::VibrationalResult::normal_modes)
+        .def_readonly("num_imaginary", &chemsim::VibrationalResult::num_imaginary);
+
+    // Vibrational analysis
+    m.def("compute_hessian", &chemsim::compute_hessian,
+          py::arg("mol"), py::arg("ff"), py::arg("step") = 0.005, py::arg("num_threads") = 0,
+          py::call_guard<py::gil_scoped_release>());
+    m.def("vibrational_analysis", &chemsim::vibrational_analysis,
+          py::arg("mol"), py::arg("ff"),
+          py::arg("settings") = chemsim::VibrationalSettings{},
+          py::call_guard<py::gil_scoped_release>());
+
+    // EmbedSettings
+    py::class_<chemsim::EmbedSettings>(m, "EmbedSettings")
+        .def(py::init<>())
+        .def_readwrite("num_embeddings", &chemsim::EmbedSettings::num_embeddings)
+        .def_readwrite("seed", &chemsim::EmbedSettings::seed)
+        .def_readwrite("max_attempts", &chemsim::EmbedSettings::max_attempts)
+        .def_readwrite("refine", &chemsim::EmbedSettings::refine)
+        .def_readwrite("num_threads", &chemsim::EmbedSettings::num_threads)
+        .def_readwrite("opt", &chemsim::EmbedSettings::opt);
+
+    // Distance-geometry embedding
+    m.def("distance_bounds", &chemsim::distance_bounds, py::arg("mol"), py::arg("ff"),
+          py::call_guard<py::gil_scoped_release>());
+    m.def("embed_molecule", &chemsim::embed_molecule,
+          py::arg("mol"), py::arg("ff"),
+          py::arg("settings") = chemsim::EmbedSettings{},
+          py::call_guard<py::gil_scoped_release>());
+
+    // Ring perception, aromaticity and bond orders
+    m.def("find_rings", &chemsim::find_rings, py::arg("mol"), py::call_guard<py::gil_scoped_release>());
+    m.def("perceive_aromaticity", &chemsim::perceive_aromaticity, py::arg("mol"), py::call_guard<py::gil_scoped_release>());
+    m.def("assign_bond_orders", &chemsim::assign_bond_orders, py::arg("mol"), py::call_guard<py::gil_scoped_release>());
+
+    // Force-field term table cache
+    py::class_<chemsim::TermCacheStats>(m, "TermCacheStats")
+        .def_readonly("hits", &chemsim::TermCacheStats::hits)
+        .def_readonly("misses", &chemsim::TermCacheStats::misses)
+        .def_readonly("evictions", &chemsim::TermCacheStats::evictions)
+        .def_readonly("entries", &chemsim::TermCacheStats::entries)
+        .def_readonly("memory_bytes", &chemsim::TermCacheStats::memory_bytes)
+        .def_readonly("budget_bytes", &chemsim::TermCacheStats::budget_bytes);
+
+    m.def("topology_hash", &chemsim::topology_hash, py::arg("mol"), py::call_guard<py::gil_scoped_release>());
+    m.def("term_cache_stats", []() { return chemsim::UFFTermCache::instance().stats(); });
+    m.def("set_term_cache_budget", [](size_t bytes) {
+        chemsim::UFFTermCache::instance().set_budget(bytes);
+    }, py::arg("bytes"));
+    m.def("clear_term_cache", []() { chemsim::UFFTermCache::instance().clear(); });
+
+    // Batched RMSD and clustering
+    py::class_<chemsim::RMSDSettings>(m, "RMSDSettings")
+        .def(py::init<>())
+        .def_readwrite("atoms", &chemsim::RMSDSettings::atoms)
+        .def_readwrite("permutations", &chemsim::RMSDSettings::permutations)
+        .def_readwrite("num_threads", &chemsim::RMSDSettings::num_threads);
+
+    py::class_<chemsim::ClusterResult>(m, "ClusterResult")
+        .def_readonly("assignments", &chemsim::ClusterResult::assignments)
+        .def_readonly("centroids", &chemsim::ClusterResult::centroids)
+        .def_readonly("sizes", &chemsim::ClusterResult::sizes);
+
+    m.def("find_automorphisms", &chemsim::find_automorphisms,
+          py::arg("mol"), py::arg("atoms") = std::vector<int>{}, py::arg("max_count") = 1000,
+          py::call_guard<py::gil_scoped_release>());
+    // Condensed matrix handed to NumPy without a copy (scipy squareform layout)
+    m.def("rmsd_matrix", [](const std::vector<std::vector<double>>& frames,
+                            const chemsim::RMSDSettings& settings) {
+        std::vector<float>* matrix;
+        {
+            py::gil_scoped_release release;
+            matrix = new std::vector<float>(chemsim::rmsd_matrix(frames, settings));
+        }
+        py::capsule owner(matrix, [](void* p) { delete static_cast<std::vector<float>*>(p); });
+        return py::array_t<float>(matrix->size(), matrix->data(), owner);
+    }, py::arg("frames"), py::arg("settings") = chemsim::RMSDSettings{});
+    m.def("butina_cluster", &chemsim::butina_cluster,
+          py::arg("frames"), py::arg("threshold"),
+          py::arg("settings") = chemsim::RMSDSettings{},
+          py::call_guard<py::gil_scoped_release>());
+    m.def("leader_cluster", &chemsim::leader_cluster,
+          py::arg("frames"), py::arg("threshold"),
+          py::arg("settings") = chemsim::RMSDSettings{},
+          py::call_guard<py::gil_scoped_release>());
+
+    // Spatial index with NumPy outputs
+    using Points = Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>;
+    auto to_points = [](const Points& xyz) {
+        std::vector<Eigen::Vector3d> points(xyz.rows());
+        for (Eigen::Index i = 0; i < xyz.rows(); ++i) points[i] = xyz.row(i).transpose();
+        return points;
+    };
+    py::class_<chemsim::SpatialIndex>(m, "SpatialIndex")
+        .def(py::init<const chemsim::Molecule&, double>(),
+             py::arg("mol"), py::arg("cell_size") = 3.0, py::call_guard<py::gil_scoped_release>())
+        .def(py::init([to_points](const Points& xyz, double cell_size) {
+            return chemsim::SpatialIndex(to_points(xyz), cell_size);
+        }), py::arg("points"), py::arg("cell_size") = 3.0, py::call_guard<py::gil_scoped_release>())
+        .def("update", [to_points](chemsim::SpatialIndex& self, const Points& xyz) {
+            return self.update(to_points(xyz));
+        }, py::arg("points"), py::call_guard<py::gil_scoped_release>())
+        .def("update", [](chemsim::SpatialIndex& self, const chemsim::Molecule& mol) {
+            std::vector<Eigen::Vector3d> points(mol.num_atoms());
+            for (int i = 0; i < mol.num_atoms(); ++i) points[i] = mol.atom(i).position;
+            return self.update(points);
+        }, py::arg("mol"), py::call_guard<py::gil_scoped_release>())
+        .def("__len__", &chemsim::SpatialIndex::size)
+        .def_property_readonly("cell_size", &chemsim::SpatialIndex::cell_size)
+        .def("within", [](const chemsim::SpatialIndex& self, const Eigen::Vector3d& center,
+                          double radius) {
+            std::vector<int> idx;
+            {
+                py::gil_scoped_release release;
+                idx = self.within(center, radius);
+            }
+            return py::array_t<int>(idx.size(), idx.data());
+        }, py::arg("center"), py::arg("radius"))
+        .def("nearest", [](const chemsim::SpatialIndex& self, const Eigen::Vector3d& center,
+                           int k) {
+            std::vector<std::pair<int, double>> found;
+            {
+                py::gil_scoped_release release;
+                found = self.nearest(center, k);
+            }
+            py::array_t<int> idx(found.size());
+            py::array_t<double> dist(found.size());
+            auto i = idx.mutable_unchecked<1>();
+            auto d = dist.mutable_unchecked<1>();
+            for (size_t q = 0; q < found.size(); ++q) {
+                i(q) = found[q].first;
+                d(q) = found[q].second;
+            }
+            return py::make_tuple(idx, dist);
+        }, py::arg("center"), py::arg("k"))
+        .def("pairs_within", [](const chemsim::SpatialIndex& self, double cutoff, int num_threads) {
+            std::vector<std::pair<int, int>> pairs;
+            {
+                py::gil_scoped_release release;
+                pairs = self.pairs_within(cutoff, num_threads);
+            }
+            py::array_t<int> out({static_cast<py::ssize_t>(pairs.size()), py::ssize_t{2}});
+            auto o = out.mutable_unchecked<2>();
+            for (size_t p = 0; p < pairs.size(); ++p) {
+                o(p, 0) = pairs[p].first;
+                o(p, 1) = pairs[p].second;
+            }
+            return out;
+        }, py::arg("cutoff"), py::arg("num_threads") = 1);
+
+    // Streaming multi-frame XYZ
+    py::class_<chemsim::XYZFrame>(m, "XYZFrame")
+        .def_property_readonly("comment", [](const chemsim::XYZFrame& f) {
+            return std::string(f.comment);
+        })
+        .def_property_readonly("atomic_numbers", [](const chemsim::XYZFrame& f) {
+            return py::array_t<int>(f.atomic_numbers.size(), f.atomic_numbers.data());
+        })
+        .def_property_readonly("positions", [](const chemsim::XYZFrame& f) {
+            return py::array_t<double>({static_cast<py::ssize_t>(f.num_atoms()), py::ssize_t{3}},
+                                       f.positions.data());
+        })
+        .def("__len__", &chemsim::XYZFrame::num_atoms)
+        .def("to_molecule", [](const chemsim::XYZFrame& f, bool perceive_bonds) {
+            chemsim::XYZOptions options;
+            options.perceive_bonds = perceive_bonds;
+            return f.to_molecule(options);
+        }, py::arg("perceive_bonds") = true, py::call_guard<py::gil_scoped_release>());
+
+    py::class_<chemsim::XYZReader>(m, "XYZReader")
+        .def(py::init(&chemsim::XYZReader::open), py::arg("path"))
+        .def("rewind", &chemsim::XYZReader::rewind)
+        .def_property_readonly("frames_read", &chemsim::XYZReader::frames_read)
+        .def("__iter__", [](chemsim::XYZReader& self) -> chemsim::XYZReader& { return self; })
+        .def("__next__", [](chemsim::XYZReader& self) {
+            chemsim::XYZFrame frame;
+            if (!self.next(frame)) throw py::stop_iteration();
+            return frame;
+        }, py::keep_alive<0, 1>());
+
+    // Multi-record SDF with an offset index
+    py::class_<chemsim::SDFReader>(m, "SDFReader")
+        .def(py::init(&chemsim::SDFReader::open), py::arg("path"))
+        .def("__len__", &chemsim::SDFReader::size)
+        .def("__getitem__", [](const chemsim::SDFReader& self, py::ssize_t i) {
+            if (i < 0) i += static_cast<py::ssize_t>(self.size());
+            if (i < 0 || static_cast<size_t>(i) >= self.size()) throw py::index_error();
+            return self.molecule(static_cast<size_t>(i));
+        })
+        .def("record", [](const chemsim::SDFReader& self, size_t i) {
+            return std::string(self.record(i));
+        }, py::arg("index"))
+        .def("properties", [](const chemsim::SDFReader& self, size_t i) {
+            py::dict props;
+            for (const auto& [key, value] : self.properties(i)) props[py::str(key)] = value;
+            return props;
+        }, py::arg("index"))
+        .def("molecules", &chemsim::SDFReader::molecules,
+             py::arg("begin") = 0, py::arg("end") = static_cast<size_t>(-1),
+             py::arg("num_threads") = 0,
+             py::call_guard<py::gil_scoped_release>());
+
+    // Binary molecule library
+    py::class_<chemsim::LibraryOptions>(m, "LibraryOptions")
+        .def(py::init<>())
+        .def_readwrite("topology_hashes", &chemsim::LibraryOptions::topology_hashes)
+        .def_readwrite("atom_types", &chemsim::LibraryOptions::atom_types)
+        .def_readwrite("num_threads", &chemsim::LibraryOptions::num_threads);
+
+    m.def("convert_to_library", &chemsim::convert_to_library,
+          py::arg("input_path"), py::arg("output_path"),
+          py::arg("options") = chemsim::LibraryOptions{},
+          py::call_guard<py::gil_scoped_release>());
+    m.def("write_library", [](const std::vector<chemsim::Molecule>& mols, const std::string& path,
+                              const chemsim::LibraryOptions& options) {
+        chemsim::LibraryBuilder builder(options);
+        builder.add(mols);
+        builder.write(path);
+    }, py::arg("molecules"), py::arg("path"), py::arg("options") = chemsim::LibraryOptions{},
+       py::call_guard<py::gil_scoped_release>());
+
+    py::class_<chemsim::MoleculeLibrary>(m, "MoleculeLibrary")
+        .def(py::init(&chemsim::MoleculeLibrary::open), py::arg("path"))
+        .def("__len__", &chemsim::MoleculeLibrary::size)
+        .def("__getitem__", [](const chemsim::MoleculeLibrary& self, py::ssize_t i) {
+            if (i < 0) i += static_cast<py::ssize_t>(self.size());
+            if (i < 0 || static_cast<size_t>(i) >= self.size()) throw py::index_error();
+            return self.molecule(static_cast<size_t>(i));
+        })
+        .def_property_readonly("has_topology_hashes", &chemsim::MoleculeLibrary::has_topology_hashes)
+        .def_property_readonly("has_atom_types", &chemsim::MoleculeLibrary::has_atom_types)
+        .def("name", [](const chemsim::MoleculeLibrary& self, size_t i) {
+            return std::string(self.view(i).name());
+        }, py::arg("index"))
+        .def("topology_hash", [](const chemsim::MoleculeLibrary& self, size_t i) {
+            return self.view(i).topology_hash();
+        }, py::arg("index"))
+        // Read-only (N, 3) array over the mapped file; keeps the library alive
+        .def("positions", [](py::object self, size_t i) {
+            auto view = self.cast<const chemsim::MoleculeLibrary&>().view(i);
+            py::array_t<double> arr({static_cast<py::ssize_t>(view.num_atoms()), py::ssize_t{3}},
+                                    view.positions(), self);
+            arr.attr("setflags")(py::arg("write") = false);
+            return arr;
+        }, py::arg("index"))
+        .def("atomic_numbers", [](const chemsim::MoleculeLibrary& self, size_t i) {
+            auto view = self.view(i);
+            py::array_t<int> out(view.num_atoms());
+            auto o = out.mutable_unchecked<1>();
+            for (int a = 0; a < view.num_atoms(); ++a) o(a) = view.atomic_number(a);
+            return out;
+        }, py::arg("index"));
+
+    // PDB / mmCIF
+    py::class_<chemsim::PDBOptions>(m, "PDBOptions")
+        .def(py::init<>())
+        .def_readwrite("use_conect", &chemsim::PDBOptions::use_conect)
+        .def_readwrite("use_templates", &chemsim::PDBOptions::use_templates)
+        .def_readwrite("perceive_unknown", &chemsim::PDBOptions::perceive_unknown)
+        .def_readwrite("assign_bond_orders", &chemsim::PDBOptions::assign_bond_orders);
+
+    py::class_<chemsim::Residue>(m, "Residue")
+        .def_readonly("name", &chemsim::Residue::name)
+        .def_readonly("seq", &chemsim::Residue::seq)
+        .def_readonly("insertion", &chemsim::Residue::insertion)
+        .def_readonly("hetero", &chemsim::Residue::hetero)
+        .def_readonly("chain", &chemsim::Residue::chain)
+        .def_readonly("first_atom", &chemsim::Residue::first_atom)
+        .def_readonly("num_atoms", &chemsim::Residue::num_atoms);
+
+    py::class_<chemsim::PDBStructure>(m, "PDBStructure")
+        .def_readonly("mol", &chemsim::PDBStructure::mol)
+        .def_readonly("residues", &chemsim::PDBStructure::residues)
+        .def_readonly("chains", &chemsim::PDBStructure::chains)
+        .def("atom_name", [](const chemsim::PDBStructure& s, int i) {
+            return std::string(s.atom_name(i));
+        }, py::arg("index"))
+        .def_property_readonly("altlocs", [](const chemsim::PDBStructure& s) {
+            return std::string(s.altlocs.begin(), s.altlocs.end());
+        })
+        .def_property_readonly("occupancies", [](const chemsim::PDBStructure& s) {
+            return py::array_t<float>(s.occupancies.size(), s.occupancies.data());
+        })
+        .def_property_readonly("b_factors", [](const chemsim::PDBStructure& s) {
+            return py::array_t<float>(s.b_factors.size(), s.b_factors.data());
+        })
+        .def_property_readonly("atom_residues", [](const chemsim::PDBStructure& s) {
+            return py::array_t<int>(s.atom_residues.size(), s.atom_residues.data());
+        });
+
+    m.def("parse_pdb", [](const std::string& content, const chemsim::PDBOptions& options) {
+        return chemsim::parse_pdb(content, options);
+    }, py::arg("content"), py::arg("options") = chemsim::PDBOptions{},
+       py::call_guard<py::gil_scoped_release>());
+    m.def("parse_mmcif", [](const std::string& content, const chemsim::PDBOptions& options) {
+        return chemsim::parse_mmcif(content, options);
+    }, py::arg("content"), py::arg("options") = chemsim::PDBOptions{},
+       py::call_guard<py::gil_scoped_release>());
+    m.def("read_structure", &chemsim::read_structure,
+          py::arg("path"), py::arg("options") = chemsim::PDBOptions{},
+          py::call_guard<py::gil_scoped_release>());
+
+    // Writers
+    m.def("write_sdf", py::overload_cast<const chemsim::Molecule&, const chemsim::SDFProperties&>(
+              &chemsim::write_sdf),
+          py::arg("mol"), py::arg("properties") = chemsim::SDFProperties{},
+          py::call_guard<py::gil_scoped_release>());
+    m.def("write_sdf_file", &chemsim::write_sdf_file,
+          py::arg("path"), py::arg("molecules"),
+          py::arg("properties") = std::vector<chemsim::SDFProperties>{},
+          py::call_guard<py::gil_scoped_release>());
+    m.def("write_xyz_frames", [](const std::string& path, const chemsim::Molecule& mol,
+                                 const std::vector<std::vector<double>>& frames,
+                                 const std::vector<std::string>& comments, int precision) {
+        auto out = chemsim::TextWriter::open(path);
+        chemsim::write_xyz_frames(*out, mol, frames, comments, precision);
+        out->flush();
+    }, py::arg("path"), py::arg("mol"), py::arg("frames"),
+       py::arg("comments") = std::vector<std::string>{}, py::arg("precision") = 6,
+       py::call_guard<py::gil_scoped_release>());
+
+    // Jobs completing through a file descriptor, for event loops. Each job
+    // calls fn(*args, **kwargs) on a worker; engine functions release the
+    // GIL while they compute, so jobs run in parallel.
+    py::class_<PyJobQueue>(m, "JobQueue")
+        .def(py::init<int>(), py::arg("num_threads") = 0)
+        .def("fileno", [](const PyJobQueue& self) { return self.queue->completion_fd(); })
+        .def("submit", [](PyJobQueue& self, py::object fn, py::args args, py::kwargs kwargs) {
+            auto job = std::make_shared<PyJob>();
+            job->fn = std::move(fn);
+            job->args = std::move(args);
+            job->kwargs = std::move(kwargs);
+            uint64_t id = self.queue->submit([job]() {
+                py::gil_scoped_acquire gil;
+                try {
+                    job->result = job->fn(*job->args, **job->kwargs);
+                } catch (py::error_already_set& e) {
+                    job->failed = true;
+                    job->result = e.value();
+                } catch (const std::exception& e) {
+                    job->failed = true;
+                    job->result = py::module_::import("builtins").attr("RuntimeError")(e.what());
+                }
+            });
+            self.jobs.emplace(id, std::move(job));
+            return id;
+        }, py::arg("fn"))
+        // (id, ok, result or exception) for each job finished since the last call
+        .def("completed", [](PyJobQueue& self) {
+            py::list out;
+            for (const auto& done : self.queue->take_completed()) {
+                auto it = self.jobs.find(done.id);
+                if (it == self.jobs.end()) continue;
+                out.append(py::make_tuple(done.id, !it->second->failed, it->second->result));
+                self.jobs.erase(it);
+            }
+            return out;
+        })
+        .def_property_readonly("pending", [](const PyJobQueue& self) {
+            return self.queue->pending();
+        });
 }
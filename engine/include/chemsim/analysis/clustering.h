@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+#include "chemsim/analysis/rmsd.h"
+
+namespace chemsim {
+
+struct ClusterResult {
+    std::vector<int> assignments; // cluster index per frame
+    std::vector<int> centroids;   // representative frame per cluster
+    std::vector<int> sizes;       // members per cluster
+};
+
+// Taylor-Butina clustering: frames with the most neighbors within threshold
+// (Angstroms) become centroids first and claim their unassigned neighbors.
+// Neighbor lists are built in parallel; the full matrix is never stored.
+ClusterResult butina_cluster(
+    const std::vector<std::vector<double>>& frames,
+    double threshold,
+    const RMSDSettings& settings = RMSDSettings{}
+);
+
+// Leader clustering in frame order: each frame joins the nearest existing
+// leader within threshold, otherwise it leads a new cluster. O(n * k).
+ClusterResult leader_cluster(
+    const std::vector<std::vector<double>>& frames,
+    double threshold,
+    const RMSDSettings& settings = RMSDSettings{}
+);
+
+} // namespace chemsim
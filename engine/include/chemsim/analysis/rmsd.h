@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "chemsim/core/molecule.h"
+
+namespace chemsim {
+
+// RMSD (Angstroms) between two flat 3N position vectors after optimal
+// superposition (Kabsch). Both frames must list atoms in the same order.
+double kabsch_rmsd(const std::vector<double>& a, const std::vector<double>& b);
+
+// As above, restricted to the given atom indices
+double kabsch_rmsd(const std::vector<double>& a, const std::vector<double>& b,
+                   const std::vector<int>& atoms);
+
+struct RMSDSettings {
+    std::vector<int> atoms;                     // atoms to superpose and compare (empty = all)
+    std::vector<std::vector<int>> permutations; // equivalent orderings of atoms (positions in
+                                                // the atoms list); the minimum RMSD is taken
+    int num_threads = 0;                        // 0 = all cores
+};
+
+// Topological automorphisms of the subgraph induced by atoms (empty = all),
+// as permutations of positions in that list; identity first. Atoms are
+// matched on element, total degree and bond orders. Stops at max_count.
+std::vector<std::vector<int>> find_automorphisms(
+    const Molecule& mol,
+    const std::vector<int>& atoms = {},
+    int max_count = 1000
+);
+
+// Frames sharing one topology, centered once and stored as separate x/y/z
+// arrays so the per-pair inner products vectorize over atoms
+class RMSDFrames {
+public:
+    RMSDFrames(const std::vector<std::vector<double>>& frames, const std::vector<int>& atoms);
+
+    int num_frames() const { return num_frames_; }
+    int num_atoms() const { return num_atoms_; }
+
+    // Minimum QCP RMSD of frames i and j over the given permutations
+    double rmsd(int i, int j, const std::vector<std::vector<int>>& permutations) const;
+
+private:
+    int num_frames_;
+    int num_atoms_;
+    std::vector<double> x_, y_, z_; // frame-major
+    std::vector<double> g_;         // sum of squared centered coordinates
+};
+
+// Index of pair (i, j), i < j, in a condensed upper-triangle matrix
+inline size_t condensed_index(size_t i, size_t j, size_t n) {
+    return i * n - i * (i + 1) / 2 + (j - i - 1);
+}
+
+// All-pairs RMSD (QCP superposition), computed in parallel, as a condensed
+// upper triangle of n(n-1)/2 floats (10k frames = 200 MB)
+std::vector<float> rmsd_matrix(
+    const std::vector<std::vector<double>>& frames,
+    const RMSDSettings& settings = RMSDSettings{}
+);
+
+} // namespace chemsim
@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <Eigen/Dense>
+#include "chemsim/core/molecule.h"
+#include "chemsim/ff/uff_energy.h"
+
+namespace chemsim {
+
+struct VibrationalSettings {
+    double step = 0.005;             // finite-difference displacement (Angstroms)
+    std::string solver = "dense";    // "dense" (full Hessian) or "lanczos" (lowest modes)
+    int num_modes = 10;              // lanczos: number of lowest modes to return
+    int num_threads = 0;             // dense: gradient threads (0 = all cores)
+};
+
+struct VibrationalResult {
+    std::vector<double> frequencies;               // cm^-1 ascending, imaginary as negative
+    std::vector<std::vector<double>> normal_modes; // normalized Cartesian displacements (3N)
+    int num_imaginary;
+};
+
+// Cartesian Hessian (kcal/mol/Angstrom^2) from central differences of the
+// analytic gradient. The 6N displaced gradients run on a thread pool.
+Eigen::MatrixXd compute_hessian(
+    const Molecule& mol,
+    const UFFForceField& ff,
+    double step = 0.005,
+    int num_threads = 0
+);
+
+// Harmonic frequencies and normal modes with translations and rotations
+// projected out. "dense" diagonalizes the full mass-weighted Hessian;
+// "lanczos" finds only the lowest num_modes from Hessian-vector products,
+// without ever forming the Hessian.
+VibrationalResult vibrational_analysis(
+    const Molecule& mol,
+    const UFFForceField& ff,
+    const VibrationalSettings& settings = VibrationalSettings{}
+);
+
+} // namespace chemsim
@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "chemsim/core/molecule.h"
+#include "chemsim/ff/uff_energy.h"
+#include "chemsim/opt/optimizer.h"
+
+namespace chemsim {
+
+struct Conformer {
+    std::vector<double> positions;
+    double energy;           // kcal/mol
+    double relative_energy;  // kcal/mol above the lowest conformer
+    bool converged;
+};
+
+struct ConformerSearchSettings {
+    std::string method = "systematic"; // "systematic" (torsion driving) or "random"
+    double torsion_step = 120.0;       // degrees between driven torsion values
+    int max_candidates = 300;          // systematic grids larger than this are subsampled
+    double energy_window = 10.0;       // kcal/mol above the minimum to keep
+    double rmsd_threshold = 0.5;       // Angstroms; closer conformers are duplicates
+    bool include_hydrogens = false;    // use hydrogens in the RMSD comparison
+    int num_threads = 0;               // 0 = all cores
+    unsigned int seed = 42;
+    OptSettings opt;                   // per-candidate minimization
+};
+
+// Single, acyclic bonds between two non-terminal atoms. Rotors whose far
+// side is three hydrogens (methyl, ammonium) are skipped as symmetric.
+std::vector<Bond> find_rotatable_bonds(const Molecule& mol);
+
+// Generate torsional candidates from mol's geometry, minimize them in
+// parallel against one shared, already set-up force field, and return the
+// unique conformers within the energy window, lowest energy first.
+std::vector<Conformer> search_conformers(
+    const Molecule& mol,
+    const UFFForceField& ff,
+    const ConformerSearchSettings& settings = ConformerSearchSettings{}
+);
+
+} // namespace chemsim
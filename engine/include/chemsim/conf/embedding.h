@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include <Eigen/Dense>
+#include "chemsim/core/molecule.h"
+#include "chemsim/ff/uff_energy.h"
+#include "chemsim/opt/optimizer.h"
+#include "chemsim/conf/conformer_search.h"
+
+namespace chemsim {
+
+struct EmbedSettings {
+    int num_embeddings = 1;
+    unsigned int seed = 42;       // embedding k draws from seed + k
+    int max_attempts = 10;        // metric-matrix retries per embedding
+    bool refine = true;           // minimize each embedding with UFF
+    int num_threads = 0;          // 0 = all cores
+    OptSettings opt;              // UFF refinement
+};
+
+// Distance bounds from connectivity: upper bounds above the diagonal,
+// lower bounds below it. 1-2 and 1-3 bounds come from UFF bond lengths and
+// natural angles, 1-4 bounds span the cis and trans distances, and the
+// rest are floored by UFF van der Waals radii. ff must be set up on mol.
+Eigen::MatrixXd distance_bounds(const Molecule& mol, const UFFForceField& ff);
+
+// Triangle-inequality smoothing of a bounds matrix in place (Floyd).
+// Returns false if the bounds are geometrically inconsistent.
+bool smooth_bounds(Eigen::MatrixXd& bounds);
+
+// Generate 3D coordinates from mol's bonds alone (input positions are
+// ignored): random distances within the smoothed bounds, metric-matrix
+// embedding, bounds-violation minimization, then optional UFF refinement.
+// Embeddings run in parallel and are reproducible for a given seed,
+// independent of the thread count. Stereochemistry is not constrained.
+// Results are in embedding order.
+std::vector<Conformer> embed_molecule(
+    const Molecule& mol,
+    const UFFForceField& ff,
+    const EmbedSettings& settings = EmbedSettings{}
+);
+
+} // namespace chemsim
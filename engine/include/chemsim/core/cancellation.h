@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+
+namespace chemsim {
+
+// Thrown by work that has no partial result to return when cancelled
+class OperationCancelled : public std::runtime_error {
+public:
+    OperationCancelled() : std::runtime_error("Operation cancelled") {}
+};
+
+// Cooperative cancellation flag. Copies share one flag, so a token handed
+// to a running job (e.g. inside OptSettings) can be cancelled from any
+// thread through another copy; the job polls it at safe points.
+class CancellationToken {
+public:
+    CancellationToken() : flag_(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() { flag_->store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return flag_->load(std::memory_order_relaxed); }
+    void throw_if_cancelled() const {
+        if (cancelled()) throw OperationCancelled();
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+// Wall-clock budget starting at construction; seconds <= 0 never expires
+class Deadline {
+public:
+    explicit Deadline(double seconds = 0.0)
+        : limited_(seconds > 0.0),
+          end_(std::chrono::steady_clock::now() +
+               std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                   std::chrono::duration<double>(limited_ ? seconds : 0.0))) {}
+
+    bool expired() const { return limited_ && std::chrono::steady_clock::now() >= end_; }
+
+private:
+    bool limited_;
+    std::chrono::steady_clock::time_point end_;
+};
+
+} // namespace chemsim
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <array>
 
 namespace chemsim {
@@ -17,9 +18,16 @@ struct ElementInfo {
 // Lookup by atomic number (1-118)
 const ElementInfo& element_by_number(int atomic_number);
 
+// Atomic numbers 0 .. num_elements() - 1 are in the table
+int num_elements();
+
 // Lookup by symbol ("H", "He", "Li", ...)
 const ElementInfo& element_by_symbol(const std::string& symbol);
 
+// Atomic number for a symbol, or -1 if unknown. Allocation-free table
+// lookup for parsers.
+int atomic_number_of(std::string_view symbol);
+
 // Max supported atomic number
 constexpr int MAX_ATOMIC_NUMBER = 118;
 
@@ -0,0 +1,25 @@
+#pragma once
+
+namespace chemsim {
+
+// Wakes an event loop from any thread: fd() becomes readable after
+// notify() and stays readable until drain(). An eventfd on Linux, a
+// non-blocking pipe elsewhere. notify() never blocks.
+class EventNotifier {
+public:
+    EventNotifier();
+    ~EventNotifier();
+
+    EventNotifier(const EventNotifier&) = delete;
+    EventNotifier& operator=(const EventNotifier&) = delete;
+
+    int fd() const { return read_fd_; }
+    void notify();
+    void drain();
+
+private:
+    int read_fd_ = -1;
+    int write_fd_ = -1;
+};
+
+} // namespace chemsim
@@ -0,0 +1,24 @@
+#pragma once
+#include <vector>
+#include "chemsim/core/molecule.h"
+
+namespace chemsim {
+
+// Dihedral angle i-j-k-l in degrees, in [-180, 180]
+double dihedral_angle(const Molecule& mol, int i, int j, int k, int l);
+
+// Atoms reachable from `start` without crossing its bond to `blocked`
+// (includes start; empty adjacency entries are fine)
+std::vector<int> atoms_on_side(const std::vector<std::vector<int>>& adj,
+                               int start, int blocked);
+
+// Rotate `atoms` in a flat 3N position vector by angle (radians) about the
+// axis running from atom axis_i to atom axis_j
+void rotate_about_axis(std::vector<double>& positions, int axis_i, int axis_j,
+                       const std::vector<int>& atoms, double angle);
+
+// Set dihedral i-j-k-l to `degrees` by rotating everything on l's side of
+// the j-k bond. Throws if j-k is part of a ring.
+void set_dihedral(Molecule& mol, int i, int j, int k, int l, double degrees);
+
+} // namespace chemsim
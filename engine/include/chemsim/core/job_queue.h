@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "chemsim/core/event_notifier.h"
+
+namespace chemsim {
+
+class ThreadPool;
+
+// Runs jobs on a fixed pool and reports completions through a file
+// descriptor, so an event loop (select/epoll, asyncio add_reader) can wait
+// for engine work without a thread per job.
+class JobQueue {
+public:
+    struct Completion {
+        uint64_t id;
+        std::exception_ptr error; // null on success
+    };
+
+    // num_threads <= 0 uses default_num_threads()
+    explicit JobQueue(int num_threads = 0);
+    // Waits for queued jobs to finish
+    ~JobQueue();
+
+    JobQueue(const JobQueue&) = delete;
+    JobQueue& operator=(const JobQueue&) = delete;
+
+    // Readable while completions are waiting in take_completed()
+    int completion_fd() const { return notifier_.fd(); }
+
+    // Queue a job and return its id (ids start at 1)
+    uint64_t submit(std::function<void()> job);
+
+    // Jobs finished since the last call, in completion order; clears the
+    // descriptor's readiness
+    std::vector<Completion> take_completed();
+
+    // Jobs submitted but not yet collected by take_completed()
+    size_t pending() const;
+
+private:
+    EventNotifier notifier_;
+    std::unique_ptr<ThreadPool> pool_; // reset first in the destructor
+    mutable std::mutex mutex_;
+    uint64_t next_id_ = 1;
+    size_t outstanding_ = 0;
+    std::vector<Completion> completed_;
+};
+
+} // namespace chemsim
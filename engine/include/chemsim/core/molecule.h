@@ -1,4 +1,5 @@
 #pragma once
+#include <memory>
 #include <vector>
 #include <string>
 #include <Eigen/Dense>
@@ -9,10 +10,108 @@ struct Atom {
     int atomic_number;
     std::string symbol;
     Eigen::Vector3d position; // Angstroms
+    int formal_charge;
 
-    Atom() : atomic_number(0), position(Eigen::Vector3d::Zero()) {}
+    Atom() : atomic_number(0), position(Eigen::Vector3d::Zero()), formal_charge(0) {}
     Atom(int z, const std::string& sym, const Eigen::Vector3d& pos)
-        : atomic_number(z), symbol(sym), position(pos) {}
+        : atomic_number(z), symbol(sym), position(pos), formal_charge(0) {}
+};
+
+// An atom stored in a Molecule: element data by reference and the position
+// as a view into the molecule's coordinate buffer. Valid until atoms are
+// added; converts to Atom for a detached copy.
+struct AtomRef {
+    int& atomic_number;
+    std::string& symbol;
+    Eigen::Map<Eigen::Vector3d> position;
+    int& formal_charge;
+
+    operator Atom() const {
+        Atom atom(atomic_number, symbol, position);
+        atom.formal_charge = formal_charge;
+        return atom;
+    }
+};
+
+struct ConstAtomRef {
+    const int& atomic_number;
+    const std::string& symbol;
+    Eigen::Map<const Eigen::Vector3d> position;
+    const int& formal_charge;
+
+    operator Atom() const {
+        Atom atom(atomic_number, symbol, position);
+        atom.formal_charge = formal_charge;
+        return atom;
+    }
+};
+
+// Contiguous x, y, z per atom. Copies are deep. share() hands out
+// co-ownership for views that must outlive the molecule (NumPy arrays);
+// growing while shared moves to a new buffer, so such a view is detached
+// rather than left dangling.
+class CoordinateBuffer {
+public:
+    CoordinateBuffer() = default;
+    CoordinateBuffer(const CoordinateBuffer& other)
+        : data_(other.data_ ? std::make_shared<std::vector<double>>(*other.data_) : nullptr) {}
+    CoordinateBuffer& operator=(const CoordinateBuffer& other) {
+        if (this != &other) CoordinateBuffer(other).swap(*this);
+        return *this;
+    }
+    CoordinateBuffer(CoordinateBuffer&&) noexcept = default;
+    CoordinateBuffer& operator=(CoordinateBuffer&&) noexcept = default;
+
+    double* data() { return data_ ? data_->data() : nullptr; }
+    const double* data() const { return data_ ? data_->data() : nullptr; }
+
+    void append(const Eigen::Vector3d& p) {
+        if (!data_) {
+            data_ = std::make_shared<std::vector<double>>();
+        } else if (data_.use_count() > 1) {
+            auto grown = std::make_shared<std::vector<double>>();
+            grown->reserve(2 * data_->size() + 3);
+            grown->assign(data_->begin(), data_->end());
+            data_ = std::move(grown);
+        }
+        data_->insert(data_->end(), p.data(), p.data() + 3);
+    }
+
+    std::shared_ptr<double> share() {
+        if (!data_) data_ = std::make_shared<std::vector<double>>();
+        return std::shared_ptr<double>(data_, data_->data());
+    }
+
+    void swap(CoordinateBuffer& other) noexcept { data_.swap(other.data_); }
+
+private:
+    std::shared_ptr<std::vector<double>> data_;
+};
+
+class Molecule;
+
+// Range over a molecule's atoms as ConstAtomRef, for range-for loops
+class AtomRange {
+public:
+    class iterator {
+    public:
+        iterator(const Molecule* mol, int i) : mol_(mol), i_(i) {}
+        ConstAtomRef operator*() const;
+        iterator& operator++() { ++i_; return *this; }
+        bool operator!=(const iterator& other) const { return i_ != other.i_; }
+        bool operator==(const iterator& other) const { return i_ == other.i_; }
+    private:
+        const Molecule* mol_;
+        int i_;
+    };
+
+    explicit AtomRange(const Molecule* mol) : mol_(mol) {}
+    iterator begin() const { return iterator(mol_, 0); }
+    iterator end() const;
+    int size() const;
+
+private:
+    const Molecule* mol_;
 };
 
 struct Bond {
@@ -31,20 +130,38 @@ public:
     void add_atom(const Atom& atom);
     void add_bond(const Bond& bond);
 
-    // Perceive bonds from distance-based covalent radii
-    void perceive_bonds(double tolerance = 0.45);
+    // Perceive bonds from distance-based covalent radii. Uses a SpatialIndex
+    // (O(N)); bonds come out sorted by (atom_i, atom_j) for any thread count.
+    void perceive_bonds(double tolerance = 0.45, int num_threads = 1);
 
     // Accessors
     int num_atoms() const { return static_cast<int>(atoms_.size()); }
     int num_bonds() const { return static_cast<int>(bonds_.size()); }
 
-    const Atom& atom(int i) const { return atoms_[i]; }
-    Atom& atom(int i) { return atoms_[i]; }
+    AtomRef atom(int i) {
+        auto& a = atoms_[i];
+        return {a.atomic_number, a.symbol, Eigen::Map<Eigen::Vector3d>(coords_.data() + 3 * i),
+                a.formal_charge};
+    }
+    ConstAtomRef atom(int i) const {
+        const auto& a = atoms_[i];
+        return {a.atomic_number, a.symbol,
+                Eigen::Map<const Eigen::Vector3d>(coords_.data() + 3 * i), a.formal_charge};
+    }
     const Bond& bond(int i) const { return bonds_[i]; }
+    Bond& bond(int i) { return bonds_[i]; }
 
-    const std::vector<Atom>& atoms() const { return atoms_; }
+    AtomRange atoms() const { return AtomRange(this); }
     const std::vector<Bond>& bonds() const { return bonds_; }
 
+    // Positions stored contiguously, x y z per atom (3*N doubles). The
+    // pointer is invalidated by add_atom; share_coordinates() co-owns the
+    // buffer instead, and a buffer shared when atoms are added stays valid
+    // but no longer tracks the molecule.
+    double* coordinates() { return coords_.data(); }
+    const double* coordinates() const { return coords_.data(); }
+    std::shared_ptr<double> share_coordinates() { return coords_.share(); }
+
     // Get/set all positions as flat vector (3*N)
     std::vector<double> get_positions() const;
     void set_positions(const std::vector<double>& positions);
@@ -61,8 +178,20 @@ public:
     std::string comment;
 
 private:
-    std::vector<Atom> atoms_;
+    // Atom fields other than the position, which lives in coords_
+    struct AtomData {
+        int atomic_number;
+        std::string symbol;
+        int formal_charge;
+    };
+
+    std::vector<AtomData> atoms_;
+    CoordinateBuffer coords_;
     std::vector<Bond> bonds_;
 };
 
+inline ConstAtomRef AtomRange::iterator::operator*() const { return mol_->atom(i_); }
+inline AtomRange::iterator AtomRange::end() const { return iterator(mol_, mol_->num_atoms()); }
+inline int AtomRange::size() const { return mol_->num_atoms(); }
+
 } // namespace chemsim
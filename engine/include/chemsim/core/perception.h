@@ -0,0 +1,24 @@
+#pragma once
+#include <vector>
+#include "chemsim/core/molecule.h"
+
+namespace chemsim {
+
+// Smallest set of smallest rings, each as an ordered cycle of atom indices.
+// Ring systems are found from the bridges of the bond graph and searched
+// independently, so the cost is linear in the number of atoms for
+// molecules whose ring systems are of bounded size.
+std::vector<std::vector<int>> find_rings(const Molecule& mol);
+
+// Mark the bonds of Hueckel (4n+2) aromatic rings with order 4. Single
+// rings are tested first, then pairs of rings fused on one bond (azulene).
+// Expects a Kekule structure or bonds already marked aromatic.
+void perceive_aromaticity(Molecule& mol);
+
+// Assign Kekule bond orders and formal charges from connectivity alone,
+// then perceive aromaticity. Meant for molecules whose bonds came from
+// perceive_bonds (all single); existing multiple bonds are respected.
+// Requires explicit hydrogens.
+void assign_bond_orders(Molecule& mol);
+
+} // namespace chemsim
@@ -0,0 +1,134 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <Eigen/Dense>
+
+namespace chemsim {
+
+class Molecule;
+
+// Sparse grid over a set of points (usually atom positions) answering
+// radius, k-nearest and all-pairs-within-cutoff queries. Only occupied cells
+// are stored, in a hash map keyed by integer cell coordinates, so memory and
+// query cost follow the number of points rather than the bounding box, and a
+// distant outlier does not coarsen the cells. Points are kept in cell order
+// so a query scans contiguous memory. Results are exact for any radius;
+// cell_size should be close to the typical query radius.
+class SpatialIndex {
+public:
+    SpatialIndex() = default;
+    SpatialIndex(const std::vector<Eigen::Vector3d>& points, double cell_size);
+    SpatialIndex(const Molecule& mol, double cell_size);
+
+    void build(const std::vector<Eigen::Vector3d>& points, double cell_size);
+
+    // Move the points (same count as built). Points that stay in their cell
+    // only have coordinates refreshed; otherwise the points are re-bucketed.
+    // Returns the number of points that changed cell.
+    int update(const std::vector<Eigen::Vector3d>& points);
+
+    int size() const { return static_cast<int>(points_.size()); }
+    double cell_size() const { return cell_; }
+    const Eigen::Vector3d& point(int i) const { return points_[i]; }
+
+    // Indices of points within radius of center (inclusive), ascending
+    std::vector<int> within(const Eigen::Vector3d& center, double radius) const;
+
+    // The k nearest points as (index, distance), closest first. Non-finite
+    // points have no distance and are never returned, so fewer than k may
+    // come back; a non-finite center finds nothing.
+    std::vector<std::pair<int, double>> nearest(const Eigen::Vector3d& center, int k) const;
+
+    // All pairs (i < j) no farther apart than cutoff, sorted by (i, j)
+    std::vector<std::pair<int, int>> pairs_within(double cutoff, int num_threads = 1) const;
+
+    // Call fn(j, squared_distance) for every point j within radius of center
+    template <typename F>
+    void for_each_within(const Eigen::Vector3d& center, double radius, F&& fn) const {
+        if (points_.empty()) return;
+        Eigen::Vector3d span = Eigen::Vector3d::Constant(radius);
+        CellKey first = cell_of(center - span);
+        CellKey last = cell_of(center + span);
+        double r2 = radius * radius;
+        auto scan = [&](const Cell& cell) {
+            for (int s = cell.begin; s < cell.end; ++s) {
+                double d2 = (sorted_[s] - center).squaredNorm();
+                if (d2 <= r2) fn(cell_points_[s], d2);
+            }
+        };
+
+        // Probe each cell of the query box, unless the box has more cells
+        // than are occupied; then walk the occupied cells instead
+        double box_cells = 1.0;
+        for (int d = 0; d < 3; ++d) box_cells *= static_cast<double>(last[d] - first[d] + 1);
+        if (box_cells > static_cast<double>(cells_.size())) {
+            for (const auto& cell : cells_) {
+                bool inside = true;
+                for (int d = 0; d < 3; ++d) {
+                    inside = inside && cell.key[d] >= first[d] && cell.key[d] <= last[d];
+                }
+                if (inside) scan(cell);
+            }
+            return;
+        }
+        CellKey c;
+        for (c[0] = first[0]; c[0] <= last[0]; ++c[0]) {
+            for (c[1] = first[1]; c[1] <= last[1]; ++c[1]) {
+                for (c[2] = first[2]; c[2] <= last[2]; ++c[2]) {
+                    auto it = cell_map_.find(c);
+                    if (it != cell_map_.end()) scan(cells_[it->second]);
+                }
+            }
+        }
+    }
+
+private:
+    using CellKey = std::array<long, 3>;
+    struct CellHash {
+        size_t operator()(const CellKey& c) const {
+            uint64_t h = static_cast<uint64_t>(c[0]) * 73856093ULL;
+            h ^= static_cast<uint64_t>(c[1]) * 19349663ULL;
+            h ^= static_cast<uint64_t>(c[2]) * 83492791ULL;
+            return static_cast<size_t>(h ^ (h >> 29));
+        }
+    };
+    struct Cell {
+        CellKey key;
+        int begin = 0;  // range in cell_points_ / sorted_
+        int end = 0;
+    };
+
+    // Integer cell coordinates; clamped so that far-off or non-finite
+    // coordinates cannot overflow the cast. Far-off points share edge cells
+    // and queries on them stay exact; NaN points land in an edge cell but
+    // never match, since their distance compares false.
+    CellKey cell_of(const Eigen::Vector3d& p) const {
+        constexpr double limit = 1e15;
+        CellKey c;
+        for (int d = 0; d < 3; ++d) {
+            double v = std::floor(p[d] / cell_);
+            c[d] = static_cast<long>(v > limit ? limit : (v > -limit ? v : -limit));
+        }
+        return c;
+    }
+    void bucket();
+    // Whether the query box around center spans every occupied cell
+    bool covers_all(const Eigen::Vector3d& center, double radius) const;
+
+    double cell_ = 1.0;
+    CellKey lo_key_{{0, 0, 0}};             // bounds of the occupied cells
+    CellKey hi_key_{{0, 0, 0}};
+    std::vector<Eigen::Vector3d> points_;   // by point index
+    std::vector<CellKey> point_cell_;       // by point index
+    std::vector<Cell> cells_;               // occupied cells
+    std::unordered_map<CellKey, int, CellHash> cell_map_;  // key -> index into cells_
+    std::vector<int> cell_points_;          // point indices in cell order
+    std::vector<Eigen::Vector3d> sorted_;   // positions in cell order
+};
+
+} // namespace chemsim
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace chemsim {
+
+// Bounded single-producer/single-consumer ring that never blocks the
+// producer: when full, push() drops the oldest unread item. Positions are
+// monotonic counters; the consumer claims an item by advancing the read
+// position with a CAS, which the producer also uses to drop. The slot the
+// consumer is copying out of is published so the producer never overwrites
+// it; in that case (the consumer stalled for a whole ring) the new item is
+// dropped instead.
+template <typename T>
+class SPSCRing {
+public:
+    explicit SPSCRing(size_t capacity)
+        : capacity_(capacity), slots_(capacity + 1) {
+        if (capacity == 0) throw std::runtime_error("SPSCRing: capacity must be positive");
+    }
+
+    SPSCRing(const SPSCRing&) = delete;
+    SPSCRing& operator=(const SPSCRing&) = delete;
+
+    size_t capacity() const { return capacity_; }
+    size_t size() const {
+        return static_cast<size_t>(write_.load(std::memory_order_acquire) -
+                                   read_.load(std::memory_order_acquire));
+    }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // Producer only. Returns false if the item itself was dropped.
+    bool push(T item) {
+        uint64_t w = write_.load(std::memory_order_relaxed);
+        uint64_t r = read_.load();
+        while (w - r >= capacity_) {
+            if (read_.compare_exchange_weak(r, r + 1)) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                r++;
+            }
+        }
+        size_t slot = static_cast<size_t>(w % slots_.size());
+        if (reading_.load() == slot) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        slots_[slot] = std::move(item);
+        write_.store(w + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns false when empty.
+    bool pop(T& out) {
+        uint64_t r = read_.load();
+        for (;;) {
+            if (r == write_.load(std::memory_order_acquire)) return false;
+            size_t slot = static_cast<size_t>(r % slots_.size());
+            reading_.store(slot);
+            if (read_.compare_exchange_strong(r, r + 1)) {
+                out = std::move(slots_[slot]);
+                reading_.store(kNone);
+                return true;
+            }
+            // The producer dropped r; r now holds the new read position
+            reading_.store(kNone);
+        }
+    }
+
+private:
+    static constexpr size_t kNone = static_cast<size_t>(-1);
+
+    size_t capacity_;
+    std::vector<T> slots_; // one spare so a full ring never wraps onto the read slot
+    alignas(64) std::atomic<uint64_t> write_{0};
+    alignas(64) std::atomic<uint64_t> read_{0};
+    alignas(64) std::atomic<size_t> reading_{kNone};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+} // namespace chemsim
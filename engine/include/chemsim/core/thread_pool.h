@@ -0,0 +1,54 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace chemsim {
+
+// Number of worker threads to use when a setting asks for 0 (= all cores)
+int default_num_threads();
+
+// Fixed-size pool of worker threads
+class ThreadPool {
+public:
+    // num_threads <= 0 uses default_num_threads()
+    explicit ThreadPool(int num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return static_cast<int>(workers_.size()); }
+
+    // Run fn(i) for every i in [0, n) and wait for completion. The calling
+    // thread takes part, so nested calls from a worker cannot deadlock.
+    // The first exception thrown by fn is rethrown here.
+    void parallel_for(int n, const std::function<void(int)>& fn);
+
+    // Queue a task and return a future for its result
+    template <typename F>
+    auto submit(F&& f) -> std::future<decltype(f())> {
+        using R = decltype(f());
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        std::future<R> future = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return future;
+    }
+
+private:
+    void enqueue(std::function<void()> task);
+    void worker_loop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+};
+
+} // namespace chemsim
@@ -1,8 +1,11 @@
 #pragma once
+#include <memory>
 #include <vector>
 #include <string>
 #include <Eigen/Dense>
+#include "chemsim/core/cancellation.h"
 #include "chemsim/core/molecule.h"
+#include "chemsim/ff/uff_terms.h"
 
 namespace chemsim {
 
@@ -11,22 +14,26 @@ struct EnergyComponents {
     double angle_bend = 0.0;
     double torsion = 0.0;
     double vdw = 0.0;
+    double restraint = 0.0;
     double total = 0.0;
 };
 
-// Internal data structures built during setup
-struct AngleInfo {
-    int i, j, k;  // atom indices (j is central)
-};
-
-struct TorsionInfo {
-    int i, j, k, l;  // atom indices
+// Harmonic restraint E = 0.5 * k * (phi - phi0)^2 on dihedral i-j-k-l
+struct DihedralRestraint {
+    int i, j, k, l;        // atom indices
+    double target;         // radians
+    double force_constant; // kcal/mol/rad^2
 };
 
 class UFFForceField {
 public:
-    // Set up force field for a molecule
-    void setup(const Molecule& mol);
+    // Set up force field for a molecule. Term tables are shared through the
+    // process-wide UFFTermCache, so a topology seen before costs a hash
+    // lookup; use_cache = false always rebuilds and leaves the cache alone.
+    void setup(const Molecule& mol, bool use_cache = true);
+    // As above, polling cancel while building tables; throws
+    // OperationCancelled and leaves the previous tables in place
+    void setup(const Molecule& mol, bool use_cache, const CancellationToken& cancel);
 
     // Calculate total energy (kcal/mol)
     double calculate_energy(const Molecule& mol) const;
@@ -34,17 +41,44 @@ public:
     // Calculate gradient (kcal/mol/Angstrom)
     Eigen::VectorXd calculate_gradient(const Molecule& mol) const;
 
+    // Calculate gradient into a caller-owned buffer (resized only if needed)
+    void calculate_gradient(const Molecule& mol, Eigen::VectorXd& grad) const;
+
+    // Hessian-vector product H*v (kcal/mol/Angstrom^2), from a central
+    // difference of the analytic gradient along v
+    Eigen::VectorXd hessian_vector_product(const Molecule& mol,
+                                           const Eigen::VectorXd& v) const;
+
     // Calculate energy with component breakdown
     EnergyComponents calculate_energy_components(const Molecule& mol) const;
 
+    // Natural UFF length of bond bond_idx (Angstroms)
+    double uff_bond_length(int bond_idx, const Molecule& mol) const;
+
     // Get assigned atom types
-    const std::vector<std::string>& atom_types() const { return atom_types_; }
+    const std::vector<std::string>& atom_types() const { return terms_->atom_types; }
+
+    // Parameterized terms built by setup (shared, immutable)
+    const UFFTermTables& terms() const { return *terms_; }
+    // Use prebuilt tables (e.g. deserialized) in place of setup()
+    void set_terms(std::shared_ptr<const UFFTermTables> terms) { terms_ = std::move(terms); }
+
+    // Restraints are added on top of the UFF terms and survive setup()
+    void add_dihedral_restraint(int i, int j, int k, int l,
+                                double target_degrees, double force_constant);
+    void add_dihedral_restraint(const DihedralRestraint& restraint) {
+        dihedral_restraints_.push_back(restraint);
+    }
+    void clear_restraints() { dihedral_restraints_.clear(); }
+    const std::vector<DihedralRestraint>& dihedral_restraints() const {
+        return dihedral_restraints_;
+    }
 
 private:
-    std::vector<std::string> atom_types_;
-    std::vector<AngleInfo> angles_;
-    std::vector<TorsionInfo> torsions_;
-    std::vector<std::pair<int,int>> nonbonded_pairs_; // 1-4 and beyond
+    std::shared_ptr<const UFFTermTables> terms_ = std::make_shared<const UFFTermTables>();
+    std::vector<DihedralRestraint> dihedral_restraints_; // per instance, never cached
+
+    void setup_terms(const Molecule& mol, bool use_cache, const CancellationToken* cancel);
 
     // Individual energy term calculations
     double bond_stretch_energy(const Molecule& mol) const;
@@ -59,9 +93,8 @@ private:
     double vdw_energy(const Molecule& mol) const;
     void vdw_gradient(const Molecule& mol, Eigen::VectorXd& grad) const;
 
-    // UFF bond length and force constant
-    double uff_bond_length(int bond_idx, const Molecule& mol) const;
-    double uff_bond_force_constant(int bond_idx, const Molecule& mol) const;
+    double restraint_energy(const Molecule& mol) const;
+    void restraint_gradient(const Molecule& mol, Eigen::VectorXd& grad) const;
 };
 
 } // namespace chemsim
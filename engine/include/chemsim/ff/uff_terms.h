@@ -0,0 +1,111 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "chemsim/core/molecule.h"
+
+namespace chemsim {
+
+// Parameterized UFF terms, resolved once at setup so energy and gradient
+// evaluation never touch the string-keyed parameter table
+struct BondTerm {
+    int i, j;
+    double r0;   // Angstroms
+    double k;    // kcal/mol/Angstrom^2
+};
+
+struct AngleTerm {
+    int i, j, k;         // j is central
+    bool linear;         // E = K (1 + cos theta)
+    double K;            // kcal/mol
+    double C0, C1, C2;   // Fourier coefficients (non-linear centers)
+};
+
+struct TorsionTerm {
+    int i, j, k, l;
+    int n;               // periodicity
+    double V;            // barrier (kcal/mol)
+    double cos_n_phi0;   // cos(n * phi0)
+};
+
+// Non-bonded parameters per atom; pair values are geometric means,
+// x_ij = sqrt_x[i] * sqrt_x[j] and D_ij = sqrt_D[i] * sqrt_D[j]
+struct VdwAtom {
+    double sqrt_x;       // sqrt(Angstroms)
+    double sqrt_D;       // sqrt(kcal/mol)
+};
+
+struct UFFTermTables {
+    std::vector<std::string> atom_types;
+    std::vector<BondTerm> bonds;
+    std::vector<AngleTerm> angles;
+    std::vector<TorsionTerm> torsions;
+    // Non-bonded terms (1-4 and beyond) cover every pair i < j that is not
+    // excluded, so only per-atom parameters and the 1-2 / 1-3 exclusions
+    // are stored: O(N) memory rather than one record per pair
+    std::vector<VdwAtom> vdw_atoms;          // by atom
+    std::vector<int32_t> vdw_excluded_start; // offsets into vdw_excluded, num_atoms + 1
+    std::vector<int32_t> vdw_excluded;       // partners j > i of each atom, ascending
+
+    size_t num_vdw_pairs() const;
+    size_t memory_bytes() const;
+};
+
+// Topology key: elements and formal charges in atom order (both feed atom
+// typing) plus the bond list with orders,
+// independent of bond order in the list and of bond direction. Term tables
+// are indexed by atom, so atom numbering is deliberately part of the key.
+std::vector<int32_t> topology_signature(const Molecule& mol);
+uint64_t topology_hash(const Molecule& mol);
+
+struct TermCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+    size_t memory_bytes = 0;
+    size_t budget_bytes = 0;
+};
+
+// Process-wide, thread-safe LRU cache of term tables keyed on topology.
+// Hits are verified against the full signature, so hash collisions cannot
+// return the wrong tables.
+class UFFTermCache {
+public:
+    static UFFTermCache& instance();
+
+    // Tables for mol's topology, or nullptr (counted as a miss)
+    std::shared_ptr<const UFFTermTables> find(const Molecule& mol);
+    void insert(const Molecule& mol, std::shared_ptr<const UFFTermTables> tables);
+
+    // Evicts least recently used entries down to the new budget
+    void set_budget(size_t bytes);
+    void clear();
+    TermCacheStats stats() const;
+
+private:
+    UFFTermCache() = default;
+
+    struct Entry {
+        uint64_t key;
+        std::vector<int32_t> signature;
+        std::shared_ptr<const UFFTermTables> tables;
+        size_t bytes;
+    };
+
+    void evict_to(size_t bytes);
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_; // most recent first
+    std::unordered_multimap<uint64_t, std::list<Entry>::iterator> index_;
+    size_t memory_bytes_ = 0;
+    size_t budget_bytes_ = 256u << 20;
+    size_t hits_ = 0, misses_ = 0, evictions_ = 0;
+};
+
+} // namespace chemsim
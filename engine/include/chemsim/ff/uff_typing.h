@@ -5,8 +5,14 @@
 
 namespace chemsim {
 
-// Assign UFF atom types to all atoms in a molecule
+// Assign UFF atom types to all atoms in a molecule from bond orders and
+// aromaticity. If every bond is single, orders are perceived on a copy.
 // Returns vector of UFF type labels (e.g., "C_3", "H_", "O_3")
 std::vector<std::string> assign_uff_types(const Molecule& mol);
 
+// As above, also filling bond_orders with the order of each bond the types
+// were derived from (the perceived ones for all-single input), so force
+// field terms can use the same orders
+std::vector<std::string> assign_uff_types(const Molecule& mol, std::vector<int>& bond_orders);
+
 } // namespace chemsim
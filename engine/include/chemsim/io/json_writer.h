@@ -0,0 +1,22 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include "chemsim/core/molecule.h"
+
+namespace chemsim {
+
+class TextWriter;
+
+// Append mol as compact JSON in the shape the API serves:
+// {"name","comment","num_atoms","num_bonds",
+//  "atoms":[{"index","symbol","atomic_number","position":[x,y,z]}],
+//  "bonds":[{"atom_i","atom_j","order"}]}
+// Coordinates are written in the shortest form that round-trips; a
+// non-finite coordinate throws, since JSON cannot represent it.
+void write_json(TextWriter& out, const Molecule& mol);
+std::string write_json(const Molecule& mol);
+
+// Append s as a quoted JSON string
+void write_json_string(TextWriter& out, std::string_view s);
+
+} // namespace chemsim
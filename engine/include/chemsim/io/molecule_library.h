@@ -0,0 +1,140 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <Eigen/Dense>
+#include "chemsim/core/molecule.h"
+
+namespace chemsim {
+
+class MappedFile;
+
+// Binary molecule library (.cslib): a fixed header with an offset table,
+// then 8-byte aligned columns shared by all molecules (atom, bond and text
+// offsets, positions, atomic numbers, charges, bonds) and the optional
+// per-molecule topology hash and per-atom UFF type columns. Files are
+// little-endian and are read through mmap without parsing.
+
+struct LibraryOptions {
+    bool topology_hashes = true; // store topology_hash() per molecule
+    bool atom_types = false;     // store assign_uff_types() per atom
+    int num_threads = 0;         // hashing, typing and input parsing; 0 = all cores
+};
+
+// Accumulates molecules column by column and writes the library file
+class LibraryBuilder {
+public:
+    explicit LibraryBuilder(const LibraryOptions& options = LibraryOptions{});
+
+    void add(const Molecule& mol);
+    // Hashes and types are computed in parallel, molecules appended in order
+    void add(const std::vector<Molecule>& mols);
+
+    size_t size() const { return atom_offsets_.size() - 1; }
+
+    void write(const std::string& path) const;
+
+private:
+    void append(const Molecule& mol, uint64_t hash, const std::vector<std::string>& types);
+
+    LibraryOptions options_;
+    std::vector<uint64_t> atom_offsets_{0};
+    std::vector<uint64_t> bond_offsets_{0};
+    std::vector<uint64_t> text_offsets_{0}; // name, comment per molecule
+    std::string text_;
+    std::vector<double> positions_;
+    std::vector<uint8_t> atomic_numbers_;
+    std::vector<int8_t> formal_charges_;
+    std::vector<int32_t> bond_atoms_;
+    std::vector<uint8_t> bond_orders_;
+    std::vector<uint64_t> hashes_;
+    std::vector<uint16_t> atom_types_;
+    std::vector<std::string> type_names_;
+    std::unordered_map<std::string, uint16_t> type_ids_;
+};
+
+// Convert an SDF (.sdf, .sd, .mol) or multi-frame XYZ (.xyz) file to a
+// library, parsing in parallel batches. Returns the number of molecules.
+size_t convert_to_library(const std::string& input_path,
+                          const std::string& output_path,
+                          const LibraryOptions& options = LibraryOptions{});
+
+// Zero-copy view of one library molecule; valid while the library lives
+class MoleculeView {
+public:
+    std::string_view name() const { return name_; }
+    std::string_view comment() const { return comment_; }
+    int num_atoms() const { return num_atoms_; }
+    int num_bonds() const { return num_bonds_; }
+
+    int atomic_number(int i) const { return atomic_numbers_[i]; }
+    int formal_charge(int i) const { return formal_charges_[i]; }
+    Eigen::Map<const Eigen::Vector3d> position(int i) const {
+        return Eigen::Map<const Eigen::Vector3d>(positions_ + 3 * i);
+    }
+    const double* positions() const { return positions_; } // flat 3N
+    Bond bond(int i) const { return Bond(bond_atoms_[2*i], bond_atoms_[2*i + 1], bond_orders_[i]); }
+
+    bool has_atom_types() const { return atom_types_ != nullptr; }
+    std::string_view atom_type(int i) const;
+    bool has_topology_hash() const { return has_hash_; }
+    uint64_t topology_hash() const { return hash_; }
+
+    // Materialize a Molecule (copies)
+    Molecule to_molecule() const;
+
+private:
+    friend class MoleculeLibrary;
+    std::string_view name_, comment_;
+    int num_atoms_ = 0, num_bonds_ = 0;
+    const double* positions_ = nullptr;
+    const uint8_t* atomic_numbers_ = nullptr;
+    const int8_t* formal_charges_ = nullptr;
+    const int32_t* bond_atoms_ = nullptr;
+    const uint8_t* bond_orders_ = nullptr;
+    const uint16_t* atom_types_ = nullptr;
+    const std::vector<std::string_view>* type_names_ = nullptr;
+    bool has_hash_ = false;
+    uint64_t hash_ = 0;
+};
+
+// Read-only library opened through mmap. Opening validates the header and
+// offset tables; molecules are then served by index without parsing.
+class MoleculeLibrary {
+public:
+    static MoleculeLibrary open(const std::string& path);
+
+    size_t size() const { return num_molecules_; }
+    bool has_topology_hashes() const { return hashes_ != nullptr; }
+    bool has_atom_types() const { return atom_types_ != nullptr; }
+
+    MoleculeView view(size_t i) const;
+    MoleculeView operator[](size_t i) const { return view(i); }
+    Molecule molecule(size_t i) const { return view(i).to_molecule(); }
+
+private:
+    MoleculeLibrary() = default;
+
+    std::shared_ptr<const MappedFile> file_;
+    size_t num_molecules_ = 0;
+    const uint64_t* atom_offsets_ = nullptr;
+    const uint64_t* bond_offsets_ = nullptr;
+    const uint64_t* text_offsets_ = nullptr;
+    const char* text_ = nullptr;
+    const double* positions_ = nullptr;
+    const uint8_t* atomic_numbers_ = nullptr;
+    const int8_t* formal_charges_ = nullptr;
+    const int32_t* bond_atoms_ = nullptr;
+    const uint8_t* bond_orders_ = nullptr;
+    const uint64_t* hashes_ = nullptr;
+    const uint16_t* atom_types_ = nullptr;
+    // Views into the mapped type-name block; shared so views stay valid
+    // when the library object is moved
+    std::shared_ptr<std::vector<std::string_view>> type_names_;
+};
+
+} // namespace chemsim
@@ -0,0 +1,59 @@
+#pragma once
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "chemsim/core/molecule.h"
+
+namespace chemsim {
+
+struct PDBOptions {
+    bool use_conect = true;        // bonds from CONECT records (PDB only)
+    bool use_templates = true;     // standard residue connectivity by atom name
+    bool perceive_unknown = true;  // distance perception inside residues with
+                                   // neither a template nor CONECT bonds
+    bool assign_bond_orders = true; // orders and charges when hydrogens are
+                                    // present; otherwise aromaticity only
+};
+
+struct Residue {
+    std::string name;
+    int seq;          // author residue number
+    char insertion;   // insertion code, ' ' if none
+    bool hetero;      // HETATM records
+    int chain;        // index into PDBStructure::chains
+    int first_atom;
+    int num_atoms;
+};
+
+// A molecule plus its biomolecular metadata in side arrays indexed by atom
+// (names, alternate locations, occupancies, B-factors, residue) and by
+// residue. Only the first model and the first alternate location of each
+// residue are kept.
+struct PDBStructure {
+    Molecule mol;
+    std::vector<std::array<char, 4>> atom_names; // NUL-padded
+    std::vector<char> altlocs;                   // ' ' if none
+    std::vector<float> occupancies;
+    std::vector<float> b_factors;
+    std::vector<int> atom_residues;              // index into residues
+    std::vector<Residue> residues;
+    std::vector<std::string> chains;
+
+    std::string_view atom_name(int i) const;
+};
+
+// Parse PDB text (ATOM/HETATM/CONECT records). Connectivity comes from
+// CONECT records and residue templates, with peptide and disulfide links
+// checked by distance only between the atoms concerned, so no all-atom
+// bond perception is needed.
+PDBStructure parse_pdb(std::string_view content, const PDBOptions& options = PDBOptions{});
+
+// Parse the _atom_site loop of mmCIF (PDBx) text; connectivity as above
+// without CONECT
+PDBStructure parse_mmcif(std::string_view content, const PDBOptions& options = PDBOptions{});
+
+// Memory-map a .pdb/.ent or .cif/.mmcif file and parse it in one pass
+PDBStructure read_structure(const std::string& path, const PDBOptions& options = PDBOptions{});
+
+} // namespace chemsim
@@ -1,10 +1,68 @@
 #pragma once
+#include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 #include "chemsim/core/molecule.h"
 
 namespace chemsim {
 
-// Parse SDF/MOL format string into a Molecule
-Molecule parse_sdf(const std::string& content);
+class MappedFile;
+class TextWriter;
+
+// Data fields of an SDF record as (name, value), in file order
+using SDFProperties = std::vector<std::pair<std::string, std::string>>;
+
+// Parse SDF/MOL format string into a Molecule (first record only).
+// Reads V2000 atom and bond blocks and formal charges (atom block and
+// "M  CHG"); data fields are ignored here, see SDFReader::properties.
+Molecule parse_sdf(std::string_view content);
+
+// Data fields ("> <NAME>" blocks) of one record
+SDFProperties parse_sdf_properties(std::string_view record);
+
+// Append mol as one V2000 record, properties as data fields, ending with
+// "$$$$". Charges go to both the atom block and "M  CHG" lines; aromatic
+// bonds are written as order 4. Throws beyond V2000's 999 atoms or bonds.
+void write_sdf(TextWriter& out, const Molecule& mol, const SDFProperties& properties = {});
+std::string write_sdf(const Molecule& mol, const SDFProperties& properties = {});
+
+// Write one record per molecule to path in chunks. properties[k] holds the
+// data fields of mols[k] and may be shorter than mols.
+void write_sdf_file(const std::string& path, const std::vector<Molecule>& mols,
+                    const std::vector<SDFProperties>& properties = {});
+
+// Multi-record SDF over a buffer or a memory-mapped file. Construction
+// scans once for "$$$$" separators and keeps only the record offsets, so
+// libraries larger than memory can be opened, sharded by record number and
+// parsed in parallel.
+class SDFReader {
+public:
+    // Reads from content without copying; it must outlive the reader
+    explicit SDFReader(std::string_view content);
+
+    // Memory-map a file and index it
+    static SDFReader open(const std::string& path);
+
+    size_t size() const { return starts_.size(); }
+
+    // Raw text of record i, without the "$$$$" line
+    std::string_view record(size_t i) const;
+
+    Molecule molecule(size_t i) const;
+
+    // Data fields of record i, parsed on demand
+    SDFProperties properties(size_t i) const;
+
+    // Records [begin, end) parsed in parallel, in order
+    std::vector<Molecule> molecules(size_t begin, size_t end, int num_threads = 0) const;
+
+private:
+    std::shared_ptr<const MappedFile> file_;
+    std::string_view data_;
+    std::vector<size_t> starts_;
+    std::vector<size_t> ends_;
+};
 
 } // namespace chemsim
@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include "chemsim/core/molecule.h"
+#include "chemsim/ff/uff_energy.h"
+
+namespace chemsim {
+
+// Compact binary images of a Molecule or a set-up UFFForceField (term
+// tables and restraints included, so the receiver skips typing and
+// parameterization). Meant for handing work to other processes on the same
+// machine: columns are raw little-endian arrays, and the term record
+// layouts are checked on load rather than made portable.
+
+std::string serialize(const Molecule& mol);
+std::string serialize(const UFFForceField& ff);
+
+// Parse an image from any buffer (a bytes object, a shared memory segment);
+// throws on a wrong kind, version or layout, or a truncated buffer
+Molecule deserialize_molecule(std::string_view data);
+UFFForceField deserialize_force_field(std::string_view data);
+
+} // namespace chemsim
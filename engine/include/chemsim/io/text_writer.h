@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace chemsim {
+
+// Append-only text sink for the format writers. Numbers are formatted with
+// std::to_chars (no locale, no streams). Output goes either to a
+// caller-provided string or, in chunks, to a file descriptor.
+class TextWriter {
+public:
+    // Append to buffer, which must outlive the writer
+    explicit TextWriter(std::string& buffer);
+    // Write to fd (not closed) whenever chunk_size bytes are pending
+    explicit TextWriter(int fd, size_t chunk_size = 1 << 20);
+    // Create or truncate path and write to it; the file is closed with
+    // the writer
+    static std::unique_ptr<TextWriter> open(const std::string& path, size_t chunk_size = 1 << 20);
+    // Flushes; write errors during this final flush are lost, so call
+    // flush() explicitly to see them
+    ~TextWriter();
+
+    TextWriter(const TextWriter&) = delete;
+    TextWriter& operator=(const TextWriter&) = delete;
+
+    void put(char c) {
+        out_->push_back(c);
+        if (fd_ >= 0 && out_->size() >= chunk_size_) flush();
+    }
+    void put(std::string_view s) {
+        out_->append(s.data(), s.size());
+        if (fd_ >= 0 && out_->size() >= chunk_size_) flush();
+    }
+
+    // Fixed-point number, right-aligned in width (0 = no padding)
+    void fixed(double value, int precision, int width = 0);
+    // Shortest decimal form that parses back to exactly value
+    void shortest(double value);
+    // Integer, right-aligned in width (0 = no padding)
+    void integer(long long value, int width = 0);
+    // String, left-aligned and space-padded to width
+    void padded(std::string_view s, int width);
+
+    // Send pending output to the file descriptor (no-op for strings)
+    void flush();
+
+private:
+    void pad_and_put(const char* begin, const char* end, int width);
+
+    std::string* out_;
+    std::string staging_;
+    int fd_ = -1;
+    bool owns_fd_ = false;
+    size_t chunk_size_ = 0;
+};
+
+} // namespace chemsim
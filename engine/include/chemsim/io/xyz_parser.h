@@ -1,14 +1,101 @@
 #pragma once
+#include <cstddef>
+#include <iterator>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 #include "chemsim/core/molecule.h"
 
 namespace chemsim {
 
-// Parse XYZ format string into a Molecule
+class MappedFile;
+class TextWriter;
+
+struct XYZOptions {
+    bool perceive_bonds = true; // false = coordinates only (no bonds or orders)
+};
+
+// Parse XYZ format string into a Molecule (first frame only)
 // Format: line 1 = atom count, line 2 = comment, lines 3+ = symbol x y z
-Molecule parse_xyz(const std::string& content);
+Molecule parse_xyz(std::string_view content, const XYZOptions& options = XYZOptions{});
 
 // Write molecule to XYZ format string
-std::string write_xyz(const Molecule& mol);
+std::string write_xyz(const Molecule& mol, int precision = 6);
+
+// Append mol as one XYZ frame
+void write_xyz(TextWriter& out, const Molecule& mol, int precision = 6);
+
+// Append one frame per flat 3N position vector, all with mol's atoms.
+// comments[k] labels frame k; missing comments fall back to mol.comment.
+void write_xyz_frames(TextWriter& out, const Molecule& mol,
+                      const std::vector<std::vector<double>>& frames,
+                      const std::vector<std::string>& comments = {},
+                      int precision = 6);
+
+// One frame of a multi-frame XYZ. The comment points into the reader's
+// buffer and is valid while the reader lives.
+struct XYZFrame {
+    std::string_view comment;
+    std::vector<int> atomic_numbers;
+    std::vector<double> positions; // flat 3N, Angstroms
+
+    int num_atoms() const { return static_cast<int>(atomic_numbers.size()); }
+    Molecule to_molecule(const XYZOptions& options = XYZOptions{}) const;
+};
+
+// Streaming reader over the frames of a (multi-frame) XYZ buffer or file.
+// Numbers are parsed in place with from_chars; a reused XYZFrame keeps
+// memory constant, so trajectories of any length stream in one pass.
+class XYZReader {
+public:
+    // Reads from content without copying; it must outlive the reader
+    explicit XYZReader(std::string_view content);
+
+    // Memory-map a file and read from it
+    static XYZReader open(const std::string& path);
+
+    // Parse the next frame into frame, reusing its storage. Returns false
+    // at the end of input; throws std::runtime_error on malformed frames.
+    bool next(XYZFrame& frame);
+
+    void rewind();
+    size_t frames_read() const { return frame_index_; }
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = XYZFrame;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const XYZFrame*;
+        using reference = const XYZFrame&;
+
+        iterator() = default;
+        explicit iterator(XYZReader* reader) : reader_(reader) { ++*this; }
+
+        reference operator*() const { return frame_; }
+        pointer operator->() const { return &frame_; }
+        iterator& operator++() {
+            if (!reader_->next(frame_)) reader_ = nullptr;
+            return *this;
+        }
+        bool operator==(const iterator& other) const { return reader_ == other.reader_; }
+        bool operator!=(const iterator& other) const { return reader_ != other.reader_; }
+
+    private:
+        XYZReader* reader_ = nullptr;
+        XYZFrame frame_;
+    };
+
+    // Single pass from the current position
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(); }
+
+private:
+    std::shared_ptr<const MappedFile> file_;
+    std::string_view data_;
+    size_t pos_ = 0;
+    size_t frame_index_ = 0;
+};
 
 } // namespace chemsim
@@ -0,0 +1,52 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include <string>
+#include "chemsim/core/molecule.h"
+#include "chemsim/ff/uff_energy.h"
+
+namespace chemsim {
+
+struct MDFrame {
+    int step;
+    double time;              // ps
+    double potential_energy;  // kcal/mol
+    double kinetic_energy;    // kcal/mol
+    double temperature;       // K
+    std::vector<double> positions;
+};
+
+// Called on output frames only (every output_interval steps)
+using MDProgressCallback = std::function<void(const MDFrame&)>;
+
+struct MDResult {
+    int steps;
+    double wall_time;         // seconds
+    double steps_per_second;
+    double ns_per_day;
+    std::vector<MDFrame> trajectory;
+};
+
+struct MDSettings {
+    int num_steps = 1000;
+    double timestep = 1.0;             // fs
+    double temperature = 300.0;        // K (initial velocities and thermostat target)
+    std::string thermostat = "none";   // "none", "langevin" or "nose_hoover"
+    double friction = 1.0;             // Langevin collision frequency (1/ps)
+    double thermostat_period = 100.0;  // Nose-Hoover coupling time (fs)
+    int output_interval = 100;         // steps between trajectory frames
+    bool store_trajectory = true;
+    unsigned int seed = 42;            // velocity initialization and Langevin noise
+};
+
+// Run velocity Verlet molecular dynamics on the UFF surface.
+// Velocities are drawn from a Maxwell-Boltzmann distribution at
+// settings.temperature; mol holds the final positions on return.
+MDResult run_dynamics(
+    Molecule& mol,
+    const UFFForceField& ff,
+    const MDSettings& settings = MDSettings{},
+    MDProgressCallback callback = nullptr
+);
+
+} // namespace chemsim
@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+#include "chemsim/core/molecule.h"
+#include "chemsim/ff/uff_energy.h"
+#include "chemsim/opt/optimizer.h"
+
+namespace chemsim {
+
+struct ScanDihedral {
+    int i, j, k, l;          // atom indices; atoms on l's side of j-k are rotated
+    double start = -180.0;   // degrees
+    double step = 15.0;      // degrees
+    int num_points = 24;
+};
+
+struct ScanSettings {
+    double force_constant = 1000.0;  // restraint, kcal/mol/rad^2
+    bool store_geometries = false;
+    int num_threads = 0;             // 2D scans: rows run in parallel (0 = all cores)
+    OptSettings opt;                 // per-point minimization
+};
+
+struct ScanResult {
+    std::vector<double> angles1;     // degrees
+    std::vector<double> angles2;     // degrees, empty for 1D scans
+    std::vector<double> energies;    // kcal/mol without restraint, row-major [angles1][angles2]
+    std::vector<bool> converged;     // same layout as energies
+    std::vector<std::vector<double>> geometries; // flat positions, if stored
+};
+
+// Relaxed 1D torsion scan. Each point starts from the previous point's
+// optimized geometry, rotated rigidly to the next target angle.
+ScanResult relaxed_scan(
+    const Molecule& mol,
+    const UFFForceField& ff,
+    const ScanDihedral& dihedral,
+    const ScanSettings& settings = ScanSettings{}
+);
+
+// Relaxed 2D torsion scan. The first column is scanned along dihedral1,
+// then every row is scanned along dihedral2 in parallel from it.
+ScanResult relaxed_scan_2d(
+    const Molecule& mol,
+    const UFFForceField& ff,
+    const ScanDihedral& dihedral1,
+    const ScanDihedral& dihedral2,
+    const ScanSettings& settings = ScanSettings{}
+);
+
+} // namespace chemsim
@@ -0,0 +1,48 @@
+#pragma once
+#include <functional>
+#include <utility>
+#include <Eigen/Dense>
+#include "chemsim/core/molecule.h"
+#include "chemsim/ff/uff_energy.h"
+
+namespace chemsim {
+
+// Energy and gradient source for optimize_geometry, so one driver runs on
+// UFF or on an external method (e.g. DFT called back into Python).
+// Energies are kcal/mol and gradients kcal/mol/Angstrom, as for
+// UFFForceField.
+class EnergyProvider {
+public:
+    virtual ~EnergyProvider() = default;
+    // Energy at mol's geometry; grad is filled with the 3N gradient
+    virtual double evaluate(const Molecule& mol, Eigen::VectorXd& grad) = 0;
+};
+
+// UFF behind the provider interface; ff must outlive the provider
+class UFFProvider : public EnergyProvider {
+public:
+    explicit UFFProvider(const UFFForceField& ff) : ff_(ff) {}
+
+    double evaluate(const Molecule& mol, Eigen::VectorXd& grad) override {
+        ff_.calculate_gradient(mol, grad);
+        return ff_.calculate_energy(mol);
+    }
+
+private:
+    const UFFForceField& ff_;
+};
+
+// Provider backed by a callable
+class FunctionProvider : public EnergyProvider {
+public:
+    using Function = std::function<double(const Molecule&, Eigen::VectorXd&)>;
+
+    explicit FunctionProvider(Function fn) : fn_(std::move(fn)) {}
+
+    double evaluate(const Molecule& mol, Eigen::VectorXd& grad) override { return fn_(mol, grad); }
+
+private:
+    Function fn_;
+};
+
+} // namespace chemsim
@@ -0,0 +1,30 @@
+#pragma once
+#include <Eigen/Dense>
+#include "chemsim/core/molecule.h"
+#include "chemsim/ff/uff_energy.h"
+
+namespace chemsim {
+
+// Positive-definite model Hessian (kcal/mol/Angstrom^2) from UFF at one
+// geometry, for preconditioning optimizations on another energy surface.
+// Each eigenvalue of the UFF Hessian is replaced by max(|lambda|,
+// min_curvature), so translations, rotations and saddle directions keep a
+// finite positive curvature. Stored dense (3N x 3N), which suits the
+// molecule sizes where gradients are expensive.
+class ModelHessian {
+public:
+    ModelHessian(const Molecule& mol, const UFFForceField& ff,
+                 double min_curvature = 10.0, int num_threads = 0);
+
+    int dimension() const { return static_cast<int>(matrix_.rows()); }
+    const Eigen::MatrixXd& matrix() const { return matrix_; }
+
+    // H^-1 v
+    Eigen::VectorXd solve(const Eigen::VectorXd& v) const { return inverse_ * v; }
+
+private:
+    Eigen::MatrixXd matrix_;
+    Eigen::MatrixXd inverse_;
+};
+
+} // namespace chemsim
@@ -0,0 +1,54 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "chemsim/core/molecule.h"
+#include "chemsim/ff/uff_energy.h"
+
+namespace chemsim {
+
+struct NEBSettings {
+    int num_images = 8;                   // intermediate images, endpoints excluded
+    std::string interpolation = "idpp";   // "linear" or "idpp"
+    std::string method = "fire";          // band optimizer: "fire" or "lbfgs"
+    bool climbing_image = true;
+    double climb_threshold = 0.5;         // start climbing below this max force (kcal/mol/Angstrom)
+    double spring_constant = 5.0;         // kcal/mol/Angstrom^2
+    int max_iterations = 2000;
+    double force_tolerance = 0.05;        // max per-atom NEB force (kcal/mol/Angstrom)
+    double max_step = 0.1;                // max per-atom displacement per iteration (Angstroms)
+    int num_threads = 0;                  // image evaluation threads (0 = all cores)
+};
+
+struct NEBResult {
+    bool converged;
+    int iterations;
+    std::vector<std::vector<double>> images; // flat positions, endpoints included
+    std::vector<double> energies;            // kcal/mol, one per image
+    int climbing_image;                      // index into images, -1 if none
+    double barrier;                          // max energy minus reactant energy
+    double max_force;                        // final max per-atom NEB force
+};
+
+// Initial band between two endpoints with the same atoms, endpoints
+// included. "idpp" refines the linear path with the image-dependent pair
+// potential so interatomic distances change smoothly along the band,
+// refining images on num_threads threads (0 = all cores).
+std::vector<std::vector<double>> interpolate_images(
+    const Molecule& reactant,
+    const Molecule& product,
+    int num_images,
+    const std::string& method = "idpp",
+    int num_threads = 0
+);
+
+// Nudged elastic band between two endpoints with the same topology. ff must
+// be set up for the reactant; its term tables are shared by every image and
+// image energies/gradients are evaluated concurrently.
+NEBResult run_neb(
+    const Molecule& reactant,
+    const Molecule& product,
+    const UFFForceField& ff,
+    const NEBSettings& settings = NEBSettings{}
+);
+
+} // namespace chemsim
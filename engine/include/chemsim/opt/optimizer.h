@@ -2,11 +2,15 @@
 #include <functional>
 #include <vector>
 #include <string>
+#include "chemsim/core/cancellation.h"
 #include "chemsim/core/molecule.h"
 #include "chemsim/ff/uff_energy.h"
+#include "chemsim/opt/energy_provider.h"
 
 namespace chemsim {
 
+class ModelHessian;
+
 struct OptProgress {
     int iteration;
     double energy;
@@ -16,7 +20,18 @@ struct OptProgress {
 
 using ProgressCallback = std::function<void(const OptProgress&)>;
 
+enum class OptStatus {
+    converged,
+    max_iterations,
+    line_search_failed, // no further descent found
+    cancelled,          // OptSettings::cancel was triggered
+    timed_out           // OptSettings::time_budget ran out
+};
+
+// Cancelled and timed-out runs return the best geometry reached so far (left
+// in mol) with the fields below filled in for it
 struct OptResult {
+    OptStatus status = OptStatus::max_iterations;
     bool converged;
     int iterations;
     double final_energy;
@@ -28,16 +43,35 @@ struct OptSettings {
     int max_iterations = 500;
     double grad_tolerance = 1e-4;   // kcal/mol/Angstrom
     double energy_tolerance = 1e-8; // kcal/mol
-    std::string method = "lbfgs";   // "steepest_descent" or "lbfgs"
+    std::string method = "lbfgs";   // "steepest_descent", "lbfgs" or "newton_cg"
+    int max_cg_iterations = 50;     // Inner CG iterations per Newton step (newton_cg)
     bool store_trajectory = true;
+    // Checked before every energy/gradient evaluation (and every inner CG
+    // step for newton_cg)
+    CancellationToken cancel;
+    double time_budget = 0.0;       // wall-clock seconds; 0 = unlimited
 };
 
 // Optimize molecular geometry
 OptResult optimize_geometry(
     Molecule& mol,
-    UFFForceField& ff,
+    const UFFForceField& ff,
     const OptSettings& settings = OptSettings{},
     ProgressCallback callback = nullptr
 );
 
+// Optimize on any energy surface with L-BFGS (settings.method must be
+// "lbfgs"). With a preconditioner the L-BFGS initial inverse Hessian is the
+// model's inverse, rescaled every step by s'y / y'P^-1 y so the provider's
+// own curvature sets the scale. Steps are capped at 0.3 Angstrom per
+// coordinate. Converged means |g|/sqrt(N) < grad_tolerance and, unless
+// energy_tolerance <= 0, a last energy change below energy_tolerance.
+OptResult optimize_geometry(
+    Molecule& mol,
+    EnergyProvider& provider,
+    const OptSettings& settings,
+    const ModelHessian* preconditioner = nullptr,
+    ProgressCallback callback = nullptr
+);
+
 } // namespace chemsim
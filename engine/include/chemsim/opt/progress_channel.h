@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "chemsim/core/event_notifier.h"
+#include "chemsim/core/spsc_ring.h"
+#include "chemsim/opt/optimizer.h"
+
+namespace chemsim {
+
+// Hands optimizer progress to another thread without locks or callbacks
+// into the consumer: the optimizer publishes every decimation-th record
+// into a bounded SPSC ring (oldest dropped when full) and signals fd(),
+// which an event loop watches and answers with drain(). One optimizer and
+// one consumer at a time.
+class ProgressChannel {
+public:
+    explicit ProgressChannel(size_t capacity = 256, int decimation = 1);
+
+    // Producer side; never blocks
+    void publish(const OptProgress& progress);
+    // Callback for optimize_geometry() that publishes into this channel
+    ProgressCallback callback();
+
+    // Consumer side: up to max_records records, oldest first
+    std::vector<OptProgress> drain(size_t max_records = static_cast<size_t>(-1));
+    int fd() const { return notifier_.fd(); }
+
+    int decimation() const { return decimation_; }
+    uint64_t published() const { return published_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return ring_.dropped(); }
+
+private:
+    SPSCRing<OptProgress> ring_;
+    EventNotifier notifier_;
+    int decimation_;
+    uint64_t seen_ = 0; // producer only
+    std::atomic<uint64_t> published_{0};
+};
+
+} // namespace chemsim
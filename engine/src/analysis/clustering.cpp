@@ -0,0 +1,90 @@
+#include "chemsim/analysis/clustering.h"
+#include "chemsim/core/thread_pool.h"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace chemsim {
+
+static void check_threshold(double threshold) {
+    if (threshold <= 0.0) throw std::runtime_error("Clustering: threshold must be positive");
+}
+
+ClusterResult butina_cluster(const std::vector<std::vector<double>>& frames,
+                             double threshold,
+                             const RMSDSettings& settings) {
+    check_threshold(threshold);
+    RMSDFrames data(frames, settings.atoms);
+    int n = data.num_frames();
+
+    // Upper-triangle neighbors per row in parallel, then mirrored
+    std::vector<std::vector<int>> upper(n);
+    ThreadPool pool(settings.num_threads);
+    pool.parallel_for(n, [&](int i) {
+        for (int j = i + 1; j < n; ++j) {
+            if (data.rmsd(i, j, settings.permutations) < threshold) upper[i].push_back(j);
+        }
+    });
+    std::vector<std::vector<int>> neighbors(n);
+    for (int i = 0; i < n; ++i) {
+        for (int j : upper[i]) {
+            neighbors[i].push_back(j);
+            neighbors[j].push_back(i);
+        }
+    }
+
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return neighbors[a].size() > neighbors[b].size();
+    });
+
+    ClusterResult result;
+    result.assignments.assign(n, -1);
+    for (int i : order) {
+        if (result.assignments[i] >= 0) continue;
+        int c = static_cast<int>(result.centroids.size());
+        result.centroids.push_back(i);
+        result.assignments[i] = c;
+        int size = 1;
+        for (int j : neighbors[i]) {
+            if (result.assignments[j] >= 0) continue;
+            result.assignments[j] = c;
+            size++;
+        }
+        result.sizes.push_back(size);
+    }
+    return result;
+}
+
+ClusterResult leader_cluster(const std::vector<std::vector<double>>& frames,
+                             double threshold,
+                             const RMSDSettings& settings) {
+    check_threshold(threshold);
+    RMSDFrames data(frames, settings.atoms);
+    int n = data.num_frames();
+
+    ClusterResult result;
+    result.assignments.assign(n, -1);
+    for (int f = 0; f < n; ++f) {
+        int best = -1;
+        double best_rmsd = threshold;
+        for (size_t c = 0; c < result.centroids.size(); ++c) {
+            double r = data.rmsd(result.centroids[c], f, settings.permutations);
+            if (r < best_rmsd) {
+                best_rmsd = r;
+                best = static_cast<int>(c);
+            }
+        }
+        if (best < 0) {
+            best = static_cast<int>(result.centroids.size());
+            result.centroids.push_back(f);
+            result.sizes.push_back(0);
+        }
+        result.assignments[f] = best;
+        result.sizes[best]++;
+    }
+    return result;
+}
+
+} // namespace chemsim
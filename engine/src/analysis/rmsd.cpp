@@ -0,0 +1,342 @@
+#include "chemsim/analysis/rmsd.h"
+#include "chemsim/core/thread_pool.h"
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+
+namespace chemsim {
+
+static double kabsch_rmsd_impl(Eigen::Matrix3Xd A, Eigen::Matrix3Xd B) {
+    long n = A.cols();
+    if (n == 0) return 0.0;
+
+    A.colwise() -= A.rowwise().mean();
+    B.colwise() -= B.rowwise().mean();
+
+    // Optimal rotation from the SVD of the covariance matrix, with a
+    // reflection correction so the result is a proper rotation
+    Eigen::Matrix3d H = A * B.transpose();
+    Eigen::JacobiSVD<Eigen::Matrix3d> svd(H, Eigen::ComputeFullU | Eigen::ComputeFullV);
+    Eigen::Matrix3d U = svd.matrixU();
+    Eigen::Matrix3d V = svd.matrixV();
+    double d = (V * U.transpose()).determinant() < 0.0 ? -1.0 : 1.0;
+    Eigen::Matrix3d D = Eigen::Matrix3d::Identity();
+    D(2, 2) = d;
+    Eigen::Matrix3d R = V * D * U.transpose();
+
+    double sq = (R * A - B).squaredNorm();
+    return std::sqrt(sq / n);
+}
+
+double kabsch_rmsd(const std::vector<double>& a, const std::vector<double>& b) {
+    if (a.size() != b.size() || a.size() % 3 != 0) {
+        throw std::runtime_error("RMSD: position vector size mismatch");
+    }
+    long n = static_cast<long>(a.size() / 3);
+    return kabsch_rmsd_impl(Eigen::Map<const Eigen::Matrix3Xd>(a.data(), 3, n),
+                            Eigen::Map<const Eigen::Matrix3Xd>(b.data(), 3, n));
+}
+
+double kabsch_rmsd(const std::vector<double>& a, const std::vector<double>& b,
+                   const std::vector<int>& atoms) {
+    if (a.size() != b.size() || a.size() % 3 != 0) {
+        throw std::runtime_error("RMSD: position vector size mismatch");
+    }
+    Eigen::Matrix3Xd A(3, atoms.size());
+    Eigen::Matrix3Xd B(3, atoms.size());
+    for (size_t c = 0; c < atoms.size(); ++c) {
+        size_t i = static_cast<size_t>(atoms[c]);
+        if (3 * i + 2 >= a.size()) throw std::runtime_error("RMSD: atom index out of range");
+        A.col(c) << a[3*i], a[3*i + 1], a[3*i + 2];
+        B.col(c) << b[3*i], b[3*i + 1], b[3*i + 2];
+    }
+    return kabsch_rmsd_impl(A, B);
+}
+
+// ============ Automorphisms ============
+
+std::vector<std::vector<int>> find_automorphisms(const Molecule& mol,
+                                                 const std::vector<int>& atoms,
+                                                 int max_count) {
+    std::vector<int> subset = atoms;
+    if (subset.empty()) {
+        subset.resize(mol.num_atoms());
+        for (int a = 0; a < mol.num_atoms(); ++a) subset[a] = a;
+    }
+    int m = static_cast<int>(subset.size());
+    std::vector<int> position(mol.num_atoms(), -1);
+    for (int p = 0; p < m; ++p) {
+        if (subset[p] < 0 || subset[p] >= mol.num_atoms()) {
+            throw std::runtime_error("Automorphisms: atom index out of range");
+        }
+        position[subset[p]] = p;
+    }
+
+    // Induced subgraph as (neighbor position, bond order) lists
+    std::vector<int> full_degree(mol.num_atoms(), 0);
+    std::vector<std::vector<std::pair<int,int>>> adj(m);
+    for (const auto& bond : mol.bonds()) {
+        full_degree[bond.atom_i]++;
+        full_degree[bond.atom_j]++;
+        int pi = position[bond.atom_i], pj = position[bond.atom_j];
+        if (pi < 0 || pj < 0) continue;
+        adj[pi].emplace_back(pj, bond.order);
+        adj[pj].emplace_back(pi, bond.order);
+    }
+
+    // Color refinement until the partition is stable
+    std::vector<int> color(m);
+    {
+        std::map<std::tuple<int,int,int>, int> ids;
+        for (int p = 0; p < m; ++p) {
+            auto key = std::make_tuple(mol.atom(subset[p]).atomic_number,
+                                       full_degree[subset[p]],
+                                       static_cast<int>(adj[p].size()));
+            color[p] = ids.emplace(key, static_cast<int>(ids.size())).first->second;
+        }
+    }
+    for (int num_colors = 0;;) {
+        std::map<std::vector<int>, int> ids;
+        std::vector<int> next(m);
+        for (int p = 0; p < m; ++p) {
+            std::vector<int> key{color[p]};
+            std::vector<int> nbrs;
+            for (const auto& [q, order] : adj[p]) nbrs.push_back(color[q] * 8 + order);
+            std::sort(nbrs.begin(), nbrs.end());
+            key.insert(key.end(), nbrs.begin(), nbrs.end());
+            next[p] = ids.emplace(key, static_cast<int>(ids.size())).first->second;
+        }
+        color = next;
+        if (static_cast<int>(ids.size()) == num_colors) break;
+        num_colors = static_cast<int>(ids.size());
+    }
+
+    // Breadth-first matching order keeps mapped neighbors close together
+    std::vector<int> order;
+    std::vector<bool> seen(m, false);
+    for (int start = 0; start < m; ++start) {
+        if (seen[start]) continue;
+        seen[start] = true;
+        order.push_back(start);
+        for (size_t q = order.size() - 1; q < order.size(); ++q) {
+            for (const auto& e : adj[order[q]]) {
+                if (!seen[e.first]) {
+                    seen[e.first] = true;
+                    order.push_back(e.first);
+                }
+            }
+        }
+    }
+
+    auto bond_order = [&](int p, int q) {
+        for (const auto& [r, o] : adj[p]) {
+            if (r == q) return o;
+        }
+        return 0;
+    };
+
+    std::vector<std::vector<int>> result;
+    std::vector<int> map(m, -1);
+    std::vector<bool> used(m, false);
+    std::function<void(int)> extend = [&](int depth) {
+        if (static_cast<int>(result.size()) >= max_count) return;
+        if (depth == m) {
+            result.push_back(map);
+            return;
+        }
+        int s = order[depth];
+        int mapped_neighbors = 0;
+        for (const auto& e : adj[s]) mapped_neighbors += map[e.first] >= 0;
+
+        // Identity candidate first, so the identity permutation comes first
+        std::vector<int> candidates{s};
+        for (int t = 0; t < m; ++t) {
+            if (t != s && color[t] == color[s]) candidates.push_back(t);
+        }
+        for (int t : candidates) {
+            if (used[t]) continue;
+            bool ok = true;
+            for (const auto& [u, o] : adj[s]) {
+                if (map[u] >= 0 && bond_order(t, map[u]) != o) {
+                    ok = false;
+                    break;
+                }
+            }
+            if (!ok) continue;
+            int t_mapped = 0;
+            for (const auto& e : adj[t]) t_mapped += used[e.first];
+            if (t_mapped != mapped_neighbors) continue;
+
+            map[s] = t;
+            used[t] = true;
+            extend(depth + 1);
+            map[s] = -1;
+            used[t] = false;
+            if (static_cast<int>(result.size()) >= max_count) return;
+        }
+    };
+    if (max_count > 0) extend(0);
+    return result;
+}
+
+// ============ Batched QCP RMSD ============
+
+RMSDFrames::RMSDFrames(const std::vector<std::vector<double>>& frames,
+                       const std::vector<int>& atoms)
+    : num_frames_(static_cast<int>(frames.size())), num_atoms_(0) {
+    if (frames.empty()) return;
+    size_t size = frames[0].size();
+    if (size % 3 != 0) throw std::runtime_error("RMSD: position vector size mismatch");
+    for (const auto& f : frames) {
+        if (f.size() != size) throw std::runtime_error("RMSD: frames have different sizes");
+    }
+
+    std::vector<int> subset = atoms;
+    if (subset.empty()) {
+        subset.resize(size / 3);
+        for (size_t a = 0; a < subset.size(); ++a) subset[a] = static_cast<int>(a);
+    }
+    for (int a : subset) {
+        if (a < 0 || 3 * static_cast<size_t>(a) + 2 >= size) {
+            throw std::runtime_error("RMSD: atom index out of range");
+        }
+    }
+
+    num_atoms_ = static_cast<int>(subset.size());
+    size_t total = static_cast<size_t>(num_frames_) * num_atoms_;
+    x_.resize(total);
+    y_.resize(total);
+    z_.resize(total);
+    g_.resize(num_frames_);
+
+    for (int f = 0; f < num_frames_; ++f) {
+        const auto& pos = frames[f];
+        double cx = 0.0, cy = 0.0, cz = 0.0;
+        for (int a : subset) {
+            cx += pos[3*a];
+            cy += pos[3*a + 1];
+            cz += pos[3*a + 2];
+        }
+        if (num_atoms_ > 0) {
+            cx /= num_atoms_;
+            cy /= num_atoms_;
+            cz /= num_atoms_;
+        }
+        double g = 0.0;
+        size_t base = static_cast<size_t>(f) * num_atoms_;
+        for (int p = 0; p < num_atoms_; ++p) {
+            int a = subset[p];
+            x_[base + p] = pos[3*a] - cx;
+            y_[base + p] = pos[3*a + 1] - cy;
+            z_[base + p] = pos[3*a + 2] - cz;
+            g += x_[base + p] * x_[base + p] + y_[base + p] * y_[base + p] +
+                 z_[base + p] * z_[base + p];
+        }
+        g_[f] = g;
+    }
+}
+
+// Largest eigenvalue of the QCP key matrix by Newton iteration on its
+// characteristic polynomial (Theobald 2005, Liu et al. 2010)
+static double qcp_rmsd(const double S[9], double ga, double gb, int n) {
+    double Sxx = S[0], Sxy = S[1], Sxz = S[2];
+    double Syx = S[3], Syy = S[4], Syz = S[5];
+    double Szx = S[6], Szy = S[7], Szz = S[8];
+
+    double Sxx2 = Sxx * Sxx, Syy2 = Syy * Syy, Szz2 = Szz * Szz;
+    double Sxy2 = Sxy * Sxy, Syz2 = Syz * Syz, Sxz2 = Sxz * Sxz;
+    double Syx2 = Syx * Syx, Szy2 = Szy * Szy, Szx2 = Szx * Szx;
+
+    double SyzSzymSyySzz2 = 2.0 * (Syz * Szy - Syy * Szz);
+    double Sxx2Syy2Szz2Syz2Szy2 = Syy2 + Szz2 - Sxx2 + Syz2 + Szy2;
+
+    double C2 = -2.0 * (Sxx2 + Syy2 + Szz2 + Sxy2 + Syx2 + Sxz2 + Szx2 + Syz2 + Szy2);
+    double C1 = 8.0 * (Sxx * Syz * Szy + Syy * Szx * Sxz + Szz * Sxy * Syx -
+                       Sxx * Syy * Szz - Syz * Szx * Sxy - Szy * Syx * Sxz);
+
+    double SxzpSzx = Sxz + Szx, SyzpSzy = Syz + Szy, SxypSyx = Sxy + Syx;
+    double SyzmSzy = Syz - Szy, SxzmSzx = Sxz - Szx, SxymSyx = Sxy - Syx;
+    double SxxpSyy = Sxx + Syy, SxxmSyy = Sxx - Syy;
+    double Sxy2Sxz2Syx2Szx2 = Sxy2 + Sxz2 - Syx2 - Szx2;
+
+    double C0 = Sxy2Sxz2Syx2Szx2 * Sxy2Sxz2Syx2Szx2
+        + (Sxx2Syy2Szz2Syz2Szy2 + SyzSzymSyySzz2) * (Sxx2Syy2Szz2Syz2Szy2 - SyzSzymSyySzz2)
+        + (-SxzpSzx * SyzmSzy + SxymSyx * (SxxmSyy - Szz)) * (-SxzmSzx * SyzpSzy + SxymSyx * (SxxmSyy + Szz))
+        + (-SxzpSzx * SyzpSzy - SxypSyx * (SxxpSyy - Szz)) * (-SxzmSzx * SyzmSzy - SxypSyx * (SxxpSyy + Szz))
+        + (SxypSyx * SyzpSzy + SxzpSzx * (SxxmSyy + Szz)) * (-SxymSyx * SyzmSzy + SxzpSzx * (SxxpSyy + Szz))
+        + (SxypSyx * SyzmSzy + SxzmSzx * (SxxmSyy - Szz)) * (-SxymSyx * SyzpSzy + SxzmSzx * (SxxpSyy - Szz));
+
+    double E0 = 0.5 * (ga + gb);
+    double lambda = E0;
+    for (int it = 0; it < 50; ++it) {
+        double old = lambda;
+        double x2 = lambda * lambda;
+        double b = (x2 + C2) * lambda;
+        double a = b + C1;
+        double denom = 2.0 * x2 * lambda + b + a;
+        if (denom == 0.0) break;
+        lambda -= (a * lambda + C0) / denom;
+        if (std::abs(lambda - old) < std::abs(1e-11 * lambda)) break;
+    }
+    return std::sqrt(std::max(0.0, 2.0 * (E0 - lambda) / n));
+}
+
+double RMSDFrames::rmsd(int i, int j, const std::vector<std::vector<int>>& permutations) const {
+    if (num_atoms_ == 0) return 0.0;
+    const double* ax = &x_[static_cast<size_t>(i) * num_atoms_];
+    const double* ay = &y_[static_cast<size_t>(i) * num_atoms_];
+    const double* az = &z_[static_cast<size_t>(i) * num_atoms_];
+    const double* bx = &x_[static_cast<size_t>(j) * num_atoms_];
+    const double* by = &y_[static_cast<size_t>(j) * num_atoms_];
+    const double* bz = &z_[static_cast<size_t>(j) * num_atoms_];
+
+    if (permutations.empty()) {
+        // Contiguous loop: compilers vectorize the nine accumulations
+        double S[9] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+        for (int p = 0; p < num_atoms_; ++p) {
+            S[0] += ax[p] * bx[p]; S[1] += ax[p] * by[p]; S[2] += ax[p] * bz[p];
+            S[3] += ay[p] * bx[p]; S[4] += ay[p] * by[p]; S[5] += ay[p] * bz[p];
+            S[6] += az[p] * bx[p]; S[7] += az[p] * by[p]; S[8] += az[p] * bz[p];
+        }
+        return qcp_rmsd(S, g_[i], g_[j], num_atoms_);
+    }
+
+    double best = std::numeric_limits<double>::max();
+    for (const auto& perm : permutations) {
+        if (static_cast<int>(perm.size()) != num_atoms_) {
+            throw std::runtime_error("RMSD: permutation size mismatch");
+        }
+        double S[9] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+        for (int p = 0; p < num_atoms_; ++p) {
+            int q = perm[p];
+            S[0] += ax[p] * bx[q]; S[1] += ax[p] * by[q]; S[2] += ax[p] * bz[q];
+            S[3] += ay[p] * bx[q]; S[4] += ay[p] * by[q]; S[5] += ay[p] * bz[q];
+            S[6] += az[p] * bx[q]; S[7] += az[p] * by[q]; S[8] += az[p] * bz[q];
+        }
+        best = std::min(best, qcp_rmsd(S, g_[i], g_[j], num_atoms_));
+    }
+    return best;
+}
+
+std::vector<float> rmsd_matrix(const std::vector<std::vector<double>>& frames,
+                               const RMSDSettings& settings) {
+    RMSDFrames data(frames, settings.atoms);
+    size_t n = frames.size();
+    std::vector<float> matrix(n < 2 ? 0 : n * (n - 1) / 2);
+
+    ThreadPool pool(settings.num_threads);
+    pool.parallel_for(static_cast<int>(n), [&](int i) {
+        for (size_t j = i + 1; j < n; ++j) {
+            matrix[condensed_index(i, j, n)] =
+                static_cast<float>(data.rmsd(i, static_cast<int>(j), settings.permutations));
+        }
+    });
+    return matrix;
+}
+
+} // namespace chemsim
@@ -0,0 +1,216 @@
+#include "chemsim/analysis/vibrations.h"
+#include "chemsim/core/element_data.h"
+#include "chemsim/core/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+namespace chemsim {
+
+// sqrt(kcal/mol/Angstrom^2/amu) -> cm^-1
+static const double EIGEN_TO_WAVENUMBER = 108.5913;
+
+Eigen::MatrixXd compute_hessian(const Molecule& mol, const UFFForceField& ff,
+                                double step, int num_threads) {
+    if (step <= 0.0) throw std::runtime_error("Hessian: step must be positive");
+    int n = 3 * mol.num_atoms();
+    Eigen::MatrixXd H(n, n);
+
+    ThreadPool pool(num_threads);
+    pool.parallel_for(n, [&](int c) {
+        Molecule displaced = mol;
+        Eigen::VectorXd g_plus, g_minus;
+        double x0 = mol.atom(c / 3).position[c % 3];
+
+        displaced.atom(c / 3).position[c % 3] = x0 + step;
+        ff.calculate_gradient(displaced, g_plus);
+        displaced.atom(c / 3).position[c % 3] = x0 - step;
+        ff.calculate_gradient(displaced, g_minus);
+
+        H.col(c) = (g_plus - g_minus) / (2.0 * step);
+    });
+
+    return 0.5 * (H + H.transpose());
+}
+
+// Orthonormal basis (columns) of mass-weighted translations and rotations;
+// five columns for linear molecules
+static Eigen::MatrixXd rigid_body_basis(const Molecule& mol, const Eigen::VectorXd& sqrt_mass) {
+    int num_atoms = mol.num_atoms();
+    int n = 3 * num_atoms;
+
+    Eigen::Vector3d com = Eigen::Vector3d::Zero();
+    double total_mass = 0.0;
+    for (int a = 0; a < num_atoms; ++a) {
+        double m = sqrt_mass[3*a] * sqrt_mass[3*a];
+        com += m * mol.atom(a).position;
+        total_mass += m;
+    }
+    com /= total_mass;
+
+    std::vector<Eigen::VectorXd> candidates;
+    for (int axis = 0; axis < 3; ++axis) {
+        Eigen::VectorXd t = Eigen::VectorXd::Zero(n);
+        for (int a = 0; a < num_atoms; ++a) t[3*a + axis] = sqrt_mass[3*a];
+        candidates.push_back(t);
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        Eigen::Vector3d e = Eigen::Vector3d::Unit(axis);
+        Eigen::VectorXd r(n);
+        for (int a = 0; a < num_atoms; ++a) {
+            r.segment<3>(3*a) = sqrt_mass[3*a] * e.cross(mol.atom(a).position - com);
+        }
+        candidates.push_back(r);
+    }
+
+    // Gram-Schmidt, dropping dependent rotations
+    std::vector<Eigen::VectorXd> basis;
+    for (auto& v : candidates) {
+        double original = v.norm();
+        for (const auto& b : basis) v -= b.dot(v) * b;
+        double norm = v.norm();
+        if (original > 0.0 && norm > 1e-6 * original) basis.push_back(v / norm);
+    }
+
+    Eigen::MatrixXd D(n, basis.size());
+    for (size_t c = 0; c < basis.size(); ++c) D.col(c) = basis[c];
+    return D;
+}
+
+static double to_wavenumber(double eigenvalue) {
+    double f = EIGEN_TO_WAVENUMBER * std::sqrt(std::abs(eigenvalue));
+    return eigenvalue < 0.0 ? -f : f;
+}
+
+// Convert mass-weighted eigenvectors to normalized Cartesian displacements
+static std::vector<double> cartesian_mode(const Eigen::VectorXd& q, const Eigen::VectorXd& sqrt_mass) {
+    Eigen::VectorXd mode = q.cwiseQuotient(sqrt_mass);
+    double norm = mode.norm();
+    if (norm > 1e-12) mode /= norm;
+    return std::vector<double>(mode.data(), mode.data() + mode.size());
+}
+
+static VibrationalResult dense_analysis(const Molecule& mol, const UFFForceField& ff,
+                                        const VibrationalSettings& settings,
+                                        const Eigen::VectorXd& sqrt_mass,
+                                        const Eigen::MatrixXd& D) {
+    int n = static_cast<int>(sqrt_mass.size());
+    Eigen::VectorXd inv_sqrt_mass = sqrt_mass.cwiseInverse();
+    Eigen::MatrixXd H = compute_hessian(mol, ff, settings.step, settings.num_threads);
+    Eigen::MatrixXd Hmw = inv_sqrt_mass.asDiagonal() * H * inv_sqrt_mass.asDiagonal();
+
+    // Internal coordinates: orthogonal complement of the rigid-body space
+    Eigen::HouseholderQR<Eigen::MatrixXd> qr(D);
+    Eigen::MatrixXd Q = qr.householderQ() * Eigen::MatrixXd::Identity(n, n);
+    Eigen::MatrixXd B = Q.rightCols(n - D.cols());
+
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(B.transpose() * Hmw * B);
+    if (solver.info() != Eigen::Success) {
+        throw std::runtime_error("Vibrational analysis: diagonalization failed");
+    }
+
+    VibrationalResult result;
+    result.num_imaginary = 0;
+    for (Eigen::Index m = 0; m < solver.eigenvalues().size(); ++m) {
+        double f = to_wavenumber(solver.eigenvalues()[m]);
+        if (f < 0.0) result.num_imaginary++;
+        result.frequencies.push_back(f);
+        result.normal_modes.push_back(cartesian_mode(B * solver.eigenvectors().col(m), sqrt_mass));
+    }
+    return result;
+}
+
+static VibrationalResult lanczos_analysis(const Molecule& mol, const UFFForceField& ff,
+                                          const VibrationalSettings& settings,
+                                          const Eigen::VectorXd& sqrt_mass,
+                                          const Eigen::MatrixXd& D) {
+    int n = static_cast<int>(sqrt_mass.size());
+    int internal = n - static_cast<int>(D.cols());
+    int k = std::min(settings.num_modes, internal);
+    if (k <= 0) return VibrationalResult{{}, {}, 0};
+    Eigen::VectorXd inv_sqrt_mass = sqrt_mass.cwiseInverse();
+
+    auto project = [&](Eigen::VectorXd& v) { v -= D * (D.transpose() * v); };
+
+    // Projected mass-weighted Hessian applied to v via a gradient difference
+    auto apply = [&](Eigen::VectorXd v) {
+        project(v);
+        Eigen::VectorXd hv = ff.hessian_vector_product(mol, v.cwiseProduct(inv_sqrt_mass));
+        Eigen::VectorXd w = hv.cwiseProduct(inv_sqrt_mass);
+        project(w);
+        return w;
+    };
+
+    // Lanczos with full reorthogonalization
+    int steps = std::min(internal, std::max(4 * k, k + 40));
+    std::mt19937 rng(12345);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    Eigen::VectorXd q(n);
+    for (int i = 0; i < n; ++i) q[i] = normal(rng);
+    project(q);
+    q.normalize();
+
+    Eigen::MatrixXd V(n, steps);
+    std::vector<double> alpha, beta;
+    int m = 0;
+    for (; m < steps; ++m) {
+        V.col(m) = q;
+        Eigen::VectorXd w = apply(q);
+        double a = q.dot(w);
+        alpha.push_back(a);
+        for (int r = 0; r < 2; ++r) {
+            w -= V.leftCols(m + 1) * (V.leftCols(m + 1).transpose() * w);
+            project(w);
+        }
+        double b = w.norm();
+        if (m + 1 == steps || b < 1e-10) {
+            m++;
+            break;
+        }
+        beta.push_back(b);
+        q = w / b;
+    }
+
+    Eigen::MatrixXd T = Eigen::MatrixXd::Zero(m, m);
+    for (int i = 0; i < m; ++i) {
+        T(i, i) = alpha[i];
+        if (i + 1 < m) T(i, i + 1) = T(i + 1, i) = beta[i];
+    }
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(T);
+
+    VibrationalResult result;
+    result.num_imaginary = 0;
+    for (int r = 0; r < std::min(k, m); ++r) {
+        double f = to_wavenumber(solver.eigenvalues()[r]);
+        if (f < 0.0) result.num_imaginary++;
+        result.frequencies.push_back(f);
+        Eigen::VectorXd ritz = V.leftCols(m) * solver.eigenvectors().col(r);
+        result.normal_modes.push_back(cartesian_mode(ritz, sqrt_mass));
+    }
+    return result;
+}
+
+VibrationalResult vibrational_analysis(const Molecule& mol, const UFFForceField& ff,
+                                       const VibrationalSettings& settings) {
+    if (settings.solver != "dense" && settings.solver != "lanczos") {
+        throw std::runtime_error("Vibrational analysis: unknown solver: " + settings.solver);
+    }
+    int num_atoms = mol.num_atoms();
+    if (num_atoms < 2) return VibrationalResult{{}, {}, 0};
+
+    Eigen::VectorXd sqrt_mass(3 * num_atoms);
+    for (int a = 0; a < num_atoms; ++a) {
+        sqrt_mass.segment<3>(3*a).setConstant(
+            std::sqrt(element_by_number(mol.atom(a).atomic_number).mass));
+    }
+    Eigen::MatrixXd D = rigid_body_basis(mol, sqrt_mass);
+
+    if (settings.solver == "lanczos") {
+        return lanczos_analysis(mol, ff, settings, sqrt_mass, D);
+    }
+    return dense_analysis(mol, ff, settings, sqrt_mass, D);
+}
+
+} // namespace chemsim
@@ -0,0 +1,165 @@
+#include "chemsim/conf/conformer_search.h"
+#include "chemsim/analysis/rmsd.h"
+#include "chemsim/core/geometry.h"
+#include "chemsim/core/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+namespace chemsim {
+
+static bool is_symmetric_rotor(const Molecule& mol,
+                               const std::vector<std::vector<int>>& adj,
+                               int center, int other) {
+    int hydrogens = 0;
+    for (int n : adj[center]) {
+        if (n == other) continue;
+        if (mol.atom(n).atomic_number != 1) return false;
+        hydrogens++;
+    }
+    return hydrogens == 3;
+}
+
+std::vector<Bond> find_rotatable_bonds(const Molecule& mol) {
+    auto adj = mol.adjacency_list();
+    std::vector<Bond> rotatable;
+    for (const auto& bond : mol.bonds()) {
+        int i = bond.atom_i, j = bond.atom_j;
+        if (bond.order != 1) continue;
+        if (adj[i].size() < 2 || adj[j].size() < 2) continue;
+        if (is_symmetric_rotor(mol, adj, i, j) || is_symmetric_rotor(mol, adj, j, i)) continue;
+
+        // Ring bond if j's side still contains i
+        auto side = atoms_on_side(adj, j, i);
+        bool in_ring = false;
+        for (int a : side) {
+            for (int b : adj[a]) {
+                if (b == i && a != j) in_ring = true;
+            }
+        }
+        if (in_ring) continue;
+        rotatable.push_back(bond);
+    }
+    return rotatable;
+}
+
+std::vector<Conformer> search_conformers(const Molecule& mol,
+                                         const UFFForceField& ff,
+                                         const ConformerSearchSettings& settings) {
+    if (settings.method != "systematic" && settings.method != "random") {
+        throw std::runtime_error("Conformer search: unknown method: " + settings.method);
+    }
+    if (settings.torsion_step <= 0.0 || settings.torsion_step > 360.0) {
+        throw std::runtime_error("Conformer search: torsion_step must be in (0, 360]");
+    }
+
+    auto adj = mol.adjacency_list();
+    auto rotors = find_rotatable_bonds(mol);
+
+    // Move the smaller side of each rotor
+    std::vector<std::vector<int>> moving(rotors.size());
+    for (size_t r = 0; r < rotors.size(); ++r) {
+        auto side_j = atoms_on_side(adj, rotors[r].atom_j, rotors[r].atom_i);
+        auto side_i = atoms_on_side(adj, rotors[r].atom_i, rotors[r].atom_j);
+        if (side_i.size() < side_j.size()) {
+            moving[r] = side_i;
+            std::swap(rotors[r].atom_i, rotors[r].atom_j);
+        } else {
+            moving[r] = side_j;
+        }
+    }
+
+    // Torsion offsets (radians) for each candidate; the input geometry is candidate 0
+    std::mt19937 rng(settings.seed);
+    std::vector<std::vector<double>> offsets;
+    offsets.push_back(std::vector<double>(rotors.size(), 0.0));
+
+    int steps_per_rotor = std::max(1, static_cast<int>(std::round(360.0 / settings.torsion_step)));
+    double grid_size = std::pow(static_cast<double>(steps_per_rotor), static_cast<double>(rotors.size()));
+
+    if (!rotors.empty() && settings.method == "systematic" && grid_size <= settings.max_candidates) {
+        long total = static_cast<long>(grid_size);
+        for (long c = 1; c < total; ++c) {
+            std::vector<double> off(rotors.size());
+            long code = c;
+            for (size_t r = 0; r < rotors.size(); ++r) {
+                off[r] = (code % steps_per_rotor) * settings.torsion_step * M_PI / 180.0;
+                code /= steps_per_rotor;
+            }
+            offsets.push_back(off);
+        }
+    } else if (!rotors.empty()) {
+        // Random torsions; systematic grids too large to enumerate are sampled on-grid
+        std::uniform_real_distribution<double> uniform(0.0, 2.0 * M_PI);
+        std::uniform_int_distribution<int> grid_index(0, steps_per_rotor - 1);
+        bool on_grid = settings.method == "systematic";
+        for (int c = 1; c < settings.max_candidates; ++c) {
+            std::vector<double> off(rotors.size());
+            for (size_t r = 0; r < rotors.size(); ++r) {
+                off[r] = on_grid ? grid_index(rng) * settings.torsion_step * M_PI / 180.0
+                                 : uniform(rng);
+            }
+            offsets.push_back(off);
+        }
+    }
+
+    // Minimize all candidates in parallel; ff is shared read-only
+    auto start = mol.get_positions();
+    std::vector<Conformer> candidates(offsets.size());
+    OptSettings opt = settings.opt;
+    opt.store_trajectory = false;
+
+    ThreadPool pool(settings.num_threads);
+    pool.parallel_for(static_cast<int>(offsets.size()), [&](int c) {
+        std::vector<double> pos = start;
+        for (size_t r = 0; r < rotors.size(); ++r) {
+            if (offsets[c][r] != 0.0) {
+                rotate_about_axis(pos, rotors[r].atom_i, rotors[r].atom_j, moving[r], offsets[c][r]);
+            }
+        }
+        Molecule work = mol;
+        work.set_positions(pos);
+        auto result = optimize_geometry(work, ff, opt);
+        candidates[c].positions = work.get_positions();
+        candidates[c].energy = result.final_energy;
+        candidates[c].converged = result.converged;
+    });
+
+    // Rank, apply the energy window, then drop RMSD duplicates
+    std::vector<Conformer> finite;
+    for (auto& c : candidates) {
+        if (std::isfinite(c.energy)) finite.push_back(std::move(c));
+    }
+    std::sort(finite.begin(), finite.end(),
+              [](const Conformer& a, const Conformer& b) { return a.energy < b.energy; });
+    if (finite.empty()) return finite;
+
+    std::vector<int> rmsd_atoms;
+    for (int a = 0; a < mol.num_atoms(); ++a) {
+        if (settings.include_hydrogens || mol.atom(a).atomic_number != 1) rmsd_atoms.push_back(a);
+    }
+    if (rmsd_atoms.size() < 3) {
+        rmsd_atoms.clear();
+        for (int a = 0; a < mol.num_atoms(); ++a) rmsd_atoms.push_back(a);
+    }
+
+    double e_min = finite.front().energy;
+    std::vector<Conformer> ensemble;
+    for (auto& c : finite) {
+        if (c.energy - e_min > settings.energy_window) break;
+        bool duplicate = false;
+        for (const auto& kept : ensemble) {
+            if (kabsch_rmsd(c.positions, kept.positions, rmsd_atoms) < settings.rmsd_threshold) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (duplicate) continue;
+        c.relative_energy = c.energy - e_min;
+        ensemble.push_back(std::move(c));
+    }
+    return ensemble;
+}
+
+} // namespace chemsim
@@ -0,0 +1,281 @@
+#include "chemsim/conf/embedding.h"
+#include "chemsim/core/thread_pool.h"
+#include "chemsim/ff/uff_params.h"
+#include <LBFGS.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+namespace chemsim {
+
+static const double UNBOUNDED = 1000.0;
+static const double BOND_TOLERANCE = 0.01;
+static const double ANGLE_TOLERANCE = 0.04;
+static const double TORSION_TOLERANCE = 0.06;
+static const double VDW_SCALE = 0.35; // fraction of the summed UFF vdW diameters
+
+// Distance between i and l for an i-j-k-l chain at dihedral phi
+static double chain_distance(double r_ij, double r_jk, double r_kl,
+                             double theta_ijk, double theta_jkl, double phi) {
+    Eigen::Vector3d j(0.0, 0.0, 0.0);
+    Eigen::Vector3d k(r_jk, 0.0, 0.0);
+    Eigen::Vector3d i = j + r_ij * Eigen::Vector3d(std::cos(theta_ijk), std::sin(theta_ijk), 0.0);
+    Eigen::Vector3d l = k + r_kl * Eigen::Vector3d(-std::cos(theta_jkl),
+                                                   std::sin(theta_jkl) * std::cos(phi),
+                                                   std::sin(theta_jkl) * std::sin(phi));
+    return (i - l).norm();
+}
+
+Eigen::MatrixXd distance_bounds(const Molecule& mol, const UFFForceField& ff) {
+    int n = mol.num_atoms();
+    const auto& types = ff.atom_types();
+    if (static_cast<int>(types.size()) != n) {
+        throw std::runtime_error("Embedding: force field is not set up for this molecule");
+    }
+
+    // 0 marks an unset pair in both triangles
+    Eigen::MatrixXd bounds = Eigen::MatrixXd::Zero(n, n);
+    auto set = [&](int a, int b, double lower, double upper) {
+        int lo = std::min(a, b), hi = std::max(a, b);
+        bounds(lo, hi) = upper;
+        bounds(hi, lo) = lower;
+    };
+    auto is_set = [&](int a, int b) { return bounds(std::min(a, b), std::max(a, b)) > 0.0; };
+
+    // 1-2
+    Eigen::MatrixXd length = Eigen::MatrixXd::Zero(n, n);
+    for (int b = 0; b < mol.num_bonds(); ++b) {
+        const auto& bond = mol.bond(b);
+        double r0 = ff.uff_bond_length(b, mol);
+        length(bond.atom_i, bond.atom_j) = length(bond.atom_j, bond.atom_i) = r0;
+        set(bond.atom_i, bond.atom_j, r0 - BOND_TOLERANCE, r0 + BOND_TOLERANCE);
+    }
+
+    // 1-3 from the central atom's natural angle
+    auto adj = mol.adjacency_list();
+    auto theta0 = [&](int center) {
+        return get_uff_params(types[center]).theta0 * M_PI / 180.0;
+    };
+    for (int j = 0; j < n; ++j) {
+        double theta = theta0(j);
+        for (size_t a = 0; a < adj[j].size(); ++a) {
+            for (size_t b = a + 1; b < adj[j].size(); ++b) {
+                int i = adj[j][a], k = adj[j][b];
+                if (is_set(i, k)) continue;
+                double r1 = length(i, j), r2 = length(j, k);
+                double d = std::sqrt(r1*r1 + r2*r2 - 2.0*r1*r2*std::cos(theta));
+                set(i, k, d - ANGLE_TOLERANCE, d + ANGLE_TOLERANCE);
+            }
+        }
+    }
+
+    // 1-4 between the cis and trans extremes
+    for (const auto& bond : mol.bonds()) {
+        int j = bond.atom_i, k = bond.atom_j;
+        for (int i : adj[j]) {
+            if (i == k) continue;
+            for (int l : adj[k]) {
+                if (l == j || l == i || is_set(i, l)) continue;
+                double cis = chain_distance(length(i, j), length(j, k), length(k, l),
+                                            theta0(j), theta0(k), 0.0);
+                double trans = chain_distance(length(i, j), length(j, k), length(k, l),
+                                              theta0(j), theta0(k), M_PI);
+                set(i, l, std::min(cis, trans) - TORSION_TOLERANCE,
+                    std::max(cis, trans) + TORSION_TOLERANCE);
+            }
+        }
+    }
+
+    // Everything else: van der Waals floor, open upper bound
+    for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) {
+            if (is_set(i, j)) continue;
+            double lower = VDW_SCALE * (get_uff_params(types[i]).x1 + get_uff_params(types[j]).x1);
+            set(i, j, lower, UNBOUNDED);
+        }
+    }
+    return bounds;
+}
+
+bool smooth_bounds(Eigen::MatrixXd& bounds) {
+    int n = static_cast<int>(bounds.rows());
+    auto upper = [&](int a, int b) -> double& { return a < b ? bounds(a, b) : bounds(b, a); };
+    auto lower = [&](int a, int b) -> double& { return a < b ? bounds(b, a) : bounds(a, b); };
+
+    for (int k = 0; k < n; ++k) {
+        for (int i = 0; i < n; ++i) {
+            if (i == k) continue;
+            for (int j = i + 1; j < n; ++j) {
+                if (j == k) continue;
+                double u_ik = upper(i, k), u_kj = upper(k, j);
+                double& u_ij = upper(i, j);
+                if (u_ij > u_ik + u_kj) u_ij = u_ik + u_kj;
+
+                double& l_ij = lower(i, j);
+                double l = std::max(lower(i, k) - u_kj, lower(k, j) - u_ik);
+                if (l_ij < l) l_ij = l;
+                if (l_ij > u_ij) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Squared violations of the distance bounds (Crippen-Havel error function)
+class BoundsObjective {
+public:
+    BoundsObjective(const Eigen::MatrixXd& bounds)
+        : bounds_(bounds), best_value_(std::numeric_limits<double>::max()) {}
+
+    double operator()(const Eigen::VectorXd& x, Eigen::VectorXd& grad) {
+        int n = static_cast<int>(bounds_.rows());
+        grad.setZero(x.size());
+        double E = 0.0;
+        for (int i = 0; i < n; ++i) {
+            for (int j = i + 1; j < n; ++j) {
+                Eigen::Vector3d r = x.segment<3>(3*i) - x.segment<3>(3*j);
+                double d2 = r.squaredNorm();
+                double u2 = bounds_(i, j) * bounds_(i, j);
+                double l2 = bounds_(j, i) * bounds_(j, i);
+                double dE_dd2 = 0.0;
+                if (d2 > u2) {
+                    double f = d2 / u2 - 1.0;
+                    E += f * f;
+                    dE_dd2 = 2.0 * f / u2;
+                } else if (d2 < l2) {
+                    double s = l2 + d2;
+                    double f = 2.0 * l2 / s - 1.0;
+                    E += f * f;
+                    dE_dd2 = -4.0 * f * l2 / (s * s);
+                }
+                if (dE_dd2 != 0.0) {
+                    Eigen::Vector3d g = 2.0 * dE_dd2 * r;
+                    grad.segment<3>(3*i) += g;
+                    grad.segment<3>(3*j) -= g;
+                }
+            }
+        }
+        if (E < best_value_) {
+            best_value_ = E;
+            best_x_ = x;
+        }
+        return E;
+    }
+
+    const Eigen::VectorXd& best_x() const { return best_x_; }
+
+private:
+    const Eigen::MatrixXd& bounds_;
+    double best_value_;
+    Eigen::VectorXd best_x_;
+};
+
+// One metric-matrix embedding; false if the metric matrix has fewer than
+// three positive eigenvalues
+static bool metric_embedding(const Eigen::MatrixXd& bounds, std::mt19937& rng,
+                             Eigen::VectorXd& x) {
+    int n = static_cast<int>(bounds.rows());
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    Eigen::MatrixXd d2 = Eigen::MatrixXd::Zero(n, n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) {
+            double d = bounds(j, i) + uniform(rng) * (bounds(i, j) - bounds(j, i));
+            d2(i, j) = d2(j, i) = d * d;
+        }
+    }
+
+    // Squared distances to the centroid, then the metric (Gram) matrix
+    double total = d2.sum() / (2.0 * n * n);
+    Eigen::VectorXd d0 = d2.rowwise().sum() / n - Eigen::VectorXd::Constant(n, total);
+    Eigen::MatrixXd G(n, n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) G(i, j) = 0.5 * (d0[i] + d0[j] - d2(i, j));
+    }
+
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(G);
+    if (solver.info() != Eigen::Success) return false;
+
+    x.resize(3 * n);
+    for (int axis = 0; axis < 3; ++axis) {
+        int col = n - 1 - axis;
+        double lambda = solver.eigenvalues()[col];
+        if (lambda <= 0.0) return false;
+        for (int i = 0; i < n; ++i) {
+            x[3*i + axis] = std::sqrt(lambda) * solver.eigenvectors()(i, col);
+        }
+    }
+    return true;
+}
+
+std::vector<Conformer> embed_molecule(const Molecule& mol,
+                                      const UFFForceField& ff,
+                                      const EmbedSettings& settings) {
+    if (settings.num_embeddings < 1) {
+        throw std::runtime_error("Embedding: num_embeddings must be positive");
+    }
+    int n = mol.num_atoms();
+    if (n == 0) throw std::runtime_error("Embedding: molecule has no atoms");
+
+    Eigen::MatrixXd bounds = distance_bounds(mol, ff);
+    if (!smooth_bounds(bounds)) {
+        throw std::runtime_error("Embedding: distance bounds are inconsistent");
+    }
+
+    std::vector<Conformer> conformers(settings.num_embeddings);
+    ThreadPool pool(settings.num_threads);
+    pool.parallel_for(settings.num_embeddings, [&](int k) {
+        std::mt19937 rng(settings.seed + static_cast<unsigned int>(k));
+
+        Eigen::VectorXd x;
+        bool embedded = n == 1;
+        if (n == 1) x = Eigen::VectorXd::Zero(3);
+        for (int attempt = 0; attempt < settings.max_attempts && !embedded; ++attempt) {
+            embedded = metric_embedding(bounds, rng, x);
+        }
+        if (!embedded) {
+            throw std::runtime_error("Embedding: metric matrix embedding failed");
+        }
+
+        if (n > 1) {
+            LBFGSpp::LBFGSParam<double> param;
+            param.max_iterations = 500;
+            param.epsilon = 1e-5;
+            param.max_linesearch = 40;
+            LBFGSpp::LBFGSSolver<double> solver(param);
+            BoundsObjective objective(bounds);
+            double fx;
+            try {
+                solver.minimize(objective, x, fx);
+            } catch (const std::exception&) {
+                // Keep the best point seen if the line search gives up
+            }
+            if (objective.best_x().size() == x.size()) x = objective.best_x();
+        }
+
+        Molecule embedded_mol = mol;
+        embedded_mol.set_positions(std::vector<double>(x.data(), x.data() + x.size()));
+
+        Conformer& conf = conformers[k];
+        if (settings.refine) {
+            OptSettings opt = settings.opt;
+            opt.store_trajectory = false;
+            OptResult result = optimize_geometry(embedded_mol, ff, opt);
+            conf.energy = result.final_energy;
+            conf.converged = result.converged;
+        } else {
+            conf.energy = ff.calculate_energy(embedded_mol);
+            conf.converged = false;
+        }
+        conf.positions = embedded_mol.get_positions();
+    });
+
+    double lowest = std::numeric_limits<double>::max();
+    for (const auto& c : conformers) lowest = std::min(lowest, c.energy);
+    for (auto& c : conformers) c.relative_energy = c.energy - lowest;
+    return conformers;
+}
+
+} // namespace chemsim
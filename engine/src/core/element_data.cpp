@@ -1,5 +1,6 @@
 #include "chemsim/core/element_data.h"
 #include <algorithm>
+#include <vector>
 #include <stdexcept>
 #include <unordered_map>
 
@@ -66,17 +67,24 @@ static const ElementInfo ELEMENT_TABLE[] = {
 
 static const int NUM_ELEMENTS = sizeof(ELEMENT_TABLE) / sizeof(ELEMENT_TABLE[0]);
 
-// Build symbol lookup map on first use
-static const std::unordered_map<std::string, int>& symbol_map() {
-    static std::unordered_map<std::string, int> map;
-    if (map.empty()) {
-        for (int i = 0; i < NUM_ELEMENTS; ++i) {
-            map[ELEMENT_TABLE[i].symbol] = i;
-        }
+static std::unordered_map<std::string, int> build_symbol_map() {
+    std::unordered_map<std::string, int> map;
+    for (int i = 0; i < NUM_ELEMENTS; ++i) {
+        map[ELEMENT_TABLE[i].symbol] = i;
     }
     return map;
 }
 
+// Build symbol lookup map on first use (static init is thread-safe)
+static const std::unordered_map<std::string, int>& symbol_map() {
+    static const auto map = build_symbol_map();
+    return map;
+}
+
+int num_elements() {
+    return NUM_ELEMENTS;
+}
+
 const ElementInfo& element_by_number(int atomic_number) {
     if (atomic_number < 0 || atomic_number >= NUM_ELEMENTS) {
         throw std::out_of_range("Atomic number " + std::to_string(atomic_number) + " out of range");
@@ -93,4 +101,25 @@ const ElementInfo& element_by_symbol(const std::string& symbol) {
     return ELEMENT_TABLE[it->second];
 }
 
+// One- and two-character symbols indexed by their ASCII codes
+static std::vector<signed char> build_symbol_table() {
+    std::vector<signed char> table(128 * 128, -1);
+    for (int i = 0; i < NUM_ELEMENTS; ++i) {
+        const auto& sym = ELEMENT_TABLE[i].symbol;
+        int code = static_cast<unsigned char>(sym[0]) * 128 +
+                   (sym.size() > 1 ? static_cast<unsigned char>(sym[1]) : 0);
+        table[code] = static_cast<signed char>(ELEMENT_TABLE[i].atomic_number);
+    }
+    return table;
+}
+
+int atomic_number_of(std::string_view symbol) {
+    static const auto table = build_symbol_table();
+    if (symbol.empty() || symbol.size() > 2) return -1;
+    unsigned char c0 = static_cast<unsigned char>(symbol[0]);
+    unsigned char c1 = symbol.size() > 1 ? static_cast<unsigned char>(symbol[1]) : 0;
+    if (c0 >= 128 || c1 >= 128) return -1;
+    return table[c0 * 128 + c1];
+}
+
 } // namespace chemsim
@@ -0,0 +1,55 @@
+#include "chemsim/core/event_notifier.h"
+#include <cstdint>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+namespace chemsim {
+
+EventNotifier::EventNotifier() {
+#ifdef __linux__
+    read_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (read_fd_ < 0) throw std::runtime_error("EventNotifier: cannot create eventfd");
+    write_fd_ = read_fd_;
+#else
+    int fds[2];
+    if (::pipe(fds) != 0) throw std::runtime_error("EventNotifier: cannot create pipe");
+    for (int fd : fds) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    read_fd_ = fds[0];
+    write_fd_ = fds[1];
+#endif
+}
+
+EventNotifier::~EventNotifier() {
+    ::close(read_fd_);
+    if (write_fd_ != read_fd_) ::close(write_fd_);
+}
+
+void EventNotifier::notify() {
+    // A full pipe or a saturated counter is already readable
+#ifdef __linux__
+    uint64_t one = 1;
+#else
+    char one = 1;
+#endif
+    ssize_t r = ::write(write_fd_, &one, sizeof(one));
+    (void)r;
+}
+
+void EventNotifier::drain() {
+#ifdef __linux__
+    uint64_t count;
+    while (::read(read_fd_, &count, sizeof(count)) > 0) {}
+#else
+    char buf[256];
+    while (::read(read_fd_, buf, sizeof(buf)) > 0) {}
+#endif
+}
+
+} // namespace chemsim
@@ -0,0 +1,80 @@
+#include "chemsim/core/geometry.h"
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace chemsim {
+
+double dihedral_angle(const Molecule& mol, int i, int j, int k, int l) {
+    Eigen::Vector3d b1 = mol.atom(j).position - mol.atom(i).position;
+    Eigen::Vector3d b2 = mol.atom(k).position - mol.atom(j).position;
+    Eigen::Vector3d b3 = mol.atom(l).position - mol.atom(k).position;
+
+    Eigen::Vector3d n1 = b1.cross(b2);
+    Eigen::Vector3d n2 = b2.cross(b3);
+    double n1_norm = n1.norm();
+    double n2_norm = n2.norm();
+    if (n1_norm < 1e-10 || n2_norm < 1e-10) return 0.0;
+
+    double cos_phi = n1.dot(n2) / (n1_norm * n2_norm);
+    cos_phi = std::max(-1.0, std::min(1.0, cos_phi));
+    double phi = std::acos(cos_phi);
+    if (n1.dot(b3) < 0.0) phi = -phi;
+    return phi * 180.0 / M_PI;
+}
+
+std::vector<int> atoms_on_side(const std::vector<std::vector<int>>& adj,
+                               int start, int blocked) {
+    std::vector<char> seen(adj.size(), 0);
+    std::vector<int> stack = {start};
+    std::vector<int> side;
+    seen[start] = 1;
+    seen[blocked] = 1;
+    while (!stack.empty()) {
+        int a = stack.back();
+        stack.pop_back();
+        side.push_back(a);
+        for (int b : adj[a]) {
+            if (!seen[b]) {
+                seen[b] = 1;
+                stack.push_back(b);
+            }
+        }
+    }
+    return side;
+}
+
+void rotate_about_axis(std::vector<double>& positions, int axis_i, int axis_j,
+                       const std::vector<int>& atoms, double angle) {
+    Eigen::Vector3d origin(positions[3*axis_i], positions[3*axis_i + 1], positions[3*axis_i + 2]);
+    Eigen::Vector3d axis = Eigen::Vector3d(positions[3*axis_j], positions[3*axis_j + 1],
+                                           positions[3*axis_j + 2]) - origin;
+    if (axis.norm() < 1e-10) return;
+    Eigen::Matrix3d R = Eigen::AngleAxisd(angle, axis.normalized()).toRotationMatrix();
+    for (int a : atoms) {
+        Eigen::Vector3d p(positions[3*a], positions[3*a + 1], positions[3*a + 2]);
+        Eigen::Vector3d q = origin + R * (p - origin);
+        positions[3*a] = q.x();
+        positions[3*a + 1] = q.y();
+        positions[3*a + 2] = q.z();
+    }
+}
+
+void set_dihedral(Molecule& mol, int i, int j, int k, int l, double degrees) {
+    auto adj = mol.adjacency_list();
+    auto moving = atoms_on_side(adj, k, j);
+    for (int a : moving) {
+        if (a == i) throw std::runtime_error("set_dihedral: bond is part of a ring");
+        for (int b : adj[a]) {
+            if (b == j && a != k) throw std::runtime_error("set_dihedral: bond is part of a ring");
+        }
+    }
+
+    double delta = (degrees - dihedral_angle(mol, i, j, k, l)) * M_PI / 180.0;
+    auto positions = mol.get_positions();
+    rotate_about_axis(positions, j, k, moving, delta);
+    mol.set_positions(positions);
+}
+
+} // namespace chemsim
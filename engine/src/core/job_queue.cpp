@@ -0,0 +1,52 @@
+#include "chemsim/core/job_queue.h"
+#include "chemsim/core/thread_pool.h"
+
+namespace chemsim {
+
+JobQueue::JobQueue(int num_threads) : pool_(std::make_unique<ThreadPool>(num_threads)) {}
+
+JobQueue::~JobQueue() {
+    // Joins the workers after the queued jobs have run
+    pool_.reset();
+}
+
+uint64_t JobQueue::submit(std::function<void()> job) {
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = next_id_++;
+        outstanding_++;
+    }
+    pool_->submit([this, id, job = std::move(job)]() {
+        Completion done{id, nullptr};
+        try {
+            job();
+        } catch (...) {
+            done.error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            completed_.push_back(std::move(done));
+        }
+        notifier_.notify();
+    });
+    return id;
+}
+
+std::vector<JobQueue::Completion> JobQueue::take_completed() {
+    // Drain before collecting: a job that finishes in between leaves the
+    // descriptor readable, so it is picked up on the next wakeup
+    notifier_.drain();
+    std::vector<Completion> done;
+    std::lock_guard<std::mutex> lock(mutex_);
+    done.swap(completed_);
+    outstanding_ -= done.size();
+    return done;
+}
+
+size_t JobQueue::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return outstanding_;
+}
+
+} // namespace chemsim
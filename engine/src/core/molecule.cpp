@@ -1,54 +1,88 @@
 #include "chemsim/core/molecule.h"
 #include "chemsim/core/element_data.h"
+#include "chemsim/core/spatial_index.h"
+#include "chemsim/core/thread_pool.h"
+#include <algorithm>
 #include <cmath>
 #include <set>
+#include <stdexcept>
 
 namespace chemsim {
 
 void Molecule::add_atom(const Atom& atom) {
-    atoms_.push_back(atom);
+    atoms_.push_back({atom.atomic_number, atom.symbol, atom.formal_charge});
+    coords_.append(atom.position);
 }
 
 void Molecule::add_bond(const Bond& bond) {
     bonds_.push_back(bond);
 }
 
-void Molecule::perceive_bonds(double tolerance) {
+void Molecule::perceive_bonds(double tolerance, int num_threads) {
     bonds_.clear();
     int n = num_atoms();
+    if (n < 2) return;
+    const double min_bond = 0.4; // Minimum bond distance
+
+    std::vector<double> radii(n);
+    std::vector<Eigen::Vector3d> points(n);
+    double max_radius = 0.0;
     for (int i = 0; i < n; ++i) {
-        for (int j = i + 1; j < n; ++j) {
-            double dist = (atoms_[i].position - atoms_[j].position).norm();
-            double ri = element_by_number(atoms_[i].atomic_number).covalent_radius;
-            double rj = element_by_number(atoms_[j].atomic_number).covalent_radius;
-            double max_bond = ri + rj + tolerance;
-            double min_bond = 0.4; // Minimum bond distance
-            if (dist >= min_bond && dist <= max_bond) {
-                bonds_.emplace_back(i, j, 1);
-            }
+        radii[i] = element_by_number(atoms_[i].atomic_number).covalent_radius;
+        max_radius = std::max(max_radius, radii[i]);
+        points[i] = atom(i).position;
+    }
+
+    // Cells one maximum bond length wide: bonded partners are always in
+    // the 27 surrounding cells
+    SpatialIndex index(points, std::max(2.0 * max_radius + tolerance, 1e-3));
+
+    // Partners j > i of each atom in a contiguous block, sorted by j
+    auto find_partners = [&](int begin, int end, std::vector<Bond>& out) {
+        std::vector<int> partners;
+        for (int i = begin; i < end; ++i) {
+            partners.clear();
+            double reach = radii[i] + max_radius + tolerance;
+            index.for_each_within(points[i], reach, [&](int j, double d2) {
+                if (j <= i) return;
+                double dist = std::sqrt(d2);
+                double max_bond = radii[i] + radii[j] + tolerance;
+                if (dist >= min_bond && dist <= max_bond) partners.push_back(j);
+            });
+            std::sort(partners.begin(), partners.end());
+            for (int j : partners) out.emplace_back(i, j, 1);
         }
+    };
+
+    int threads = num_threads <= 0 ? default_num_threads() : num_threads;
+    int blocks = std::min(threads, n / 1024 + 1);
+    if (blocks <= 1) {
+        find_partners(0, n, bonds_);
+        return;
+    }
+
+    std::vector<std::vector<Bond>> block_bonds(blocks);
+    ThreadPool pool(blocks);
+    pool.parallel_for(blocks, [&](int b) {
+        int begin = static_cast<int>(static_cast<long>(n) * b / blocks);
+        int end = static_cast<int>(static_cast<long>(n) * (b + 1) / blocks);
+        find_partners(begin, end, block_bonds[b]);
+    });
+    for (const auto& block : block_bonds) {
+        bonds_.insert(bonds_.end(), block.begin(), block.end());
     }
 }
 
 std::vector<double> Molecule::get_positions() const {
-    std::vector<double> pos(3 * atoms_.size());
-    for (size_t i = 0; i < atoms_.size(); ++i) {
-        pos[3*i + 0] = atoms_[i].position.x();
-        pos[3*i + 1] = atoms_[i].position.y();
-        pos[3*i + 2] = atoms_[i].position.z();
-    }
-    return pos;
+    const double* p = coordinates();
+    return std::vector<double>(p, p + 3 * atoms_.size());
 }
 
 void Molecule::set_positions(const std::vector<double>& positions) {
     if (positions.size() != 3 * atoms_.size()) {
         throw std::runtime_error("Position vector size mismatch");
     }
-    for (size_t i = 0; i < atoms_.size(); ++i) {
-        atoms_[i].position.x() = positions[3*i + 0];
-        atoms_[i].position.y() = positions[3*i + 1];
-        atoms_[i].position.z() = positions[3*i + 2];
-    }
+    std::copy(positions.begin(), positions.end(), coordinates());
 }
 
 std::vector<std::vector<int>> Molecule::adjacency_list() const {
@@ -0,0 +1,498 @@
+#include "chemsim/core/perception.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+
+namespace chemsim {
+
+namespace {
+
+struct Edge {
+    int to;
+    int bond;
+};
+
+using BondGraph = std::vector<std::vector<Edge>>;
+
+} // namespace
+
+static BondGraph bond_graph(const Molecule& mol) {
+    BondGraph g(mol.num_atoms());
+    for (int b = 0; b < mol.num_bonds(); ++b) {
+        const auto& bond = mol.bond(b);
+        g[bond.atom_i].push_back({bond.atom_j, b});
+        g[bond.atom_j].push_back({bond.atom_i, b});
+    }
+    return g;
+}
+
+static int bond_between(const BondGraph& g, int a, int b) {
+    for (const auto& e : g[a]) {
+        if (e.to == b) return e.bond;
+    }
+    return -1;
+}
+
+// Bonds that lie on a cycle, i.e. everything but the bridges (iterative
+// Tarjan, so long chains cannot overflow the stack)
+static std::vector<bool> cyclic_bonds(const BondGraph& g, int num_bonds) {
+    int n = static_cast<int>(g.size());
+    std::vector<int> disc(n, -1), low(n, 0);
+    std::vector<bool> cyclic(num_bonds, true);
+
+    struct Frame {
+        int atom;
+        int parent_bond;
+        size_t next;
+    };
+    std::vector<Frame> stack;
+    int time = 0;
+    for (int root = 0; root < n; ++root) {
+        if (disc[root] != -1) continue;
+        disc[root] = low[root] = time++;
+        stack.push_back({root, -1, 0});
+        while (!stack.empty()) {
+            Frame& f = stack.back();
+            if (f.next < g[f.atom].size()) {
+                Edge e = g[f.atom][f.next++];
+                if (e.bond == f.parent_bond) continue;
+                if (disc[e.to] == -1) {
+                    disc[e.to] = low[e.to] = time++;
+                    stack.push_back({e.to, e.bond, 0});
+                } else {
+                    low[f.atom] = std::min(low[f.atom], disc[e.to]);
+                }
+            } else {
+                int v = f.atom, parent_bond = f.parent_bond;
+                stack.pop_back();
+                if (stack.empty()) continue;
+                int u = stack.back().atom;
+                low[u] = std::min(low[u], low[v]);
+                if (low[v] > disc[u]) cyclic[parent_bond] = false;
+            }
+        }
+    }
+    return cyclic;
+}
+
+// Smallest independent cycles of one ring system. Candidates are Horton
+// cycles (shortest paths from a root to both ends of an edge), accepted
+// shortest first when independent over GF(2). BFS depth is limited first so
+// ordinary ring systems never pay for a search over the whole system.
+static void system_rings(const BondGraph& g, const std::vector<bool>& cyclic,
+                         const std::vector<int>& atoms, const std::vector<int>& bonds,
+                         std::vector<int>& edge_index,
+                         std::vector<std::vector<int>>& rings) {
+    int num_rings = static_cast<int>(bonds.size()) - static_cast<int>(atoms.size()) + 1;
+    if (num_rings <= 0) return;
+
+    for (size_t e = 0; e < bonds.size(); ++e) edge_index[bonds[e]] = static_cast<int>(e);
+    size_t words = (bonds.size() + 63) / 64;
+
+    std::vector<std::vector<uint64_t>> basis;
+    std::vector<int> pivots;
+    int found = 0;
+
+    int n = static_cast<int>(g.size());
+    std::vector<int> dist(n, -1), parent(n, -1), parent_bond(n, -1);
+
+    for (int limit : {4, 10, INT_MAX}) {
+        std::vector<std::vector<int>> candidates;
+        for (int root : atoms) {
+            std::vector<int> visited{root};
+            dist[root] = 0;
+            parent[root] = parent_bond[root] = -1;
+            for (size_t q = 0; q < visited.size(); ++q) {
+                int a = visited[q];
+                if (dist[a] >= limit) continue;
+                for (const auto& e : g[a]) {
+                    if (!cyclic[e.bond] || dist[e.to] != -1) continue;
+                    dist[e.to] = dist[a] + 1;
+                    parent[e.to] = a;
+                    parent_bond[e.to] = e.bond;
+                    visited.push_back(e.to);
+                }
+            }
+
+            for (int u : visited) {
+                for (const auto& e : g[u]) {
+                    int v = e.to;
+                    if (!cyclic[e.bond] || dist[v] == -1 || u > v) continue;
+                    if (parent_bond[u] == e.bond || parent_bond[v] == e.bond) continue;
+
+                    // Paths back to the root must only meet at the root
+                    std::vector<int> path_u, path_v;
+                    for (int a = u; a != -1; a = parent[a]) path_u.push_back(a);
+                    for (int a = v; a != -1; a = parent[a]) path_v.push_back(a);
+                    bool simple = true;
+                    for (size_t p = 0; p + 1 < path_v.size() && simple; ++p) {
+                        for (size_t s = 0; s + 1 < path_u.size(); ++s) {
+                            if (path_u[s] == path_v[p]) {
+                                simple = false;
+                                break;
+                            }
+                        }
+                    }
+                    if (!simple) continue;
+
+                    std::vector<int> cycle(path_u.rbegin(), path_u.rend());
+                    cycle.insert(cycle.end(), path_v.begin(), path_v.end() - 1);
+                    candidates.push_back(std::move(cycle));
+                }
+            }
+            for (int a : visited) dist[a] = -1;
+        }
+
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [](const std::vector<int>& a, const std::vector<int>& b) {
+                             return a.size() < b.size();
+                         });
+
+        for (const auto& cycle : candidates) {
+            if (found == num_rings) break;
+            std::vector<uint64_t> bits(words, 0);
+            for (size_t p = 0; p < cycle.size(); ++p) {
+                int b = bond_between(g, cycle[p], cycle[(p + 1) % cycle.size()]);
+                int e = edge_index[b];
+                bits[e / 64] ^= uint64_t(1) << (e % 64);
+            }
+            for (size_t r = 0; r < basis.size(); ++r) {
+                int p = pivots[r];
+                if (bits[p / 64] >> (p % 64) & 1) {
+                    for (size_t w = 0; w < words; ++w) bits[w] ^= basis[r][w];
+                }
+            }
+            int pivot = -1;
+            for (size_t w = 0; w < words && pivot < 0; ++w) {
+                if (bits[w]) {
+                    uint64_t word = bits[w];
+                    int bit = 0;
+                    while (!(word >> bit & 1)) ++bit;
+                    pivot = static_cast<int>(w * 64) + bit;
+                }
+            }
+            if (pivot < 0) continue;
+            basis.push_back(std::move(bits));
+            pivots.push_back(pivot);
+            rings.push_back(cycle);
+            found++;
+        }
+        if (found == num_rings) break;
+    }
+
+    for (int b : bonds) edge_index[b] = -1;
+}
+
+std::vector<std::vector<int>> find_rings(const Molecule& mol) {
+    auto g = bond_graph(mol);
+    auto cyclic = cyclic_bonds(g, mol.num_bonds());
+
+    // Ring systems: atoms connected through cyclic bonds
+    int n = mol.num_atoms();
+    std::vector<int> root(n);
+    std::iota(root.begin(), root.end(), 0);
+    auto find = [&](int a) {
+        while (root[a] != a) a = root[a] = root[root[a]];
+        return a;
+    };
+    for (int b = 0; b < mol.num_bonds(); ++b) {
+        if (!cyclic[b]) continue;
+        int ra = find(mol.bond(b).atom_i), rb = find(mol.bond(b).atom_j);
+        if (ra != rb) root[ra] = rb;
+    }
+
+    std::vector<int> system_of(n, -1);
+    std::vector<std::vector<int>> system_atoms, system_bonds;
+    for (int b = 0; b < mol.num_bonds(); ++b) {
+        if (!cyclic[b]) continue;
+        int r = find(mol.bond(b).atom_i);
+        if (system_of[r] < 0) {
+            system_of[r] = static_cast<int>(system_atoms.size());
+            system_atoms.emplace_back();
+            system_bonds.emplace_back();
+        }
+        system_bonds[system_of[r]].push_back(b);
+    }
+    for (int a = 0; a < n; ++a) {
+        int r = find(a);
+        if (system_of[r] >= 0 && !g[a].empty()) {
+            bool on_ring = false;
+            for (const auto& e : g[a]) on_ring = on_ring || cyclic[e.bond];
+            if (on_ring) system_atoms[system_of[r]].push_back(a);
+        }
+    }
+
+    std::vector<std::vector<int>> rings;
+    std::vector<int> edge_index(mol.num_bonds(), -1);
+    for (size_t s = 0; s < system_atoms.size(); ++s) {
+        system_rings(g, cyclic, system_atoms[s], system_bonds[s], edge_index, rings);
+    }
+    return rings;
+}
+
+static bool is_aromatic_order(int order) { return order == 2 || order == 4; }
+
+// Pi electrons an atom donates to an aromatic ring, or -1 if it cannot be
+// part of one
+static int pi_electrons(const Molecule& mol, const BondGraph& g,
+                        const std::vector<bool>& ring_bond, int a) {
+    const auto& atom = mol.atom(a);
+    int degree = static_cast<int>(g[a].size());
+    for (const auto& e : g[a]) {
+        if (ring_bond[e.bond] && is_aromatic_order(mol.bond(e.bond).order)) return 1;
+    }
+    for (const auto& e : g[a]) {
+        if (mol.bond(e.bond).order != 2) continue;
+        // Exocyclic double bond: a heteroatom takes the electrons (pyridone)
+        int z = mol.atom(e.to).atomic_number;
+        return (z == 7 || z == 8 || z == 16) ? 0 : -1;
+    }
+    switch (atom.atomic_number) {
+        case 5:
+            return degree == 3 ? 0 : -1;
+        case 6:
+            if (atom.formal_charge == -1) return 2;
+            if (atom.formal_charge == 1) return 0;
+            return -1;
+        case 7:
+        case 15:
+            return (degree == 3 || (degree == 2 && atom.formal_charge == -1)) ? 2 : -1;
+        case 8:
+        case 16:
+        case 34:
+            return degree == 2 ? 2 : -1;
+        default:
+            return -1;
+    }
+}
+
+void perceive_aromaticity(Molecule& mol) {
+    auto rings = find_rings(mol);
+    if (rings.empty()) return;
+    auto g = bond_graph(mol);
+
+    std::vector<std::vector<int>> ring_bonds(rings.size());
+    std::vector<bool> ring_bond(mol.num_bonds(), false);
+    std::vector<std::vector<int>> rings_of_bond(mol.num_bonds());
+    for (size_t r = 0; r < rings.size(); ++r) {
+        const auto& ring = rings[r];
+        for (size_t p = 0; p < ring.size(); ++p) {
+            int b = bond_between(g, ring[p], ring[(p + 1) % ring.size()]);
+            ring_bonds[r].push_back(b);
+            ring_bond[b] = true;
+            rings_of_bond[b].push_back(static_cast<int>(r));
+        }
+    }
+
+    std::vector<int> electrons(mol.num_atoms());
+    for (int a = 0; a < mol.num_atoms(); ++a) electrons[a] = pi_electrons(mol, g, ring_bond, a);
+
+    auto huckel = [&](const std::vector<int>& atoms) {
+        int total = 0;
+        for (int a : atoms) {
+            if (electrons[a] < 0) return false;
+            total += electrons[a];
+        }
+        return total % 4 == 2;
+    };
+
+    std::vector<bool> aromatic(rings.size());
+    for (size_t r = 0; r < rings.size(); ++r) aromatic[r] = huckel(rings[r]);
+
+    // Envelopes of two rings fused on a single bond
+    for (int b = 0; b < mol.num_bonds(); ++b) {
+        if (rings_of_bond[b].size() != 2) continue;
+        int r1 = rings_of_bond[b][0], r2 = rings_of_bond[b][1];
+        if (aromatic[r1] && aromatic[r2]) continue;
+        std::vector<int> envelope = rings[r1];
+        for (int a : rings[r2]) {
+            if (std::find(rings[r1].begin(), rings[r1].end(), a) == rings[r1].end()) {
+                envelope.push_back(a);
+            }
+        }
+        if (envelope.size() != rings[r1].size() + rings[r2].size() - 2) continue;
+        if (huckel(envelope)) aromatic[r1] = aromatic[r2] = true;
+    }
+
+    for (size_t r = 0; r < rings.size(); ++r) {
+        if (!aromatic[r]) continue;
+        for (int b : ring_bonds[r]) mol.bond(b).order = 4;
+    }
+}
+
+// Neutral valence, adjusted for hypervalent S/P and onium ions
+static int target_valence(int z, int degree) {
+    switch (z) {
+        case 6:  return 4;
+        case 7:  return degree >= 4 ? 4 : 3;
+        case 8:  return degree >= 3 ? 3 : 2;
+        case 15: return degree >= 4 ? 5 : 3;
+        case 16:
+        case 34: return degree <= 2 ? 2 : (degree == 3 ? 4 : 6);
+        default: return 0; // no multiple bonds assigned
+    }
+}
+
+void assign_bond_orders(Molecule& mol) {
+    for (const auto& bond : mol.bonds()) {
+        if (bond.order == 4) {
+            perceive_aromaticity(mol);
+            return;
+        }
+    }
+
+    int n = mol.num_atoms();
+    auto g = bond_graph(mol);
+
+    // Unsaturation: bonds each atom still needs beyond its current valence
+    std::vector<int> unsat(n, 0);
+    for (int a = 0; a < n; ++a) {
+        auto atom = mol.atom(a);
+        int degree = static_cast<int>(g[a].size());
+        int valence = 0;
+        for (const auto& e : g[a]) valence += mol.bond(e.bond).order;
+        int target = target_valence(atom.atomic_number, degree);
+        if (target > 0) unsat[a] = std::max(0, target - valence);
+
+        if (atom.formal_charge == 0) {
+            if ((atom.atomic_number == 7 && degree == 4) ||
+                (atom.atomic_number == 8 && degree == 3)) {
+                atom.formal_charge = 1;
+            } else if (atom.atomic_number == 5 && degree == 4) {
+                atom.formal_charge = -1;
+            }
+        }
+    }
+    std::vector<int> added(mol.num_bonds(), 0);
+
+    auto unsaturated_neighbors = [&](int a) {
+        int count = 0;
+        for (const auto& e : g[a]) {
+            if (unsat[e.to] > 0 && mol.bond(e.bond).order < 3) count++;
+        }
+        return count;
+    };
+
+    // Atoms with a single unsaturated neighbor have no choice
+    std::vector<int> forced;
+    auto check_forced = [&](int a) {
+        if (unsat[a] > 0 && unsaturated_neighbors(a) == 1) forced.push_back(a);
+    };
+    auto raise = [&](int b, int i, int j, int inc) {
+        mol.bond(b).order += inc;
+        added[b] += inc;
+        unsat[i] -= inc;
+        unsat[j] -= inc;
+        for (int a : {i, j}) {
+            check_forced(a);
+            for (const auto& e : g[a]) check_forced(e.to);
+        }
+    };
+    auto propagate = [&]() {
+        while (!forced.empty()) {
+            int a = forced.back();
+            forced.pop_back();
+            if (unsat[a] == 0 || unsaturated_neighbors(a) != 1) continue;
+            for (const auto& e : g[a]) {
+                if (unsat[e.to] == 0 || mol.bond(e.bond).order >= 3) continue;
+                int inc = std::min({unsat[a], unsat[e.to], 3 - mol.bond(e.bond).order});
+                raise(e.bond, a, e.to, inc);
+                break;
+            }
+        }
+    };
+
+    for (int a = 0; a < n; ++a) check_forced(a);
+    propagate();
+
+    // Conjugated systems: pair each open atom with its most constrained
+    // open neighbor, propagating the forced choices that follow
+    for (int a = 0; a < n; ++a) {
+        while (unsat[a] > 0) {
+            int best = -1, best_count = INT_MAX;
+            for (size_t k = 0; k < g[a].size(); ++k) {
+                const auto& e = g[a][k];
+                if (unsat[e.to] == 0 || mol.bond(e.bond).order >= 3) continue;
+                int count = unsaturated_neighbors(e.to);
+                if (count < best_count) {
+                    best = static_cast<int>(k);
+                    best_count = count;
+                }
+            }
+            if (best < 0) break;
+            raise(g[a][best].bond, a, g[a][best].to, 1);
+            propagate();
+        }
+    }
+
+    // Greedy pairing can strand atoms in fused systems; repair with
+    // alternating paths (flip added and unadded bonds along the path)
+    std::vector<int> visited(n, -1);
+    std::vector<int> path;
+    int stamp = 0, end = -1;
+    std::function<bool(int, int)> augment = [&](int a, int depth) -> bool {
+        if (depth > 64) return false;
+        visited[a] = stamp;
+        for (const auto& e : g[a]) {
+            int b = e.to;
+            if (visited[b] == stamp || added[e.bond] != 0 || mol.bond(e.bond).order >= 3) continue;
+            if (target_valence(mol.atom(b).atomic_number, static_cast<int>(g[b].size())) == 0) continue;
+            if (unsat[b] > 0) {
+                path.push_back(e.bond);
+                end = b;
+                return true;
+            }
+            visited[b] = stamp;
+            for (const auto& f : g[b]) {
+                if (visited[f.to] == stamp || added[f.bond] == 0) continue;
+                path.push_back(e.bond);
+                path.push_back(f.bond);
+                if (augment(f.to, depth + 1)) return true;
+                path.pop_back();
+                path.pop_back();
+            }
+        }
+        return false;
+    };
+    for (int a = 0; a < n; ++a) {
+        if (unsat[a] == 0) continue;
+        stamp++;
+        path.clear();
+        if (!augment(a, 0)) continue;
+        for (size_t p = 0; p < path.size(); ++p) {
+            int inc = p % 2 == 0 ? 1 : -1;
+            mol.bond(path[p]).order += inc;
+            added[path[p]] += inc;
+        }
+        unsat[a]--;
+        unsat[end]--;
+    }
+
+    // Leftover open atoms: nitro/N-oxide/azide style N+ partners, then anions
+    for (int a = 0; a < n; ++a) {
+        auto atom = mol.atom(a);
+        if (atom.atomic_number != 7 || atom.formal_charge != 0 || unsat[a] != 0) continue;
+        if (g[a].size() > 3) continue;
+        for (const auto& e : g[a]) {
+            int z = mol.atom(e.to).atomic_number;
+            if (z != 7 && z != 8 && z != 16) continue;
+            if (unsat[e.to] == 0 || mol.bond(e.bond).order >= 3) continue;
+            mol.bond(e.bond).order += 1;
+            unsat[e.to] -= 1;
+            atom.formal_charge = 1;
+            break;
+        }
+    }
+    for (int a = 0; a < n; ++a) {
+        auto atom = mol.atom(a);
+        if (unsat[a] == 0 || atom.formal_charge != 0) continue;
+        int z = atom.atomic_number;
+        if (z == 7 || z == 8 || z == 16 || z == 34) atom.formal_charge = -1;
+    }
+
+    perceive_aromaticity(mol);
+}
+
+} // namespace chemsim
@@ -0,0 +1,163 @@
+#include "chemsim/core/spatial_index.h"
+#include "chemsim/core/molecule.h"
+#include "chemsim/core/thread_pool.h"
+#include <limits>
+#include <stdexcept>
+
+namespace chemsim {
+
+SpatialIndex::SpatialIndex(const std::vector<Eigen::Vector3d>& points, double cell_size) {
+    build(points, cell_size);
+}
+
+SpatialIndex::SpatialIndex(const Molecule& mol, double cell_size) {
+    std::vector<Eigen::Vector3d> points(mol.num_atoms());
+    for (int i = 0; i < mol.num_atoms(); ++i) points[i] = mol.atom(i).position;
+    build(points, cell_size);
+}
+
+void SpatialIndex::build(const std::vector<Eigen::Vector3d>& points, double cell_size) {
+    if (!(cell_size > 0.0)) throw std::runtime_error("SpatialIndex: cell size must be positive");
+    cell_ = cell_size;
+    points_ = points;
+    point_cell_.resize(points_.size());
+    for (size_t i = 0; i < points_.size(); ++i) point_cell_[i] = cell_of(points_[i]);
+    bucket();
+}
+
+// Counting sort of points into the occupied cells, in order of first use
+void SpatialIndex::bucket() {
+    int n = size();
+    cells_.clear();
+    cell_map_.clear();
+    cell_map_.reserve(n);
+    std::vector<int> slot(n);
+    for (int i = 0; i < n; ++i) {
+        auto inserted = cell_map_.emplace(point_cell_[i], static_cast<int>(cells_.size()));
+        if (inserted.second) {
+            Cell cell;
+            cell.key = point_cell_[i];
+            cells_.push_back(cell);
+        }
+        slot[i] = inserted.first->second;
+        cells_[slot[i]].end++;
+    }
+    if (!cells_.empty()) lo_key_ = hi_key_ = cells_[0].key;
+    int offset = 0;
+    for (auto& cell : cells_) {
+        for (int d = 0; d < 3; ++d) {
+            lo_key_[d] = std::min(lo_key_[d], cell.key[d]);
+            hi_key_[d] = std::max(hi_key_[d], cell.key[d]);
+        }
+        cell.begin = offset;
+        offset += cell.end;
+        cell.end = cell.begin;
+    }
+
+    cell_points_.resize(n);
+    sorted_.resize(n);
+    for (int i = 0; i < n; ++i) {
+        int s = cells_[slot[i]].end++;
+        cell_points_[s] = i;
+        sorted_[s] = points_[i];
+    }
+}
+
+int SpatialIndex::update(const std::vector<Eigen::Vector3d>& points) {
+    if (points.size() != points_.size()) {
+        throw std::runtime_error("SpatialIndex: point count mismatch");
+    }
+
+    points_ = points;
+    int moved = 0;
+    for (int i = 0; i < size(); ++i) {
+        CellKey c = cell_of(points_[i]);
+        if (c != point_cell_[i]) {
+            point_cell_[i] = c;
+            moved++;
+        }
+    }
+    if (moved > 0) {
+        bucket();
+    } else {
+        for (int s = 0; s < size(); ++s) sorted_[s] = points_[cell_points_[s]];
+    }
+    return moved;
+}
+
+std::vector<int> SpatialIndex::within(const Eigen::Vector3d& center, double radius) const {
+    std::vector<int> result;
+    for_each_within(center, radius, [&](int j, double) { result.push_back(j); });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<std::pair<int, double>> SpatialIndex::nearest(const Eigen::Vector3d& center, int k) const {
+    k = std::min(k, size());
+    if (k <= 0 || !center.allFinite()) return {};
+
+    // Grow the search radius until it holds k points; anything outside it
+    // is farther than every point inside. Once the box spans every occupied
+    // cell, one unbounded pass finds every point that has a distance; any
+    // still missing are NaN and never match.
+    std::vector<std::pair<double, int>> found;
+    for (double radius = cell_;; radius *= 2.0) {
+        bool last = covers_all(center, radius);
+        if (last) radius = std::numeric_limits<double>::infinity();
+        found.clear();
+        for_each_within(center, radius, [&](int j, double d2) { found.emplace_back(d2, j); });
+        if (static_cast<int>(found.size()) >= k || last) break;
+    }
+    k = std::min(k, static_cast<int>(found.size()));
+    std::partial_sort(found.begin(), found.begin() + k, found.end());
+
+    std::vector<std::pair<int, double>> result(k);
+    for (int q = 0; q < k; ++q) result[q] = {found[q].second, std::sqrt(found[q].first)};
+    return result;
+}
+
+bool SpatialIndex::covers_all(const Eigen::Vector3d& center, double radius) const {
+    Eigen::Vector3d span = Eigen::Vector3d::Constant(radius);
+    CellKey first = cell_of(center - span);
+    CellKey last = cell_of(center + span);
+    for (int d = 0; d < 3; ++d) {
+        if (first[d] > lo_key_[d] || last[d] < hi_key_[d]) return false;
+    }
+    return true;
+}
+
+std::vector<std::pair<int, int>> SpatialIndex::pairs_within(double cutoff, int num_threads) const {
+    int n = size();
+    // Partners j > i of each point in a contiguous block, sorted by j
+    auto find_pairs = [&](int begin, int end, std::vector<std::pair<int, int>>& out) {
+        std::vector<int> partners;
+        for (int i = begin; i < end; ++i) {
+            partners.clear();
+            for_each_within(points_[i], cutoff, [&](int j, double) {
+                if (j > i) partners.push_back(j);
+            });
+            std::sort(partners.begin(), partners.end());
+            for (int j : partners) out.emplace_back(i, j);
+        }
+    };
+
+    std::vector<std::pair<int, int>> pairs;
+    int threads = num_threads <= 0 ? default_num_threads() : num_threads;
+    int blocks = std::min(threads, n / 1024 + 1);
+    if (blocks <= 1) {
+        find_pairs(0, n, pairs);
+        return pairs;
+    }
+
+    std::vector<std::vector<std::pair<int, int>>> block_pairs(blocks);
+    ThreadPool pool(blocks);
+    pool.parallel_for(blocks, [&](int b) {
+        int begin = static_cast<int>(static_cast<long>(n) * b / blocks);
+        int end = static_cast<int>(static_cast<long>(n) * (b + 1) / blocks);
+        find_pairs(begin, end, block_pairs[b]);
+    });
+    for (const auto& block : block_pairs) pairs.insert(pairs.end(), block.begin(), block.end());
+    return pairs;
+}
+
+} // namespace chemsim
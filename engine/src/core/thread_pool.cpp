@@ -0,0 +1,99 @@
+#include "chemsim/core/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace chemsim {
+
+int default_num_threads() {
+    unsigned int hw = std::thread::hardware_concurrency();
+    return hw > 0 ? static_cast<int>(hw) : 1;
+}
+
+ThreadPool::ThreadPool(int num_threads) {
+    if (num_threads <= 0) num_threads = default_num_threads();
+    workers_.reserve(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+        workers_.emplace_back([this]() { worker_loop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& w : workers_) w.join();
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+void ThreadPool::worker_loop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+            if (stop_ && tasks_.empty()) return;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallel_for(int n, const std::function<void(int)>& fn) {
+    if (n <= 0) return;
+    if (n == 1 || workers_.size() <= 1) {
+        for (int i = 0; i < n; ++i) fn(i);
+        return;
+    }
+
+    // Shared with helper tasks, which may start after the loop has finished
+    struct State {
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+        int n = 0;
+        const std::function<void(int)>* fn = nullptr;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+    state->n = n;
+    state->fn = &fn;
+
+    auto run = [state]() {
+        for (;;) {
+            int i = state->next.fetch_add(1);
+            if (i >= state->n) return;
+            try {
+                (*state->fn)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->error) state->error = std::current_exception();
+            }
+            if (state->done.fetch_add(1) + 1 == state->n) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->cv.notify_all();
+            }
+        }
+    };
+
+    int helpers = std::min(static_cast<int>(workers_.size()), n - 1);
+    for (int h = 0; h < helpers; ++h) enqueue(run);
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&]() { return state->done.load() == n; });
+    if (state->error) std::rethrow_exception(state->error);
+}
+
+} // namespace chemsim
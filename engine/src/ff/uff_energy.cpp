@@ -2,124 +2,220 @@
 #include "chemsim/ff/uff_params.h"
 #include "chemsim/ff/uff_typing.h"
 #include <cmath>
-#include <set>
 #include <algorithm>
+#include <stdexcept>
 
 namespace chemsim {
 
 static const double DEG2RAD = M_PI / 180.0;
 static const double RAD2DEG = 180.0 / M_PI;
 
-void UFFForceField::setup(const Molecule& mol) {
-    atom_types_ = assign_uff_types(mol);
+// UFF natural bond length: r_ij = r_i + r_j + r_BO - r_EN
+static double natural_bond_length(const UFFAtomType& pi, const UFFAtomType& pj, int bond_order) {
+    double order = bond_order == 4 ? 1.5 : bond_order; // aromatic
+    double r_BO = -0.1332 * (pi.r1 + pj.r1) * std::log(order);
+    double chi_diff = std::sqrt(pi.Xi) - std::sqrt(pj.Xi);
+    double r_EN = pi.r1 * pj.r1 * chi_diff * chi_diff /
+                  (pi.Xi * pi.r1 + pj.Xi * pj.r1);
+
+    return pi.r1 + pj.r1 + r_BO - r_EN;
+}
+
+static AngleTerm angle_term(int i, int j, int k, const UFFAtomType& pi,
+                            const UFFAtomType& pj, const UFFAtomType& pk) {
+    double theta0 = pj.theta0 * DEG2RAD;
+    double r_ij = pi.r1 + pj.r1; // approximate
+    double r_jk = pj.r1 + pk.r1;
+
+    // K_ijk = 664.12 * (Z_i * Z_k / r_ik^5) * r_ij * r_jk *
+    //         [3*r_ij*r_jk*(1-cos^2(theta0)) - r_ik^2*cos(theta0)]
+    double cos_theta0 = std::cos(theta0);
+    double sin_theta0 = std::sin(theta0);
+    double r_ik_sq = r_ij*r_ij + r_jk*r_jk - 2.0*r_ij*r_jk*cos_theta0;
+    double r_ik = std::sqrt(std::max(r_ik_sq, 0.01));
+    double r_ik5 = r_ik * r_ik * r_ik * r_ik * r_ik;
+
+    double K = 664.12 * pi.Z1 * pk.Z1 / r_ik5;
+    K *= r_ij * r_jk;
+    K *= 3.0 * r_ij * r_jk * (1.0 - cos_theta0 * cos_theta0) - r_ik_sq * cos_theta0;
+
+    AngleTerm t{i, j, k, std::abs(theta0 - M_PI) < 0.01, K, 0.0, 0.0, 0.0};
+    if (!t.linear) {
+        // Fourier expansion: E = K * (C0 + C1 cos(theta) + C2 cos(2 theta))
+        t.C2 = 1.0 / (4.0 * sin_theta0 * sin_theta0);
+        t.C1 = -4.0 * t.C2 * cos_theta0;
+        t.C0 = t.C2 * (2.0 * cos_theta0 * cos_theta0 + 1.0);
+    }
+    return t;
+}
+
+static TorsionTerm torsion_term(int i, int j, int k, int l,
+                                const UFFAtomType& pj, const UFFAtomType& pk) {
+    // Determine periodicity and barrier from hybridization
+    // sp3-sp3: n=3, V = sqrt(Vi*Vj)
+    // sp2-sp2: n=2, V = 5*sqrt(Uj*Uk)*(1+4.18*ln(bond_order))
+    // sp3-sp2: n=6, V = sqrt(Vi*Uj) (or 1 kcal/mol default)
+    double V = 0.0;
+    int n = 3;
+    double phi0 = M_PI; // or 0.0
+
+    // Simple heuristic based on theta0
+    bool j_sp3 = std::abs(pj.theta0 - 109.47) < 5.0;
+    bool k_sp3 = std::abs(pk.theta0 - 109.47) < 5.0;
+    bool j_sp2 = std::abs(pj.theta0 - 120.0) < 5.0 || std::abs(pj.theta0 - 111.2) < 5.0;
+    bool k_sp2 = std::abs(pk.theta0 - 120.0) < 5.0 || std::abs(pk.theta0 - 111.2) < 5.0;
+
+    if (j_sp3 && k_sp3) {
+        n = 3; phi0 = M_PI; V = std::sqrt(std::abs(pj.Vi * pk.Vi));
+    } else if (j_sp2 && k_sp2) {
+        n = 2; phi0 = M_PI; V = 5.0 * std::sqrt(std::abs(pj.Uj * pk.Uj));
+    } else if ((j_sp3 && k_sp2) || (j_sp2 && k_sp3)) {
+        n = 6; phi0 = 0.0; V = 1.0; // default barrier
+    } else {
+        // Default: small barrier
+        n = 3; phi0 = M_PI; V = 0.5;
+    }
+    return TorsionTerm{i, j, k, l, n, V, std::cos(n * phi0)};
+}
 
-    // Build angle list: for each atom j with 2+ bonds, enumerate i-j-k triples
-    angles_.clear();
+// cancel (optional) is polled between phases
+static std::shared_ptr<const UFFTermTables> build_term_tables(const Molecule& mol,
+                                                              const CancellationToken* cancel) {
+    auto check = [cancel]() { if (cancel) cancel->throw_if_cancelled(); };
+    auto tables = std::make_shared<UFFTermTables>();
+    // Terms use the orders the types came from, which differ from mol's
+    // when those were all single (e.g. after perceive_bonds())
+    std::vector<int> bond_orders;
+    tables->atom_types = assign_uff_types(mol, bond_orders);
+    check();
+
+    // Resolve each atom's parameters once
+    int num_atoms = mol.num_atoms();
+    std::vector<const UFFAtomType*> params(num_atoms);
+    for (int a = 0; a < num_atoms; ++a) params[a] = &get_uff_params(tables->atom_types[a]);
+
+    for (int b = 0; b < mol.num_bonds(); ++b) {
+        const auto& bond = mol.bond(b);
+        const auto& pi = *params[bond.atom_i];
+        const auto& pj = *params[bond.atom_j];
+        double r0 = natural_bond_length(pi, pj, bond_orders[b]);
+        // k = 664.12 * Z_i * Z_j / r0^3
+        double k = 664.12 * pi.Z1 * pj.Z1 / (r0 * r0 * r0);
+        tables->bonds.push_back({bond.atom_i, bond.atom_j, r0, k});
+    }
+
+    // Angles: for each atom j with 2+ bonds, enumerate i-j-k triples
     auto adj = mol.adjacency_list();
-    for (int j = 0; j < mol.num_atoms(); ++j) {
+    for (int j = 0; j < num_atoms; ++j) {
         const auto& neighbors = adj[j];
         for (size_t a = 0; a < neighbors.size(); ++a) {
             for (size_t b = a + 1; b < neighbors.size(); ++b) {
-                angles_.push_back({neighbors[a], j, neighbors[b]});
+                int i = neighbors[a], k = neighbors[b];
+                AngleTerm t = angle_term(i, j, k, *params[i], *params[j], *params[k]);
+                if (std::abs(t.K) >= 1e-10) tables->angles.push_back(t);
             }
         }
     }
 
-    // Build torsion list: for each bond j-k, enumerate i-j-k-l
-    torsions_.clear();
+    check();
+
+    // Torsions: for each bond j-k, enumerate i-j-k-l
     for (const auto& bond : mol.bonds()) {
         int j = bond.atom_i;
         int k = bond.atom_j;
-        const auto& nbrs_j = adj[j];
-        const auto& nbrs_k = adj[k];
-        for (int i : nbrs_j) {
+        for (int i : adj[j]) {
             if (i == k) continue;
-            for (int l : nbrs_k) {
+            for (int l : adj[k]) {
                 if (l == j || l == i) continue;
-                torsions_.push_back({i, j, k, l});
+                TorsionTerm t = torsion_term(i, j, k, l, *params[j], *params[k]);
+                if (t.V >= 1e-10) tables->torsions.push_back(t);
             }
         }
     }
 
-    // Build non-bonded pair list (1-4 and beyond)
-    // Exclude 1-2 (bonded) and 1-3 (angle) pairs
-    std::set<std::pair<int,int>> excluded;
-    for (const auto& bond : mol.bonds()) {
-        int a = std::min(bond.atom_i, bond.atom_j);
-        int b = std::max(bond.atom_i, bond.atom_j);
-        excluded.insert({a, b});
-    }
-    for (const auto& angle : angles_) {
-        int a = std::min(angle.i, angle.k);
-        int b = std::max(angle.i, angle.k);
-        excluded.insert({a, b});
+    // Non-bonded pairs (1-4 and beyond): per-atom parameters plus each
+    // atom's 1-2 (bonded) and 1-3 (angle) partners above it, which the
+    // pair loops skip
+    check();
+    tables->vdw_atoms.resize(num_atoms);
+    for (int a = 0; a < num_atoms; ++a) {
+        tables->vdw_atoms[a] = {std::sqrt(params[a]->x1), std::sqrt(params[a]->D1)};
     }
-
-    nonbonded_pairs_.clear();
-    for (int i = 0; i < mol.num_atoms(); ++i) {
-        for (int j = i + 1; j < mol.num_atoms(); ++j) {
-            if (excluded.find({i, j}) == excluded.end()) {
-                nonbonded_pairs_.push_back({i, j});
+    tables->vdw_excluded_start.assign(1, 0);
+    tables->vdw_excluded_start.reserve(num_atoms + 1);
+    std::vector<int32_t> partners;
+    for (int i = 0; i < num_atoms; ++i) {
+        partners.clear();
+        for (int n1 : adj[i]) {
+            if (n1 > i) partners.push_back(n1);
+            for (int n2 : adj[n1]) {
+                if (n2 > i) partners.push_back(n2);
             }
         }
+        std::sort(partners.begin(), partners.end());
+        partners.erase(std::unique(partners.begin(), partners.end()), partners.end());
+        tables->vdw_excluded.insert(tables->vdw_excluded.end(), partners.begin(), partners.end());
+        tables->vdw_excluded_start.push_back(static_cast<int32_t>(tables->vdw_excluded.size()));
     }
+    return tables;
 }
 
-// ============ UFF Bond Parameters ============
-
-double UFFForceField::uff_bond_length(int bond_idx, const Molecule& mol) const {
-    const auto& bond = mol.bond(bond_idx);
-    const auto& pi = get_uff_params(atom_types_[bond.atom_i]);
-    const auto& pj = get_uff_params(atom_types_[bond.atom_j]);
+void UFFForceField::setup(const Molecule& mol, bool use_cache) {
+    setup_terms(mol, use_cache, nullptr);
+}
 
-    // UFF natural bond length: r_ij = r_i + r_j + r_BO + r_EN
-    double r_BO = -0.1332 * (pi.r1 + pj.r1) * std::log(bond.order);
-    double chi_diff = std::sqrt(pi.Xi) - std::sqrt(pj.Xi);
-    double r_EN = pi.r1 * pj.r1 * chi_diff * chi_diff /
-                  (pi.Xi * pi.r1 + pj.Xi * pj.r1);
+void UFFForceField::setup(const Molecule& mol, bool use_cache, const CancellationToken& cancel) {
+    setup_terms(mol, use_cache, &cancel);
+}
 
-    return pi.r1 + pj.r1 + r_BO - r_EN;
+void UFFForceField::setup_terms(const Molecule& mol, bool use_cache,
+                                const CancellationToken* cancel) {
+    if (!use_cache) {
+        terms_ = build_term_tables(mol, cancel);
+        return;
+    }
+    auto& cache = UFFTermCache::instance();
+    if (auto cached = cache.find(mol)) {
+        terms_ = std::move(cached);
+        return;
+    }
+    terms_ = build_term_tables(mol, cancel);
+    cache.insert(mol, terms_);
 }
 
-double UFFForceField::uff_bond_force_constant(int bond_idx, const Molecule& mol) const {
-    const auto& bond = mol.bond(bond_idx);
-    const auto& pi = get_uff_params(atom_types_[bond.atom_i]);
-    const auto& pj = get_uff_params(atom_types_[bond.atom_j]);
+// ============ UFF Bond Parameters ============
 
-    double r0 = uff_bond_length(bond_idx, mol);
-    // k = 664.12 * Z_i * Z_j / r0^3
-    return 664.12 * pi.Z1 * pj.Z1 / (r0 * r0 * r0);
+double UFFForceField::uff_bond_length(int bond_idx, const Molecule& mol) const {
+    // One stretch term per bond, in bond order, built from the typing orders
+    if (bond_idx < 0 || bond_idx >= mol.num_bonds() ||
+        static_cast<size_t>(bond_idx) >= terms_->bonds.size()) {
+        throw std::runtime_error("uff_bond_length: bond index out of range");
+    }
+    return terms_->bonds[bond_idx].r0;
 }
 
 // ============ Bond Stretch ============
 
 double UFFForceField::bond_stretch_energy(const Molecule& mol) const {
     double E = 0.0;
-    for (int b = 0; b < mol.num_bonds(); ++b) {
-        const auto& bond = mol.bond(b);
-        double r = (mol.atom(bond.atom_i).position - mol.atom(bond.atom_j).position).norm();
-        double r0 = uff_bond_length(b, mol);
-        double k = uff_bond_force_constant(b, mol);
-        double dr = r - r0;
-        E += 0.5 * k * dr * dr;
+    for (const auto& t : terms_->bonds) {
+        double r = (mol.atom(t.i).position - mol.atom(t.j).position).norm();
+        double dr = r - t.r0;
+        E += 0.5 * t.k * dr * dr;
     }
     return E;
 }
 
 void UFFForceField::bond_stretch_gradient(const Molecule& mol, Eigen::VectorXd& grad) const {
-    for (int b = 0; b < mol.num_bonds(); ++b) {
-        const auto& bond = mol.bond(b);
-        int i = bond.atom_i, j = bond.atom_j;
+    for (const auto& t : terms_->bonds) {
+        int i = t.i, j = t.j;
         Eigen::Vector3d rij = mol.atom(i).position - mol.atom(j).position;
         double r = rij.norm();
         if (r < 1e-10) continue;
 
-        double r0 = uff_bond_length(b, mol);
-        double k = uff_bond_force_constant(b, mol);
-
         // dE/dr = k * (r - r0)
         // dr/dx_i = rij / r
-        Eigen::Vector3d dE = k * (r - r0) * rij / r;
+        Eigen::Vector3d dE = t.k * (r - t.r0) * rij / r;
         grad.segment<3>(3*i) += dE;
         grad.segment<3>(3*j) -= dE;
     }
@@ -129,75 +225,30 @@ void UFFForceField::bond_stretch_gradient(const Molecule& mol, Eigen::VectorXd&
 
 double UFFForceField::angle_bend_energy(const Molecule& mol) const {
     double E = 0.0;
-    for (const auto& angle : angles_) {
-        int i = angle.i, j = angle.j, k = angle.k;
-        Eigen::Vector3d rji = mol.atom(i).position - mol.atom(j).position;
-        Eigen::Vector3d rjk = mol.atom(k).position - mol.atom(j).position;
+    for (const auto& t : terms_->angles) {
+        Eigen::Vector3d rji = mol.atom(t.i).position - mol.atom(t.j).position;
+        Eigen::Vector3d rjk = mol.atom(t.k).position - mol.atom(t.j).position;
         double dji = rji.norm();
         double djk = rjk.norm();
         if (dji < 1e-10 || djk < 1e-10) continue;
 
         double cos_theta = rji.dot(rjk) / (dji * djk);
         cos_theta = std::max(-1.0, std::min(1.0, cos_theta));
-        double theta = std::acos(cos_theta);
-
-        const auto& pj = get_uff_params(atom_types_[j]);
-        double theta0 = pj.theta0 * DEG2RAD;
-
-        // UFF force constant for angle bending
-        const auto& pi = get_uff_params(atom_types_[i]);
-        const auto& pk = get_uff_params(atom_types_[k]);
-        double r_ij = pi.r1 + pj.r1; // approximate
-        double r_jk = pj.r1 + pk.r1;
-
-        double beta = 664.12 / (r_ij * r_jk);
-        double Z_i = pi.Z1, Z_k = pk.Z1;
-        double K = beta * Z_i * Z_k / (r_ij * r_jk * r_ij * r_jk * r_jk);
-        // Simplified: K = 664.12 * Z_i * Z_k / (r_ij * r_jk)^3 * r_ij * r_jk
-        K = 664.12 / (r_ij * r_jk) * Z_i * Z_k / (r_ij * r_jk * r_ij * r_jk * r_jk);
-
-        // More standard UFF angle force constant:
-        // K_ijk = beta * (Z_i * Z_k / r_ik^5) * r_ij * r_jk *
-        //         [3*r_ij*r_jk*(1-cos^2(theta0)) - r_ik^2*cos(theta0)]
-        // But for simplicity, use the harmonic approximation that works well:
-        double r_ik_sq = r_ij*r_ij + r_jk*r_jk - 2.0*r_ij*r_jk*std::cos(theta0);
-        double r_ik = std::sqrt(std::max(r_ik_sq, 0.01));
-        double r_ik5 = r_ik * r_ik * r_ik * r_ik * r_ik;
 
-        K = 664.12 * Z_i * Z_k / r_ik5;
-        K *= r_ij * r_jk;
-        double cos_theta0 = std::cos(theta0);
-        K *= 3.0 * r_ij * r_jk * (1.0 - cos_theta0 * cos_theta0) - r_ik_sq * cos_theta0;
-
-        if (std::abs(K) < 1e-10) continue;
-
-        // Use Fourier expansion based on coordination
-        double sin_theta0 = std::sin(theta0);
-
-        if (std::abs(theta0 - M_PI) < 0.01) {
+        if (t.linear) {
             // Linear: E = K * (1 + cos(theta))
-            E += K * (1.0 + cos_theta);
-        } else if (std::abs(theta0 - 2.0*M_PI/3.0) < 0.01) {
-            // Trigonal planar (120 deg): E = K/4.5 * (1 - cos(3*theta)) -- actually no
-            // General small-angle Fourier:
-            double C2 = 1.0 / (4.0 * sin_theta0 * sin_theta0);
-            double C1 = -4.0 * C2 * cos_theta0;
-            double C0 = C2 * (2.0 * cos_theta0 * cos_theta0 + 1.0);
-            E += K * (C0 + C1 * cos_theta + C2 * std::cos(2.0 * theta));
+            E += t.K * (1.0 + cos_theta);
         } else {
-            // General: Fourier expansion
-            double C2 = 1.0 / (4.0 * sin_theta0 * sin_theta0);
-            double C1 = -4.0 * C2 * cos_theta0;
-            double C0 = C2 * (2.0 * cos_theta0 * cos_theta0 + 1.0);
-            E += K * (C0 + C1 * cos_theta + C2 * std::cos(2.0 * theta));
+            double theta = std::acos(cos_theta);
+            E += t.K * (t.C0 + t.C1 * cos_theta + t.C2 * std::cos(2.0 * theta));
         }
     }
     return E;
 }
 
 void UFFForceField::angle_bend_gradient(const Molecule& mol, Eigen::VectorXd& grad) const {
-    for (const auto& angle : angles_) {
-        int i = angle.i, j = angle.j, k = angle.k;
+    for (const auto& t : terms_->angles) {
+        int i = t.i, j = t.j, k = t.k;
         Eigen::Vector3d rji = mol.atom(i).position - mol.atom(j).position;
         Eigen::Vector3d rjk = mol.atom(k).position - mol.atom(j).position;
         double dji = rji.norm();
@@ -210,33 +261,12 @@ void UFFForceField::angle_bend_gradient(const Molecule& mol, Eigen::VectorXd& gr
         double sin_theta = std::sin(theta);
         if (std::abs(sin_theta) < 1e-10) sin_theta = 1e-10;
 
-        const auto& pj = get_uff_params(atom_types_[j]);
-        const auto& pi = get_uff_params(atom_types_[i]);
-        const auto& pk = get_uff_params(atom_types_[k]);
-        double theta0 = pj.theta0 * DEG2RAD;
-        double cos_theta0 = std::cos(theta0);
-        double sin_theta0 = std::sin(theta0);
-
-        double r_ij = pi.r1 + pj.r1;
-        double r_jk = pj.r1 + pk.r1;
-        double r_ik_sq = r_ij*r_ij + r_jk*r_jk - 2.0*r_ij*r_jk*cos_theta0;
-        double r_ik = std::sqrt(std::max(r_ik_sq, 0.01));
-        double r_ik5 = r_ik*r_ik*r_ik*r_ik*r_ik;
-
-        double K = 664.12 * pi.Z1 * pk.Z1 / r_ik5;
-        K *= r_ij * r_jk;
-        K *= 3.0 * r_ij * r_jk * (1.0 - cos_theta0*cos_theta0) - r_ik_sq * cos_theta0;
-
-        if (std::abs(K) < 1e-10) continue;
-
         // dE/dtheta
         double dE_dtheta;
-        if (std::abs(theta0 - M_PI) < 0.01) {
-            dE_dtheta = -K * sin_theta;
+        if (t.linear) {
+            dE_dtheta = -t.K * sin_theta;
         } else {
-            double C2 = 1.0 / (4.0 * sin_theta0 * sin_theta0);
-            double C1 = -4.0 * C2 * cos_theta0;
-            dE_dtheta = K * (-C1 * sin_theta - 2.0 * C2 * std::sin(2.0 * theta));
+            dE_dtheta = t.K * (-t.C1 * sin_theta - 2.0 * t.C2 * std::sin(2.0 * theta));
         }
 
         // dtheta/d(positions) - standard angle gradient
@@ -282,187 +312,221 @@ static double compute_dihedral(const Eigen::Vector3d& p1, const Eigen::Vector3d&
     return phi;
 }
 
+// Cartesian derivatives of the dihedral angle p1-p2-p3-p4 (Bekker).
+// Returns false for degenerate (collinear) geometries.
+static bool dihedral_derivatives(const Eigen::Vector3d& p1, const Eigen::Vector3d& p2,
+                                 const Eigen::Vector3d& p3, const Eigen::Vector3d& p4,
+                                 Eigen::Vector3d& d1, Eigen::Vector3d& d2,
+                                 Eigen::Vector3d& d3, Eigen::Vector3d& d4) {
+    Eigen::Vector3d b1 = p2 - p1;
+    Eigen::Vector3d b2 = p3 - p2;
+    Eigen::Vector3d b3 = p4 - p3;
+
+    Eigen::Vector3d n1 = b1.cross(b2);
+    Eigen::Vector3d n2 = b2.cross(b3);
+    double n1_sq = n1.squaredNorm();
+    double n2_sq = n2.squaredNorm();
+    if (n1_sq < 1e-20 || n2_sq < 1e-20) return false;
+
+    double b2_norm = b2.norm();
+    if (b2_norm < 1e-10) return false;
+
+    // dphi/dr_i = -(b2_norm / n1_sq) * n1
+    // dphi/dr_l = (b2_norm / n2_sq) * n2
+    d1 = -(b2_norm / n1_sq) * n1;
+    d4 = (b2_norm / n2_sq) * n2;
+
+    double dot_b1_b2 = b1.dot(b2) / (b2_norm * b2_norm);
+    double dot_b3_b2 = b3.dot(b2) / (b2_norm * b2_norm);
+
+    d2 = -(1.0 + dot_b1_b2) * d1 + dot_b3_b2 * d4;
+    d3 = -(1.0 + dot_b3_b2) * d4 + dot_b1_b2 * d1;
+    return true;
+}
+
 double UFFForceField::torsion_energy(const Molecule& mol) const {
     double E = 0.0;
-    for (const auto& tor : torsions_) {
-        double phi = compute_dihedral(mol.atom(tor.i).position, mol.atom(tor.j).position,
-                                      mol.atom(tor.k).position, mol.atom(tor.l).position);
-
-        const auto& pj = get_uff_params(atom_types_[tor.j]);
-        const auto& pk = get_uff_params(atom_types_[tor.k]);
-
-        // Determine periodicity and barrier from hybridization
-        // sp3-sp3: n=3, V = sqrt(Vi*Vj)
-        // sp2-sp2: n=2, V = 5*sqrt(Uj*Uk)*(1+4.18*ln(bond_order))
-        // sp3-sp2: n=6, V = sqrt(Vi*Uj) (or 1 kcal/mol default)
-        double V = 0.0;
-        int n = 3;
-        double phi0 = M_PI; // or 0.0
-
-        // Simple heuristic based on theta0
-        bool j_sp3 = std::abs(pj.theta0 - 109.47) < 5.0;
-        bool k_sp3 = std::abs(pk.theta0 - 109.47) < 5.0;
-        bool j_sp2 = std::abs(pj.theta0 - 120.0) < 5.0 || std::abs(pj.theta0 - 111.2) < 5.0;
-        bool k_sp2 = std::abs(pk.theta0 - 120.0) < 5.0 || std::abs(pk.theta0 - 111.2) < 5.0;
-
-        if (j_sp3 && k_sp3) {
-            n = 3;
-            phi0 = M_PI;
-            V = std::sqrt(std::abs(pj.Vi * pk.Vi));
-        } else if (j_sp2 && k_sp2) {
-            n = 2;
-            phi0 = M_PI;
-            V = 5.0 * std::sqrt(std::abs(pj.Uj * pk.Uj));
-        } else if ((j_sp3 && k_sp2) || (j_sp2 && k_sp3)) {
-            n = 6;
-            phi0 = 0.0;
-            V = 1.0; // default barrier
-        } else {
-            // Default: small barrier
-            n = 3;
-            phi0 = M_PI;
-            V = 0.5;
-        }
-
-        if (V < 1e-10) continue;
+    for (const auto& t : terms_->torsions) {
+        double phi = compute_dihedral(mol.atom(t.i).position, mol.atom(t.j).position,
+                                      mol.atom(t.k).position, mol.atom(t.l).position);
 
         // E = 0.5 * V * (1 - cos(n*phi0)*cos(n*phi))
-        E += 0.5 * V * (1.0 - std::cos(n * phi0) * std::cos(n * phi));
+        E += 0.5 * t.V * (1.0 - t.cos_n_phi0 * std::cos(t.n * phi));
     }
     return E;
 }
 
 void UFFForceField::torsion_gradient(const Molecule& mol, Eigen::VectorXd& grad) const {
-    for (const auto& tor : torsions_) {
-        const auto& p1 = mol.atom(tor.i).position;
-        const auto& p2 = mol.atom(tor.j).position;
-        const auto& p3 = mol.atom(tor.k).position;
-        const auto& p4 = mol.atom(tor.l).position;
-
-        Eigen::Vector3d b1 = p2 - p1;
-        Eigen::Vector3d b2 = p3 - p2;
-        Eigen::Vector3d b3 = p4 - p3;
+    for (const auto& t : terms_->torsions) {
+        const auto& p1 = mol.atom(t.i).position;
+        const auto& p2 = mol.atom(t.j).position;
+        const auto& p3 = mol.atom(t.k).position;
+        const auto& p4 = mol.atom(t.l).position;
 
-        Eigen::Vector3d n1 = b1.cross(b2);
-        Eigen::Vector3d n2 = b2.cross(b3);
-        double n1_sq = n1.squaredNorm();
-        double n2_sq = n2.squaredNorm();
-        if (n1_sq < 1e-20 || n2_sq < 1e-20) continue;
-
-        double b2_norm = b2.norm();
-        if (b2_norm < 1e-10) continue;
+        Eigen::Vector3d dphi_dp1, dphi_dp2, dphi_dp3, dphi_dp4;
+        if (!dihedral_derivatives(p1, p2, p3, p4, dphi_dp1, dphi_dp2, dphi_dp3, dphi_dp4)) continue;
 
         double phi = compute_dihedral(p1, p2, p3, p4);
 
-        const auto& pj = get_uff_params(atom_types_[tor.j]);
-        const auto& pk = get_uff_params(atom_types_[tor.k]);
-
-        double V = 0.0;
-        int n = 3;
-        double phi0 = M_PI;
-
-        bool j_sp3 = std::abs(pj.theta0 - 109.47) < 5.0;
-        bool k_sp3 = std::abs(pk.theta0 - 109.47) < 5.0;
-        bool j_sp2 = std::abs(pj.theta0 - 120.0) < 5.0 || std::abs(pj.theta0 - 111.2) < 5.0;
-        bool k_sp2 = std::abs(pk.theta0 - 120.0) < 5.0 || std::abs(pk.theta0 - 111.2) < 5.0;
-
-        if (j_sp3 && k_sp3) {
-            n = 3; phi0 = M_PI; V = std::sqrt(std::abs(pj.Vi * pk.Vi));
-        } else if (j_sp2 && k_sp2) {
-            n = 2; phi0 = M_PI; V = 5.0 * std::sqrt(std::abs(pj.Uj * pk.Uj));
-        } else if ((j_sp3 && k_sp2) || (j_sp2 && k_sp3)) {
-            n = 6; phi0 = 0.0; V = 1.0;
-        } else {
-            n = 3; phi0 = M_PI; V = 0.5;
-        }
-
-        if (V < 1e-10) continue;
-
         // dE/dphi = 0.5 * V * n * cos(n*phi0) * sin(n*phi)
-        double dE_dphi = 0.5 * V * n * std::cos(n * phi0) * std::sin(n * phi);
+        double dE_dphi = 0.5 * t.V * t.n * t.cos_n_phi0 * std::sin(t.n * phi);
 
-        // Torsion gradient using standard formulation
-        // dphi/dr_i = -(b2_norm / n1_sq) * n1
-        // dphi/dr_l = (b2_norm / n2_sq) * n2
-        Eigen::Vector3d dphi_dp1 = -(b2_norm / n1_sq) * n1;
-        Eigen::Vector3d dphi_dp4 = (b2_norm / n2_sq) * n2;
-
-        double dot_b1_b2 = b1.dot(b2) / (b2_norm * b2_norm);
-        double dot_b3_b2 = b3.dot(b2) / (b2_norm * b2_norm);
-
-        Eigen::Vector3d dphi_dp2 = (dot_b1_b2 - 1.0) * dphi_dp1 - dot_b3_b2 * dphi_dp4;
-        Eigen::Vector3d dphi_dp3 = (dot_b3_b2 - 1.0) * dphi_dp4 - dot_b1_b2 * dphi_dp1;
-
-        grad.segment<3>(3*tor.i) += dE_dphi * dphi_dp1;
-        grad.segment<3>(3*tor.j) += dE_dphi * dphi_dp2;
-        grad.segment<3>(3*tor.k) += dE_dphi * dphi_dp3;
-        grad.segment<3>(3*tor.l) += dE_dphi * dphi_dp4;
+        grad.segment<3>(3*t.i) += dE_dphi * dphi_dp1;
+        grad.segment<3>(3*t.j) += dE_dphi * dphi_dp2;
+        grad.segment<3>(3*t.k) += dE_dphi * dphi_dp3;
+        grad.segment<3>(3*t.l) += dE_dphi * dphi_dp4;
     }
 }
 
 // ============ Van der Waals ============
 
+// Call fn(i, j) for every non-bonded pair i < j, skipping the exclusions
+template <typename F>
+static void for_each_vdw_pair(const UFFTermTables& t, F&& fn) {
+    int n = static_cast<int>(t.vdw_atoms.size());
+    for (int i = 0; i < n; ++i) {
+        const int32_t* skip = t.vdw_excluded.data() + t.vdw_excluded_start[i];
+        const int32_t* skip_end = t.vdw_excluded.data() + t.vdw_excluded_start[i + 1];
+        for (int j = i + 1; j < n; ++j) {
+            if (skip != skip_end && *skip == j) {
+                ++skip;
+                continue;
+            }
+            fn(i, j);
+        }
+    }
+}
+
 double UFFForceField::vdw_energy(const Molecule& mol) const {
     double E = 0.0;
-    for (const auto& [i, j] : nonbonded_pairs_) {
-        const auto& pi = get_uff_params(atom_types_[i]);
-        const auto& pj = get_uff_params(atom_types_[j]);
-
-        double x_ij = std::sqrt(pi.x1 * pj.x1); // geometric mean
-        double D_ij = std::sqrt(pi.D1 * pj.D1);
-
+    const auto& atoms = terms_->vdw_atoms;
+    for_each_vdw_pair(*terms_, [&](int i, int j) {
         double r = (mol.atom(i).position - mol.atom(j).position).norm();
-        if (r < 1e-10) continue;
+        if (r < 1e-10) return;
 
-        double x = x_ij / r;
+        double x = atoms[i].sqrt_x * atoms[j].sqrt_x / r;
         double x6 = x * x * x * x * x * x;
         double x12 = x6 * x6;
 
-        E += D_ij * (x12 - 2.0 * x6);
-    }
+        E += atoms[i].sqrt_D * atoms[j].sqrt_D * (x12 - 2.0 * x6);
+    });
     return E;
 }
 
 void UFFForceField::vdw_gradient(const Molecule& mol, Eigen::VectorXd& grad) const {
-    for (const auto& [i, j] : nonbonded_pairs_) {
-        const auto& pi = get_uff_params(atom_types_[i]);
-        const auto& pj = get_uff_params(atom_types_[j]);
-
-        double x_ij = std::sqrt(pi.x1 * pj.x1);
-        double D_ij = std::sqrt(pi.D1 * pj.D1);
-
+    const auto& atoms = terms_->vdw_atoms;
+    for_each_vdw_pair(*terms_, [&](int i, int j) {
         Eigen::Vector3d rij = mol.atom(i).position - mol.atom(j).position;
         double r = rij.norm();
-        if (r < 1e-10) continue;
+        if (r < 1e-10) return;
 
-        double x = x_ij / r;
+        double x = atoms[i].sqrt_x * atoms[j].sqrt_x / r;
         double x6 = x * x * x * x * x * x;
         double x12 = x6 * x6;
 
         // dE/dr = D_ij * (-12*x12/r + 12*x6/r)
-        double dE_dr = D_ij * 12.0 * (-x12 + x6) / r;
+        double dE_dr = atoms[i].sqrt_D * atoms[j].sqrt_D * 12.0 * (-x12 + x6) / r;
 
         Eigen::Vector3d dE = dE_dr * rij / r;
         grad.segment<3>(3*i) += dE;
         grad.segment<3>(3*j) -= dE;
+    });
+}
+
+// ============ Restraints ============
+
+void UFFForceField::add_dihedral_restraint(int i, int j, int k, int l,
+                                           double target_degrees, double force_constant) {
+    dihedral_restraints_.push_back({i, j, k, l, target_degrees * DEG2RAD, force_constant});
+}
+
+// Wrap an angle difference into [-pi, pi)
+static double wrap_angle(double d) {
+    return d - 2.0 * M_PI * std::floor((d + M_PI) / (2.0 * M_PI));
+}
+
+double UFFForceField::restraint_energy(const Molecule& mol) const {
+    double E = 0.0;
+    for (const auto& r : dihedral_restraints_) {
+        double phi = compute_dihedral(mol.atom(r.i).position, mol.atom(r.j).position,
+                                      mol.atom(r.k).position, mol.atom(r.l).position);
+        double d = wrap_angle(phi - r.target);
+        E += 0.5 * r.force_constant * d * d;
+    }
+    return E;
+}
+
+void UFFForceField::restraint_gradient(const Molecule& mol, Eigen::VectorXd& grad) const {
+    for (const auto& r : dihedral_restraints_) {
+        const auto& p1 = mol.atom(r.i).position;
+        const auto& p2 = mol.atom(r.j).position;
+        const auto& p3 = mol.atom(r.k).position;
+        const auto& p4 = mol.atom(r.l).position;
+
+        Eigen::Vector3d dphi_dp1, dphi_dp2, dphi_dp3, dphi_dp4;
+        if (!dihedral_derivatives(p1, p2, p3, p4, dphi_dp1, dphi_dp2, dphi_dp3, dphi_dp4)) continue;
+
+        double phi = compute_dihedral(p1, p2, p3, p4);
+        double dE_dphi = r.force_constant * wrap_angle(phi - r.target);
+
+        grad.segment<3>(3*r.i) += dE_dphi * dphi_dp1;
+        grad.segment<3>(3*r.j) += dE_dphi * dphi_dp2;
+        grad.segment<3>(3*r.k) += dE_dphi * dphi_dp3;
+        grad.segment<3>(3*r.l) += dE_dphi * dphi_dp4;
     }
 }
 
 // ============ Public Interface ============
 
 double UFFForceField::calculate_energy(const Molecule& mol) const {
-    return bond_stretch_energy(mol) + angle_bend_energy(mol) +
-           torsion_energy(mol) + vdw_energy(mol);
+    double E = bond_stretch_energy(mol) + angle_bend_energy(mol) +
+               torsion_energy(mol) + vdw_energy(mol);
+    if (!dihedral_restraints_.empty()) E += restraint_energy(mol);
+    return E;
 }
 
 Eigen::VectorXd UFFForceField::calculate_gradient(const Molecule& mol) const {
+    Eigen::VectorXd grad;
+    calculate_gradient(mol, grad);
+    return grad;
+}
+
+void UFFForceField::calculate_gradient(const Molecule& mol, Eigen::VectorXd& grad) const {
     int n = mol.num_atoms() * 3;
-    Eigen::VectorXd grad = Eigen::VectorXd::Zero(n);
+    if (grad.size() != n) grad.resize(n);
+    grad.setZero();
     bond_stretch_gradient(mol, grad);
     angle_bend_gradient(mol, grad);
     torsion_gradient(mol, grad);
     vdw_gradient(mol, grad);
-    return grad;
+    if (!dihedral_restraints_.empty()) restraint_gradient(mol, grad);
+}
+
+Eigen::VectorXd UFFForceField::hessian_vector_product(const Molecule& mol,
+                                                      const Eigen::VectorXd& v) const {
+    int n = mol.num_atoms() * 3;
+    if (v.size() != n) {
+        throw std::runtime_error("Hessian-vector product: vector size mismatch");
+    }
+    double v_norm = v.norm();
+    if (v_norm < 1e-300) return Eigen::VectorXd::Zero(n);
+
+    // Fixed 1e-4 Angstrom displacement along the unit direction, so the
+    // truncation error does not depend on the scale of v
+    double h = 1e-4 / v_norm;
+    Molecule displaced = mol;
+
+    for (int a = 0; a < mol.num_atoms(); ++a) {
+        displaced.atom(a).position = mol.atom(a).position + h * v.segment<3>(3*a);
+    }
+    Eigen::VectorXd g_plus = calculate_gradient(displaced);
+
+    for (int a = 0; a < mol.num_atoms(); ++a) {
+        displaced.atom(a).position = mol.atom(a).position - h * v.segment<3>(3*a);
+    }
+    Eigen::VectorXd g_minus = calculate_gradient(displaced);
+
+    return (g_plus - g_minus) / (2.0 * h);
 }
 
 EnergyComponents UFFForceField::calculate_energy_components(const Molecule& mol) const {
@@ -471,7 +535,8 @@ EnergyComponents UFFForceField::calculate_energy_components(const Molecule& mol)
     ec.angle_bend = angle_bend_energy(mol);
     ec.torsion = torsion_energy(mol);
     ec.vdw = vdw_energy(mol);
-    ec.total = ec.bond_stretch + ec.angle_bend + ec.torsion + ec.vdw;
+    ec.restraint = restraint_energy(mol);
+    ec.total = ec.bond_stretch + ec.angle_bend + ec.torsion + ec.vdw + ec.restraint;
     return ec;
 }
 
@@ -0,0 +1,149 @@
+#include "chemsim/ff/uff_terms.h"
+#include <algorithm>
+#include <tuple>
+
+namespace chemsim {
+
+template <typename T>
+static size_t vector_bytes(const std::vector<T>& v) {
+    return v.capacity() * sizeof(T);
+}
+
+size_t UFFTermTables::num_vdw_pairs() const {
+    size_t n = vdw_atoms.size();
+    return n < 2 ? 0 : n * (n - 1) / 2 - vdw_excluded.size();
+}
+
+size_t UFFTermTables::memory_bytes() const {
+    size_t bytes = sizeof(UFFTermTables);
+    bytes += vector_bytes(atom_types);
+    for (const auto& t : atom_types) bytes += t.capacity();
+    return bytes + vector_bytes(bonds) + vector_bytes(angles) +
+           vector_bytes(torsions) + vector_bytes(vdw_atoms) +
+           vector_bytes(vdw_excluded_start) + vector_bytes(vdw_excluded);
+}
+
+std::vector<int32_t> topology_signature(const Molecule& mol) {
+    std::vector<std::tuple<int32_t, int32_t, int32_t>> bonds;
+    bonds.reserve(mol.num_bonds());
+    for (const auto& b : mol.bonds()) {
+        bonds.emplace_back(std::min(b.atom_i, b.atom_j), std::max(b.atom_i, b.atom_j), b.order);
+    }
+    std::sort(bonds.begin(), bonds.end());
+
+    std::vector<int32_t> sig;
+    sig.reserve(2 + 2 * mol.num_atoms() + 3 * bonds.size());
+    sig.push_back(mol.num_atoms());
+    for (const auto& atom : mol.atoms()) sig.push_back(atom.atomic_number);
+    for (const auto& atom : mol.atoms()) sig.push_back(atom.formal_charge);
+    sig.push_back(static_cast<int32_t>(bonds.size()));
+    for (const auto& [i, j, order] : bonds) {
+        sig.push_back(i);
+        sig.push_back(j);
+        sig.push_back(order);
+    }
+    return sig;
+}
+
+static uint64_t hash_signature(const std::vector<int32_t>& sig) {
+    // FNV-1a over the words, finished with a splitmix64 avalanche
+    uint64_t h = 14695981039346656037ull;
+    for (int32_t w : sig) {
+        h ^= static_cast<uint32_t>(w);
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    return h ^ (h >> 31);
+}
+
+uint64_t topology_hash(const Molecule& mol) {
+    return hash_signature(topology_signature(mol));
+}
+
+UFFTermCache& UFFTermCache::instance() {
+    static UFFTermCache cache;
+    return cache;
+}
+
+std::shared_ptr<const UFFTermTables> UFFTermCache::find(const Molecule& mol) {
+    auto sig = topology_signature(mol);
+    uint64_t key = hash_signature(sig);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto range = index_.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second->signature != sig) continue;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        hits_++;
+        return it->second->tables;
+    }
+    misses_++;
+    return nullptr;
+}
+
+void UFFTermCache::insert(const Molecule& mol, std::shared_ptr<const UFFTermTables> tables) {
+    auto sig = topology_signature(mol);
+    uint64_t key = hash_signature(sig);
+    size_t bytes = tables->memory_bytes() + sig.capacity() * sizeof(int32_t);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (bytes > budget_bytes_) return;
+
+    // Another thread may have built the same topology concurrently
+    auto range = index_.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second->signature == sig) return;
+    }
+
+    evict_to(budget_bytes_ - bytes);
+    lru_.push_front(Entry{key, std::move(sig), std::move(tables), bytes});
+    index_.emplace(key, lru_.begin());
+    memory_bytes_ += bytes;
+}
+
+void UFFTermCache::evict_to(size_t bytes) {
+    while (memory_bytes_ > bytes && !lru_.empty()) {
+        auto last = std::prev(lru_.end());
+        auto range = index_.equal_range(last->key);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == last) {
+                index_.erase(it);
+                break;
+            }
+        }
+        memory_bytes_ -= last->bytes;
+        lru_.erase(last);
+        evictions_++;
+    }
+}
+
+void UFFTermCache::set_budget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_bytes_ = bytes;
+    evict_to(bytes);
+}
+
+void UFFTermCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    index_.clear();
+    memory_bytes_ = 0;
+    hits_ = misses_ = evictions_ = 0;
+}
+
+TermCacheStats UFFTermCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TermCacheStats s;
+    s.hits = hits_;
+    s.misses = misses_;
+    s.evictions = evictions_;
+    s.entries = lru_.size();
+    s.memory_bytes = memory_bytes_;
+    s.budget_bytes = budget_bytes_;
+    return s;
+}
+
+} // namespace chemsim
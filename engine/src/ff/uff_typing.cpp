@@ -1,15 +1,56 @@
 #include "chemsim/ff/uff_typing.h"
 #include "chemsim/ff/uff_params.h"
+#include "chemsim/core/perception.h"
 #include <stdexcept>
 
 namespace chemsim {
 
 std::vector<std::string> assign_uff_types(const Molecule& mol) {
-    std::vector<std::string> types(mol.num_atoms());
+    std::vector<int> bond_orders;
+    return assign_uff_types(mol, bond_orders);
+}
+
+std::vector<std::string> assign_uff_types(const Molecule& mol, std::vector<int>& bond_orders) {
+    // Connectivity-only molecules (every bond single) get bond orders and
+    // aromaticity on a copy, so hybridization comes from real bond orders
+    const Molecule* src = &mol;
+    Molecule perceived;
+    bool all_single = true;
+    for (const auto& bond : mol.bonds()) all_single = all_single && bond.order == 1;
+    if (all_single && mol.num_bonds() > 0) {
+        perceived = mol;
+        assign_bond_orders(perceived);
+        src = &perceived;
+    }
+    bond_orders.resize(src->num_bonds());
+    for (int b = 0; b < src->num_bonds(); ++b) bond_orders[b] = src->bond(b).order;
 
-    for (int i = 0; i < mol.num_atoms(); ++i) {
-        const auto& atom = mol.atom(i);
-        int deg = mol.degree(i);
+    // Per-atom bond summary in one pass over the bonds
+    int n = src->num_atoms();
+    std::vector<int> degree(n, 0), doubles(n, 0), valence(n, 0);
+    std::vector<bool> triple(n, false), aromatic(n, false), unsaturated(n, false);
+    for (const auto& bond : src->bonds()) {
+        for (int a : {bond.atom_i, bond.atom_j}) {
+            degree[a]++;
+            valence[a] += bond.order == 4 ? 1 : bond.order;
+            if (bond.order == 2) doubles[a]++;
+            if (bond.order == 3) triple[a] = true;
+            if (bond.order == 4) aromatic[a] = true;
+            if (bond.order > 1) unsaturated[a] = true;
+        }
+    }
+    // Conjugated: bonded to an atom carrying a multiple or aromatic bond
+    std::vector<bool> conjugated(n, false);
+    for (const auto& bond : src->bonds()) {
+        if (unsaturated[bond.atom_j]) conjugated[bond.atom_i] = true;
+        if (unsaturated[bond.atom_i]) conjugated[bond.atom_j] = true;
+    }
+
+    std::vector<std::string> types(n);
+
+    for (int i = 0; i < n; ++i) {
+        const auto& atom = src->atom(i);
+        int deg = degree[i];
         std::string type;
 
         switch (atom.atomic_number) {
@@ -30,54 +71,25 @@ std::vector<std::string> assign_uff_types(const Molecule& mol) {
                 else type = "B_3";
                 break;
             case 6:  // C
-                if (deg <= 1) type = "C_1";
-                else if (deg == 2) type = "C_2";
-                else if (deg == 3) {
-                    // Check for aromatic: simple heuristic - if bonded to
-                    // atoms that also have degree 3 (aromatic ring-like)
-                    bool aromatic = false;
-                    auto neighbors = mol.bonded_to(i);
-                    for (int n : neighbors) {
-                        if (mol.atom(n).atomic_number == 6 && mol.degree(n) == 3) {
-                            aromatic = true;
-                            break;
-                        }
-                    }
-                    type = aromatic ? "C_R" : "C_2";
-                }
+                if (aromatic[i]) type = "C_R";
+                else if (deg <= 1 || triple[i] || doubles[i] >= 2) type = "C_1";
+                else if (deg <= 3) type = "C_2";
                 else type = "C_3"; // deg >= 4
                 break;
             case 7:  // N
-                if (deg <= 1) type = "N_1";
+                if (aromatic[i]) type = "N_R";
+                else if (deg <= 1 || triple[i] || doubles[i] >= 2) type = "N_1";
                 else if (deg == 2) type = "N_2";
                 else if (deg == 3) {
-                    // Check if in aromatic ring
-                    bool aromatic = false;
-                    auto neighbors = mol.bonded_to(i);
-                    for (int n : neighbors) {
-                        if (mol.atom(n).atomic_number == 6 && mol.degree(n) == 3) {
-                            aromatic = true;
-                            break;
-                        }
-                    }
-                    type = aromatic ? "N_R" : "N_3";
+                    // Planar when conjugated (amide, aniline, nitro)
+                    type = (doubles[i] > 0 || conjugated[i]) ? "N_R" : "N_3";
                 }
                 else type = "N_3";
                 break;
             case 8:  // O
-                if (deg <= 1) type = "O_2";
-                else if (deg == 2) {
-                    // Check if in aromatic ring
-                    bool aromatic = false;
-                    auto neighbors = mol.bonded_to(i);
-                    for (int n : neighbors) {
-                        if (mol.atom(n).atomic_number == 6 && mol.degree(n) == 3) {
-                            aromatic = true;
-                            break;
-                        }
-                    }
-                    type = aromatic ? "O_R" : "O_3";
-                }
+                if (aromatic[i]) type = "O_R";
+                else if (triple[i]) type = "O_1";
+                else if (deg <= 1 || doubles[i] > 0) type = "O_2";
                 else type = "O_3";
                 break;
             case 9:  // F
@@ -99,12 +111,14 @@ std::vector<std::string> assign_uff_types(const Molecule& mol) {
                 type = "Si3";
                 break;
             case 15: // P
-                if (deg <= 3) type = "P_3+3";
+                if (valence[i] <= 3) type = "P_3+3";
                 else type = "P_3+5";
                 break;
             case 16: // S
-                if (deg <= 2) type = "S_3+2";
-                else if (deg <= 4) type = "S_3+4";
+                if (aromatic[i]) type = "S_R";
+                else if (deg == 1 && doubles[i] > 0) type = "S_2";
+                else if (valence[i] <= 2) type = "S_3+2";
+                else if (valence[i] <= 4) type = "S_3+4";
                 else type = "S_3+6";
                 break;
             case 17: // Cl
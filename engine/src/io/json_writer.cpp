@@ -0,0 +1,95 @@
+#include "chemsim/io/json_writer.h"
+#include "chemsim/io/text_writer.h"
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace chemsim {
+
+void write_json_string(TextWriter& out, std::string_view s) {
+    static const char hex[] = "0123456789abcdef";
+    out.put('"');
+    size_t run = 0; // start of the pending unescaped run
+    for (size_t i = 0; i < s.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        out.put(s.substr(run, i - run));
+        run = i + 1;
+        switch (c) {
+        case '"': out.put("\\\""); break;
+        case '\\': out.put("\\\\"); break;
+        case '\n': out.put("\\n"); break;
+        case '\r': out.put("\\r"); break;
+        case '\t': out.put("\\t"); break;
+        default: {
+            char esc[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 15]};
+            out.put(std::string_view(esc, sizeof(esc)));
+        }
+        }
+    }
+    out.put(s.substr(run));
+    out.put('"');
+}
+
+// JSON has no NaN or infinity, and positions must stay numbers
+static void write_coordinate(TextWriter& out, double value, int atom) {
+    if (!std::isfinite(value)) {
+        throw std::runtime_error("JSON: non-finite coordinate for atom " + std::to_string(atom));
+    }
+    out.shortest(value);
+}
+
+void write_json(TextWriter& out, const Molecule& mol) {
+    out.put("{\"name\":");
+    write_json_string(out, mol.name);
+    out.put(",\"comment\":");
+    write_json_string(out, mol.comment);
+    out.put(",\"num_atoms\":");
+    out.integer(mol.num_atoms());
+    out.put(",\"num_bonds\":");
+    out.integer(mol.num_bonds());
+
+    out.put(",\"atoms\":[");
+    for (int i = 0; i < mol.num_atoms(); ++i) {
+        const auto atom = mol.atom(i);
+        if (i > 0) out.put(',');
+        out.put("{\"index\":");
+        out.integer(i);
+        out.put(",\"symbol\":");
+        write_json_string(out, atom.symbol);
+        out.put(",\"atomic_number\":");
+        out.integer(atom.atomic_number);
+        out.put(",\"position\":[");
+        write_coordinate(out, atom.position.x(), i);
+        out.put(',');
+        write_coordinate(out, atom.position.y(), i);
+        out.put(',');
+        write_coordinate(out, atom.position.z(), i);
+        out.put("]}");
+    }
+
+    out.put("],\"bonds\":[");
+    for (int i = 0; i < mol.num_bonds(); ++i) {
+        const Bond& bond = mol.bond(i);
+        if (i > 0) out.put(',');
+        out.put("{\"atom_i\":");
+        out.integer(bond.atom_i);
+        out.put(",\"atom_j\":");
+        out.integer(bond.atom_j);
+        out.put(",\"order\":");
+        out.integer(bond.order);
+        out.put('}');
+    }
+    out.put("]}");
+}
+
+std::string write_json(const Molecule& mol) {
+    std::string text;
+    // Roughly 80 bytes per atom and 35 per bond
+    text.reserve(128 + 80 * static_cast<size_t>(mol.num_atoms()) + 35 * static_cast<size_t>(mol.num_bonds()));
+    TextWriter out(text);
+    write_json(out, mol);
+    return text;
+}
+
+} // namespace chemsim
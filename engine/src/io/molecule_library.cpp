@@ -0,0 +1,371 @@
+#include "chemsim/io/molecule_library.h"
+#include "chemsim/io/mapped_file.h"
+#include "chemsim/io/sdf_parser.h"
+#include "chemsim/io/xyz_parser.h"
+#include "chemsim/core/element_data.h"
+#include "chemsim/core/thread_pool.h"
+#include "chemsim/ff/uff_terms.h"
+#include "chemsim/ff/uff_typing.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace chemsim {
+
+namespace {
+
+constexpr char LIBRARY_MAGIC[8] = {'C', 'S', 'M', 'L', 'I', 'B', '\0', '\0'};
+constexpr uint32_t LIBRARY_VERSION = 1;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr uint32_t FLAG_HASHES = 1u << 0;
+constexpr uint32_t FLAG_TYPES = 1u << 1;
+
+enum Section {
+    ATOM_OFFSETS,    // uint64[n + 1]
+    BOND_OFFSETS,    // uint64[n + 1]
+    TEXT_OFFSETS,    // uint64[2n + 1], name then comment
+    POSITIONS,       // double[3 * atoms]
+    ATOMIC_NUMBERS,  // uint8[atoms]
+    FORMAL_CHARGES,  // int8[atoms]
+    BOND_ATOMS,      // int32[2 * bonds], molecule-local
+    BOND_ORDERS,     // uint8[bonds]
+    HASHES,          // uint64[n], optional
+    ATOM_TYPES,      // uint16[atoms], optional
+    TYPE_OFFSETS,    // uint64[types + 1]
+    TEXT,            // char[]
+    TYPE_NAMES,      // char[]
+    NUM_SECTIONS
+};
+
+struct LibraryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t num_molecules;
+    uint64_t num_atoms;
+    uint64_t num_bonds;
+    uint64_t num_types;
+    uint64_t text_bytes;
+    uint64_t type_name_bytes;
+    uint64_t file_size;
+    uint64_t section_offset[NUM_SECTIONS];
+};
+
+size_t align8(size_t n) { return (n + 7) & ~size_t{7}; }
+
+// count * per + extra, saturating: a corrupt header count must not wrap
+// around to a small size that passes the section table check
+size_t array_bytes(uint64_t count, uint64_t per, uint64_t extra = 0) {
+    constexpr uint64_t max = std::numeric_limits<size_t>::max();
+    if (count > (max - extra) / per) return max;
+    return static_cast<size_t>(count * per + extra);
+}
+
+// Expected byte size of every section given the header counts
+void section_sizes(const LibraryHeader& h, size_t sizes[NUM_SECTIONS]) {
+    bool hashes = h.flags & FLAG_HASHES;
+    bool types = h.flags & FLAG_TYPES;
+    sizes[ATOM_OFFSETS] = array_bytes(h.num_molecules, 8, 8);
+    sizes[BOND_OFFSETS] = array_bytes(h.num_molecules, 8, 8);
+    sizes[TEXT_OFFSETS] = array_bytes(h.num_molecules, 16, 8);
+    sizes[POSITIONS] = array_bytes(h.num_atoms, 8 * 3);
+    sizes[ATOMIC_NUMBERS] = array_bytes(h.num_atoms, 1);
+    sizes[FORMAL_CHARGES] = array_bytes(h.num_atoms, 1);
+    sizes[BOND_ATOMS] = array_bytes(h.num_bonds, 4 * 2);
+    sizes[BOND_ORDERS] = array_bytes(h.num_bonds, 1);
+    sizes[HASHES] = hashes ? array_bytes(h.num_molecules, 8) : 0;
+    sizes[ATOM_TYPES] = types ? array_bytes(h.num_atoms, 2) : 0;
+    sizes[TYPE_OFFSETS] = array_bytes(h.num_types, 8, 8);
+    sizes[TEXT] = array_bytes(h.text_bytes, 1);
+    sizes[TYPE_NAMES] = array_bytes(h.type_name_bytes, 1);
+}
+
+// Offsets must start at 0, never decrease and end at total
+bool valid_offsets(const uint64_t* offsets, size_t count, uint64_t total) {
+    if (offsets[0] != 0 || offsets[count - 1] != total) return false;
+    for (size_t i = 1; i < count; ++i) {
+        if (offsets[i] < offsets[i - 1]) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+// ============ Builder ============
+
+LibraryBuilder::LibraryBuilder(const LibraryOptions& options) : options_(options) {}
+
+void LibraryBuilder::append(const Molecule& mol, uint64_t hash,
+                            const std::vector<std::string>& types) {
+    text_ += mol.name;
+    text_offsets_.push_back(text_.size());
+    text_ += mol.comment;
+    text_offsets_.push_back(text_.size());
+
+    for (const auto& atom : mol.atoms()) {
+        positions_.insert(positions_.end(), atom.position.data(), atom.position.data() + 3);
+        atomic_numbers_.push_back(static_cast<uint8_t>(atom.atomic_number));
+        formal_charges_.push_back(static_cast<int8_t>(atom.formal_charge));
+    }
+    for (const auto& bond : mol.bonds()) {
+        bond_atoms_.push_back(bond.atom_i);
+        bond_atoms_.push_back(bond.atom_j);
+        bond_orders_.push_back(static_cast<uint8_t>(bond.order));
+    }
+    if (options_.topology_hashes) hashes_.push_back(hash);
+    for (const auto& type : types) {
+        auto it = type_ids_.find(type);
+        if (it == type_ids_.end()) {
+            if (type_names_.size() > std::numeric_limits<uint16_t>::max()) {
+                throw std::runtime_error("Library: too many distinct atom types");
+            }
+            it = type_ids_.emplace(type, static_cast<uint16_t>(type_names_.size())).first;
+            type_names_.push_back(type);
+        }
+        atom_types_.push_back(it->second);
+    }
+
+    atom_offsets_.push_back(atomic_numbers_.size());
+    bond_offsets_.push_back(bond_orders_.size());
+}
+
+void LibraryBuilder::add(const Molecule& mol) {
+    append(mol, options_.topology_hashes ? topology_hash(mol) : 0,
+           options_.atom_types ? assign_uff_types(mol) : std::vector<std::string>{});
+}
+
+void LibraryBuilder::add(const std::vector<Molecule>& mols) {
+    int n = static_cast<int>(mols.size());
+    std::vector<uint64_t> hashes(n, 0);
+    std::vector<std::vector<std::string>> types(n);
+    if (options_.topology_hashes || options_.atom_types) {
+        ThreadPool pool(options_.num_threads);
+        pool.parallel_for(n, [&](int i) {
+            if (options_.topology_hashes) hashes[i] = topology_hash(mols[i]);
+            if (options_.atom_types) types[i] = assign_uff_types(mols[i]);
+        });
+    }
+    for (int i = 0; i < n; ++i) append(mols[i], hashes[i], types[i]);
+}
+
+void LibraryBuilder::write(const std::string& path) const {
+    LibraryHeader header{};
+    std::memcpy(header.magic, LIBRARY_MAGIC, sizeof(LIBRARY_MAGIC));
+    header.version = LIBRARY_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.flags = (options_.topology_hashes ? FLAG_HASHES : 0) |
+                   (options_.atom_types ? FLAG_TYPES : 0);
+    header.num_molecules = size();
+    header.num_atoms = atomic_numbers_.size();
+    header.num_bonds = bond_orders_.size();
+    header.num_types = type_names_.size();
+    header.text_bytes = text_.size();
+
+    std::string type_text;
+    std::vector<uint64_t> type_offsets{0};
+    for (const auto& name : type_names_) {
+        type_text += name;
+        type_offsets.push_back(type_text.size());
+    }
+    header.type_name_bytes = type_text.size();
+
+    const void* data[NUM_SECTIONS] = {
+        atom_offsets_.data(), bond_offsets_.data(), text_offsets_.data(),
+        positions_.data(), atomic_numbers_.data(), formal_charges_.data(),
+        bond_atoms_.data(), bond_orders_.data(), hashes_.data(), atom_types_.data(),
+        type_offsets.data(), text_.data(), type_text.data()
+    };
+    size_t sizes[NUM_SECTIONS];
+    section_sizes(header, sizes);
+
+    size_t offset = align8(sizeof(LibraryHeader));
+    for (int s = 0; s < NUM_SECTIONS; ++s) {
+        header.section_offset[s] = offset;
+        offset = align8(offset + sizes[s]);
+    }
+    header.file_size = offset;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) throw std::runtime_error("Cannot open: " + path);
+    const char zeros[8] = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(zeros, align8(sizeof(header)) - sizeof(header));
+    for (int s = 0; s < NUM_SECTIONS; ++s) {
+        out.write(static_cast<const char*>(data[s]), sizes[s]);
+        out.write(zeros, align8(sizes[s]) - sizes[s]);
+    }
+    if (!out) throw std::runtime_error("Library: write failed: " + path);
+}
+
+// ============ Conversion ============
+
+size_t convert_to_library(const std::string& input_path,
+                          const std::string& output_path,
+                          const LibraryOptions& options) {
+    const size_t batch = 4096;
+    auto ends_with = [&](const char* ext) {
+        size_t len = std::strlen(ext);
+        return input_path.size() >= len &&
+               input_path.compare(input_path.size() - len, len, ext) == 0;
+    };
+
+    LibraryBuilder builder(options);
+    if (ends_with(".sdf") || ends_with(".sd") || ends_with(".mol")) {
+        auto reader = SDFReader::open(input_path);
+        for (size_t begin = 0; begin < reader.size(); begin += batch) {
+            builder.add(reader.molecules(begin, begin + batch, options.num_threads));
+        }
+    } else if (ends_with(".xyz")) {
+        auto reader = XYZReader::open(input_path);
+        ThreadPool pool(options.num_threads);
+        std::vector<XYZFrame> frames(batch);
+        std::vector<Molecule> mols;
+        for (;;) {
+            size_t count = 0;
+            while (count < batch && reader.next(frames[count])) ++count;
+            if (count == 0) break;
+            mols.assign(count, Molecule());
+            pool.parallel_for(static_cast<int>(count), [&](int i) {
+                mols[i] = frames[i].to_molecule();
+            });
+            builder.add(mols);
+        }
+    } else {
+        throw std::runtime_error("Library: unsupported input format: " + input_path);
+    }
+    builder.write(output_path);
+    return builder.size();
+}
+
+// ============ Reader ============
+
+std::string_view MoleculeView::atom_type(int i) const {
+    if (!atom_types_) throw std::runtime_error("Library: no atom types stored");
+    return (*type_names_)[atom_types_[i]];
+}
+
+Molecule MoleculeView::to_molecule() const {
+    Molecule mol;
+    mol.name = std::string(name_);
+    mol.comment = std::string(comment_);
+    for (int i = 0; i < num_atoms_; ++i) {
+        const auto& elem = element_by_number(atomic_numbers_[i]);
+        Atom atom(elem.atomic_number, elem.symbol, position(i));
+        atom.formal_charge = formal_charges_[i];
+        mol.add_atom(atom);
+    }
+    for (int b = 0; b < num_bonds_; ++b) mol.add_bond(bond(b));
+    return mol;
+}
+
+MoleculeLibrary MoleculeLibrary::open(const std::string& path) {
+    auto file = std::make_shared<const MappedFile>(path);
+    std::string_view data = file->data();
+    auto fail = [&](const std::string& why) {
+        throw std::runtime_error("Library: " + why + ": " + path);
+    };
+
+    LibraryHeader header;
+    if (data.size() < sizeof(header)) fail("file too short");
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, LIBRARY_MAGIC, sizeof(LIBRARY_MAGIC)) != 0) fail("not a library");
+    if (header.byte_order != BYTE_ORDER_MARK) fail("wrong byte order");
+    if (header.version != LIBRARY_VERSION) fail("unsupported version");
+    if (header.file_size != data.size()) fail("truncated file");
+
+    size_t sizes[NUM_SECTIONS];
+    section_sizes(header, sizes);
+    for (int s = 0; s < NUM_SECTIONS; ++s) {
+        uint64_t offset = header.section_offset[s];
+        if (offset % 8 != 0 || offset > data.size() || sizes[s] > data.size() - offset) {
+            fail("corrupt section table");
+        }
+    }
+    auto section = [&](int s) { return data.data() + header.section_offset[s]; };
+
+    MoleculeLibrary lib;
+    lib.num_molecules_ = header.num_molecules;
+    lib.atom_offsets_ = reinterpret_cast<const uint64_t*>(section(ATOM_OFFSETS));
+    lib.bond_offsets_ = reinterpret_cast<const uint64_t*>(section(BOND_OFFSETS));
+    lib.text_offsets_ = reinterpret_cast<const uint64_t*>(section(TEXT_OFFSETS));
+    lib.text_ = section(TEXT);
+    lib.positions_ = reinterpret_cast<const double*>(section(POSITIONS));
+    lib.atomic_numbers_ = reinterpret_cast<const uint8_t*>(section(ATOMIC_NUMBERS));
+    lib.formal_charges_ = reinterpret_cast<const int8_t*>(section(FORMAL_CHARGES));
+    lib.bond_atoms_ = reinterpret_cast<const int32_t*>(section(BOND_ATOMS));
+    lib.bond_orders_ = reinterpret_cast<const uint8_t*>(section(BOND_ORDERS));
+    if (header.flags & FLAG_HASHES) {
+        lib.hashes_ = reinterpret_cast<const uint64_t*>(section(HASHES));
+    }
+
+    size_t n = header.num_molecules;
+    if (!valid_offsets(lib.atom_offsets_, n + 1, header.num_atoms) ||
+        !valid_offsets(lib.bond_offsets_, n + 1, header.num_bonds) ||
+        !valid_offsets(lib.text_offsets_, 2 * n + 1, header.text_bytes)) {
+        fail("corrupt offset table");
+    }
+    // Columns that views and to_molecule() read unchecked: element numbers,
+    // and bond atoms, which are local to their molecule
+    int elements = num_elements();
+    for (size_t a = 0; a < header.num_atoms; ++a) {
+        if (lib.atomic_numbers_[a] >= elements) fail("corrupt atomic numbers");
+    }
+    for (size_t m = 0; m < n; ++m) {
+        int64_t atoms = static_cast<int64_t>(lib.atom_offsets_[m + 1] - lib.atom_offsets_[m]);
+        for (uint64_t b = lib.bond_offsets_[m]; b < lib.bond_offsets_[m + 1]; ++b) {
+            int64_t i = lib.bond_atoms_[2*b], j = lib.bond_atoms_[2*b + 1];
+            if (i < 0 || j < 0 || i >= atoms || j >= atoms || i == j) fail("corrupt bonds");
+        }
+    }
+
+    lib.type_names_ = std::make_shared<std::vector<std::string_view>>();
+    if (header.flags & FLAG_TYPES) {
+        auto type_offsets = reinterpret_cast<const uint64_t*>(section(TYPE_OFFSETS));
+        if (!valid_offsets(type_offsets, header.num_types + 1, header.type_name_bytes)) {
+            fail("corrupt type table");
+        }
+        const char* names = section(TYPE_NAMES);
+        for (size_t t = 0; t < header.num_types; ++t) {
+            lib.type_names_->emplace_back(names + type_offsets[t], type_offsets[t + 1] - type_offsets[t]);
+        }
+        lib.atom_types_ = reinterpret_cast<const uint16_t*>(section(ATOM_TYPES));
+        for (size_t a = 0; a < header.num_atoms; ++a) {
+            if (lib.atom_types_[a] >= header.num_types) fail("corrupt atom types");
+        }
+    }
+    lib.file_ = std::move(file);
+    return lib;
+}
+
+MoleculeView MoleculeLibrary::view(size_t i) const {
+    if (i >= num_molecules_) {
+        throw std::runtime_error("Library: molecule " + std::to_string(i) + " out of range");
+    }
+    MoleculeView v;
+    uint64_t atom_begin = atom_offsets_[i], bond_begin = bond_offsets_[i];
+    v.num_atoms_ = static_cast<int>(atom_offsets_[i + 1] - atom_begin);
+    v.num_bonds_ = static_cast<int>(bond_offsets_[i + 1] - bond_begin);
+    v.name_ = std::string_view(text_ + text_offsets_[2*i], text_offsets_[2*i + 1] - text_offsets_[2*i]);
+    v.comment_ = std::string_view(text_ + text_offsets_[2*i + 1],
+                                  text_offsets_[2*i + 2] - text_offsets_[2*i + 1]);
+    v.positions_ = positions_ + 3 * atom_begin;
+    v.atomic_numbers_ = atomic_numbers_ + atom_begin;
+    v.formal_charges_ = formal_charges_ + atom_begin;
+    v.bond_atoms_ = bond_atoms_ + 2 * bond_begin;
+    v.bond_orders_ = bond_orders_ + bond_begin;
+    if (atom_types_) {
+        v.atom_types_ = atom_types_ + atom_begin;
+        v.type_names_ = type_names_.get();
+    }
+    if (hashes_) {
+        v.has_hash_ = true;
+        v.hash_ = hashes_[i];
+    }
+    return v;
+}
+
+} // namespace chemsim
@@ -0,0 +1,556 @@
+#include "chemsim/io/pdb_parser.h"
+#include "chemsim/io/mapped_file.h"
+#include "chemsim/core/element_data.h"
+#include "chemsim/core/perception.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace chemsim {
+
+namespace {
+
+// ============ Text helpers ============
+
+std::string_view next_line(std::string_view data, size_t& pos) {
+    size_t end = data.find('\n', pos);
+    if (end == std::string_view::npos) end = data.size();
+    std::string_view line = data.substr(pos, end - pos);
+    pos = end < data.size() ? end + 1 : end;
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    return line;
+}
+
+std::string_view trim(std::string_view s) {
+    size_t start = s.find_first_not_of(" \t");
+    if (start == std::string_view::npos) return {};
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(start, end - start + 1);
+}
+
+std::string_view column(std::string_view line, size_t start, size_t width) {
+    if (start >= line.size()) return {};
+    return trim(line.substr(start, width));
+}
+
+template <typename T>
+bool parse_number(std::string_view token, T& value) {
+    if (!token.empty() && token[0] == '+') token.remove_prefix(1);
+    if (token.empty()) return false;
+    const char* end = token.data() + token.size();
+    auto [ptr, ec] = std::from_chars(token.data(), end, value);
+    return ec == std::errc() && ptr == end;
+}
+
+std::array<char, 4> pack_name(std::string_view name) {
+    std::array<char, 4> packed{};
+    std::memcpy(packed.data(), name.data(), std::min<size_t>(name.size(), 4));
+    return packed;
+}
+
+// "FE" or "Fe" -> 26; -1 if unknown
+int element_from_symbol(std::string_view symbol) {
+    char buf[2] = {0, 0};
+    if (symbol.empty() || symbol.size() > 2) return -1;
+    buf[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(symbol[0])));
+    if (symbol.size() == 2) buf[1] = static_cast<char>(std::tolower(static_cast<unsigned char>(symbol[1])));
+    return atomic_number_of(std::string_view(buf, symbol.size()));
+}
+
+// Element from a PDB atom name field (columns 13-16) when the element
+// column is blank. Names starting in column 14 or with a digit are
+// one-letter elements ("1HG1", " HB2" -> H); two-letter elements are only
+// tried for names left-justified in column 13, and a longer name starting
+// with H there is a hydrogen ("HG11", "HE21"), not Hg or He.
+int element_from_atom_name(std::string_view field) {
+    std::string_view name = trim(field);
+    bool leading_digit = !name.empty() && std::isdigit(static_cast<unsigned char>(name[0]));
+    while (!name.empty() && std::isdigit(static_cast<unsigned char>(name[0]))) name.remove_prefix(1);
+    if (name.empty()) return -1;
+
+    bool column_13 = !field.empty() && field[0] != ' ' && !leading_digit;
+    bool hydrogen_name = (name[0] == 'H' || name[0] == 'h') && name.size() > 2;
+    if (column_13 && name.size() >= 2 && !hydrogen_name) {
+        int z = element_from_symbol(name.substr(0, 2));
+        if (z > 0 && z != 1) return z;
+    }
+    return element_from_symbol(name.substr(0, 1));
+}
+
+// ============ Residue templates ============
+
+struct TemplateBond {
+    std::array<char, 4> a, b;
+    int order;
+};
+
+// Heavy-atom bonds by PDB atom name, Kekule orders; "=" is a double bond.
+// Hydrogens are attached to the nearest heavy atom of their residue.
+const std::unordered_map<std::string, std::vector<TemplateBond>>& residue_templates() {
+    static const auto templates = []() {
+        const char* backbone = "N-CA CA-C C=O C-OXT";
+        const std::pair<const char*, const char*> specs[] = {
+            {"ALA", "CA-CB"},
+            {"ARG", "CA-CB CB-CG CG-CD CD-NE NE-CZ CZ=NH1 CZ-NH2"},
+            {"ASN", "CA-CB CB-CG CG=OD1 CG-ND2"},
+            {"ASP", "CA-CB CB-CG CG=OD1 CG-OD2"},
+            {"CYS", "CA-CB CB-SG"},
+            {"GLN", "CA-CB CB-CG CG-CD CD=OE1 CD-NE2"},
+            {"GLU", "CA-CB CB-CG CG-CD CD=OE1 CD-OE2"},
+            {"GLY", ""},
+            {"HIS", "CA-CB CB-CG CG=CD2 CG-ND1 ND1-CE1 CE1=NE2 NE2-CD2"},
+            {"ILE", "CA-CB CB-CG1 CB-CG2 CG1-CD1"},
+            {"LEU", "CA-CB CB-CG CG-CD1 CG-CD2"},
+            {"LYS", "CA-CB CB-CG CG-CD CD-CE CE-NZ"},
+            {"MET", "CA-CB CB-CG CG-SD SD-CE"},
+            {"PHE", "CA-CB CB-CG CG=CD1 CD1-CE1 CE1=CZ CZ-CE2 CE2=CD2 CD2-CG"},
+            {"PRO", "CA-CB CB-CG CG-CD CD-N"},
+            {"SER", "CA-CB CB-OG"},
+            {"THR", "CA-CB CB-OG1 CB-CG2"},
+            {"TRP", "CA-CB CB-CG CG=CD1 CD1-NE1 NE1-CE2 CE2=CD2 CD2-CG CE2-CZ2 "
+                    "CZ2=CH2 CH2-CZ3 CZ3=CE3 CE3-CD2"},
+            {"TYR", "CA-CB CB-CG CG=CD1 CD1-CE1 CE1=CZ CZ-CE2 CE2=CD2 CD2-CG CZ-OH"},
+            {"VAL", "CA-CB CB-CG1 CB-CG2"},
+        };
+
+        auto parse = [](std::string_view spec, std::vector<TemplateBond>& out) {
+            size_t pos = 0;
+            while (pos < spec.size()) {
+                size_t end = spec.find(' ', pos);
+                if (end == std::string_view::npos) end = spec.size();
+                std::string_view token = spec.substr(pos, end - pos);
+                pos = end + 1;
+                if (token.empty()) continue;
+                size_t sep = token.find_first_of("-=");
+                out.push_back({pack_name(token.substr(0, sep)), pack_name(token.substr(sep + 1)),
+                               token[sep] == '=' ? 2 : 1});
+            }
+        };
+
+        std::unordered_map<std::string, std::vector<TemplateBond>> map;
+        for (const auto& [name, spec] : specs) {
+            auto& bonds = map[name];
+            parse(backbone, bonds);
+            parse(spec, bonds);
+        }
+        // Histidine protonation variants, and waters with hydrogens only
+        map["HID"] = map["HIS"];
+        map["HIE"] = map["HIS"];
+        map["HIP"] = map["HIS"];
+        map["HOH"];
+        map["WAT"];
+        return map;
+    }();
+    return templates;
+}
+
+bool is_amino_acid(const std::string& name) {
+    const auto& templates = residue_templates();
+    auto it = templates.find(name);
+    return it != templates.end() && !it->second.empty();
+}
+
+// ============ Structure assembly ============
+
+struct AtomRecord {
+    int serial = 0;
+    bool has_serial = false;
+    std::string_view name;
+    char altloc = ' ';
+    std::string_view res_name;
+    std::string_view chain;
+    int res_seq = 0;
+    char insertion = ' ';
+    bool hetero = false;
+    Eigen::Vector3d position = Eigen::Vector3d::Zero();
+    float occupancy = 1.0f;
+    float b_factor = 0.0f;
+    int atomic_number = 0;
+    int formal_charge = 0;
+};
+
+// Collects atom records in file order into PDBStructure side arrays, then
+// builds connectivity from CONECT pairs, templates and local perception
+class StructureBuilder {
+public:
+    explicit StructureBuilder(const PDBOptions& options) : options_(options) {}
+
+    void add_atom(const AtomRecord& rec) {
+        bool new_residue = s_.residues.empty();
+        if (!new_residue) {
+            const auto& last = s_.residues.back();
+            new_residue = last.seq != rec.res_seq || last.insertion != rec.insertion ||
+                          last.name != rec.res_name || s_.chains[last.chain] != rec.chain;
+        }
+        if (new_residue) {
+            auto it = chain_ids_.find(std::string(rec.chain));
+            if (it == chain_ids_.end()) {
+                it = chain_ids_.emplace(std::string(rec.chain), static_cast<int>(s_.chains.size())).first;
+                s_.chains.emplace_back(rec.chain);
+            }
+            s_.residues.push_back({std::string(rec.res_name), rec.res_seq, rec.insertion,
+                                   rec.hetero, it->second, s_.mol.num_atoms(), 0});
+            chosen_altloc_ = ' ';
+        }
+
+        // Keep blank alternate locations and the first one named per residue
+        if (rec.altloc != ' ') {
+            if (chosen_altloc_ == ' ') chosen_altloc_ = rec.altloc;
+            if (rec.altloc != chosen_altloc_) return;
+        }
+        if (rec.atomic_number <= 0) {
+            throw std::runtime_error("PDB: unknown element for atom " + std::string(rec.name));
+        }
+
+        int index = s_.mol.num_atoms();
+        if (rec.has_serial) serial_to_index_[rec.serial] = index;
+        const auto& elem = element_by_number(rec.atomic_number);
+        Atom atom(rec.atomic_number, elem.symbol, rec.position);
+        atom.formal_charge = rec.formal_charge;
+        s_.mol.add_atom(atom);
+        s_.atom_names.push_back(pack_name(rec.name));
+        s_.altlocs.push_back(rec.altloc);
+        s_.occupancies.push_back(rec.occupancy);
+        s_.b_factors.push_back(rec.b_factor);
+        s_.atom_residues.push_back(static_cast<int>(s_.residues.size()) - 1);
+        s_.residues.back().num_atoms++;
+    }
+
+    void add_conect(int serial_a, int serial_b) { conect_.emplace_back(serial_a, serial_b); }
+
+    size_t num_atoms() const { return s_.mol.num_atoms(); }
+
+    PDBStructure finish() {
+        std::vector<Bond> bonds;
+        std::vector<bool> residue_has_conect(s_.residues.size(), false);
+
+        if (options_.use_conect) {
+            for (const auto& [sa, sb] : conect_) {
+                auto ia = serial_to_index_.find(sa), ib = serial_to_index_.find(sb);
+                if (ia == serial_to_index_.end() || ib == serial_to_index_.end()) continue;
+                if (ia->second == ib->second) continue;
+                bonds.emplace_back(ia->second, ib->second, 1);
+                residue_has_conect[s_.atom_residues[ia->second]] = true;
+                residue_has_conect[s_.atom_residues[ib->second]] = true;
+            }
+        }
+        conect_.clear();
+        serial_to_index_.clear();
+
+        const auto& templates = residue_templates();
+        for (size_t r = 0; r < s_.residues.size(); ++r) {
+            const auto& res = s_.residues[r];
+            auto it = options_.use_templates ? templates.find(res.name) : templates.end();
+            if (it != templates.end()) {
+                template_bonds(res, it->second, bonds);
+            } else if (options_.perceive_unknown && !residue_has_conect[r]) {
+                perceive_residue(res, bonds);
+            }
+        }
+        if (options_.use_templates) link_residues(bonds);
+
+        // Unique bonds sorted by (i, j); duplicates keep the higher order
+        for (auto& b : bonds) {
+            if (b.atom_i > b.atom_j) std::swap(b.atom_i, b.atom_j);
+        }
+        std::sort(bonds.begin(), bonds.end(), [](const Bond& a, const Bond& b) {
+            if (a.atom_i != b.atom_i) return a.atom_i < b.atom_i;
+            if (a.atom_j != b.atom_j) return a.atom_j < b.atom_j;
+            return a.order > b.order;
+        });
+        bool has_hydrogens = false;
+        for (const auto& atom : s_.mol.atoms()) has_hydrogens |= atom.atomic_number == 1;
+        for (size_t b = 0; b < bonds.size(); ++b) {
+            if (b > 0 && bonds[b].atom_i == bonds[b - 1].atom_i &&
+                bonds[b].atom_j == bonds[b - 1].atom_j) continue;
+            s_.mol.add_bond(bonds[b]);
+        }
+
+        if (options_.assign_bond_orders && has_hydrogens) {
+            assign_bond_orders(s_.mol);
+        } else {
+            perceive_aromaticity(s_.mol);
+        }
+        return std::move(s_);
+    }
+
+private:
+    int find_atom(const Residue& res, const std::array<char, 4>& name) const {
+        for (int a = res.first_atom; a < res.first_atom + res.num_atoms; ++a) {
+            if (s_.atom_names[a] == name) return a;
+        }
+        return -1;
+    }
+
+    void template_bonds(const Residue& res, const std::vector<TemplateBond>& tmpl,
+                        std::vector<Bond>& bonds) const {
+        for (const auto& tb : tmpl) {
+            int a = find_atom(res, tb.a), b = find_atom(res, tb.b);
+            if (a >= 0 && b >= 0) bonds.emplace_back(a, b, tb.order);
+        }
+        // Each hydrogen to its nearest heavy atom in the residue
+        for (int h = res.first_atom; h < res.first_atom + res.num_atoms; ++h) {
+            if (s_.mol.atom(h).atomic_number != 1) continue;
+            int best = -1;
+            double best_dist = 1.35;
+            for (int a = res.first_atom; a < res.first_atom + res.num_atoms; ++a) {
+                if (s_.mol.atom(a).atomic_number == 1) continue;
+                double d = (s_.mol.atom(a).position - s_.mol.atom(h).position).norm();
+                if (d < best_dist) {
+                    best_dist = d;
+                    best = a;
+                }
+            }
+            if (best >= 0) bonds.emplace_back(best, h, 1);
+        }
+    }
+
+    // Distance-based bonds within one residue (ligands, unknown residues)
+    void perceive_residue(const Residue& res, std::vector<Bond>& bonds) const {
+        if (res.num_atoms < 2) return;
+        Molecule local;
+        for (int a = res.first_atom; a < res.first_atom + res.num_atoms; ++a) {
+            local.add_atom(s_.mol.atom(a));
+        }
+        local.perceive_bonds();
+        for (const auto& b : local.bonds()) {
+            bonds.emplace_back(res.first_atom + b.atom_i, res.first_atom + b.atom_j, 1);
+        }
+    }
+
+    // Peptide bonds between consecutive amino acids of a chain and
+    // disulfides between cysteines, each checked only by distance
+    void link_residues(std::vector<Bond>& bonds) const {
+        std::vector<int> sulfurs;
+        static const auto C = pack_name("C"), N = pack_name("N"), SG = pack_name("SG");
+        for (size_t r = 0; r < s_.residues.size(); ++r) {
+            const auto& res = s_.residues[r];
+            if (!is_amino_acid(res.name)) continue;
+            if (res.name == "CYS") {
+                int sg = find_atom(res, SG);
+                if (sg >= 0) sulfurs.push_back(sg);
+            }
+            if (r + 1 >= s_.residues.size()) continue;
+            const auto& next = s_.residues[r + 1];
+            if (next.chain != res.chain || !is_amino_acid(next.name)) continue;
+            int c = find_atom(res, C), n = find_atom(next, N);
+            if (c >= 0 && n >= 0 &&
+                (s_.mol.atom(c).position - s_.mol.atom(n).position).norm() < 1.8) {
+                bonds.emplace_back(c, n, 1);
+            }
+        }
+        for (size_t i = 0; i < sulfurs.size(); ++i) {
+            for (size_t j = i + 1; j < sulfurs.size(); ++j) {
+                double d = (s_.mol.atom(sulfurs[i]).position - s_.mol.atom(sulfurs[j]).position).norm();
+                if (d < 2.3) bonds.emplace_back(sulfurs[i], sulfurs[j], 1);
+            }
+        }
+    }
+
+    PDBOptions options_;
+    PDBStructure s_;
+    std::unordered_map<std::string, int> chain_ids_;
+    std::unordered_map<int, int> serial_to_index_;
+    std::vector<std::pair<int, int>> conect_;
+    char chosen_altloc_ = ' ';
+};
+
+// ============ mmCIF tokens ============
+
+// Split a data line into tokens, honoring '...' and "..." quoting
+void cif_tokens(std::string_view line, std::vector<std::string_view>& out) {
+    size_t pos = 0;
+    while (pos < line.size()) {
+        while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t')) ++pos;
+        if (pos >= line.size()) break;
+        char quote = line[pos];
+        if (quote == '\'' || quote == '"') {
+            size_t end = pos + 1;
+            // A closing quote must be followed by whitespace or the line end
+            while (end < line.size() &&
+                   !(line[end] == quote && (end + 1 == line.size() || line[end + 1] == ' ' ||
+                                            line[end + 1] == '\t'))) {
+                ++end;
+            }
+            out.push_back(line.substr(pos + 1, end - pos - 1));
+            pos = end + 1;
+        } else {
+            size_t end = pos;
+            while (end < line.size() && line[end] != ' ' && line[end] != '\t') ++end;
+            out.push_back(line.substr(pos, end - pos));
+            pos = end;
+        }
+    }
+}
+
+bool cif_null(std::string_view v) { return v.empty() || v == "." || v == "?"; }
+
+} // namespace
+
+std::string_view PDBStructure::atom_name(int i) const {
+    const auto& n = atom_names[i];
+    return std::string_view(n.data(), strnlen(n.data(), n.size()));
+}
+
+PDBStructure parse_pdb(std::string_view content, const PDBOptions& options) {
+    StructureBuilder builder(options);
+    size_t pos = 0;
+    bool first_model_done = false;
+    while (pos < content.size()) {
+        std::string_view line = next_line(content, pos);
+        std::string_view record = line.substr(0, 6);
+
+        if (record == "ATOM  " || record == "HETATM") {
+            if (first_model_done) continue;
+            AtomRecord rec;
+            rec.hetero = record == "HETATM";
+            rec.has_serial = parse_number(column(line, 6, 5), rec.serial);
+            rec.name = column(line, 12, 4);
+            rec.altloc = line.size() > 16 ? line[16] : ' ';
+            rec.res_name = column(line, 17, 4);
+            rec.chain = column(line, 21, 1);
+            if (!parse_number(column(line, 22, 4), rec.res_seq)) rec.res_seq = 0;
+            rec.insertion = line.size() > 26 ? line[26] : ' ';
+            if (!parse_number(column(line, 30, 8), rec.position.x()) ||
+                !parse_number(column(line, 38, 8), rec.position.y()) ||
+                !parse_number(column(line, 46, 8), rec.position.z())) {
+                throw std::runtime_error("PDB: invalid coordinates: " + std::string(line));
+            }
+            parse_number(column(line, 54, 6), rec.occupancy);
+            parse_number(column(line, 60, 6), rec.b_factor);
+
+            std::string_view element = column(line, 76, 2);
+            rec.atomic_number = element.empty() ? element_from_atom_name(line.substr(12, 4))
+                                                : element_from_symbol(element);
+            // Charge column: "2+" or "1-"
+            std::string_view charge = column(line, 78, 2);
+            if (charge.size() == 2 && std::isdigit(static_cast<unsigned char>(charge[0]))) {
+                rec.formal_charge = (charge[0] - '0') * (charge[1] == '-' ? -1 : 1);
+            }
+            builder.add_atom(rec);
+        } else if (record == "CONECT") {
+            int from;
+            if (!parse_number(column(line, 6, 5), from)) continue;
+            for (size_t col = 11; col <= 26; col += 5) {
+                int to;
+                if (parse_number(column(line, col, 5), to)) builder.add_conect(from, to);
+            }
+        } else if (record == "ENDMDL") {
+            // CONECT records follow the last model, so keep scanning
+            first_model_done = true;
+        }
+    }
+    if (builder.num_atoms() == 0) throw std::runtime_error("PDB: no atoms");
+    return builder.finish();
+}
+
+PDBStructure parse_mmcif(std::string_view content, const PDBOptions& options) {
+    StructureBuilder builder(options);
+    size_t pos = 0;
+
+    // Find the _atom_site loop and its column names
+    std::vector<std::string_view> fields;
+    while (pos < content.size()) {
+        std::string_view line = trim(next_line(content, pos));
+        if (line != "loop_") continue;
+        size_t peek = pos;
+        if (trim(next_line(content, peek)).substr(0, 11) != "_atom_site.") continue;
+        while (pos < content.size()) {
+            peek = pos;
+            std::string_view header = trim(next_line(content, peek));
+            if (header.substr(0, 11) != "_atom_site.") break;
+            fields.push_back(header.substr(11));
+            pos = peek;
+        }
+        break;
+    }
+    if (fields.empty()) throw std::runtime_error("mmCIF: no _atom_site loop");
+
+    auto field = [&](std::initializer_list<const char*> names) {
+        for (const char* name : names) {
+            auto it = std::find(fields.begin(), fields.end(), name);
+            if (it != fields.end()) return static_cast<int>(it - fields.begin());
+        }
+        return -1;
+    };
+    int f_group = field({"group_PDB"});
+    int f_id = field({"id"});
+    int f_element = field({"type_symbol"});
+    int f_name = field({"auth_atom_id", "label_atom_id"});
+    int f_alt = field({"label_alt_id"});
+    int f_res = field({"auth_comp_id", "label_comp_id"});
+    int f_chain = field({"auth_asym_id", "label_asym_id"});
+    int f_seq = field({"auth_seq_id", "label_seq_id"});
+    int f_icode = field({"pdbx_PDB_ins_code"});
+    int f_x = field({"Cartn_x"}), f_y = field({"Cartn_y"}), f_z = field({"Cartn_z"});
+    int f_occ = field({"occupancy"});
+    int f_b = field({"B_iso_or_equiv"});
+    int f_charge = field({"pdbx_formal_charge"});
+    int f_model = field({"pdbx_PDB_model_num"});
+    if (f_x < 0 || f_y < 0 || f_z < 0 || f_name < 0 || f_element < 0) {
+        throw std::runtime_error("mmCIF: _atom_site lacks coordinates, names or elements");
+    }
+
+    // Rows until the next category, loop or data block; a row may wrap
+    std::vector<std::string_view> tokens;
+    std::string_view first_model;
+    while (pos < content.size()) {
+        std::string_view line = next_line(content, pos);
+        std::string_view t = trim(line);
+        if (t.empty()) continue;
+        if (t[0] == '#' || t[0] == '_' || t.substr(0, 5) == "loop_" || t.substr(0, 5) == "data_") {
+            if (tokens.empty()) break;
+            throw std::runtime_error("mmCIF: truncated _atom_site row");
+        }
+        cif_tokens(line, tokens);
+        if (tokens.size() < fields.size()) continue;
+        if (tokens.size() > fields.size()) {
+            throw std::runtime_error("mmCIF: malformed _atom_site row: " + std::string(line));
+        }
+
+        if (f_model >= 0) {
+            if (first_model.empty()) first_model = tokens[f_model];
+            if (tokens[f_model] != first_model) break;
+        }
+        AtomRecord rec;
+        rec.hetero = f_group >= 0 && tokens[f_group] == "HETATM";
+        rec.has_serial = f_id >= 0 && parse_number(tokens[f_id], rec.serial);
+        rec.name = tokens[f_name];
+        if (f_alt >= 0 && !cif_null(tokens[f_alt])) rec.altloc = tokens[f_alt][0];
+        if (f_res >= 0) rec.res_name = tokens[f_res];
+        if (f_chain >= 0) rec.chain = tokens[f_chain];
+        if (f_seq >= 0 && !parse_number(tokens[f_seq], rec.res_seq)) rec.res_seq = 0;
+        if (f_icode >= 0 && !cif_null(tokens[f_icode])) rec.insertion = tokens[f_icode][0];
+        if (!parse_number(tokens[f_x], rec.position.x()) ||
+            !parse_number(tokens[f_y], rec.position.y()) ||
+            !parse_number(tokens[f_z], rec.position.z())) {
+            throw std::runtime_error("mmCIF: invalid coordinates: " + std::string(line));
+        }
+        if (f_occ >= 0) parse_number(tokens[f_occ], rec.occupancy);
+        if (f_b >= 0) parse_number(tokens[f_b], rec.b_factor);
+        rec.atomic_number = element_from_symbol(tokens[f_element]);
+        if (f_charge >= 0 && !cif_null(tokens[f_charge])) {
+            parse_number(tokens[f_charge], rec.formal_charge);
+        }
+        builder.add_atom(rec);
+        tokens.clear();
+    }
+    if (builder.num_atoms() == 0) throw std::runtime_error("mmCIF: no atoms");
+    return builder.finish();
+}
+
+PDBStructure read_structure(const std::string& path, const PDBOptions& options) {
+    auto ends_with = [&](const char* ext) {
+        size_t len = std::strlen(ext);
+        return path.size() >= len && path.compare(path.size() - len, len, ext) == 0;
+    };
+    MappedFile file(path);
+    if (ends_with(".cif") || ends_with(".mmcif")) return parse_mmcif(file.data(), options);
+    if (ends_with(".pdb") || ends_with(".ent")) return parse_pdb(file.data(), options);
+    throw std::runtime_error("Unsupported structure format: " + path);
+}
+
+} // namespace chemsim
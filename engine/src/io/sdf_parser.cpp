@@ -1,76 +1,315 @@
 #include "chemsim/io/sdf_parser.h"
+#include "chemsim/io/mapped_file.h"
+#include "chemsim/io/text_writer.h"
 #include "chemsim/core/element_data.h"
-#include <sstream>
+#include "chemsim/core/perception.h"
+#include "chemsim/core/thread_pool.h"
+#include <algorithm>
+#include <charconv>
 #include <stdexcept>
 
 namespace chemsim {
 
-Molecule parse_sdf(const std::string& content) {
-    std::istringstream stream(content);
+// Next line of data starting at pos (without the newline or a trailing
+// carriage return); advances pos past it
+static std::string_view next_line(std::string_view data, size_t& pos) {
+    size_t end = data.find('\n', pos);
+    if (end == std::string_view::npos) end = data.size();
+    std::string_view line = data.substr(pos, end - pos);
+    pos = end < data.size() ? end + 1 : end;
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    return line;
+}
+
+static std::string_view trim(std::string_view s) {
+    size_t start = s.find_first_not_of(" \t");
+    if (start == std::string_view::npos) return {};
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(start, end - start + 1);
+}
+
+// Fixed-width column [start, start + width) of line, trimmed
+static std::string_view column(std::string_view line, size_t start, size_t width) {
+    if (start >= line.size()) return {};
+    return trim(line.substr(start, width));
+}
+
+template <typename T>
+static bool parse_number(std::string_view token, T& value) {
+    if (!token.empty() && token[0] == '+') token.remove_prefix(1);
+    if (token.empty()) return false;
+    const char* end = token.data() + token.size();
+    auto [ptr, ec] = std::from_chars(token.data(), end, value);
+    return ec == std::errc() && ptr == end;
+}
+
+static int parse_int_field(std::string_view line, size_t start, size_t width,
+                           const char* what) {
+    int value = 0;
+    if (!parse_number(column(line, start, width), value)) {
+        throw std::runtime_error(std::string("SDF: invalid ") + what + ": " + std::string(line));
+    }
+    return value;
+}
+
+Molecule parse_sdf(std::string_view content) {
     Molecule mol;
-    std::string line;
+    size_t pos = 0;
 
     // Line 1: molecule name
-    if (!std::getline(stream, line)) throw std::runtime_error("SDF: empty input");
-    mol.name = line;
+    if (content.empty()) throw std::runtime_error("SDF: empty input");
+    mol.name = std::string(next_line(content, pos));
 
     // Lines 2-3: header (program, comment)
-    std::getline(stream, line);
-    if (std::getline(stream, line)) mol.comment = line;
+    next_line(content, pos);
+    if (pos < content.size()) mol.comment = std::string(next_line(content, pos));
 
     // Counts line: aaabbblllfffcccsssxxxrrrpppiiimmmvvvvvv
-    if (!std::getline(stream, line)) throw std::runtime_error("SDF: missing counts line");
+    if (pos >= content.size()) throw std::runtime_error("SDF: missing counts line");
+    std::string_view line = next_line(content, pos);
     if (line.size() < 6) throw std::runtime_error("SDF: counts line too short");
-
-    int num_atoms, num_bonds;
-    try {
-        num_atoms = std::stoi(line.substr(0, 3));
-        num_bonds = std::stoi(line.substr(3, 3));
-    } catch (...) {
-        throw std::runtime_error("SDF: invalid counts line: " + line);
+    if (line.find("V3000") != std::string_view::npos) {
+        throw std::runtime_error("SDF: V3000 records are not supported");
     }
+    int num_atoms = parse_int_field(line, 0, 3, "counts line");
+    int num_bonds = parse_int_field(line, 3, 3, "counts line");
 
     // Atom block
     for (int i = 0; i < num_atoms; ++i) {
-        if (!std::getline(stream, line)) {
+        if (pos >= content.size()) {
             throw std::runtime_error("SDF: expected " + std::to_string(num_atoms) +
                                    " atoms, got " + std::to_string(i));
         }
+        line = next_line(content, pos);
         if (line.size() < 34) {
-            throw std::runtime_error("SDF: atom line too short: " + line);
+            throw std::runtime_error("SDF: atom line too short: " + std::string(line));
+        }
+        double x, y, z;
+        if (!parse_number(column(line, 0, 10), x) || !parse_number(column(line, 10, 10), y) ||
+            !parse_number(column(line, 20, 10), z)) {
+            throw std::runtime_error("SDF: invalid coordinates: " + std::string(line));
         }
-        double x = std::stod(line.substr(0, 10));
-        double y = std::stod(line.substr(10, 10));
-        double z = std::stod(line.substr(20, 10));
-        std::string symbol = line.substr(31, 3);
-        // Trim whitespace from symbol
-        size_t start = symbol.find_first_not_of(' ');
-        size_t end = symbol.find_last_not_of(' ');
-        if (start != std::string::npos) {
-            symbol = symbol.substr(start, end - start + 1);
+        std::string_view symbol = column(line, 31, 3);
+        int atomic_number = atomic_number_of(symbol);
+        if (atomic_number < 0) {
+            atomic_number = element_by_symbol(std::string(symbol)).atomic_number;
         }
 
-        const auto& elem = element_by_symbol(symbol);
-        mol.add_atom(Atom(elem.atomic_number, symbol, Eigen::Vector3d(x, y, z)));
+        Atom atom(atomic_number, std::string(symbol), Eigen::Vector3d(x, y, z));
+        // Atom block charge code: 1..3 = +3..+1, 5..7 = -1..-3
+        int code = 0;
+        if (parse_number(column(line, 36, 3), code) && code >= 1 && code <= 7 && code != 4) {
+            atom.formal_charge = 4 - code;
+        }
+        mol.add_atom(atom);
     }
 
     // Bond block
     for (int i = 0; i < num_bonds; ++i) {
-        if (!std::getline(stream, line)) {
+        if (pos >= content.size()) {
             throw std::runtime_error("SDF: expected " + std::to_string(num_bonds) +
                                    " bonds, got " + std::to_string(i));
         }
+        line = next_line(content, pos);
         if (line.size() < 9) {
-            throw std::runtime_error("SDF: bond line too short: " + line);
+            throw std::runtime_error("SDF: bond line too short: " + std::string(line));
+        }
+        int a1 = parse_int_field(line, 0, 3, "bond line") - 1; // 1-indexed to 0-indexed
+        int a2 = parse_int_field(line, 3, 3, "bond line") - 1;
+        int order = parse_int_field(line, 6, 3, "bond line");
+        if (a1 < 0 || a1 >= num_atoms || a2 < 0 || a2 >= num_atoms) {
+            throw std::runtime_error("SDF: bond atom out of range: " + std::string(line));
         }
-        int a1 = std::stoi(line.substr(0, 3)) - 1; // 1-indexed to 0-indexed
-        int a2 = std::stoi(line.substr(3, 3)) - 1;
-        int order = std::stoi(line.substr(6, 3));
         // SDF bond order 4 = aromatic
         mol.add_bond(Bond(a1, a2, order));
     }
 
+    // Properties block: "M  CHG" replaces all atom block charges
+    bool charges_reset = false;
+    while (pos < content.size()) {
+        line = next_line(content, pos);
+        if (line.substr(0, 6) == "M  END") break;
+        if (line.substr(0, 6) != "M  CHG") continue;
+        if (!charges_reset) {
+            for (int i = 0; i < num_atoms; ++i) mol.atom(i).formal_charge = 0;
+            charges_reset = true;
+        }
+        int count = parse_int_field(line, 6, 3, "charge line");
+        for (int k = 0; k < count; ++k) {
+            int atom = parse_int_field(line, 9 + 8 * k, 4, "charge line") - 1;
+            int charge = parse_int_field(line, 13 + 8 * k, 4, "charge line");
+            if (atom < 0 || atom >= num_atoms) {
+                throw std::runtime_error("SDF: charge atom out of range: " + std::string(line));
+            }
+            mol.atom(atom).formal_charge = charge;
+        }
+    }
+
+    // Kekule rings become aromatic (order 4) so typing sees them as such
+    perceive_aromaticity(mol);
+
     return mol;
 }
 
+SDFProperties parse_sdf_properties(std::string_view record) {
+    SDFProperties props;
+    size_t pos = 0;
+
+    // Data items follow "M  END"
+    while (pos < record.size()) {
+        if (next_line(record, pos).substr(0, 6) == "M  END") break;
+    }
+    while (pos < record.size()) {
+        std::string_view line = next_line(record, pos);
+        if (line.empty() || line[0] != '>') continue;
+        size_t open = line.find('<');
+        size_t close = open == std::string_view::npos ? open : line.find('>', open);
+        if (close == std::string_view::npos) continue;
+
+        // Value lines run until a blank line
+        std::string value;
+        while (pos < record.size()) {
+            std::string_view data = next_line(record, pos);
+            if (trim(data).empty()) break;
+            if (!value.empty()) value += '\n';
+            value += data;
+        }
+        props.emplace_back(std::string(line.substr(open + 1, close - open - 1)), std::move(value));
+    }
+    return props;
+}
+
+void write_sdf(TextWriter& out, const Molecule& mol, const SDFProperties& properties) {
+    int n = mol.num_atoms(), m = mol.num_bonds();
+    if (n > 999 || m > 999) {
+        throw std::runtime_error("SDF: V2000 records hold at most 999 atoms and bonds");
+    }
+
+    // Header: name, program line, comment
+    out.put(mol.name);
+    out.put("\n  chemsim\n");
+    out.put(mol.comment);
+    out.put('\n');
+
+    out.integer(n, 3);
+    out.integer(m, 3);
+    out.put("  0  0  0  0  0  0  0  0999 V2000\n");
+
+    std::vector<int> charged;
+    for (int i = 0; i < n; ++i) {
+        const auto& atom = mol.atom(i);
+        for (int k = 0; k < 3; ++k) out.fixed(atom.position[k], 4, 10);
+        out.put(' ');
+        out.padded(atom.symbol, 3);
+        // Atom block charge code: +3..+1 = 1..3, -1..-3 = 5..7
+        int q = atom.formal_charge;
+        out.put(" 0");
+        out.integer(q != 0 && q >= -3 && q <= 3 ? 4 - q : 0, 3);
+        out.put("  0  0  0  0  0  0  0  0  0  0\n");
+        if (q != 0) charged.push_back(i);
+    }
+    for (const auto& bond : mol.bonds()) {
+        out.integer(bond.atom_i + 1, 3);
+        out.integer(bond.atom_j + 1, 3);
+        out.integer(bond.order, 3);
+        out.put("  0\n");
+    }
+
+    // Up to eight charges per "M  CHG" line
+    for (size_t start = 0; start < charged.size(); start += 8) {
+        size_t count = std::min<size_t>(8, charged.size() - start);
+        out.put("M  CHG");
+        out.integer(static_cast<long long>(count), 3);
+        for (size_t k = start; k < start + count; ++k) {
+            out.integer(charged[k] + 1, 4);
+            out.integer(mol.atom(charged[k]).formal_charge, 4);
+        }
+        out.put('\n');
+    }
+    out.put("M  END\n");
+
+    for (const auto& [name, value] : properties) {
+        out.put("> <");
+        out.put(name);
+        out.put(">\n");
+        out.put(value);
+        out.put("\n\n");
+    }
+    out.put("$$$$\n");
+}
+
+std::string write_sdf(const Molecule& mol, const SDFProperties& properties) {
+    std::string text;
+    TextWriter out(text);
+    write_sdf(out, mol, properties);
+    return text;
+}
+
+void write_sdf_file(const std::string& path, const std::vector<Molecule>& mols,
+                    const std::vector<SDFProperties>& properties) {
+    auto out = TextWriter::open(path);
+    static const SDFProperties none;
+    for (size_t k = 0; k < mols.size(); ++k) {
+        write_sdf(*out, mols[k], k < properties.size() ? properties[k] : none);
+    }
+    out->flush();
+}
+
+SDFReader::SDFReader(std::string_view content) : data_(content) {
+    size_t pos = 0;
+    size_t start = 0;
+    while (pos < data_.size()) {
+        size_t line_start = pos;
+        std::string_view line = next_line(data_, pos);
+        if (line.substr(0, 4) == "$$$$") {
+            starts_.push_back(start);
+            ends_.push_back(line_start);
+            start = pos;
+        }
+    }
+    // A final record without a separator (plain MOL file)
+    if (!trim(data_.substr(start)).empty()) {
+        starts_.push_back(start);
+        ends_.push_back(data_.size());
+    }
+}
+
+SDFReader SDFReader::open(const std::string& path) {
+    auto file = std::make_shared<const MappedFile>(path);
+    SDFReader reader(file->data());
+    reader.file_ = std::move(file);
+    return reader;
+}
+
+std::string_view SDFReader::record(size_t i) const {
+    if (i >= size()) {
+        throw std::runtime_error("SDF: record " + std::to_string(i) + " out of range");
+    }
+    return data_.substr(starts_[i], ends_[i] - starts_[i]);
+}
+
+Molecule SDFReader::molecule(size_t i) const {
+    std::string_view text = record(i);
+    try {
+        return parse_sdf(text);
+    } catch (const std::exception& e) {
+        throw std::runtime_error(std::string(e.what()) + " (record " + std::to_string(i) + ")");
+    }
+}
+
+SDFProperties SDFReader::properties(size_t i) const {
+    return parse_sdf_properties(record(i));
+}
+
+std::vector<Molecule> SDFReader::molecules(size_t begin, size_t end, int num_threads) const {
+    end = std::min(end, size());
+    if (begin >= end) return {};
+    std::vector<Molecule> mols(end - begin);
+    ThreadPool pool(num_threads);
+    pool.parallel_for(static_cast<int>(end - begin), [&](int k) {
+        mols[k] = molecule(begin + k);
+    });
+    return mols;
+}
+
 } // namespace chemsim
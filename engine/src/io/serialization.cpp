@@ -0,0 +1,287 @@
+#include "chemsim/io/serialization.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+namespace chemsim {
+
+namespace {
+
+constexpr char BLOB_MAGIC[8] = {'C', 'S', 'B', 'L', 'O', 'B', '\0', '\0'};
+constexpr uint32_t BLOB_VERSION = 2;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+enum BlobKind : uint32_t { KIND_MOLECULE = 1, KIND_FORCE_FIELD = 2 };
+
+struct BlobHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t kind;
+    uint32_t reserved;
+    uint64_t size; // whole blob, header included
+};
+
+class BlobWriter {
+public:
+    BlobWriter(BlobKind kind, size_t reserve) {
+        out_.reserve(sizeof(BlobHeader) + reserve);
+        BlobHeader header{};
+        std::memcpy(header.magic, BLOB_MAGIC, sizeof(BLOB_MAGIC));
+        header.version = BLOB_VERSION;
+        header.byte_order = BYTE_ORDER_MARK;
+        header.kind = kind;
+        put(header);
+    }
+
+    void bytes(const void* data, size_t n) {
+        out_.append(static_cast<const char*>(data), n);
+    }
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "raw value");
+        bytes(&value, sizeof(T));
+    }
+    // Count, then the raw elements
+    template <typename T>
+    void array(const T* data, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "raw array");
+        put(static_cast<uint64_t>(count));
+        bytes(data, count * sizeof(T));
+    }
+    void string(const std::string& s) { array(s.data(), s.size()); }
+
+    std::string finish() {
+        uint64_t size = out_.size();
+        std::memcpy(&out_[offsetof(BlobHeader, size)], &size, sizeof(size));
+        return std::move(out_);
+    }
+
+private:
+    std::string out_;
+};
+
+class BlobReader {
+public:
+    BlobReader(std::string_view data, BlobKind kind) : data_(data) {
+        BlobHeader header;
+        get(header);
+        if (std::memcmp(header.magic, BLOB_MAGIC, sizeof(BLOB_MAGIC)) != 0) {
+            throw std::runtime_error("Blob: bad magic");
+        }
+        if (header.byte_order != BYTE_ORDER_MARK) throw std::runtime_error("Blob: byte order mismatch");
+        if (header.version != BLOB_VERSION) {
+            throw std::runtime_error("Blob: unsupported version " + std::to_string(header.version));
+        }
+        if (header.kind != kind) throw std::runtime_error("Blob: wrong object kind");
+        if (header.size > data.size()) throw std::runtime_error("Blob: truncated");
+        data_ = data.substr(0, header.size);
+    }
+
+    const char* take(size_t n) {
+        if (n > data_.size() - pos_) throw std::runtime_error("Blob: truncated");
+        const char* p = data_.data() + pos_;
+        pos_ += n;
+        return p;
+    }
+    template <typename T>
+    void get(T& value) { std::memcpy(&value, take(sizeof(T)), sizeof(T)); }
+    template <typename T>
+    T get() { T value; get(value); return value; }
+    template <typename T>
+    void array(std::vector<T>& out) {
+        uint64_t count = get<uint64_t>();
+        if (count > (data_.size() - pos_) / sizeof(T)) throw std::runtime_error("Blob: truncated");
+        out.resize(count);
+        if (count > 0) std::memcpy(out.data(), take(count * sizeof(T)), count * sizeof(T));
+    }
+    std::string string() {
+        uint64_t n = get<uint64_t>();
+        const char* p = take(n);
+        return std::string(p, n);
+    }
+    bool done() const { return pos_ == data_.size(); }
+
+private:
+    std::string_view data_;
+    size_t pos_ = 0;
+};
+
+void check_index(int32_t i, size_t n) {
+    if (i < 0 || static_cast<size_t>(i) >= n) throw std::runtime_error("Blob: atom index out of range");
+}
+
+// Term records are copied as raw structs; their layout travels with the blob
+struct TermLayout {
+    uint32_t bond, angle, torsion, vdw, restraint;
+    bool operator==(const TermLayout& o) const {
+        return bond == o.bond && angle == o.angle && torsion == o.torsion &&
+               vdw == o.vdw && restraint == o.restraint;
+    }
+};
+constexpr TermLayout TERM_LAYOUT{sizeof(BondTerm), sizeof(AngleTerm), sizeof(TorsionTerm),
+                                 sizeof(VdwAtom), sizeof(DihedralRestraint)};
+
+} // namespace
+
+std::string serialize(const Molecule& mol) {
+    size_t n = mol.num_atoms(), m = mol.num_bonds();
+    BlobWriter w(KIND_MOLECULE, 48 * n + 12 * m + mol.name.size() + mol.comment.size() + 64);
+    w.string(mol.name);
+    w.string(mol.comment);
+
+    // Atoms column by column
+    std::vector<int32_t> ints(n);
+    for (size_t i = 0; i < n; ++i) ints[i] = mol.atom(i).atomic_number;
+    w.array(ints.data(), n);
+    for (size_t i = 0; i < n; ++i) ints[i] = mol.atom(i).formal_charge;
+    w.array(ints.data(), n);
+    std::vector<double> positions(3 * n);
+    for (size_t i = 0; i < n; ++i) {
+        std::memcpy(&positions[3 * i], mol.atom(i).position.data(), 3 * sizeof(double));
+    }
+    w.array(positions.data(), positions.size());
+    std::string symbols;
+    for (const auto& atom : mol.atoms()) {
+        symbols.push_back(static_cast<char>(atom.symbol.size()));
+        symbols += atom.symbol;
+    }
+    w.string(symbols);
+
+    std::vector<int32_t> bonds(3 * m);
+    for (size_t b = 0; b < m; ++b) {
+        const auto& bond = mol.bond(b);
+        bonds[3*b] = bond.atom_i;
+        bonds[3*b + 1] = bond.atom_j;
+        bonds[3*b + 2] = bond.order;
+    }
+    w.array(bonds.data(), bonds.size());
+    return w.finish();
+}
+
+Molecule deserialize_molecule(std::string_view data) {
+    BlobReader r(data, KIND_MOLECULE);
+    Molecule mol;
+    mol.name = r.string();
+    mol.comment = r.string();
+
+    std::vector<int32_t> atomic_numbers, charges, bonds;
+    std::vector<double> positions;
+    r.array(atomic_numbers);
+    r.array(charges);
+    r.array(positions);
+    std::string symbols = r.string();
+    r.array(bonds);
+    if (!r.done()) throw std::runtime_error("Blob: trailing data");
+
+    size_t n = atomic_numbers.size();
+    if (charges.size() != n || positions.size() != 3 * n || bonds.size() % 3 != 0) {
+        throw std::runtime_error("Blob: inconsistent molecule columns");
+    }
+    size_t s = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (s >= symbols.size()) throw std::runtime_error("Blob: truncated symbols");
+        size_t len = static_cast<unsigned char>(symbols[s++]);
+        if (len > symbols.size() - s) throw std::runtime_error("Blob: truncated symbols");
+        Atom atom(atomic_numbers[i], symbols.substr(s, len),
+                  Eigen::Vector3d(positions[3*i], positions[3*i + 1], positions[3*i + 2]));
+        atom.formal_charge = charges[i];
+        mol.add_atom(atom);
+        s += len;
+    }
+    for (size_t b = 0; b < bonds.size(); b += 3) {
+        check_index(bonds[b], n);
+        check_index(bonds[b + 1], n);
+        mol.add_bond(Bond(bonds[b], bonds[b + 1], bonds[b + 2]));
+    }
+    return mol;
+}
+
+std::string serialize(const UFFForceField& ff) {
+    const auto& t = ff.terms();
+    const auto& restraints = ff.dihedral_restraints();
+    BlobWriter w(KIND_FORCE_FIELD, t.memory_bytes() + 64);
+    w.put(TERM_LAYOUT);
+
+    std::string types;
+    for (const auto& type : t.atom_types) {
+        types.push_back(static_cast<char>(type.size()));
+        types += type;
+    }
+    w.put(static_cast<uint64_t>(t.atom_types.size()));
+    w.string(types);
+    w.array(t.bonds.data(), t.bonds.size());
+    w.array(t.angles.data(), t.angles.size());
+    w.array(t.torsions.data(), t.torsions.size());
+    w.array(t.vdw_atoms.data(), t.vdw_atoms.size());
+    w.array(t.vdw_excluded_start.data(), t.vdw_excluded_start.size());
+    w.array(t.vdw_excluded.data(), t.vdw_excluded.size());
+    w.array(restraints.data(), restraints.size());
+    return w.finish();
+}
+
+UFFForceField deserialize_force_field(std::string_view data) {
+    BlobReader r(data, KIND_FORCE_FIELD);
+    if (!(r.get<TermLayout>() == TERM_LAYOUT)) {
+        throw std::runtime_error("Blob: force-field term layout differs from this build");
+    }
+
+    auto tables = std::make_shared<UFFTermTables>();
+    uint64_t num_types = r.get<uint64_t>();
+    std::string types = r.string();
+    size_t s = 0;
+    for (uint64_t i = 0; i < num_types; ++i) {
+        if (s >= types.size()) throw std::runtime_error("Blob: truncated atom types");
+        size_t len = static_cast<unsigned char>(types[s++]);
+        if (len > types.size() - s) throw std::runtime_error("Blob: truncated atom types");
+        tables->atom_types.emplace_back(types, s, len);
+        s += len;
+    }
+    r.array(tables->bonds);
+    r.array(tables->angles);
+    r.array(tables->torsions);
+    r.array(tables->vdw_atoms);
+    r.array(tables->vdw_excluded_start);
+    r.array(tables->vdw_excluded);
+    std::vector<DihedralRestraint> restraints;
+    r.array(restraints);
+    if (!r.done()) throw std::runtime_error("Blob: trailing data");
+
+    // Term indices address atoms; keep a corrupt blob from reading out of bounds
+    size_t n = tables->atom_types.size();
+    for (const auto& b : tables->bonds) { check_index(b.i, n); check_index(b.j, n); }
+    for (const auto& a : tables->angles) {
+        check_index(a.i, n); check_index(a.j, n); check_index(a.k, n);
+    }
+    for (const auto& d : tables->torsions) {
+        check_index(d.i, n); check_index(d.j, n); check_index(d.k, n); check_index(d.l, n);
+    }
+    // Exclusions: num_atoms + 1 offsets, each atom's partners ascending above it
+    const auto& start = tables->vdw_excluded_start;
+    const auto& excluded = tables->vdw_excluded;
+    if (tables->vdw_atoms.size() != n || start.size() != n + 1 || start[0] != 0 ||
+        static_cast<size_t>(start[n]) != excluded.size()) {
+        throw std::runtime_error("Blob: corrupt non-bonded tables");
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (start[i + 1] < start[i] || start[i + 1] > start[n]) throw std::runtime_error("Blob: corrupt non-bonded tables");
+        int32_t previous = static_cast<int32_t>(i);
+        for (int32_t e = start[i]; e < start[i + 1]; ++e) {
+            check_index(excluded[e], n);
+            if (excluded[e] <= previous) throw std::runtime_error("Blob: corrupt non-bonded tables");
+            previous = excluded[e];
+        }
+    }
+    for (const auto& d : restraints) {
+        check_index(d.i, n); check_index(d.j, n); check_index(d.k, n); check_index(d.l, n);
+    }
+
+    UFFForceField ff;
+    ff.set_terms(std::move(tables));
+    for (const auto& restraint : restraints) ff.add_dihedral_restraint(restraint);
+    return ff;
+}
+
+} // namespace chemsim
@@ -0,0 +1,82 @@
+#include "chemsim/io/text_writer.h"
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace chemsim {
+
+TextWriter::TextWriter(std::string& buffer) : out_(&buffer) {}
+
+TextWriter::TextWriter(int fd, size_t chunk_size)
+    : out_(&staging_), fd_(fd), chunk_size_(chunk_size) {
+    if (fd < 0) throw std::runtime_error("TextWriter: invalid file descriptor");
+    staging_.reserve(chunk_size + 4096);
+}
+
+std::unique_ptr<TextWriter> TextWriter::open(const std::string& path, size_t chunk_size) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw std::runtime_error("Cannot open: " + path);
+    auto writer = std::make_unique<TextWriter>(fd, chunk_size);
+    writer->owns_fd_ = true;
+    return writer;
+}
+
+TextWriter::~TextWriter() {
+    try {
+        flush();
+    } catch (...) {
+    }
+    if (owns_fd_) ::close(fd_);
+}
+
+void TextWriter::pad_and_put(const char* begin, const char* end, int width) {
+    for (int pad = width - static_cast<int>(end - begin); pad > 0; --pad) out_->push_back(' ');
+    put(std::string_view(begin, end - begin));
+}
+
+void TextWriter::fixed(double value, int precision, int width) {
+    // Room for the largest double in fixed notation
+    char buf[400];
+    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, precision);
+    if (ec != std::errc()) throw std::runtime_error("TextWriter: cannot format number");
+    pad_and_put(buf, ptr, width);
+}
+
+void TextWriter::shortest(double value) {
+    char buf[32];
+    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+    if (ec != std::errc()) throw std::runtime_error("TextWriter: cannot format number");
+    put(std::string_view(buf, ptr - buf));
+}
+
+void TextWriter::integer(long long value, int width) {
+    char buf[24];
+    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+    pad_and_put(buf, ptr, width);
+}
+
+void TextWriter::padded(std::string_view s, int width) {
+    out_->append(s.data(), s.size());
+    for (int pad = width - static_cast<int>(s.size()); pad > 0; --pad) out_->push_back(' ');
+    if (fd_ >= 0 && out_->size() >= chunk_size_) flush();
+}
+
+void TextWriter::flush() {
+    if (fd_ < 0) return;
+    size_t done = 0;
+    while (done < staging_.size()) {
+        ssize_t n = ::write(fd_, staging_.data() + done, staging_.size() - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            staging_.clear();
+            throw std::runtime_error(std::string("TextWriter: write failed: ") + std::strerror(errno));
+        }
+        done += static_cast<size_t>(n);
+    }
+    staging_.clear();
+}
+
+} // namespace chemsim
@@ -1,69 +1,187 @@
 #include "chemsim/io/xyz_parser.h"
+#include "chemsim/io/mapped_file.h"
+#include "chemsim/io/text_writer.h"
 #include "chemsim/core/element_data.h"
-#include <sstream>
+#include "chemsim/core/perception.h"
+#include <charconv>
 #include <stdexcept>
 
 namespace chemsim {
 
-Molecule parse_xyz(const std::string& content) {
-    std::istringstream stream(content);
-    Molecule mol;
+// Next line of data starting at pos (without the newline or a trailing
+// carriage return); advances pos past it
+static std::string_view next_line(std::string_view data, size_t& pos) {
+    size_t end = data.find('\n', pos);
+    if (end == std::string_view::npos) end = data.size();
+    std::string_view line = data.substr(pos, end - pos);
+    pos = end < data.size() ? end + 1 : end;
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    return line;
+}
 
-    // Line 1: atom count
-    std::string line;
-    if (!std::getline(stream, line)) {
-        throw std::runtime_error("XYZ: empty input");
-    }
-    int num_atoms;
-    try {
-        num_atoms = std::stoi(line);
-    } catch (...) {
-        throw std::runtime_error("XYZ: invalid atom count: " + line);
+// Next whitespace-separated token of line starting at pos
+static std::string_view next_token(std::string_view line, size_t& pos) {
+    while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t')) ++pos;
+    size_t start = pos;
+    while (pos < line.size() && line[pos] != ' ' && line[pos] != '\t') ++pos;
+    return line.substr(start, pos - start);
+}
+
+static bool parse_number(std::string_view token, double& value) {
+    if (!token.empty() && token[0] == '+') token.remove_prefix(1);
+    const char* end = token.data() + token.size();
+    auto [ptr, ec] = std::from_chars(token.data(), end, value);
+    return ec == std::errc() && ptr == end;
+}
+
+static bool is_blank(std::string_view line) {
+    return line.find_first_not_of(" \t") == std::string_view::npos;
+}
+
+XYZReader::XYZReader(std::string_view content) : data_(content) {}
+
+XYZReader XYZReader::open(const std::string& path) {
+    auto file = std::make_shared<const MappedFile>(path);
+    XYZReader reader(file->data());
+    reader.file_ = std::move(file);
+    return reader;
+}
+
+void XYZReader::rewind() {
+    pos_ = 0;
+    frame_index_ = 0;
+}
+
+bool XYZReader::next(XYZFrame& frame) {
+    // Blank lines between frames and at the end are skipped
+    std::string_view line;
+    do {
+        if (pos_ >= data_.size()) return false;
+        line = next_line(data_, pos_);
+    } while (is_blank(line));
+
+    // Error-message suffix, built only when throwing
+    auto where = [this]() {
+        return frame_index_ > 0 ? " (frame " + std::to_string(frame_index_) + ")" : std::string();
+    };
+    size_t col = 0;
+    std::string_view count_token = next_token(line, col);
+    int num_atoms = 0;
+    auto [ptr, ec] = std::from_chars(count_token.data(), count_token.data() + count_token.size(),
+                                     num_atoms);
+    if (ec != std::errc() || ptr != count_token.data() + count_token.size()) {
+        throw std::runtime_error("XYZ: invalid atom count: " + std::string(line) + where());
     }
     if (num_atoms < 0) {
-        throw std::runtime_error("XYZ: negative atom count");
+        throw std::runtime_error("XYZ: negative atom count" + where());
     }
 
     // Line 2: comment
-    if (!std::getline(stream, line)) {
-        throw std::runtime_error("XYZ: missing comment line");
+    if (pos_ >= data_.size()) {
+        throw std::runtime_error("XYZ: missing comment line" + where());
+    }
+    frame.comment = next_line(data_, pos_);
+
+    // Each atom line takes at least 8 bytes ("H 0 0 0" and a newline, which
+    // the last line may omit); reject a corrupt count before allocating
+    if (static_cast<size_t>(num_atoms) > (data_.size() - pos_ + 1) / 8) {
+        throw std::runtime_error("XYZ: atom count " + std::to_string(num_atoms) +
+                                 " exceeds the remaining data" + where());
     }
-    mol.comment = line;
 
     // Lines 3+: symbol x y z
+    frame.atomic_numbers.resize(num_atoms);
+    frame.positions.resize(3 * static_cast<size_t>(num_atoms));
     for (int i = 0; i < num_atoms; ++i) {
-        if (!std::getline(stream, line)) {
+        if (pos_ >= data_.size()) {
             throw std::runtime_error("XYZ: expected " + std::to_string(num_atoms) +
-                                   " atoms, got " + std::to_string(i));
+                                     " atoms, got " + std::to_string(i) + where());
         }
-        std::istringstream atom_stream(line);
-        std::string symbol;
-        double x, y, z;
-        if (!(atom_stream >> symbol >> x >> y >> z)) {
-            throw std::runtime_error("XYZ: malformed atom line: " + line);
+        line = next_line(data_, pos_);
+        col = 0;
+        std::string_view symbol = next_token(line, col);
+        double* xyz = &frame.positions[3 * static_cast<size_t>(i)];
+        if (!parse_number(next_token(line, col), xyz[0]) ||
+            !parse_number(next_token(line, col), xyz[1]) ||
+            !parse_number(next_token(line, col), xyz[2])) {
+            throw std::runtime_error("XYZ: malformed atom line: " + std::string(line) + where());
         }
 
-        const auto& elem = element_by_symbol(symbol);
-        mol.add_atom(Atom(elem.atomic_number, symbol, Eigen::Vector3d(x, y, z)));
+        int z = atomic_number_of(symbol);
+        if (z < 0) z = element_by_symbol(std::string(symbol)).atomic_number;
+        frame.atomic_numbers[i] = z;
     }
+    ++frame_index_;
+    return true;
+}
 
-    // Perceive bonds from distances
-    mol.perceive_bonds();
+Molecule XYZFrame::to_molecule(const XYZOptions& options) const {
+    Molecule mol;
+    mol.comment = std::string(comment);
+    for (int i = 0; i < num_atoms(); ++i) {
+        const auto& elem = element_by_number(atomic_numbers[i]);
+        mol.add_atom(Atom(elem.atomic_number, elem.symbol,
+                          Eigen::Vector3d(positions[3*i], positions[3*i + 1], positions[3*i + 2])));
+    }
+
+    // Perceive bonds from distances, then their orders and aromaticity
+    if (options.perceive_bonds) {
+        mol.perceive_bonds();
+        assign_bond_orders(mol);
+    }
     return mol;
 }
 
-std::string write_xyz(const Molecule& mol) {
-    std::ostringstream out;
-    out << mol.num_atoms() << "\n";
-    out << mol.comment << "\n";
+Molecule parse_xyz(std::string_view content, const XYZOptions& options) {
+    XYZReader reader(content);
+    XYZFrame frame;
+    if (!reader.next(frame)) {
+        throw std::runtime_error("XYZ: empty input");
+    }
+    return frame.to_molecule(options);
+}
+
+// One frame; positions are flat 3N
+static void write_frame(TextWriter& out, const Molecule& mol, std::string_view comment,
+                        const double* positions, int precision) {
+    out.integer(mol.num_atoms());
+    out.put('\n');
+    out.put(comment);
+    out.put('\n');
     for (int i = 0; i < mol.num_atoms(); ++i) {
-        const auto& a = mol.atom(i);
-        out << a.symbol << " "
-            << a.position.x() << " "
-            << a.position.y() << " "
-            << a.position.z() << "\n";
+        out.padded(mol.atom(i).symbol, 2);
+        for (int k = 0; k < 3; ++k) {
+            out.put(' ');
+            out.fixed(positions[3*i + k], precision, precision + 5);
+        }
+        out.put('\n');
+    }
+}
+
+void write_xyz(TextWriter& out, const Molecule& mol, int precision) {
+    auto positions = mol.get_positions();
+    write_frame(out, mol, mol.comment, positions.data(), precision);
+}
+
+std::string write_xyz(const Molecule& mol, int precision) {
+    std::string text;
+    TextWriter out(text);
+    write_xyz(out, mol, precision);
+    return text;
+}
+
+void write_xyz_frames(TextWriter& out, const Molecule& mol,
+                      const std::vector<std::vector<double>>& frames,
+                      const std::vector<std::string>& comments,
+                      int precision) {
+    for (size_t f = 0; f < frames.size(); ++f) {
+        if (frames[f].size() != 3 * static_cast<size_t>(mol.num_atoms())) {
+            throw std::runtime_error("XYZ: frame " + std::to_string(f) + " size mismatch");
+        }
+        std::string_view comment = f < comments.size() ? std::string_view(comments[f])
+                                                        : std::string_view(mol.comment);
+        write_frame(out, mol, comment, frames[f].data(), precision);
     }
-    return out.str();
 }
 
 } // namespace chemsim
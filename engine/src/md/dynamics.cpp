@@ -0,0 +1,151 @@
+#include "chemsim/md/dynamics.h"
+#include "chemsim/core/element_data.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+namespace chemsim {
+
+// kcal/mol/Angstrom / amu -> Angstrom/fs^2
+static const double FORCE_TO_ACCEL = 4.184e-4;
+// Boltzmann constant in kcal/mol/K
+static const double KB = 0.0019872041;
+
+// Kinetic energy in amu*Angstrom^2/fs^2
+static double kinetic_energy(const Eigen::VectorXd& v, const Eigen::VectorXd& mass) {
+    return 0.5 * mass.dot(v.cwiseProduct(v));
+}
+
+MDResult run_dynamics(Molecule& mol, const UFFForceField& ff,
+                      const MDSettings& settings,
+                      MDProgressCallback callback) {
+    if (settings.timestep <= 0.0) {
+        throw std::runtime_error("MD: timestep must be positive");
+    }
+    if (settings.output_interval <= 0) {
+        throw std::runtime_error("MD: output_interval must be positive");
+    }
+    bool langevin = settings.thermostat == "langevin";
+    bool nose_hoover = settings.thermostat == "nose_hoover";
+    if (!langevin && !nose_hoover && settings.thermostat != "none") {
+        throw std::runtime_error("MD: unknown thermostat: " + settings.thermostat);
+    }
+
+    int num_atoms = mol.num_atoms();
+    int n = 3 * num_atoms;
+    double dt = settings.timestep;
+
+    // Per-coordinate masses (amu) and inverse masses
+    Eigen::VectorXd mass(n);
+    for (int a = 0; a < num_atoms; ++a) {
+        double m = element_by_number(mol.atom(a).atomic_number).mass;
+        if (m <= 0.0) throw std::runtime_error("MD: atom without mass: " + mol.atom(a).symbol);
+        mass.segment<3>(3*a).setConstant(m);
+    }
+    Eigen::VectorXd inv_mass = mass.cwiseInverse();
+    Eigen::VectorXd accel_scale = -FORCE_TO_ACCEL * inv_mass;
+
+    // Degrees of freedom after removing center-of-mass motion
+    int dof = num_atoms > 1 ? n - 3 : n;
+    double kT = KB * settings.temperature * FORCE_TO_ACCEL; // amu*A^2/fs^2
+
+    // Maxwell-Boltzmann velocities with zero net momentum, rescaled to T
+    std::mt19937_64 rng(settings.seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    Eigen::VectorXd v(n);
+    for (int i = 0; i < n; ++i) v[i] = normal(rng) * std::sqrt(kT * inv_mass[i]);
+    if (num_atoms > 1) {
+        Eigen::Vector3d momentum = Eigen::Vector3d::Zero();
+        double total_mass = 0.0;
+        for (int a = 0; a < num_atoms; ++a) {
+            momentum += mass[3*a] * v.segment<3>(3*a);
+            total_mass += mass[3*a];
+        }
+        Eigen::Vector3d v_com = momentum / total_mass;
+        for (int a = 0; a < num_atoms; ++a) v.segment<3>(3*a) -= v_com;
+    }
+    double ke = kinetic_energy(v, mass);
+    if (ke > 0.0 && settings.temperature > 0.0) {
+        v *= std::sqrt(0.5 * dof * kT / ke);
+    } else {
+        v.setZero();
+    }
+
+    // Langevin (BAOAB) Ornstein-Uhlenbeck coefficients
+    double gamma = settings.friction * 1e-3; // 1/fs
+    double c1 = std::exp(-gamma * dt);
+    Eigen::VectorXd noise_scale = ((1.0 - c1 * c1) * kT * inv_mass).cwiseSqrt();
+
+    // Nose-Hoover thermostat mass and friction variable
+    double tau = settings.thermostat_period;
+    double Q = dof * kT * tau * tau;
+    double xi = 0.0;
+
+    Eigen::VectorXd grad(n);
+    ff.calculate_gradient(mol, grad);
+
+    MDResult result;
+    result.steps = 0;
+
+    auto emit_frame = [&](int step) {
+        if (!callback && !settings.store_trajectory) return;
+        double ke_kcal = kinetic_energy(v, mass) / FORCE_TO_ACCEL;
+        MDFrame frame;
+        frame.step = step;
+        frame.time = step * dt * 1e-3;
+        frame.potential_energy = ff.calculate_energy(mol);
+        frame.kinetic_energy = ke_kcal;
+        frame.temperature = dof > 0 ? 2.0 * ke_kcal / (dof * KB) : 0.0;
+        frame.positions = mol.get_positions();
+        if (callback) callback(frame);
+        if (settings.store_trajectory) result.trajectory.push_back(std::move(frame));
+    };
+
+    auto drift = [&](double h) {
+        for (int a = 0; a < num_atoms; ++a) {
+            mol.atom(a).position += h * v.segment<3>(3*a);
+        }
+    };
+
+    auto nose_hoover_half_step = [&]() {
+        double ke2 = 2.0 * kinetic_energy(v, mass);
+        xi += 0.5 * dt * (ke2 - dof * kT) / Q;
+        v *= std::exp(-0.5 * dt * xi);
+    };
+
+    emit_frame(0);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int step = 1; step <= settings.num_steps; ++step) {
+        if (langevin) {
+            // BAOAB splitting
+            v.array() += 0.5 * dt * accel_scale.array() * grad.array();
+            drift(0.5 * dt);
+            for (int i = 0; i < n; ++i) v[i] = c1 * v[i] + noise_scale[i] * normal(rng);
+            drift(0.5 * dt);
+            ff.calculate_gradient(mol, grad);
+            v.array() += 0.5 * dt * accel_scale.array() * grad.array();
+        } else {
+            if (nose_hoover && Q > 0.0) nose_hoover_half_step();
+            v.array() += 0.5 * dt * accel_scale.array() * grad.array();
+            drift(dt);
+            ff.calculate_gradient(mol, grad);
+            v.array() += 0.5 * dt * accel_scale.array() * grad.array();
+            if (nose_hoover && Q > 0.0) nose_hoover_half_step();
+        }
+
+        result.steps = step;
+        if (step % settings.output_interval == 0) emit_frame(step);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    result.wall_time = std::chrono::duration<double>(end - start).count();
+    double wall = std::max(result.wall_time, 1e-12);
+    result.steps_per_second = result.steps / wall;
+    result.ns_per_day = result.steps * dt * 1e-6 / wall * 86400.0;
+    return result;
+}
+
+} // namespace chemsim
@@ -0,0 +1,113 @@
+#include "chemsim/opt/dihedral_scan.h"
+#include "chemsim/core/geometry.h"
+#include "chemsim/core/thread_pool.h"
+#include <stdexcept>
+
+namespace chemsim {
+
+struct ScanPoint {
+    std::vector<double> positions;
+    double energy;
+    bool converged;
+};
+
+// Restrain the given dihedrals to their targets and minimize `work` in place
+static ScanPoint optimize_point(Molecule& work, UFFForceField& restrained,
+                                const std::vector<const ScanDihedral*>& dihedrals,
+                                const std::vector<double>& targets,
+                                const ScanSettings& settings) {
+    restrained.clear_restraints();
+    for (size_t d = 0; d < dihedrals.size(); ++d) {
+        const auto& dh = *dihedrals[d];
+        set_dihedral(work, dh.i, dh.j, dh.k, dh.l, targets[d]);
+        restrained.add_dihedral_restraint(dh.i, dh.j, dh.k, dh.l, targets[d],
+                                          settings.force_constant);
+    }
+
+    OptSettings opt = settings.opt;
+    opt.store_trajectory = false;
+    auto result = optimize_geometry(work, restrained, opt);
+
+    auto ec = restrained.calculate_energy_components(work);
+    return {work.get_positions(), ec.total - ec.restraint, result.converged};
+}
+
+static void check_dihedral(const Molecule& mol, const ScanDihedral& d) {
+    int n = mol.num_atoms();
+    if (d.i < 0 || d.j < 0 || d.k < 0 || d.l < 0 ||
+        d.i >= n || d.j >= n || d.k >= n || d.l >= n) {
+        throw std::runtime_error("Dihedral scan: atom index out of range");
+    }
+    if (d.num_points < 1) {
+        throw std::runtime_error("Dihedral scan: num_points must be positive");
+    }
+}
+
+ScanResult relaxed_scan(const Molecule& mol, const UFFForceField& ff,
+                        const ScanDihedral& dihedral,
+                        const ScanSettings& settings) {
+    check_dihedral(mol, dihedral);
+
+    ScanResult result;
+    Molecule work = mol;
+    UFFForceField restrained = ff;
+    for (int a = 0; a < dihedral.num_points; ++a) {
+        double angle = dihedral.start + a * dihedral.step;
+        auto point = optimize_point(work, restrained, {&dihedral}, {angle}, settings);
+        result.angles1.push_back(angle);
+        result.energies.push_back(point.energy);
+        result.converged.push_back(point.converged);
+        if (settings.store_geometries) result.geometries.push_back(std::move(point.positions));
+    }
+    return result;
+}
+
+ScanResult relaxed_scan_2d(const Molecule& mol, const UFFForceField& ff,
+                           const ScanDihedral& dihedral1,
+                           const ScanDihedral& dihedral2,
+                           const ScanSettings& settings) {
+    check_dihedral(mol, dihedral1);
+    check_dihedral(mol, dihedral2);
+
+    int n1 = dihedral1.num_points;
+    int n2 = dihedral2.num_points;
+    std::vector<ScanPoint> grid(static_cast<size_t>(n1) * n2);
+    std::vector<const ScanDihedral*> both = {&dihedral1, &dihedral2};
+
+    auto angle1 = [&](int a) { return dihedral1.start + a * dihedral1.step; };
+    auto angle2 = [&](int b) { return dihedral2.start + b * dihedral2.step; };
+
+    // First column: one warm-started line along dihedral1
+    {
+        Molecule work = mol;
+        UFFForceField restrained = ff;
+        for (int a = 0; a < n1; ++a) {
+            grid[static_cast<size_t>(a) * n2] =
+                optimize_point(work, restrained, both, {angle1(a), angle2(0)}, settings);
+        }
+    }
+
+    // Rows are independent once their first point is known
+    ThreadPool pool(settings.num_threads);
+    pool.parallel_for(n1, [&](int a) {
+        Molecule work = mol;
+        work.set_positions(grid[static_cast<size_t>(a) * n2].positions);
+        UFFForceField restrained = ff;
+        for (int b = 1; b < n2; ++b) {
+            grid[static_cast<size_t>(a) * n2 + b] =
+                optimize_point(work, restrained, both, {angle1(a), angle2(b)}, settings);
+        }
+    });
+
+    ScanResult result;
+    for (int a = 0; a < n1; ++a) result.angles1.push_back(angle1(a));
+    for (int b = 0; b < n2; ++b) result.angles2.push_back(angle2(b));
+    for (auto& point : grid) {
+        result.energies.push_back(point.energy);
+        result.converged.push_back(point.converged);
+        if (settings.store_geometries) result.geometries.push_back(std::move(point.positions));
+    }
+    return result;
+}
+
+} // namespace chemsim
@@ -0,0 +1,20 @@
+#include "chemsim/opt/model_hessian.h"
+#include "chemsim/analysis/vibrations.h"
+#include <stdexcept>
+
+namespace chemsim {
+
+ModelHessian::ModelHessian(const Molecule& mol, const UFFForceField& ff,
+                           double min_curvature, int num_threads) {
+    if (!(min_curvature > 0.0)) throw std::runtime_error("ModelHessian: min_curvature must be positive");
+
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(compute_hessian(mol, ff, 0.005, num_threads));
+    if (eig.info() != Eigen::Success) throw std::runtime_error("ModelHessian: eigendecomposition failed");
+
+    Eigen::VectorXd curvature = eig.eigenvalues().cwiseAbs().cwiseMax(min_curvature);
+    const Eigen::MatrixXd& V = eig.eigenvectors();
+    matrix_ = V * curvature.asDiagonal() * V.transpose();
+    inverse_ = V * curvature.cwiseInverse().asDiagonal() * V.transpose();
+}
+
+} // namespace chemsim
@@ -0,0 +1,348 @@
+#include "chemsim/opt/neb.h"
+#include "chemsim/core/thread_pool.h"
+#include <LBFGS.h>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+
+namespace chemsim {
+
+static void check_endpoints(const Molecule& reactant, const Molecule& product) {
+    if (reactant.num_atoms() != product.num_atoms()) {
+        throw std::runtime_error("NEB: endpoints have different numbers of atoms");
+    }
+    for (int a = 0; a < reactant.num_atoms(); ++a) {
+        if (reactant.atom(a).atomic_number != product.atom(a).atomic_number) {
+            throw std::runtime_error("NEB: endpoints differ at atom " + std::to_string(a));
+        }
+    }
+}
+
+static std::vector<double> pair_distances(const Eigen::VectorXd& x, int num_atoms) {
+    std::vector<double> d;
+    d.reserve(static_cast<size_t>(num_atoms) * (num_atoms - 1) / 2);
+    for (int i = 0; i < num_atoms; ++i) {
+        for (int j = i + 1; j < num_atoms; ++j) {
+            d.push_back((x.segment<3>(3*i) - x.segment<3>(3*j)).norm());
+        }
+    }
+    return d;
+}
+
+// ============ IDPP ============
+
+// S = sum_ij (d_ij - target_ij)^2 / d_ij^4 (Smidstrup et al., JCP 2014)
+class IDPPObjective {
+public:
+    IDPPObjective(std::vector<double> targets, int num_atoms)
+        : targets_(std::move(targets)), num_atoms_(num_atoms),
+          best_value_(std::numeric_limits<double>::infinity()) {}
+
+    double operator()(const Eigen::VectorXd& x, Eigen::VectorXd& grad) {
+        grad.setZero();
+        double S = 0.0;
+        size_t p = 0;
+        for (int i = 0; i < num_atoms_; ++i) {
+            for (int j = i + 1; j < num_atoms_; ++j, ++p) {
+                Eigen::Vector3d rij = x.segment<3>(3*i) - x.segment<3>(3*j);
+                double d = std::max(rij.norm(), 1e-6);
+                double diff = d - targets_[p];
+                double d4 = d * d * d * d;
+                S += diff * diff / d4;
+                double dS_dd = 2.0 * diff / d4 - 4.0 * diff * diff / (d4 * d);
+                Eigen::Vector3d g = dS_dd * rij / d;
+                grad.segment<3>(3*i) += g;
+                grad.segment<3>(3*j) -= g;
+            }
+        }
+        if (S < best_value_) {
+            best_value_ = S;
+            best_x_ = x;
+        }
+        return S;
+    }
+
+    const Eigen::VectorXd& best_x() const { return best_x_; }
+
+private:
+    std::vector<double> targets_;
+    int num_atoms_;
+    double best_value_;
+    Eigen::VectorXd best_x_;
+};
+
+std::vector<std::vector<double>> interpolate_images(const Molecule& reactant,
+                                                    const Molecule& product,
+                                                    int num_images,
+                                                    const std::string& method,
+                                                    int num_threads) {
+    check_endpoints(reactant, product);
+    if (num_images < 0) throw std::runtime_error("NEB: negative number of images");
+    if (method != "linear" && method != "idpp") {
+        throw std::runtime_error("NEB: unknown interpolation: " + method);
+    }
+
+    auto pa = reactant.get_positions();
+    auto pb = product.get_positions();
+    int n = static_cast<int>(pa.size());
+    int num_atoms = reactant.num_atoms();
+    Eigen::VectorXd a = Eigen::Map<Eigen::VectorXd>(pa.data(), n);
+    Eigen::VectorXd b = Eigen::Map<Eigen::VectorXd>(pb.data(), n);
+
+    int total = num_images + 2;
+    std::vector<std::vector<double>> images(total);
+    images.front() = pa;
+    images.back() = pb;
+
+    std::vector<double> da, db;
+    if (method == "idpp") {
+        da = pair_distances(a, num_atoms);
+        db = pair_distances(b, num_atoms);
+    }
+
+    ThreadPool pool(method == "idpp" ? num_threads : 1);
+    pool.parallel_for(num_images, [&](int idx) {
+        int m = idx + 1;
+        double t = static_cast<double>(m) / (total - 1);
+        Eigen::VectorXd x = (1.0 - t) * a + t * b;
+
+        if (method == "idpp") {
+            std::vector<double> targets(da.size());
+            for (size_t p = 0; p < da.size(); ++p) targets[p] = (1.0 - t) * da[p] + t * db[p];
+
+            LBFGSpp::LBFGSParam<double> param;
+            param.max_iterations = 500;
+            param.epsilon = 1e-5;
+            param.max_linesearch = 40;
+            LBFGSpp::LBFGSSolver<double> solver(param);
+            IDPPObjective objective(std::move(targets), num_atoms);
+            double fx;
+            try {
+                solver.minimize(objective, x, fx);
+            } catch (const std::exception&) {
+                // Keep the best point seen if the line search gives up
+            }
+            if (objective.best_x().size() == n) x = objective.best_x();
+        }
+        images[m] = std::vector<double>(x.data(), x.data() + n);
+    });
+    return images;
+}
+
+// ============ NEB ============
+
+static double max_atom_norm(const Eigen::MatrixXd& F) {
+    double max_sq = 0.0;
+    for (Eigen::Index m = 0; m < F.cols(); ++m) {
+        for (Eigen::Index a = 0; a < F.rows() / 3; ++a) {
+            max_sq = std::max(max_sq, F.col(m).segment<3>(3*a).squaredNorm());
+        }
+    }
+    return std::sqrt(max_sq);
+}
+
+// Scale dx so no atom of any image moves further than max_step
+static void limit_step(Eigen::MatrixXd& dx, double max_step) {
+    double largest = max_atom_norm(dx);
+    if (largest > max_step) dx *= max_step / largest;
+}
+
+NEBResult run_neb(const Molecule& reactant, const Molecule& product,
+                  const UFFForceField& ff, const NEBSettings& settings) {
+    if (settings.num_images < 1) throw std::runtime_error("NEB: need at least one image");
+    if (settings.method != "fire" && settings.method != "lbfgs") {
+        throw std::runtime_error("NEB: unknown method: " + settings.method);
+    }
+
+    auto band = interpolate_images(reactant, product, settings.num_images,
+                                   settings.interpolation, settings.num_threads);
+    int M = static_cast<int>(band.size());
+    int num_atoms = reactant.num_atoms();
+    int n = 3 * num_atoms;
+
+    Eigen::MatrixXd X(n, M);
+    for (int m = 0; m < M; ++m) X.col(m) = Eigen::Map<Eigen::VectorXd>(band[m].data(), n);
+
+    // One molecule and gradient buffer per image; the force field is shared
+    std::vector<Molecule> image_mols(M, reactant);
+    std::vector<Eigen::VectorXd> grads(M, Eigen::VectorXd::Zero(n));
+    Eigen::VectorXd E(M);
+
+    ThreadPool pool(settings.num_threads);
+    auto evaluate = [&](int first, int last) {
+        pool.parallel_for(last - first, [&](int idx) {
+            int m = first + idx;
+            Molecule& mol = image_mols[m];
+            for (int a = 0; a < num_atoms; ++a) mol.atom(a).position = X.col(m).segment<3>(3*a);
+            E[m] = ff.calculate_energy(mol);
+            ff.calculate_gradient(mol, grads[m]);
+        });
+    };
+
+    // Endpoints stay fixed and are evaluated once
+    evaluate(0, 1);
+    evaluate(M - 1, M);
+
+    Eigen::MatrixXd F = Eigen::MatrixXd::Zero(n, M);
+    int climbing = -1;
+    double max_force = 0.0;
+
+    auto neb_forces = [&]() {
+        for (int m = 1; m < M - 1; ++m) {
+            Eigen::VectorXd tp = X.col(m + 1) - X.col(m);
+            Eigen::VectorXd tm = X.col(m) - X.col(m - 1);
+
+            // Energy-weighted tangent (Henkelman & Jonsson, JCP 2000)
+            Eigen::VectorXd tau;
+            if (E[m + 1] > E[m] && E[m] > E[m - 1]) {
+                tau = tp;
+            } else if (E[m + 1] < E[m] && E[m] < E[m - 1]) {
+                tau = tm;
+            } else {
+                double dv_max = std::max(std::abs(E[m + 1] - E[m]), std::abs(E[m - 1] - E[m]));
+                double dv_min = std::min(std::abs(E[m + 1] - E[m]), std::abs(E[m - 1] - E[m]));
+                tau = E[m + 1] > E[m - 1] ? (tp * dv_max + tm * dv_min).eval()
+                                          : (tp * dv_min + tm * dv_max).eval();
+            }
+            double tau_norm = tau.norm();
+            if (tau_norm > 1e-12) tau /= tau_norm;
+
+            Eigen::VectorXd f_true = -grads[m];
+            double f_par = f_true.dot(tau);
+            if (m == climbing) {
+                F.col(m) = f_true - 2.0 * f_par * tau;
+            } else {
+                double spring = settings.spring_constant * (tp.norm() - tm.norm());
+                F.col(m) = f_true - f_par * tau + spring * tau;
+            }
+        }
+        max_force = max_atom_norm(F);
+    };
+
+    auto update_climbing = [&]() {
+        if (!settings.climbing_image) return;
+        if (climbing < 0 && max_force > settings.climb_threshold) return;
+        int top = 1;
+        for (int m = 2; m < M - 1; ++m) {
+            if (E[m] > E[top]) top = m;
+        }
+        climbing = top;
+    };
+
+    NEBResult result;
+    result.converged = false;
+    result.iterations = 0;
+
+    // FIRE state (Bitzek et al., PRL 2006)
+    Eigen::MatrixXd V = Eigen::MatrixXd::Zero(n, M);
+    double dt = 0.1;
+    const double dt_max = 1.0;
+    double alpha = 0.1;
+    int steps_downhill = 0;
+
+    // Force-based L-BFGS state
+    std::deque<Eigen::VectorXd> s_hist, y_hist;
+    Eigen::VectorXd prev_x, prev_g;
+    const int memory = 10;
+
+    int iter = 0;
+    for (; iter < settings.max_iterations; ++iter) {
+        evaluate(1, M - 1);
+        neb_forces();
+        update_climbing();
+        neb_forces();
+
+        bool climbing_ready = !settings.climbing_image || climbing >= 0;
+        if (max_force < settings.force_tolerance && climbing_ready) {
+            result.converged = true;
+            break;
+        }
+
+        Eigen::MatrixXd dx;
+        if (settings.method == "fire") {
+            double power = (F.array() * V.array()).sum();
+            if (power > 0.0) {
+                double v_norm = V.norm();
+                double f_norm = F.norm();
+                if (f_norm > 0.0) V = (1.0 - alpha) * V + alpha * v_norm * F / f_norm;
+                if (++steps_downhill > 5) {
+                    dt = std::min(dt * 1.1, dt_max);
+                    alpha *= 0.99;
+                }
+            } else {
+                V.setZero();
+                dt *= 0.5;
+                alpha = 0.1;
+                steps_downhill = 0;
+            }
+            V += dt * F;
+            dx = dt * V;
+        } else {
+            // Two-loop recursion on g = -F for the whole band
+            Eigen::VectorXd x = Eigen::Map<const Eigen::VectorXd>(X.data(), X.size());
+            Eigen::VectorXd g = -Eigen::Map<const Eigen::VectorXd>(F.data(), F.size());
+            if (prev_x.size() == x.size()) {
+                Eigen::VectorXd s = x - prev_x;
+                Eigen::VectorXd y = g - prev_g;
+                if (s.dot(y) > 1e-10) {
+                    s_hist.push_back(s);
+                    y_hist.push_back(y);
+                    if (static_cast<int>(s_hist.size()) > memory) {
+                        s_hist.pop_front();
+                        y_hist.pop_front();
+                    }
+                }
+            }
+            prev_x = x;
+            prev_g = g;
+
+            Eigen::VectorXd q = g;
+            int k = static_cast<int>(s_hist.size());
+            std::vector<double> a(k);
+            for (int i = k - 1; i >= 0; --i) {
+                a[i] = s_hist[i].dot(q) / y_hist[i].dot(s_hist[i]);
+                q -= a[i] * y_hist[i];
+            }
+            // Initial inverse Hessian: 1/70 Angstrom^2 mol/kcal without history
+            q *= k > 0 ? s_hist.back().dot(y_hist.back()) / y_hist.back().squaredNorm()
+                       : 1.0 / 70.0;
+            for (int i = 0; i < k; ++i) {
+                double beta = y_hist[i].dot(q) / y_hist[i].dot(s_hist[i]);
+                q += (a[i] - beta) * s_hist[i];
+            }
+            if (q.dot(g) <= 0.0) {
+                // Not a descent direction: restart from the scaled force
+                s_hist.clear();
+                y_hist.clear();
+                q = g / 70.0;
+            }
+            dx = -Eigen::Map<Eigen::MatrixXd>(q.data(), n, M);
+        }
+
+        dx.col(0).setZero();
+        dx.col(M - 1).setZero();
+        limit_step(dx, settings.max_step);
+        X += dx;
+    }
+
+    if (!result.converged) {
+        evaluate(1, M - 1);
+        neb_forces();
+    }
+
+    result.iterations = iter;
+    result.max_force = max_force;
+    result.climbing_image = climbing;
+    result.images.resize(M);
+    result.energies.resize(M);
+    for (int m = 0; m < M; ++m) {
+        result.images[m] = std::vector<double>(X.col(m).data(), X.col(m).data() + n);
+        result.energies[m] = E[m];
+    }
+    result.barrier = E.maxCoeff() - E[0];
+    return result;
+}
+
+} // namespace chemsim
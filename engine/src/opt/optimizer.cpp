@@ -1,23 +1,47 @@
 #include "chemsim/opt/optimizer.h"
+#include "chemsim/opt/model_hessian.h"
 #include <LBFGS.h>
 #include <cmath>
+#include <deque>
 #include <iostream>
+#include <stdexcept>
 
 namespace chemsim {
 
+// Cancellation or an exhausted time budget; sets status when either fires
+static bool interrupted(const OptSettings& settings, const Deadline& deadline,
+                        OptStatus& status) {
+    if (settings.cancel.cancelled()) {
+        status = OptStatus::cancelled;
+        return true;
+    }
+    if (deadline.expired()) {
+        status = OptStatus::timed_out;
+        return true;
+    }
+    return false;
+}
+
 // ============ Steepest Descent ============
 
-static OptResult steepest_descent(Molecule& mol, UFFForceField& ff,
+static OptResult steepest_descent(Molecule& mol, const UFFForceField& ff,
                                    const OptSettings& settings,
                                    ProgressCallback callback) {
     OptResult result;
     result.converged = false;
     result.iterations = 0;
 
+    Deadline deadline(settings.time_budget);
     double step_size = 0.01; // Initial step size in Angstroms
     double prev_energy = ff.calculate_energy(mol);
 
     for (int iter = 0; iter < settings.max_iterations; ++iter) {
+        if (interrupted(settings, deadline, result.status)) {
+            result.iterations = iter;
+            result.final_energy = prev_energy;
+            result.final_grad_norm = ff.calculate_gradient(mol).norm() / std::sqrt(mol.num_atoms());
+            return result;
+        }
         Eigen::VectorXd grad = ff.calculate_gradient(mol);
         double grad_norm = grad.norm() / std::sqrt(mol.num_atoms());
 
@@ -34,6 +58,7 @@ static OptResult steepest_descent(Molecule& mol, UFFForceField& ff,
 
         // Check convergence
         if (grad_norm < settings.grad_tolerance) {
+            result.status = OptStatus::converged;
             result.converged = true;
             result.iterations = iter;
             result.final_energy = prev_energy;
@@ -80,6 +105,7 @@ static OptResult steepest_descent(Molecule& mol, UFFForceField& ff,
         // Energy convergence check
         double energy_change = std::abs(prev_energy - result.trajectory.back().energy);
         if (iter > 0 && energy_change < settings.energy_tolerance) {
+            result.status = OptStatus::converged;
             result.converged = true;
             result.iterations = iter;
             result.final_energy = prev_energy;
@@ -96,19 +122,29 @@ static OptResult steepest_descent(Molecule& mol, UFFForceField& ff,
 
 // ============ L-BFGS ============
 
+// Thrown out of the solver when the run is cancelled or out of time
+struct OptInterrupted {};
+
 class UFFObjective {
 public:
-    UFFObjective(Molecule& mol, UFFForceField& ff,
+    UFFObjective(Molecule& mol, const UFFForceField& ff,
                  const OptSettings& settings, ProgressCallback callback)
-        : mol_(mol), ff_(ff), settings_(settings), callback_(callback), iter_(0) {}
+        : mol_(mol), ff_(ff), settings_(settings), callback_(callback), iter_(0),
+          deadline_(settings.time_budget) {}
 
     double operator()(const Eigen::VectorXd& x, Eigen::VectorXd& grad) {
+        if (interrupted(settings_, deadline_, status_)) throw OptInterrupted{};
+
         // Set positions from x
         std::vector<double> pos(x.data(), x.data() + x.size());
         mol_.set_positions(pos);
 
         double energy = ff_.calculate_energy(mol_);
-        grad = ff_.calculate_gradient(mol_);
+        ff_.calculate_gradient(mol_, grad);
+        if (best_x_.size() == 0 || energy < best_energy_) {
+            best_x_ = x;
+            best_energy_ = energy;
+        }
 
         // Report progress
         if (callback_ || settings_.store_trajectory) {
@@ -129,17 +165,24 @@ public:
 
     int iterations() const { return iter_; }
     const std::vector<OptProgress>& trajectory() const { return trajectory_; }
+    OptStatus status() const { return status_; }
+    // Lowest-energy point evaluated so far (empty before the first call)
+    const Eigen::VectorXd& best_x() const { return best_x_; }
 
 private:
     Molecule& mol_;
-    UFFForceField& ff_;
+    const UFFForceField& ff_;
     const OptSettings& settings_;
     ProgressCallback callback_;
     int iter_;
+    Deadline deadline_;
+    OptStatus status_ = OptStatus::max_iterations;
+    Eigen::VectorXd best_x_;
+    double best_energy_ = 0.0;
     std::vector<OptProgress> trajectory_;
 };
 
-static OptResult lbfgs_optimize(Molecule& mol, UFFForceField& ff,
+static OptResult lbfgs_optimize(Molecule& mol, const UFFForceField& ff,
                                  const OptSettings& settings,
                                  ProgressCallback callback) {
     LBFGSpp::LBFGSParam<double> param;
@@ -165,15 +208,29 @@ static OptResult lbfgs_optimize(Molecule& mol, UFFForceField& ff,
         std::vector<double> final_pos(x.data(), x.data() + x.size());
         mol.set_positions(final_pos);
 
-        result.converged = true;
+        // The solver also returns, without throwing, at max_iterations
+        bool at_limit = param.max_iterations > 0 && niter >= param.max_iterations;
+        result.status = at_limit ? OptStatus::max_iterations : OptStatus::converged;
+        result.converged = !at_limit;
         result.iterations = niter;
         result.final_energy = fx;
         result.final_grad_norm = ff.calculate_gradient(mol).norm() / std::sqrt(mol.num_atoms());
+    } catch (const OptInterrupted&) {
+        // Keep the best geometry evaluated; x may be an untried line-search point
+        const Eigen::VectorXd& best = objective.best_x().size() > 0 ? objective.best_x() : x;
+        mol.set_positions(std::vector<double>(best.data(), best.data() + best.size()));
+
+        result.status = objective.status();
+        result.converged = false;
+        result.iterations = objective.iterations();
+        result.final_energy = ff.calculate_energy(mol);
+        result.final_grad_norm = ff.calculate_gradient(mol).norm() / std::sqrt(mol.num_atoms());
     } catch (const std::exception& e) {
         // L-BFGS may throw on convergence failure
         std::vector<double> final_pos(x.data(), x.data() + x.size());
         mol.set_positions(final_pos);
 
+        result.status = OptStatus::line_search_failed;
         result.converged = false;
         result.iterations = objective.iterations();
         result.final_energy = ff.calculate_energy(mol);
@@ -184,16 +241,314 @@ static OptResult lbfgs_optimize(Molecule& mol, UFFForceField& ff,
     return result;
 }
 
+// ============ Truncated Newton (Newton-CG) ============
+
+static OptResult newton_cg(Molecule& mol, const UFFForceField& ff,
+                           const OptSettings& settings,
+                           ProgressCallback callback) {
+    OptResult result;
+    result.converged = false;
+    result.iterations = 0;
+
+    auto positions = mol.get_positions();
+    int n = static_cast<int>(positions.size());
+    double sqrt_atoms = std::sqrt(mol.num_atoms());
+    Eigen::VectorXd x = Eigen::Map<Eigen::VectorXd>(positions.data(), n);
+
+    Deadline deadline(settings.time_budget);
+    double energy = ff.calculate_energy(mol);
+    Eigen::VectorXd grad = ff.calculate_gradient(mol);
+
+    for (int iter = 0; iter < settings.max_iterations; ++iter) {
+        double grad_norm = grad.norm() / sqrt_atoms;
+        result.iterations = iter;
+        result.final_energy = energy;
+        result.final_grad_norm = grad_norm;
+        if (interrupted(settings, deadline, result.status)) return result;
+
+        // Report progress
+        OptProgress prog;
+        prog.iteration = iter;
+        prog.energy = energy;
+        prog.grad_norm = grad_norm;
+        if (settings.store_trajectory) {
+            prog.positions = mol.get_positions();
+        }
+        result.trajectory.push_back(prog);
+        if (callback) callback(prog);
+
+        if (grad_norm < settings.grad_tolerance) {
+            result.status = OptStatus::converged;
+            result.converged = true;
+            return result;
+        }
+
+        // Inner CG on H p = -g, truncated by the forcing term
+        // eta = min(0.5, sqrt(|g|)) so steps become exact Newton near the minimum
+        double g_norm = grad.norm();
+        double cg_tol = std::min(0.5, std::sqrt(g_norm)) * g_norm;
+        Eigen::VectorXd p = Eigen::VectorXd::Zero(n);
+        Eigen::VectorXd r = -grad;
+        Eigen::VectorXd d = r;
+        double rr = r.squaredNorm();
+
+        for (int cg = 0; cg < settings.max_cg_iterations; ++cg) {
+            if (interrupted(settings, deadline, result.status)) return result;
+            Eigen::VectorXd Hd = ff.hessian_vector_product(mol, d);
+            double curvature = d.dot(Hd);
+            if (curvature <= 1e-12 * d.squaredNorm()) {
+                // Negative curvature: keep the last descent iterate
+                if (cg == 0) p = -grad;
+                break;
+            }
+            double alpha = rr / curvature;
+            p += alpha * d;
+            r -= alpha * Hd;
+            double rr_new = r.squaredNorm();
+            if (std::sqrt(rr_new) < cg_tol) break;
+            d = r + (rr_new / rr) * d;
+            rr = rr_new;
+        }
+
+        double slope = grad.dot(p);
+        if (slope >= 0.0) {
+            p = -grad;
+            slope = -grad.squaredNorm();
+        }
+
+        // Limit the largest per-coordinate displacement to 0.3 Angstrom
+        double max_disp = p.cwiseAbs().maxCoeff();
+        if (max_disp > 0.3) {
+            p *= 0.3 / max_disp;
+            slope *= 0.3 / max_disp;
+        }
+
+        // Backtracking line search (Armijo condition)
+        double step = 1.0;
+        bool accepted = false;
+        double trial_energy = energy;
+        for (int ls = 0; ls < 30; ++ls) {
+            Eigen::VectorXd trial = x + step * p;
+            mol.set_positions(std::vector<double>(trial.data(), trial.data() + n));
+            trial_energy = ff.calculate_energy(mol);
+            if (trial_energy <= energy + 1e-4 * step * slope) {
+                x = trial;
+                accepted = true;
+                break;
+            }
+            step *= 0.5;
+        }
+
+        if (!accepted) {
+            mol.set_positions(std::vector<double>(x.data(), x.data() + n));
+            result.status = OptStatus::line_search_failed;
+            return result;
+        }
+
+        double energy_change = std::abs(energy - trial_energy);
+        energy = trial_energy;
+        grad = ff.calculate_gradient(mol);
+
+        if (energy_change < settings.energy_tolerance) {
+            result.status = OptStatus::converged;
+            result.converged = true;
+            result.iterations = iter + 1;
+            result.final_energy = energy;
+            result.final_grad_norm = grad.norm() / sqrt_atoms;
+            return result;
+        }
+    }
+
+    result.iterations = settings.max_iterations;
+    result.final_energy = energy;
+    result.final_grad_norm = grad.norm() / sqrt_atoms;
+    return result;
+}
+
+// ============ Preconditioned L-BFGS (energy providers) ============
+
+static OptResult preconditioned_lbfgs(Molecule& mol, EnergyProvider& provider,
+                                      const OptSettings& settings,
+                                      const ModelHessian* preconditioner,
+                                      ProgressCallback callback) {
+    const int memory = 10;
+    auto positions = mol.get_positions();
+    int n = static_cast<int>(positions.size());
+    double sqrt_atoms = std::sqrt(mol.num_atoms());
+    if (preconditioner && preconditioner->dimension() != n) {
+        throw std::runtime_error("optimize_geometry: preconditioner size mismatch");
+    }
+
+    auto evaluate = [&](const Eigen::VectorXd& x, Eigen::VectorXd& grad) {
+        mol.set_positions(std::vector<double>(x.data(), x.data() + n));
+        double energy = provider.evaluate(mol, grad);
+        if (grad.size() != n) throw std::runtime_error("EnergyProvider: gradient size mismatch");
+        return energy;
+    };
+    // Initial inverse Hessian: the model's, or identity without one
+    auto apply_h0 = [&](const Eigen::VectorXd& v) -> Eigen::VectorXd {
+        return preconditioner ? preconditioner->solve(v) : v;
+    };
+
+    OptResult result;
+    result.converged = false;
+    result.iterations = 0;
+
+    Deadline deadline(settings.time_budget);
+    Eigen::VectorXd x = Eigen::Map<Eigen::VectorXd>(positions.data(), n);
+    Eigen::VectorXd grad, trial_grad;
+    double energy = evaluate(x, grad);
+
+    std::deque<Eigen::VectorXd> s_hist, y_hist;
+    std::deque<double> rho_hist;
+    double gamma = 1.0;
+    double energy_change = 0.0; // of the last step; none before the first
+
+    for (int iter = 0; iter < settings.max_iterations; ++iter) {
+        double grad_norm = grad.norm() / sqrt_atoms;
+        result.iterations = iter;
+        result.final_energy = energy;
+        result.final_grad_norm = grad_norm;
+        if (interrupted(settings, deadline, result.status)) return result;
+
+        // Report progress
+        OptProgress prog;
+        prog.iteration = iter;
+        prog.energy = energy;
+        prog.grad_norm = grad_norm;
+        if (settings.store_trajectory) {
+            prog.positions = mol.get_positions();
+        }
+        result.trajectory.push_back(prog);
+        if (callback) callback(prog);
+
+        // Gradient and energy criteria jointly, so a short backtracked step
+        // cannot end the run while the gradient is still large
+        bool energy_settled = settings.energy_tolerance <= 0.0 ||
+                              energy_change < settings.energy_tolerance;
+        if (grad_norm < settings.grad_tolerance && energy_settled) {
+            result.status = OptStatus::converged;
+            result.converged = true;
+            return result;
+        }
+
+        // Two-loop recursion with H0 = gamma * P^-1
+        int k = static_cast<int>(s_hist.size());
+        std::vector<double> alpha(k);
+        Eigen::VectorXd q = grad;
+        for (int i = k - 1; i >= 0; --i) {
+            alpha[i] = rho_hist[i] * s_hist[i].dot(q);
+            q -= alpha[i] * y_hist[i];
+        }
+        Eigen::VectorXd p = gamma * apply_h0(q);
+        for (int i = 0; i < k; ++i) {
+            double beta = rho_hist[i] * y_hist[i].dot(p);
+            p += (alpha[i] - beta) * s_hist[i];
+        }
+        p = -p;
+
+        double slope = grad.dot(p);
+        if (slope >= 0.0) {
+            // Not a descent direction: drop the history
+            s_hist.clear();
+            y_hist.clear();
+            rho_hist.clear();
+            gamma = 1.0;
+            p = -apply_h0(grad);
+            slope = grad.dot(p);
+        }
+
+        // Limit the largest per-coordinate displacement to 0.3 Angstrom
+        double max_disp = p.cwiseAbs().maxCoeff();
+        if (max_disp > 0.3) {
+            p *= 0.3 / max_disp;
+            slope *= 0.3 / max_disp;
+        }
+
+        // Backtracking line search (Armijo condition); the unit step is
+        // usually taken, so expensive providers see one call per iteration
+        double step = 1.0;
+        bool accepted = false;
+        Eigen::VectorXd trial;
+        double trial_energy = energy;
+        for (int ls = 0; ls < 10; ++ls) {
+            if (interrupted(settings, deadline, result.status)) {
+                mol.set_positions(std::vector<double>(x.data(), x.data() + n));
+                return result;
+            }
+            trial = x + step * p;
+            trial_energy = evaluate(trial, trial_grad);
+            if (trial_energy <= energy + 1e-4 * step * slope) {
+                accepted = true;
+                break;
+            }
+            step *= 0.5;
+        }
+
+        if (!accepted) {
+            mol.set_positions(std::vector<double>(x.data(), x.data() + n));
+            if (!s_hist.empty()) {
+                // Retry from the preconditioned gradient alone
+                s_hist.clear();
+                y_hist.clear();
+                rho_hist.clear();
+                gamma = 1.0;
+                continue;
+            }
+            result.status = OptStatus::line_search_failed;
+            return result;
+        }
+
+        // Curvature pair; skipped when s'y is not safely positive
+        Eigen::VectorXd s_vec = trial - x;
+        Eigen::VectorXd y_vec = trial_grad - grad;
+        double sy = s_vec.dot(y_vec);
+        if (sy > 1e-10 * s_vec.norm() * y_vec.norm()) {
+            if (static_cast<int>(s_hist.size()) == memory) {
+                s_hist.pop_front();
+                y_hist.pop_front();
+                rho_hist.pop_front();
+            }
+            gamma = sy / y_vec.dot(apply_h0(y_vec));
+            s_hist.push_back(std::move(s_vec));
+            y_hist.push_back(std::move(y_vec));
+            rho_hist.push_back(1.0 / sy);
+        }
+
+        energy_change = std::abs(energy - trial_energy);
+        x = trial;
+        energy = trial_energy;
+        grad.swap(trial_grad);
+    }
+
+    result.iterations = settings.max_iterations;
+    result.final_energy = energy;
+    result.final_grad_norm = grad.norm() / sqrt_atoms;
+    return result;
+}
+
 // ============ Public Interface ============
 
-OptResult optimize_geometry(Molecule& mol, UFFForceField& ff,
+OptResult optimize_geometry(Molecule& mol, const UFFForceField& ff,
                             const OptSettings& settings,
                             ProgressCallback callback) {
     if (settings.method == "steepest_descent") {
         return steepest_descent(mol, ff, settings, callback);
+    } else if (settings.method == "newton_cg") {
+        return newton_cg(mol, ff, settings, callback);
     } else {
         return lbfgs_optimize(mol, ff, settings, callback);
     }
 }
 
+OptResult optimize_geometry(Molecule& mol, EnergyProvider& provider,
+                            const OptSettings& settings,
+                            const ModelHessian* preconditioner,
+                            ProgressCallback callback) {
+    if (settings.method != "lbfgs") {
+        throw std::runtime_error("optimize_geometry: energy providers support lbfgs only");
+    }
+    return preconditioned_lbfgs(mol, provider, settings, preconditioner, callback);
+}
+
 } // namespace chemsim
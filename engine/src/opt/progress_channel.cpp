@@ -0,0 +1,36 @@
+#include "chemsim/opt/progress_channel.h"
+#include <stdexcept>
+
+namespace chemsim {
+
+ProgressChannel::ProgressChannel(size_t capacity, int decimation)
+    : ring_(capacity), decimation_(decimation) {
+    if (decimation < 1) throw std::runtime_error("ProgressChannel: decimation must be >= 1");
+}
+
+void ProgressChannel::publish(const OptProgress& progress) {
+    if (seen_++ % static_cast<uint64_t>(decimation_) != 0) return;
+    ring_.push(progress);
+    published_.fetch_add(1, std::memory_order_relaxed);
+    notifier_.notify();
+}
+
+ProgressCallback ProgressChannel::callback() {
+    return [this](const OptProgress& progress) { publish(progress); };
+}
+
+std::vector<OptProgress> ProgressChannel::drain(size_t max_records) {
+    // Clear the wakeup before popping, so a record published meanwhile
+    // signals again
+    notifier_.drain();
+    std::vector<OptProgress> records;
+    OptProgress record;
+    while (records.size() < max_records && ring_.pop(record)) {
+        records.push_back(std::move(record));
+    }
+    // Records left behind by max_records still need a wakeup
+    if (ring_.size() > 0) notifier_.notify();
+    return records;
+}
+
+} // namespace chemsim
@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include "chemsim/io/xyz_parser.h"
+#include "chemsim/ff/uff_energy.h"
+#include "chemsim/conf/conformer_search.h"
+#include "chemsim/analysis/rmsd.h"
+#include "chemsim/analysis/clustering.h"
+#include <random>
+
+using namespace chemsim;
+
+static std::string read_file(const std::string& path) {
+    std::ifstream f(path);
+    if (!f.is_open()) throw std::runtime_error("Cannot open: " + path);
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+TEST(RMSD, RigidMotionIsZero) {
+    auto mol = parse_xyz(read_file("data/test_molecules/ethanol.xyz"));
+    auto a = mol.get_positions();
+
+    // Rotate 90 degrees about z and translate
+    std::vector<double> b(a.size());
+    for (size_t i = 0; i < a.size(); i += 3) {
+        b[i] = -a[i + 1] + 3.0;
+        b[i + 1] = a[i] - 1.0;
+        b[i + 2] = a[i + 2] + 0.5;
+    }
+    EXPECT_NEAR(kabsch_rmsd(a, b), 0.0, 1e-8);
+
+    b[0] += 0.3;
+    EXPECT_GT(kabsch_rmsd(a, b), 0.01);
+    EXPECT_NEAR(kabsch_rmsd(a, b, {1, 2, 3}), 0.0, 1e-8);
+}
+
+// Random rigid motion plus optional Gaussian noise on every coordinate
+static std::vector<double> perturb(const std::vector<double>& a, std::mt19937& rng, double noise) {
+    std::normal_distribution<double> gauss(0.0, 1.0);
+    Eigen::Vector3d axis(gauss(rng), gauss(rng), gauss(rng));
+    Eigen::Matrix3d R = Eigen::AngleAxisd(gauss(rng), axis.normalized()).toRotationMatrix();
+    Eigen::Vector3d t(gauss(rng), gauss(rng), gauss(rng));
+    std::vector<double> b(a.size());
+    for (size_t i = 0; i < a.size(); i += 3) {
+        Eigen::Vector3d p = R * Eigen::Vector3d(a[i], a[i + 1], a[i + 2]) + t;
+        for (int k = 0; k < 3; ++k) b[i + k] = p[k] + noise * gauss(rng);
+    }
+    return b;
+}
+
+TEST(RMSD, MatrixMatchesKabsch) {
+    auto a = parse_xyz(read_file("data/test_molecules/ethanol.xyz")).get_positions();
+    std::mt19937 rng(7);
+    std::vector<std::vector<double>> frames;
+    for (int f = 0; f < 12; ++f) frames.push_back(perturb(a, rng, 0.2));
+
+    RMSDSettings settings;
+    settings.num_threads = 3;
+    auto matrix = rmsd_matrix(frames, settings);
+    ASSERT_EQ(matrix.size(), 12u * 11u / 2u);
+    for (size_t i = 0; i < frames.size(); ++i) {
+        for (size_t j = i + 1; j < frames.size(); ++j) {
+            EXPECT_NEAR(matrix[condensed_index(i, j, frames.size())],
+                        kabsch_rmsd(frames[i], frames[j]), 1e-5);
+        }
+    }
+
+    settings.atoms = {0, 1, 2};
+    matrix = rmsd_matrix(frames, settings);
+    EXPECT_NEAR(matrix[condensed_index(2, 5, frames.size())],
+                kabsch_rmsd(frames[2], frames[5], {0, 1, 2}), 1e-5);
+}
+
+TEST(RMSD, SymmetryAwareMapping) {
+    auto mol = parse_xyz(read_file("data/test_molecules/benzene.xyz"));
+    std::vector<int> carbons;
+    for (int i = 0; i < mol.num_atoms(); ++i) {
+        if (mol.atom(i).atomic_number == 6) carbons.push_back(i);
+    }
+    // D6h ring: six rotations times two reflections
+    auto perms = find_automorphisms(mol, carbons);
+    ASSERT_EQ(perms.size(), 12u);
+    for (int p = 0; p < 6; ++p) EXPECT_EQ(perms[0][p], p);
+    EXPECT_EQ(find_automorphisms(mol).size(), 12u);
+
+    // Ethanol has no heavy-atom symmetry; the methyl hydrogens permute
+    auto ethanol = parse_xyz(read_file("data/test_molecules/ethanol.xyz"));
+    auto all = find_automorphisms(ethanol);
+    EXPECT_EQ(all.size(), 12u);
+
+    // Swapping two methyl hydrogens is not a rigid motion, but it is
+    // invisible to the symmetry-aware RMSD
+    std::vector<int> methyl_h;
+    for (int c = 0; c < ethanol.num_atoms() && methyl_h.empty(); ++c) {
+        std::vector<int> h;
+        for (int n : ethanol.bonded_to(c)) {
+            if (ethanol.atom(n).atomic_number == 1) h.push_back(n);
+        }
+        if (h.size() == 3) methyl_h = h;
+    }
+    ASSERT_EQ(methyl_h.size(), 3u);
+    auto a = ethanol.get_positions();
+    std::mt19937 rng(3);
+    auto b = perturb(a, rng, 0.0);
+    for (int k = 0; k < 3; ++k) std::swap(b[3*methyl_h[0] + k], b[3*methyl_h[1] + k]);
+    RMSDFrames frames({a, b}, {});
+    EXPECT_GT(frames.rmsd(0, 1, {}), 0.3);
+    EXPECT_NEAR(frames.rmsd(0, 1, all), 0.0, 1e-6);
+}
+
+TEST(Clustering, ButinaAndLeaderRecoverGroups) {
+    auto butane = parse_xyz(read_file("data/test_molecules/butane.xyz")).get_positions();
+    std::mt19937 rng(11);
+    // Two well-separated shapes: the input and a stretched copy
+    std::vector<double> stretched = butane;
+    for (size_t i = 0; i < stretched.size(); i += 3) stretched[i] *= 1.5;
+
+    std::vector<std::vector<double>> frames;
+    std::vector<int> truth;
+    for (int f = 0; f < 20; ++f) {
+        bool second = f % 3 == 0;
+        frames.push_back(perturb(second ? stretched : butane, rng, 0.02));
+        truth.push_back(second);
+    }
+
+    for (const auto& result : {butina_cluster(frames, 0.3), leader_cluster(frames, 0.3)}) {
+        ASSERT_EQ(result.centroids.size(), 2u);
+        ASSERT_EQ(result.assignments.size(), frames.size());
+        EXPECT_EQ(result.sizes[0] + result.sizes[1], 20);
+        for (size_t f = 0; f < frames.size(); ++f) {
+            int c = result.assignments[f];
+            EXPECT_EQ(truth[f], truth[result.centroids[c]]);
+        }
+    }
+    // Butina picks the most populated cluster first
+    auto butina = butina_cluster(frames, 0.3);
+    EXPECT_GE(butina.sizes[0], butina.sizes[1]);
+}
+
+TEST(ConformerSearch, RotatableBonds) {
+    auto butane = parse_xyz(read_file("data/test_molecules/butane.xyz"));
+    auto rotors = find_rotatable_bonds(butane);
+    // Only the central C-C bond; methyl rotors are symmetric
+    ASSERT_EQ(rotors.size(), 1u);
+    int i = std::min(rotors[0].atom_i, rotors[0].atom_j);
+    int j = std::max(rotors[0].atom_i, rotors[0].atom_j);
+    EXPECT_EQ(i, 1);
+    EXPECT_EQ(j, 2);
+
+    auto benzene = parse_xyz(read_file("data/test_molecules/benzene.xyz"));
+    EXPECT_TRUE(find_rotatable_bonds(benzene).empty());
+}
+
+TEST(ConformerSearch, ButaneAntiAndGauche) {
+    auto mol = parse_xyz(read_file("data/test_molecules/butane.xyz"));
+    UFFForceField ff;
+    ff.setup(mol);
+
+    ConformerSearchSettings settings;
+    settings.torsion_step = 120.0;
+    settings.rmsd_threshold = 0.1;
+    settings.num_threads = 2;
+
+    auto ensemble = search_conformers(mol, ff, settings);
+
+    // Anti plus the two gauche mirror images
+    ASSERT_GE(ensemble.size(), 2u);
+    EXPECT_DOUBLE_EQ(ensemble[0].relative_energy, 0.0);
+    for (size_t c = 1; c < ensemble.size(); ++c) {
+        EXPECT_GE(ensemble[c].energy, ensemble[c - 1].energy);
+        EXPECT_LE(ensemble[c].relative_energy, settings.energy_window);
+        EXPECT_EQ(ensemble[c].positions.size(), 3u * mol.num_atoms());
+    }
+}
+
+TEST(ConformerSearch, RandomIsReproducible) {
+    auto mol = parse_xyz(read_file("data/test_molecules/butane.xyz"));
+    UFFForceField ff;
+    ff.setup(mol);
+
+    ConformerSearchSettings settings;
+    settings.method = "random";
+    settings.max_candidates = 12;
+    settings.seed = 7;
+
+    auto a = search_conformers(mol, ff, settings);
+    auto b = search_conformers(mol, ff, settings);
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t c = 0; c < a.size(); ++c) {
+        EXPECT_DOUBLE_EQ(a[c].energy, b[c].energy);
+    }
+}
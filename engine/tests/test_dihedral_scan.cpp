@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include "chemsim/io/xyz_parser.h"
+#include "chemsim/core/geometry.h"
+#include "chemsim/ff/uff_energy.h"
+#include "chemsim/opt/dihedral_scan.h"
+
+using namespace chemsim;
+
+static std::string read_file(const std::string& path) {
+    std::ifstream f(path);
+    if (!f.is_open()) throw std::runtime_error("Cannot open: " + path);
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+static double angle_diff(double a, double b) {
+    double d = std::fmod(a - b + 540.0, 360.0) - 180.0;
+    return std::abs(d);
+}
+
+TEST(Geometry, SetDihedral) {
+    auto mol = parse_xyz(read_file("data/test_molecules/butane.xyz"));
+    EXPECT_NEAR(std::abs(dihedral_angle(mol, 0, 1, 2, 3)), 180.0, 1e-3);
+
+    set_dihedral(mol, 0, 1, 2, 3, 60.0);
+    EXPECT_NEAR(dihedral_angle(mol, 0, 1, 2, 3), 60.0, 1e-6);
+    // Bond lengths are untouched by the rigid rotation
+    EXPECT_NEAR((mol.atom(2).position - mol.atom(3).position).norm(), 1.53, 1e-3);
+
+    auto benzene = parse_xyz(read_file("data/test_molecules/benzene.xyz"));
+    EXPECT_THROW(set_dihedral(benzene, 0, 1, 2, 3, 30.0), std::runtime_error);
+}
+
+TEST(DihedralScan, Butane1D) {
+    auto mol = parse_xyz(read_file("data/test_molecules/butane.xyz"));
+    UFFForceField ff;
+    ff.setup(mol);
+
+    ScanDihedral dihedral{0, 1, 2, 3, -180.0, 60.0, 6};
+    ScanSettings settings;
+    settings.store_geometries = true;
+
+    auto result = relaxed_scan(mol, ff, dihedral, settings);
+    ASSERT_EQ(result.energies.size(), 6u);
+    ASSERT_EQ(result.geometries.size(), 6u);
+    EXPECT_TRUE(result.angles2.empty());
+
+    // Anti (-180) is the global minimum, eclipsed (0) the maximum
+    for (size_t p = 1; p < result.energies.size(); ++p) {
+        EXPECT_GT(result.energies[p], result.energies[0]);
+        EXPECT_LE(result.energies[p], result.energies[3] + 1e-8);
+    }
+
+    // Restraints hold each point near its target
+    Molecule check = mol;
+    for (size_t p = 0; p < result.geometries.size(); ++p) {
+        check.set_positions(result.geometries[p]);
+        EXPECT_LT(angle_diff(dihedral_angle(check, 0, 1, 2, 3), result.angles1[p]), 2.0);
+    }
+}
+
+TEST(DihedralScan, Butane2D) {
+    auto mol = parse_xyz(read_file("data/test_molecules/butane.xyz"));
+    UFFForceField ff;
+    ff.setup(mol);
+
+    ScanDihedral backbone{0, 1, 2, 3, -180.0, 120.0, 3};
+    ScanDihedral methyl{4, 0, 1, 2, 60.0, 60.0, 2};
+    ScanSettings settings;
+    settings.store_geometries = true;
+    settings.num_threads = 2;
+
+    auto result = relaxed_scan_2d(mol, ff, backbone, methyl, settings);
+    ASSERT_EQ(result.angles1.size(), 3u);
+    ASSERT_EQ(result.angles2.size(), 2u);
+    ASSERT_EQ(result.energies.size(), 6u);
+
+    Molecule check = mol;
+    for (size_t a = 0; a < 3; ++a) {
+        for (size_t b = 0; b < 2; ++b) {
+            size_t p = a * 2 + b;
+            EXPECT_TRUE(std::isfinite(result.energies[p]));
+            check.set_positions(result.geometries[p]);
+            EXPECT_LT(angle_diff(dihedral_angle(check, 0, 1, 2, 3), result.angles1[a]), 2.0);
+            EXPECT_LT(angle_diff(dihedral_angle(check, 4, 0, 1, 2), result.angles2[b]), 2.0);
+        }
+    }
+}
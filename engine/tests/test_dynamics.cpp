@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include "chemsim/io/xyz_parser.h"
+#include "chemsim/ff/uff_energy.h"
+#include "chemsim/opt/optimizer.h"
+#include "chemsim/md/dynamics.h"
+
+using namespace chemsim;
+
+static std::string read_file(const std::string& path) {
+    std::ifstream f(path);
+    if (!f.is_open()) throw std::runtime_error("Cannot open: " + path);
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+TEST(Dynamics, NVEConservesEnergy) {
+    auto mol = parse_xyz(read_file("data/test_molecules/ethanol.xyz"));
+    UFFForceField ff;
+    ff.setup(mol);
+
+    MDSettings settings;
+    settings.num_steps = 1000;
+    settings.timestep = 0.25;
+    settings.temperature = 100.0;
+    settings.output_interval = 50;
+
+    auto result = run_dynamics(mol, ff, settings);
+    ASSERT_EQ(result.trajectory.size(), 21u);
+
+    double e0 = result.trajectory.front().potential_energy +
+                result.trajectory.front().kinetic_energy;
+    for (const auto& frame : result.trajectory) {
+        double e = frame.potential_energy + frame.kinetic_energy;
+        EXPECT_NEAR(e, e0, 0.5) << "step " << frame.step;
+    }
+    EXPECT_NEAR(result.trajectory.front().temperature, 100.0, 1e-6);
+}
+
+TEST(Dynamics, LangevinHoldsTemperature) {
+    auto mol = parse_xyz(read_file("data/test_molecules/benzene.xyz"));
+    UFFForceField ff;
+    ff.setup(mol);
+
+    MDSettings settings;
+    settings.num_steps = 4000;
+    settings.timestep = 0.5;
+    settings.temperature = 300.0;
+    settings.thermostat = "langevin";
+    settings.friction = 10.0;
+    settings.output_interval = 10;
+
+    auto result = run_dynamics(mol, ff, settings);
+
+    double t_sum = 0.0;
+    int count = 0;
+    for (size_t f = result.trajectory.size() / 2; f < result.trajectory.size(); ++f) {
+        t_sum += result.trajectory[f].temperature;
+        count++;
+    }
+    EXPECT_NEAR(t_sum / count, 300.0, 60.0);
+}
+
+TEST(Dynamics, NoseHooverHoldsTemperature) {
+    auto mol = parse_xyz(read_file("data/test_molecules/benzene.xyz"));
+    UFFForceField ff;
+    ff.setup(mol);
+
+    MDSettings settings;
+    settings.num_steps = 4000;
+    settings.timestep = 0.5;
+    settings.temperature = 300.0;
+    settings.thermostat = "nose_hoover";
+    settings.thermostat_period = 50.0;
+    settings.output_interval = 10;
+
+    auto result = run_dynamics(mol, ff, settings);
+
+    double t_sum = 0.0;
+    int count = 0;
+    for (size_t f = result.trajectory.size() / 2; f < result.trajectory.size(); ++f) {
+        t_sum += result.trajectory[f].temperature;
+        count++;
+    }
+    EXPECT_NEAR(t_sum / count, 300.0, 60.0);
+}
+
+TEST(Dynamics, CallbackOnOutputFramesOnly) {
+    auto mol = parse_xyz(read_file("data/test_molecules/water.xyz"));
+    UFFForceField ff;
+    ff.setup(mol);
+
+    std::vector<int> steps;
+    auto callback = [&steps](const MDFrame& frame) {
+        steps.push_back(frame.step);
+        EXPECT_TRUE(std::isfinite(frame.potential_energy));
+    };
+
+    MDSettings settings;
+    settings.num_steps = 55;
+    settings.timestep = 0.5;
+    settings.output_interval = 10;
+    settings.store_trajectory = false;
+
+    auto result = run_dynamics(mol, ff, settings, callback);
+
+    ASSERT_EQ(steps.size(), 6u);
+    for (size_t i = 0; i < steps.size(); ++i) EXPECT_EQ(steps[i], 10 * static_cast<int>(i));
+    EXPECT_TRUE(result.trajectory.empty());
+    EXPECT_EQ(result.steps, 55);
+    EXPECT_GT(result.steps_per_second, 0.0);
+    EXPECT_GT(result.ns_per_day, 0.0);
+}
+
+TEST(Dynamics, InvalidThermostat) {
+    auto mol = parse_xyz(read_file("data/test_molecules/water.xyz"));
+    UFFForceField ff;
+    ff.setup(mol);
+
+    MDSettings settings;
+    settings.thermostat = "berendsen";
+    EXPECT_THROW(run_dynamics(mol, ff, settings), std::runtime_error);
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include "chemsim/io/xyz_parser.h"
+#include "chemsim/ff/uff_energy.h"
+#include "chemsim/opt/optimizer.h"
+#include "chemsim/conf/embedding.h"
+
+using namespace chemsim;
+
+static std::string read_file(const std::string& path) {
+    std::ifstream f(path);
+    if (!f.is_open()) throw std::runtime_error("Cannot open: " + path);
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+// Minimized energy of the reference geometry
+static double reference_energy(Molecule mol, const UFFForceField& ff) {
+    OptSettings settings;
+    settings.store_trajectory = false;
+    return optimize_geometry(mol, ff, settings).final_energy;
+}
+
+TEST(Embedding, SmoothedBoundsAreConsistent) {
+    Molecule mol = parse_xyz(read_file("data/test_molecules/ethanol.xyz"));
+    UFFForceField ff;
+    ff.setup(mol);
+
+    Eigen::MatrixXd bounds = distance_bounds(mol, ff);
+    ASSERT_TRUE(smooth_bounds(bounds));
+    for (int i = 0; i < mol.num_atoms(); ++i) {
+        for (int j = i + 1; j < mol.num_atoms(); ++j) {
+            EXPECT_LE(bounds(j, i), bounds(i, j));
+            EXPECT_GT(bounds(j, i), 0.0);
+        }
+    }
+
+    Eigen::MatrixXd bad = Eigen::MatrixXd::Zero(3, 3);
+    bad(0, 1) = bad(1, 2) = 1.0;   // upper bounds
+    bad(1, 0) = bad(2, 1) = 0.9;   // lower bounds
+    bad(0, 2) = 10.0;
+    bad(2, 0) = 5.0;               // unreachable through atom 1
+    EXPECT_FALSE(smooth_bounds(bad));
+}
+
+TEST(Embedding, EthanolFromConnectivity) {
+    Molecule mol = parse_xyz(read_file("data/test_molecules/ethanol.xyz"));
+    UFFForceField ff;
+    ff.setup(mol);
+    double reference = reference_energy(mol, ff);
+
+    // Discard the input geometry entirely
+    Molecule flat = mol;
+    flat.set_positions(std::vector<double>(3 * mol.num_atoms(), 0.0));
+
+    EmbedSettings settings;
+    settings.num_embeddings = 4;
+    auto confs = embed_molecule(flat, ff, settings);
+    ASSERT_EQ(confs.size(), 4u);
+
+    double best = confs[0].energy;
+    for (const auto& c : confs) best = std::min(best, c.energy);
+    EXPECT_NEAR(best, reference, 1.0);
+
+    Molecule embedded = mol;
+    embedded.set_positions(confs[0].positions);
+    for (const auto& bond : mol.bonds()) {
+        double d = (embedded.atom(bond.atom_i).position - embedded.atom(bond.atom_j).position).norm();
+        double d_ref = (mol.atom(bond.atom_i).position - mol.atom(bond.atom_j).position).norm();
+        EXPECT_NEAR(d, d_ref, 0.1);
+    }
+}
+
+TEST(Embedding, ReproducibleAcrossThreadCounts) {
+    Molecule mol = parse_xyz(read_file("data/test_molecules/benzene.xyz"));
+    UFFForceField ff;
+    ff.setup(mol);
+    double reference = reference_energy(mol, ff);
+
+    EmbedSettings settings;
+    settings.num_embeddings = 3;
+    settings.num_threads = 1;
+    auto serial = embed_molecule(mol, ff, settings);
+    settings.num_threads = 3;
+    auto parallel = embed_molecule(mol, ff, settings);
+
+    for (int k = 0; k < 3; ++k) {
+        EXPECT_EQ(serial[k].positions, parallel[k].positions);
+        EXPECT_NEAR(serial[k].energy, reference, 1.0);
+    }
+}
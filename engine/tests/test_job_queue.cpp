@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <poll.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "chemsim/core/job_queue.h"
+
+using namespace chemsim;
+
+static bool readable(int fd, int timeout_ms) {
+    pollfd p{fd, POLLIN, 0};
+    return ::poll(&p, 1, timeout_ms) == 1 && (p.revents & POLLIN);
+}
+
+TEST(JobQueue, CompletionsSignalDescriptor) {
+    JobQueue queue(4);
+    EXPECT_FALSE(readable(queue.completion_fd(), 0));
+
+    std::atomic<int> sum{0};
+    std::vector<uint64_t> ids;
+    for (int i = 1; i <= 20; ++i) {
+        ids.push_back(queue.submit([&sum, i]() { sum += i; }));
+    }
+    ids.push_back(queue.submit([]() { throw std::runtime_error("job failed"); }));
+
+    // Wait on the descriptor the way an event loop would
+    std::vector<JobQueue::Completion> done;
+    while (done.size() < ids.size()) {
+        ASSERT_TRUE(readable(queue.completion_fd(), 5000));
+        for (auto& c : queue.take_completed()) done.push_back(std::move(c));
+    }
+    EXPECT_EQ(queue.pending(), 0u);
+    EXPECT_EQ(sum.load(), 210);
+    EXPECT_FALSE(readable(queue.completion_fd(), 0));
+
+    std::vector<uint64_t> seen;
+    for (const auto& c : done) {
+        seen.push_back(c.id);
+        if (c.id == ids.back()) {
+            ASSERT_TRUE(c.error);
+            EXPECT_THROW(std::rethrow_exception(c.error), std::runtime_error);
+        } else {
+            EXPECT_FALSE(c.error);
+        }
+    }
+    std::sort(seen.begin(), seen.end());
+    EXPECT_EQ(seen, ids);
+}
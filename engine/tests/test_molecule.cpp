@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
+#include <random>
 #include "chemsim/core/molecule.h"
+#include "chemsim/core/element_data.h"
 
 using namespace chemsim;
 
@@ -26,6 +28,47 @@ TEST(Molecule, PerceiveBonds) {
     EXPECT_EQ(mol.degree(1), 1);    // H has 1 bond
 }
 
+// All-pairs reference for the cell-list perception
+static std::vector<std::pair<int,int>> brute_force_bonds(const Molecule& mol, double tolerance) {
+    std::vector<std::pair<int,int>> bonds;
+    for (int i = 0; i < mol.num_atoms(); ++i) {
+        for (int j = i + 1; j < mol.num_atoms(); ++j) {
+            double dist = (mol.atom(i).position - mol.atom(j).position).norm();
+            double ri = element_by_number(mol.atom(i).atomic_number).covalent_radius;
+            double rj = element_by_number(mol.atom(j).atomic_number).covalent_radius;
+            if (dist >= 0.4 && dist <= ri + rj + tolerance) bonds.emplace_back(i, j);
+        }
+    }
+    return bonds;
+}
+
+TEST(Molecule, PerceiveBondsMatchesAllPairs) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> coord(0.0, 22.0);
+    const int elements[] = {1, 6, 7, 8, 16};
+
+    Molecule mol;
+    for (int i = 0; i < 3000; ++i) {
+        int z = elements[i % 5];
+        mol.add_atom(Atom(z, element_by_number(z).symbol,
+                          Eigen::Vector3d(coord(rng), coord(rng), coord(rng))));
+    }
+    // A distant pair exercises the sparse-box path
+    mol.add_atom(Atom(6, "C", Eigen::Vector3d(5000.0, 0.0, 0.0)));
+    mol.add_atom(Atom(6, "C", Eigen::Vector3d(5001.5, 0.0, 0.0)));
+
+    auto expected = brute_force_bonds(mol, 0.45);
+    ASSERT_GT(expected.size(), 1000u);
+    for (int threads : {1, 4}) {
+        mol.perceive_bonds(0.45, threads);
+        ASSERT_EQ(mol.num_bonds(), static_cast<int>(expected.size()));
+        for (int b = 0; b < mol.num_bonds(); ++b) {
+            EXPECT_EQ(mol.bond(b).atom_i, expected[b].first);
+            EXPECT_EQ(mol.bond(b).atom_j, expected[b].second);
+        }
+    }
+}
+
 TEST(Molecule, GetSetPositions) {
     Molecule mol;
     mol.add_atom(Atom(6, "C", Eigen::Vector3d(0, 0, 0)));
@@ -40,6 +83,40 @@ TEST(Molecule, GetSetPositions) {
     EXPECT_DOUBLE_EQ(mol.atom(1).position.x(), 2.0);
 }
 
+TEST(Molecule, ContiguousCoordinates) {
+    Molecule mol;
+    mol.add_atom(Atom(6, "C", Eigen::Vector3d(0, 0, 0)));
+    mol.add_atom(Atom(1, "H", Eigen::Vector3d(1, 2, 3)));
+
+    // atom(i).position aliases the flat buffer
+    double* xyz = mol.coordinates();
+    EXPECT_EQ(mol.atom(1).position.data(), xyz + 3);
+    xyz[4] = 5.0;
+    EXPECT_DOUBLE_EQ(mol.atom(1).position.y(), 5.0);
+    mol.atom(0).position += Eigen::Vector3d(0.5, 0, 0);
+    EXPECT_DOUBLE_EQ(xyz[0], 0.5);
+
+    // A shared buffer tracks the molecule until atoms are added, then
+    // keeps the old coordinates alive instead of dangling
+    auto shared = mol.share_coordinates();
+    mol.atom(1).position.z() = 7.0;
+    EXPECT_DOUBLE_EQ(shared.get()[5], 7.0);
+    mol.add_atom(Atom(1, "H", Eigen::Vector3d(-1, 0, 0)));
+    EXPECT_NE(mol.coordinates(), shared.get());
+    EXPECT_DOUBLE_EQ(mol.atom(1).position.z(), 7.0);
+    mol.atom(1).position.z() = 9.0;
+    EXPECT_DOUBLE_EQ(shared.get()[5], 7.0);
+
+    // Copies are deep
+    Molecule copy = mol;
+    copy.atom(0).position.x() = -1.0;
+    EXPECT_DOUBLE_EQ(mol.atom(0).position.x(), 0.5);
+    Atom detached = mol.atom(2);
+    detached.position.x() = 4.0;
+    EXPECT_DOUBLE_EQ(mol.atom(2).position.x(), -1.0);
+    EXPECT_EQ(detached.symbol, "H");
+}
+
 TEST(Molecule, Adjacency) {
     Molecule mol;
     mol.add_atom(Atom(8, "O", Eigen::Vector3d(0, 0, 0)));
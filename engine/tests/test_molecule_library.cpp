@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include "chemsim/io/molecule_library.h"
+#include "chemsim/io/xyz_parser.h"
+#include "chemsim/ff/uff_terms.h"
+#include "chemsim/ff/uff_typing.h"
+
+using namespace chemsim;
+
+static std::string read_file(const std::string& path) {
+    std::ifstream f(path);
+    if (!f.is_open()) throw std::runtime_error("Cannot open: " + path);
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+TEST(MoleculeLibrary, RoundTrip) {
+    std::vector<Molecule> mols;
+    for (const char* name : {"water", "ethanol", "benzene", "butane"}) {
+        mols.push_back(parse_xyz(read_file(std::string("data/test_molecules/") + name + ".xyz")));
+        mols.back().name = name;
+    }
+    mols[0].atom(0).formal_charge = -1;
+
+    LibraryOptions options;
+    options.atom_types = true;
+    LibraryBuilder builder(options);
+    builder.add(mols[0]);
+    builder.add(std::vector<Molecule>(mols.begin() + 1, mols.end()));
+    ASSERT_EQ(builder.size(), 4u);
+
+    std::string path = testing::TempDir() + "chemsim_roundtrip.cslib";
+    builder.write(path);
+    auto lib = MoleculeLibrary::open(path);
+    ASSERT_EQ(lib.size(), 4u);
+    EXPECT_TRUE(lib.has_topology_hashes());
+    EXPECT_TRUE(lib.has_atom_types());
+
+    for (size_t m = 0; m < mols.size(); ++m) {
+        MoleculeView view = lib[m];
+        const Molecule& mol = mols[m];
+        EXPECT_EQ(view.name(), mol.name);
+        ASSERT_EQ(view.num_atoms(), mol.num_atoms());
+        ASSERT_EQ(view.num_bonds(), mol.num_bonds());
+        EXPECT_EQ(view.topology_hash(), topology_hash(mol));
+
+        auto types = assign_uff_types(mol);
+        for (int i = 0; i < mol.num_atoms(); ++i) {
+            EXPECT_EQ(view.atomic_number(i), mol.atom(i).atomic_number);
+            EXPECT_EQ(view.formal_charge(i), mol.atom(i).formal_charge);
+            EXPECT_EQ(view.position(i), mol.atom(i).position);
+            EXPECT_EQ(view.atom_type(i), types[i]);
+        }
+        for (int b = 0; b < mol.num_bonds(); ++b) {
+            EXPECT_EQ(view.bond(b).atom_i, mol.bond(b).atom_i);
+            EXPECT_EQ(view.bond(b).atom_j, mol.bond(b).atom_j);
+            EXPECT_EQ(view.bond(b).order, mol.bond(b).order);
+        }
+        auto copy = lib.molecule(m);
+        EXPECT_EQ(copy.get_positions(), mol.get_positions());
+        EXPECT_EQ(topology_hash(copy), topology_hash(mol));
+    }
+    EXPECT_THROW(lib.view(4), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(MoleculeLibrary, ConvertAndValidate) {
+    std::string xyz_path = testing::TempDir() + "chemsim_frames.xyz";
+    std::string lib_path = testing::TempDir() + "chemsim_frames.cslib";
+    std::string ethanol = read_file("data/test_molecules/ethanol.xyz");
+    {
+        std::ofstream out(xyz_path);
+        for (int f = 0; f < 10; ++f) out << ethanol;
+    }
+    LibraryOptions options;
+    options.topology_hashes = false;
+    EXPECT_EQ(convert_to_library(xyz_path, lib_path, options), 10u);
+
+    auto lib = MoleculeLibrary::open(lib_path);
+    ASSERT_EQ(lib.size(), 10u);
+    EXPECT_FALSE(lib.has_topology_hashes());
+    EXPECT_FALSE(lib.has_atom_types());
+    EXPECT_EQ(lib[9].num_bonds(), parse_xyz(ethanol).num_bonds());
+    EXPECT_THROW(lib[0].atom_type(0), std::runtime_error);
+
+    // Truncated and foreign files are rejected
+    std::string bytes = read_file(lib_path);
+    {
+        std::ofstream out(lib_path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), bytes.size() - 8);
+    }
+    EXPECT_THROW(MoleculeLibrary::open(lib_path), std::runtime_error);
+    EXPECT_THROW(MoleculeLibrary::open(xyz_path), std::runtime_error);
+    EXPECT_THROW(convert_to_library(lib_path, xyz_path + ".out"), std::runtime_error);
+
+    std::remove(xyz_path.c_str());
+    std::remove(lib_path.c_str());
+}
+
+TEST(MoleculeLibrary, RejectsCorruptColumns) {
+    std::string lib_path = testing::TempDir() + "chemsim_corrupt.cslib";
+    LibraryBuilder builder;
+    builder.add(parse_xyz(read_file("data/test_molecules/water.xyz")));
+    builder.write(lib_path);
+    const std::string good = read_file(lib_path);
+    auto rewrite = [&](const std::string& bytes) {
+        std::ofstream out(lib_path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), bytes.size());
+    };
+
+    // Element column (O, H, H) with an atomic number past the table
+    std::string bytes = good;
+    size_t at = bytes.find(std::string("\x08\x01\x01", 3));
+    ASSERT_NE(at, std::string::npos);
+    bytes[at] = static_cast<char>(200);
+    rewrite(bytes);
+    EXPECT_THROW(MoleculeLibrary::open(lib_path), std::runtime_error);
+
+    // Bond column (0-1, 0-2) pointing past the molecule's atoms
+    const int32_t pairs[] = {0, 1, 0, 2};
+    bytes = good;
+    at = bytes.find(std::string(reinterpret_cast<const char*>(pairs), sizeof(pairs)));
+    ASSERT_NE(at, std::string::npos);
+    const int32_t outside = 7;
+    std::memcpy(&bytes[at + 12], &outside, sizeof(outside));
+    rewrite(bytes);
+    EXPECT_THROW(MoleculeLibrary::open(lib_path), std::runtime_error);
+
+    // Header counts whose section sizes overflow size_t: 8 * (types + 1)
+    // and 24 * atoms both wrap to 0
+    const size_t num_atoms_at = 32, num_types_at = 48;
+    for (auto [at_count, count] : {std::pair<size_t, uint64_t>{num_types_at, (uint64_t{1} << 61) - 1},
+                                   std::pair<size_t, uint64_t>{num_atoms_at, uint64_t{1} << 61}}) {
+        bytes = good;
+        std::memcpy(&bytes[at_count], &count, sizeof(count));
+        rewrite(bytes);
+        EXPECT_THROW(MoleculeLibrary::open(lib_path), std::runtime_error);
+    }
+
+    rewrite(good);
+    EXPECT_EQ(MoleculeLibrary::open(lib_path).molecule(0).num_bonds(), 2);
+    std::remove(lib_path.c_str());
+}
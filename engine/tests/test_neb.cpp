@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include "chemsim/io/xyz_parser.h"
+#include "chemsim/core/geometry.h"
+#include "chemsim/ff/uff_energy.h"
+#include "chemsim/opt/optimizer.h"
+#include "chemsim/opt/neb.h"
+
+using namespace chemsim;
+
+static std::string read_file(const std::string& path) {
+    std::ifstream f(path);
+    if (!f.is_open()) throw std::runtime_error("Cannot open: " + path);
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+// Optimized anti and gauche butane sharing one force field
+static void butane_endpoints(Molecule& anti, Molecule& gauche, UFFForceField& ff) {
+    anti = parse_xyz(read_file("data/test_molecules/butane.xyz"));
+    ff.setup(anti);
+    gauche = anti;
+    set_dihedral(gauche, 0, 1, 2, 3, 65.0);
+
+    OptSettings settings;
+    settings.store_trajectory = false;
+    optimize_geometry(anti, ff, settings);
+    optimize_geometry(gauche, ff, settings);
+}
+
+TEST(NEB, InterpolationKeepsEndpoints) {
+    Molecule anti, gauche;
+    UFFForceField ff;
+    butane_endpoints(anti, gauche, ff);
+
+    for (const std::string method : {"linear", "idpp"}) {
+        auto images = interpolate_images(anti, gauche, 5, method);
+        ASSERT_EQ(images.size(), 7u);
+        EXPECT_EQ(images.front(), anti.get_positions());
+        EXPECT_EQ(images.back(), gauche.get_positions());
+    }
+
+    // IDPP keeps the C-C bond close to its endpoint length mid-path
+    auto idpp = interpolate_images(anti, gauche, 5, "idpp");
+    // Images are refined independently, so the thread count does not matter
+    EXPECT_EQ(interpolate_images(anti, gauche, 5, "idpp", 1), idpp);
+    Molecule mid = anti;
+    mid.set_positions(idpp[3]);
+    EXPECT_NEAR((mid.atom(2).position - mid.atom(3).position).norm(),
+                (anti.atom(2).position - anti.atom(3).position).norm(), 0.05);
+}
+
+TEST(NEB, ButaneTorsionBarrier) {
+    Molecule anti, gauche;
+    UFFForceField ff;
+    butane_endpoints(anti, gauche, ff);
+
+    NEBSettings settings;
+    settings.num_images = 7;
+    settings.force_tolerance = 0.1;
+    settings.num_threads = 2;
+
+    auto result = run_neb(anti, gauche, ff, settings);
+
+    EXPECT_TRUE(result.converged);
+    ASSERT_EQ(result.energies.size(), 9u);
+    ASSERT_GT(result.climbing_image, 0);
+    ASSERT_LT(result.climbing_image, 8);
+
+    // The climbing image sits above both endpoints, near the eclipsed form
+    double e_top = result.energies[result.climbing_image];
+    EXPECT_GT(e_top, result.energies.front());
+    EXPECT_GT(e_top, result.energies.back());
+    EXPECT_NEAR(result.barrier, e_top - result.energies.front(), 1e-10);
+
+    Molecule top = anti;
+    top.set_positions(result.images[result.climbing_image]);
+    double phi = std::abs(dihedral_angle(top, 0, 1, 2, 3));
+    EXPECT_GT(phi, 90.0);
+    EXPECT_LT(phi, 150.0);
+}
+
+TEST(NEB, LBFGSMatchesFIRE) {
+    Molecule anti, gauche;
+    UFFForceField ff;
+    butane_endpoints(anti, gauche, ff);
+
+    NEBSettings settings;
+    settings.num_images = 5;
+    settings.force_tolerance = 0.1;
+
+    auto fire = run_neb(anti, gauche, ff, settings);
+    settings.method = "lbfgs";
+    auto lbfgs = run_neb(anti, gauche, ff, settings);
+
+    EXPECT_TRUE(lbfgs.converged);
+    EXPECT_NEAR(lbfgs.barrier, fire.barrier, 0.1);
+}
+
+TEST(NEB, MismatchedEndpoints) {
+    auto water = parse_xyz(read_file("data/test_molecules/water.xyz"));
+    auto methane = parse_xyz(read_file("data/test_molecules/methane.xyz"));
+    UFFForceField ff;
+    ff.setup(water);
+    EXPECT_THROW(run_neb(water, methane, ff), std::runtime_error);
+}
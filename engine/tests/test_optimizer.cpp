@@ -4,7 +4,11 @@
 #include <cmath>
 #include "chemsim/io/xyz_parser.h"
 #include "chemsim/ff/uff_energy.h"
+#include "chemsim/opt/model_hessian.h"
 #include "chemsim/opt/optimizer.h"
+#include "chemsim/opt/progress_channel.h"
+#include <poll.h>
+#include <thread>
 
 using namespace chemsim;
 
@@ -108,3 +112,182 @@ TEST(Optimizer, Callback) {
     optimize_geometry(mol, ff, settings, callback);
     EXPECT_GT(callback_count, 0);
 }
+
+TEST(Optimizer, ProgressChannel) {
+    auto mol = parse_xyz(read_file("data/test_molecules/ethanol.xyz"));
+    mol.atom(1).position += Eigen::Vector3d(0.2, -0.1, 0.1);
+
+    UFFForceField ff;
+    ff.setup(mol);
+    OptSettings settings;
+    settings.grad_tolerance = 1e-5;
+
+    // Small ring: the consumer falls behind and the oldest records drop
+    ProgressChannel channel(4, 2);
+    std::atomic<bool> done{false};
+    OptResult result;
+    std::thread optimizer([&]() {
+        result = optimize_geometry(mol, ff, settings, channel.callback());
+        done = true;
+    });
+
+    std::vector<OptProgress> received;
+    while (!done.load()) {
+        pollfd p{channel.fd(), POLLIN, 0};
+        if (::poll(&p, 1, 10) > 0) {
+            for (auto& r : channel.drain(3)) received.push_back(std::move(r));
+        }
+    }
+    optimizer.join();
+    for (auto batch = channel.drain(); !batch.empty(); batch = channel.drain()) {
+        for (auto& r : batch) received.push_back(std::move(r));
+    }
+
+    ASSERT_FALSE(received.empty());
+    EXPECT_EQ(received.size() + channel.dropped(), channel.published());
+    for (size_t i = 0; i < received.size(); ++i) {
+        EXPECT_EQ(received[i].positions.size(), 3u * mol.num_atoms());
+        if (i > 0) {
+            EXPECT_GT(received[i].iteration, received[i - 1].iteration);
+        }
+    }
+    EXPECT_TRUE(result.converged);
+}
+
+TEST(Optimizer, CancellationAndTimeBudget) {
+    auto start = parse_xyz(read_file("data/test_molecules/butane.xyz"));
+    start.atom(0).position += Eigen::Vector3d(0.3, -0.2, 0.1);
+    UFFForceField ff;
+    ff.setup(start);
+    double initial_energy = ff.calculate_energy(start);
+
+    for (const char* method : {"steepest_descent", "lbfgs", "newton_cg"}) {
+        SCOPED_TRACE(method);
+        // Cancelled from another copy of the token after a few evaluations
+        OptSettings settings;
+        settings.method = method;
+        settings.grad_tolerance = 1e-8;
+        settings.energy_tolerance = 0.0;
+        CancellationToken token = settings.cancel;
+        int calls = 0;
+        Molecule mol = start;
+        auto result = optimize_geometry(mol, ff, settings, [&](const OptProgress&) {
+            if (++calls == 4) token.cancel();
+        });
+        EXPECT_EQ(result.status, OptStatus::cancelled);
+        EXPECT_FALSE(result.converged);
+        EXPECT_LE(calls, 5);
+        EXPECT_LT(result.final_energy, initial_energy);
+        EXPECT_NEAR(result.final_energy, ff.calculate_energy(mol), 1e-9);
+
+        // Budget already spent
+        settings = OptSettings{};
+        settings.method = method;
+        settings.time_budget = 1e-9;
+        mol = start;
+        result = optimize_geometry(mol, ff, settings);
+        EXPECT_EQ(result.status, OptStatus::timed_out);
+    }
+
+    OptSettings settings;
+    Molecule mol = start;
+    auto result = optimize_geometry(mol, ff, settings);
+    EXPECT_EQ(result.status, OptStatus::converged);
+
+    // Setup polls the token too, and keeps its previous tables
+    CancellationToken cancelled;
+    cancelled.cancel();
+    auto ethanol = parse_xyz(read_file("data/test_molecules/ethanol.xyz"));
+    EXPECT_THROW(ff.setup(ethanol, false, cancelled), OperationCancelled);
+    EXPECT_EQ(ff.atom_types().size(), static_cast<size_t>(start.num_atoms()));
+}
+
+TEST(Optimizer, NewtonCGMethane) {
+    auto mol = parse_xyz(read_file("data/test_molecules/methane.xyz"));
+    mol.atom(1).position += Eigen::Vector3d(0.2, 0.0, 0.0);
+    mol.atom(2).position -= Eigen::Vector3d(0.0, 0.15, 0.0);
+
+    UFFForceField ff;
+    ff.setup(mol);
+
+    double initial_energy = ff.calculate_energy(mol);
+
+    OptSettings settings;
+    settings.method = "newton_cg";
+    settings.max_iterations = 100;
+    settings.grad_tolerance = 1e-5;
+
+    auto result = optimize_geometry(mol, ff, settings);
+
+    EXPECT_TRUE(result.converged);
+    EXPECT_LT(result.final_energy, initial_energy);
+    // Quadratic convergence: far fewer outer steps than L-BFGS would need
+    EXPECT_LT(result.iterations, 30);
+    for (int i = 1; i <= 4; ++i) {
+        double dist = (mol.atom(0).position - mol.atom(i).position).norm();
+        EXPECT_NEAR(dist, 1.09, 0.15);
+    }
+}
+
+TEST(Optimizer, ProviderWithModelHessian) {
+    auto start = parse_xyz(read_file("data/test_molecules/ethanol.xyz"));
+    start.atom(0).position += Eigen::Vector3d(0.15, -0.1, 0.05);
+    start.atom(3).position -= Eigen::Vector3d(0.0, 0.2, 0.1);
+
+    UFFForceField ff;
+    ff.setup(start);
+    double initial_energy = ff.calculate_energy(start);
+
+    // Stands in for an expensive external method; counts gradient calls
+    int calls = 0;
+    FunctionProvider provider([&](const Molecule& m, Eigen::VectorXd& grad) {
+        calls++;
+        ff.calculate_gradient(m, grad);
+        return ff.calculate_energy(m);
+    });
+
+    OptSettings settings;
+    settings.max_iterations = 500;
+    settings.grad_tolerance = 1e-3;
+    settings.energy_tolerance = 0.0;
+
+    Molecule plain = start;
+    auto plain_result = optimize_geometry(plain, provider, settings);
+    int plain_calls = calls;
+
+    ModelHessian model(start, ff);
+    EXPECT_EQ(model.dimension(), 3 * start.num_atoms());
+    EXPECT_GT(Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd>(model.matrix()).eigenvalues().minCoeff(), 0.0);
+
+    calls = 0;
+    Molecule preconditioned = start;
+    auto pre_result = optimize_geometry(preconditioned, provider, settings, &model);
+
+    ASSERT_TRUE(plain_result.converged);
+    ASSERT_TRUE(pre_result.converged);
+    EXPECT_LT(pre_result.final_energy, initial_energy);
+    EXPECT_NEAR(pre_result.final_energy, plain_result.final_energy, 1e-3);
+    EXPECT_NEAR(pre_result.final_energy, ff.calculate_energy(preconditioned), 1e-9);
+    EXPECT_LT(calls, plain_calls);
+
+    // The UFF adapter gives the same surface
+    Molecule via_uff = start;
+    UFFProvider uff(ff);
+    auto uff_result = optimize_geometry(via_uff, uff, settings, &model);
+    EXPECT_EQ(uff_result.iterations, pre_result.iterations);
+
+    // A loose energy tolerance alone never ends the run
+    settings.energy_tolerance = 1e3;
+    Molecule loose = start;
+    auto loose_result = optimize_geometry(loose, uff, settings, &model);
+    ASSERT_TRUE(loose_result.converged);
+    EXPECT_LT(loose_result.final_grad_norm, settings.grad_tolerance);
+
+    FunctionProvider bad([](const Molecule&, Eigen::VectorXd& grad) {
+        grad.resize(3);
+        return 0.0;
+    });
+    EXPECT_THROW(optimize_geometry(via_uff, bad, settings), std::runtime_error);
+    settings.method = "newton_cg";
+    EXPECT_THROW(optimize_geometry(via_uff, uff, settings), std::runtime_error);
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include "chemsim/io/pdb_parser.h"
+
+using namespace chemsim;
+
+// Ala-Gly with two alternate CB positions, a water, a ligand with CONECT
+// records, an unknown residue without them, and a second model to ignore
+static const std::string DIPEPTIDE = R"(HEADER    TEST
+MODEL        1
+ATOM      1  N   ALA A   1       0.000   0.000   0.000  1.00 10.00           N  
+ATOM      2  CA  ALA A   1       1.460   0.000   0.000  1.00 10.00           C  
+ATOM      3  C   ALA A   1       2.000   1.400   0.000  1.00 10.00           C  
+ATOM      4  O   ALA A   1       1.300   2.400   0.000  1.00 10.00           O  
+ATOM      5  CB AALA A   1       2.000  -0.800   1.200  1.00 10.00           C  
+ATOM      6  CB BALA A   1       2.000  -0.800  -1.200  1.00 10.00           C  
+ATOM      7  N   GLY A   2       3.330   1.500   0.000  1.00 10.00           N  
+ATOM      8  CA  GLY A   2       4.000   2.800   0.000  1.00 10.00           C  
+ATOM      9  C   GLY A   2       5.500   2.700   0.000  1.00 10.00           C  
+ATOM     10  O   GLY A   2       6.100   1.600   0.000  1.00 10.00           O  
+ATOM     11  OXT GLY A   2       6.200   3.800   0.000  1.00 10.00           O1-
+TER      12      GLY A   2
+HETATM   13  O   HOH W   1      10.000  10.000  10.000  1.00 10.00           O  
+HETATM   14  C1  LIG B   1       0.000   5.000   5.000  1.00 10.00           C  
+HETATM   15  C2  LIG B   1       1.520   5.000   5.000  1.00 10.00           C  
+HETATM   16  O1  LIG B   1       2.000   6.300   5.000  1.00 10.00           O  
+HETATM   17  C1  UNL B   2       0.000  -5.000  -5.000  1.00 10.00              
+HETATM   18  C2  UNL B   2       1.520  -5.000  -5.000  1.00 10.00              
+ENDMDL
+MODEL        2
+ATOM      1  N   ALA A   1       0.000   0.000   0.000  1.00 10.00           N  
+ENDMDL
+CONECT   14   15
+CONECT   15   14
+END
+)";
+
+TEST(PDBParser, ConnectivityWithoutPerception) {
+    auto s = parse_pdb(DIPEPTIDE);
+    const auto& mol = s.mol;
+
+    // First altloc only, first model only
+    ASSERT_EQ(mol.num_atoms(), 16);
+    EXPECT_EQ(s.altlocs[4], 'A');
+    EXPECT_EQ(s.atom_name(4), "CB");
+    EXPECT_DOUBLE_EQ(mol.atom(4).position.z(), 1.2);
+
+    ASSERT_EQ(s.residues.size(), 5u);
+    EXPECT_EQ(s.residues[0].name, "ALA");
+    EXPECT_EQ(s.residues[1].first_atom, 5);
+    EXPECT_EQ(s.residues[1].num_atoms, 5);
+    EXPECT_TRUE(s.residues[2].hetero);
+    ASSERT_EQ(s.chains.size(), 3u);
+    EXPECT_EQ(s.chains[s.residues[3].chain], "B");
+    EXPECT_EQ(s.atom_residues[15], 4);
+    EXPECT_EQ(mol.atom(9).formal_charge, -1);
+    EXPECT_FLOAT_EQ(s.b_factors[0], 10.0f);
+
+    // Template bonds (with the backbone C=O double), the peptide link,
+    // CONECT for the ligand (its C-O stays unbonded), perception for UNL
+    EXPECT_EQ(mol.num_bonds(), 11);
+    EXPECT_EQ(mol.bond_order_between(2, 3), 2);
+    EXPECT_EQ(mol.bond_order_between(2, 5), 1);
+    EXPECT_EQ(mol.bond_order_between(11, 12), 1);
+    EXPECT_EQ(mol.bond_order_between(12, 13), 0);
+    EXPECT_EQ(mol.bond_order_between(14, 15), 1);
+    EXPECT_EQ(mol.degree(10), 0);
+
+    PDBOptions options;
+    options.use_conect = false;
+    EXPECT_EQ(parse_pdb(DIPEPTIDE, options).mol.bond_order_between(12, 13), 1);
+
+    EXPECT_THROW(parse_pdb("HEADER\nEND\n"), std::runtime_error);
+}
+
+TEST(PDBParser, MMCIFMatchesPDB) {
+    std::string cif =
+        "data_test\n"
+        "#\n"
+        "loop_\n"
+        "_atom_site.group_PDB\n"
+        "_atom_site.id\n"
+        "_atom_site.type_symbol\n"
+        "_atom_site.label_atom_id\n"
+        "_atom_site.label_alt_id\n"
+        "_atom_site.label_comp_id\n"
+        "_atom_site.auth_asym_id\n"
+        "_atom_site.auth_seq_id\n"
+        "_atom_site.pdbx_PDB_ins_code\n"
+        "_atom_site.Cartn_x\n"
+        "_atom_site.Cartn_y\n"
+        "_atom_site.Cartn_z\n"
+        "_atom_site.occupancy\n"
+        "_atom_site.B_iso_or_equiv\n"
+        "_atom_site.pdbx_formal_charge\n"
+        "_atom_site.pdbx_PDB_model_num\n"
+        "ATOM 1 N N . ALA A 1 ? 0.000 0.000 0.000 1.00 10.00 ? 1\n"
+        "ATOM 2 C CA . ALA A 1 ? 1.460 0.000 0.000 1.00 10.00 ? 1\n"
+        "ATOM 3 C C . ALA A 1 ? 2.000 1.400 0.000 1.00 10.00 ? 1\n"
+        "ATOM 4 O O . ALA A 1 ? 1.300 2.400 0.000 1.00 10.00 ? 1\n"
+        "ATOM 5 C CB A ALA A 1 ? 2.000 -0.800 1.200 0.50 10.00 ? 1\n"
+        "ATOM 6 C CB B ALA A 1 ? 2.000 -0.800 -1.200 0.50 10.00 ? 1\n"
+        "ATOM 7 N N . GLY A 2 ? 3.330 1.500 0.000 1.00 10.00 ? 1\n"
+        "ATOM 8 C CA . GLY A 2 ? 4.000 2.800 0.000 1.00 10.00 ? 1\n"
+        "ATOM 9 C C . GLY A 2 ? 5.500 2.700 0.000 1.00 10.00 ? 1\n"
+        "ATOM 10 O O . GLY A 2 ? 6.100 1.600 0.000 1.00 10.00 ? 1\n"
+        "ATOM 11 O OXT . GLY A 2 ? 6.200 3.800 0.000 1.00 10.00 -1 1\n"
+        "ATOM 12 N N . ALA A 1 ? 0.000 0.000 0.000 1.00 10.00 ? 2\n"
+        "#\n";
+    auto s = parse_mmcif(cif);
+    auto ref = parse_pdb(DIPEPTIDE);
+    ASSERT_EQ(s.mol.num_atoms(), 10);
+    EXPECT_EQ(s.mol.num_bonds(), 9);
+    EXPECT_EQ(s.mol.atom(9).formal_charge, -1);
+    EXPECT_FLOAT_EQ(s.occupancies[4], 0.5f);
+    for (int b = 0; b < s.mol.num_bonds(); ++b) {
+        EXPECT_EQ(ref.mol.bond_order_between(s.mol.bond(b).atom_i, s.mol.bond(b).atom_j),
+                  s.mol.bond(b).order);
+    }
+
+    std::string path = testing::TempDir() + "chemsim_dipeptide.cif";
+    {
+        std::ofstream out(path);
+        out << cif;
+    }
+    EXPECT_EQ(read_structure(path).mol.num_atoms(), 10);
+    std::remove(path.c_str());
+    EXPECT_THROW(parse_mmcif("data_empty\n"), std::runtime_error);
+}
+
+TEST(PDBParser, ElementsFromAtomNames) {
+    // Blank element columns: hydrogen names must not read as Hg or He,
+    // while left-justified names keep their two-letter element
+    const std::string pdb = R"(ATOM      1  CG  LEU A   1       0.000   0.000   0.000  1.00 10.00
+ATOM      2 HG11 VAL A   2       1.000   0.000   0.000  1.00 10.00
+ATOM      3 HE21 GLN A   3       2.000   0.000   0.000  1.00 10.00
+ATOM      4 1HG1 VAL A   4       3.000   0.000   0.000  1.00 10.00
+ATOM      5  HB2 SER A   5       4.000   0.000   0.000  1.00 10.00
+HETATM    6 FE   HEM B   1      10.000   0.000   0.000  1.00 10.00
+HETATM    7 CA    CA B   2      20.000   0.000   0.000  1.00 10.00
+HETATM    8 CL1  LIG B   3      30.000   0.000   0.000  1.00 10.00
+END
+)";
+    PDBOptions options;
+    options.perceive_unknown = false;
+    auto s = parse_pdb(pdb, options);
+    ASSERT_EQ(s.mol.num_atoms(), 8);
+    const int expected[] = {6, 1, 1, 1, 1, 26, 20, 17};
+    for (int i = 0; i < 8; ++i) EXPECT_EQ(s.mol.atom(i).atomic_number, expected[i]) << s.atom_name(i);
+}
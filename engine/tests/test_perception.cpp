@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include "chemsim/io/xyz_parser.h"
+#include "chemsim/core/element_data.h"
+#include "chemsim/core/perception.h"
+#include "chemsim/ff/uff_typing.h"
+
+using namespace chemsim;
+
+static std::string read_file(const std::string& path) {
+    std::ifstream f(path);
+    if (!f.is_open()) throw std::runtime_error("Cannot open: " + path);
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+// Connectivity-only molecule; hydrogens[i] hydrogens are attached to atom i
+static Molecule build(const std::vector<int>& elements,
+                      const std::vector<std::pair<int,int>>& bonds,
+                      const std::vector<int>& hydrogens) {
+    Molecule mol;
+    for (int z : elements) {
+        mol.add_atom(Atom(z, element_by_number(z).symbol, Eigen::Vector3d::Zero()));
+    }
+    for (const auto& b : bonds) mol.add_bond(Bond(b.first, b.second, 1));
+    for (size_t i = 0; i < hydrogens.size(); ++i) {
+        for (int h = 0; h < hydrogens[i]; ++h) {
+            mol.add_atom(Atom(1, "H", Eigen::Vector3d::Zero()));
+            mol.add_bond(Bond(static_cast<int>(i), mol.num_atoms() - 1, 1));
+        }
+    }
+    return mol;
+}
+
+static int order(const Molecule& mol, int i, int j) { return mol.bond_order_between(i, j); }
+
+TEST(Perception, BenzeneFromXYZIsAromatic) {
+    Molecule mol = parse_xyz(read_file("data/test_molecules/benzene.xyz"));
+    auto rings = find_rings(mol);
+    ASSERT_EQ(rings.size(), 1u);
+    EXPECT_EQ(rings[0].size(), 6u);
+
+    int aromatic = 0;
+    for (const auto& bond : mol.bonds()) aromatic += bond.order == 4;
+    EXPECT_EQ(aromatic, 6);
+    for (const auto& type : assign_uff_types(mol)) {
+        EXPECT_TRUE(type == "C_R" || type == "H_");
+    }
+}
+
+TEST(Perception, SaturatedMoleculesStaySingle) {
+    Molecule mol = parse_xyz(read_file("data/test_molecules/ethanol.xyz"));
+    EXPECT_TRUE(find_rings(mol).empty());
+    for (const auto& bond : mol.bonds()) EXPECT_EQ(bond.order, 1);
+    for (const auto& atom : mol.atoms()) EXPECT_EQ(atom.formal_charge, 0);
+}
+
+TEST(Perception, FusedAndCagedRings) {
+    // Naphthalene: perimeter 0-7, fusion atoms 8 and 9
+    Molecule naphthalene = build(
+        {6, 6, 6, 6, 6, 6, 6, 6, 6, 6},
+        {{0,1}, {1,2}, {2,3}, {3,8}, {8,4}, {4,5}, {5,6}, {6,7}, {7,9}, {9,0}, {8,9}},
+        {1, 1, 1, 1, 1, 1, 1, 1, 0, 0});
+    auto rings = find_rings(naphthalene);
+    ASSERT_EQ(rings.size(), 2u);
+    EXPECT_EQ(rings[0].size(), 6u);
+    EXPECT_EQ(rings[1].size(), 6u);
+    assign_bond_orders(naphthalene);
+    EXPECT_EQ(order(naphthalene, 8, 9), 4);
+    EXPECT_EQ(order(naphthalene, 0, 1), 4);
+
+    // Cubane: five independent four-membered rings
+    Molecule cubane = build(
+        {6, 6, 6, 6, 6, 6, 6, 6},
+        {{0,1}, {1,2}, {2,3}, {3,0}, {4,5}, {5,6}, {6,7}, {7,4}, {0,4}, {1,5}, {2,6}, {3,7}},
+        {1, 1, 1, 1, 1, 1, 1, 1});
+    rings = find_rings(cubane);
+    ASSERT_EQ(rings.size(), 5u);
+    for (const auto& ring : rings) EXPECT_EQ(ring.size(), 4u);
+
+    // Azulene is only aromatic as the 10-electron envelope
+    Molecule azulene = build(
+        {6, 6, 6, 6, 6, 6, 6, 6, 6, 6},
+        {{0,1}, {0,2}, {2,3}, {3,4}, {4,1}, {0,5}, {5,6}, {6,7}, {7,8}, {8,9}, {9,1}},
+        {0, 0, 1, 1, 1, 1, 1, 1, 1, 1});
+    assign_bond_orders(azulene);
+    for (const auto& bond : azulene.bonds()) {
+        if (azulene.atom(bond.atom_j).atomic_number == 6) {
+            EXPECT_EQ(bond.order, 4);
+        }
+    }
+}
+
+TEST(Perception, BondOrdersAndCharges) {
+    // Acetonitrile
+    Molecule nitrile = build({6, 6, 7}, {{0,1}, {1,2}}, {3, 0, 0});
+    assign_bond_orders(nitrile);
+    EXPECT_EQ(order(nitrile, 1, 2), 3);
+    EXPECT_EQ(order(nitrile, 0, 1), 1);
+
+    // Acetic acid
+    Molecule acid = build({6, 6, 8, 8}, {{0,1}, {1,2}, {1,3}}, {3, 0, 0, 1});
+    assign_bond_orders(acid);
+    EXPECT_EQ(order(acid, 1, 2), 2);
+    EXPECT_EQ(order(acid, 1, 3), 1);
+
+    // Nitromethane: N+ with one N=O and one O-
+    Molecule nitro = build({6, 7, 8, 8}, {{0,1}, {1,2}, {1,3}}, {3, 0, 0, 0});
+    assign_bond_orders(nitro);
+    EXPECT_EQ(nitro.atom(1).formal_charge, 1);
+    EXPECT_EQ(order(nitro, 1, 2) + order(nitro, 1, 3), 3);
+    EXPECT_EQ(nitro.atom(2).formal_charge + nitro.atom(3).formal_charge, -1);
+
+    // Tetramethylammonium
+    Molecule ammonium = build({7, 6, 6, 6, 6}, {{0,1}, {0,2}, {0,3}, {0,4}}, {0, 3, 3, 3, 3});
+    assign_bond_orders(ammonium);
+    EXPECT_EQ(ammonium.atom(0).formal_charge, 1);
+}
+
+TEST(Perception, TypingUsesPerceivedOrders) {
+    // Pyrrole, all bonds single on input
+    Molecule pyrrole = build({7, 6, 6, 6, 6}, {{0,1}, {1,2}, {2,3}, {3,4}, {4,0}}, {1, 1, 1, 1, 1});
+    auto types = assign_uff_types(pyrrole);
+    EXPECT_EQ(types[0], "N_R");
+    for (int i = 1; i <= 4; ++i) EXPECT_EQ(types[i], "C_R");
+
+    // Acetone: carbonyl carbon is sp2, methyl carbons sp3, O double bonded
+    Molecule acetone = build({6, 6, 6, 8}, {{0,1}, {1,2}, {1,3}}, {3, 0, 3, 0});
+    types = assign_uff_types(acetone);
+    EXPECT_EQ(types[0], "C_3");
+    EXPECT_EQ(types[1], "C_2");
+    EXPECT_EQ(types[3], "O_2");
+
+    // Acetonitrile: sp carbon and nitrogen
+    Molecule nitrile = build({6, 6, 7}, {{0,1}, {1,2}}, {3, 0, 0});
+    types = assign_uff_types(nitrile);
+    EXPECT_EQ(types[1], "C_1");
+    EXPECT_EQ(types[2], "N_1");
+}
+
+TEST(Perception, LargePolyphenylene) {
+    // 1500 para-linked benzene rings, about 15k atoms
+    const int num_rings = 1500;
+    std::vector<int> elements(6 * num_rings, 6);
+    std::vector<std::pair<int,int>> bonds;
+    std::vector<int> hydrogens(6 * num_rings, 1);
+    for (int r = 0; r < num_rings; ++r) {
+        int base = 6 * r;
+        for (int k = 0; k < 6; ++k) bonds.emplace_back(base + k, base + (k + 1) % 6);
+        if (r + 1 < num_rings) {
+            bonds.emplace_back(base + 3, base + 6);
+            hydrogens[base + 3] = 0;
+            hydrogens[base + 6] = 0;
+        }
+    }
+    Molecule mol = build(elements, bonds, hydrogens);
+
+    auto rings = find_rings(mol);
+    EXPECT_EQ(static_cast<int>(rings.size()), num_rings);
+    assign_bond_orders(mol);
+    int aromatic = 0, linking = 0;
+    for (const auto& bond : mol.bonds()) {
+        aromatic += bond.order == 4;
+        linking += bond.order == 1 && mol.atom(bond.atom_j).atomic_number == 6;
+    }
+    EXPECT_EQ(aromatic, 6 * num_rings);
+    EXPECT_EQ(linking, num_rings - 1);
+}
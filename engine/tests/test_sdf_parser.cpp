@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include "chemsim/io/sdf_parser.h"
+
+using namespace chemsim;
+
+// Acetate (charge from M  CHG, two data fields), ammonium (charge from the
+// atom block) and water without a trailing separator
+static const std::string LIBRARY = R"(acetate
+  chemsim
+
+  4  3  0  0  0  0  0  0  0  0999 V2000
+    0.0000    0.0000    0.0000 C   0  0  0  0  0  0  0  0  0  0  0  0
+    1.5200    0.0000    0.0000 C   0  0  0  0  0  0  0  0  0  0  0  0
+    2.1000    1.1000    0.0000 O   0  0  0  0  0  0  0  0  0  0  0  0
+    2.1000   -1.1000    0.0000 O   0  0  0  0  0  0  0  0  0  0  0  0
+  1  2  1  0
+  2  3  2  0
+  2  4  1  0
+M  CHG  1   4  -1
+M  END
+> <ID>
+A-1
+
+> 12 <NOTE> (MD-1)
+first line
+second line
+
+$$$$
+ammonium
+
+
+  1  0  0  0  0  0  0  0  0  0999 V2000
+    0.0000    0.0000    0.0000 N   0  3  0  0  0  0  0  0  0  0  0  0
+M  END
+$$$$
+water
+
+
+  3  2  0  0  0  0  0  0  0  0999 V2000
+    0.0000    0.0000    0.0000 O   0  0  0  0  0  0  0  0  0  0  0  0
+    0.9600    0.0000    0.0000 H   0  0  0  0  0  0  0  0  0  0  0  0
+   -0.2400    0.9300    0.0000 H   0  0  0  0  0  0  0  0  0  0  0  0
+  1  2  1  0
+  1  3  1  0
+M  END
+)";
+
+TEST(SDFParser, ParseSingleRecord) {
+    auto mol = parse_sdf(LIBRARY);
+    EXPECT_EQ(mol.name, "acetate");
+    EXPECT_EQ(mol.num_atoms(), 4);
+    EXPECT_EQ(mol.num_bonds(), 3);
+    EXPECT_EQ(mol.bond_order_between(1, 2), 2);
+    EXPECT_EQ(mol.atom(3).formal_charge, -1);
+    EXPECT_EQ(mol.atom(2).formal_charge, 0);
+
+    EXPECT_THROW(parse_sdf(""), std::runtime_error);
+    EXPECT_THROW(parse_sdf("x\n\n\n  2  0\n"), std::runtime_error);
+}
+
+TEST(SDFParser, RecordIndexAndProperties) {
+    SDFReader reader(LIBRARY);
+    ASSERT_EQ(reader.size(), 3u);
+
+    // Random access in any order
+    EXPECT_EQ(reader.molecule(2).name, "water");
+    EXPECT_EQ(reader.molecule(2).num_bonds(), 2);
+    EXPECT_EQ(reader.molecule(1).atom(0).formal_charge, 1);
+
+    auto props = reader.properties(0);
+    ASSERT_EQ(props.size(), 2u);
+    EXPECT_EQ(props[0].first, "ID");
+    EXPECT_EQ(props[0].second, "A-1");
+    EXPECT_EQ(props[1].first, "NOTE");
+    EXPECT_EQ(props[1].second, "first line\nsecond line");
+    EXPECT_TRUE(reader.properties(1).empty());
+
+    EXPECT_THROW(reader.record(3), std::runtime_error);
+}
+
+TEST(SDFParser, ParallelParsing) {
+    std::string library;
+    for (int k = 0; k < 200; ++k) {
+        // Water has no separator; add one so the copies stay apart
+        library += LIBRARY + "$$$$\n";
+    }
+    SDFReader reader(library);
+    ASSERT_EQ(reader.size(), 600u);
+
+    auto mols = reader.molecules(0, reader.size(), 4);
+    ASSERT_EQ(mols.size(), 600u);
+    for (size_t i = 0; i < mols.size(); ++i) {
+        EXPECT_EQ(mols[i].name, reader.molecule(i).name);
+    }
+    // Shards are plain record ranges
+    auto shard = reader.molecules(299, 302, 2);
+    ASSERT_EQ(shard.size(), 3u);
+    EXPECT_EQ(shard[0].name, "water");
+    EXPECT_EQ(shard[1].name, "acetate");
+
+    // Errors carry the record number
+    std::string broken = library + "bad\n\n\n  1  0\n";
+    try {
+        SDFReader(broken).molecules(0, 601, 4);
+        FAIL() << "expected a parse error";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("record 600"), std::string::npos);
+    }
+}
+
+TEST(SDFParser, MappedFile) {
+    std::string path = testing::TempDir() + "chemsim_library.sdf";
+    {
+        std::ofstream out(path);
+        out << LIBRARY;
+    }
+    auto reader = SDFReader::open(path);
+    EXPECT_EQ(reader.size(), 3u);
+    EXPECT_EQ(reader.molecule(0).num_atoms(), 4);
+    std::remove(path.c_str());
+}
+
+TEST(SDFParser, WriteRoundTrip) {
+    auto acetate = parse_sdf(LIBRARY);
+    std::string text = write_sdf(acetate, {{"energy", "-12.5"}, {"source", "test"}});
+
+    SDFReader reader(text);
+    ASSERT_EQ(reader.size(), 1u);
+    auto back = reader.molecule(0);
+    EXPECT_EQ(back.name, "acetate");
+    ASSERT_EQ(back.num_atoms(), 4);
+    EXPECT_EQ(back.num_bonds(), 3);
+    EXPECT_EQ(back.bond_order_between(1, 2), 2);
+    EXPECT_EQ(back.atom(3).formal_charge, -1);
+    EXPECT_NEAR(back.atom(3).position.y(), -1.1, 1e-9);
+    auto props = reader.properties(0);
+    ASSERT_EQ(props.size(), 2u);
+    EXPECT_EQ(props[0].second, "-12.5");
+
+    // Many records through the chunked file writer
+    std::vector<Molecule> mols;
+    std::vector<SDFProperties> props_per_mol;
+    SDFReader library(LIBRARY);
+    for (int k = 0; k < 300; ++k) {
+        mols.push_back(library.molecule(k % 3));
+        props_per_mol.push_back({{"index", std::to_string(k)}});
+    }
+    std::string path = testing::TempDir() + "chemsim_written.sdf";
+    write_sdf_file(path, mols, props_per_mol);
+    auto written = SDFReader::open(path);
+    ASSERT_EQ(written.size(), 300u);
+    EXPECT_EQ(written.molecule(299).name, "water");
+    EXPECT_EQ(written.molecule(299).num_bonds(), 2);
+    EXPECT_EQ(written.properties(299)[0].second, "299");
+    std::remove(path.c_str());
+}
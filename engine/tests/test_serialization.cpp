@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include "chemsim/io/serialization.h"
+#include "chemsim/io/xyz_parser.h"
+
+using namespace chemsim;
+
+static std::string read_file(const std::string& path) {
+    std::ifstream f(path);
+    if (!f.is_open()) throw std::runtime_error("Cannot open: " + path);
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+TEST(Serialization, MoleculeRoundTrip) {
+    auto mol = parse_xyz(read_file("data/test_molecules/ethanol.xyz"));
+    mol.name = "ethanol";
+    mol.atom(2).formal_charge = -1;
+    mol.bond(0).order = 2;
+
+    std::string blob = serialize(mol);
+    auto copy = deserialize_molecule(blob);
+    EXPECT_EQ(copy.name, mol.name);
+    EXPECT_EQ(copy.comment, mol.comment);
+    ASSERT_EQ(copy.num_atoms(), mol.num_atoms());
+    ASSERT_EQ(copy.num_bonds(), mol.num_bonds());
+    for (int i = 0; i < mol.num_atoms(); ++i) {
+        EXPECT_EQ(copy.atom(i).atomic_number, mol.atom(i).atomic_number);
+        EXPECT_EQ(copy.atom(i).symbol, mol.atom(i).symbol);
+        EXPECT_EQ(copy.atom(i).formal_charge, mol.atom(i).formal_charge);
+        EXPECT_EQ(copy.atom(i).position, mol.atom(i).position);
+    }
+    for (int b = 0; b < mol.num_bonds(); ++b) {
+        EXPECT_EQ(copy.bond(b).atom_i, mol.bond(b).atom_i);
+        EXPECT_EQ(copy.bond(b).atom_j, mol.bond(b).atom_j);
+        EXPECT_EQ(copy.bond(b).order, mol.bond(b).order);
+    }
+
+    EXPECT_THROW(deserialize_molecule(blob.substr(0, blob.size() - 5)), std::runtime_error);
+    EXPECT_THROW(deserialize_force_field(blob), std::runtime_error);
+}
+
+TEST(Serialization, ForceFieldRoundTrip) {
+    auto mol = parse_xyz(read_file("data/test_molecules/butane.xyz"));
+    UFFForceField ff;
+    ff.setup(mol, false);
+    ff.add_dihedral_restraint(0, 1, 2, 3, 60.0, 50.0);
+
+    auto copy = deserialize_force_field(serialize(ff));
+    EXPECT_EQ(copy.atom_types(), ff.atom_types());
+    EXPECT_EQ(copy.terms().bonds.size(), ff.terms().bonds.size());
+    EXPECT_EQ(copy.terms().num_vdw_pairs(), ff.terms().num_vdw_pairs());
+    EXPECT_EQ(copy.terms().vdw_excluded, ff.terms().vdw_excluded);
+    ASSERT_EQ(copy.dihedral_restraints().size(), 1u);
+    EXPECT_EQ(copy.dihedral_restraints()[0].target, ff.dihedral_restraints()[0].target);
+
+    // Bit-identical energies and gradients without running setup()
+    EXPECT_EQ(copy.calculate_energy(mol), ff.calculate_energy(mol));
+    EXPECT_EQ(copy.calculate_gradient(mol), ff.calculate_gradient(mol));
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include "chemsim/core/spatial_index.h"
+
+using namespace chemsim;
+
+static std::vector<Eigen::Vector3d> random_points(int n, double box, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(0.0, box);
+    std::vector<Eigen::Vector3d> points(n);
+    for (auto& p : points) p = Eigen::Vector3d(u(rng), u(rng), u(rng));
+    return points;
+}
+
+TEST(SpatialIndex, QueriesMatchBruteForce) {
+    auto points = random_points(2000, 20.0, 5);
+    SpatialIndex index(points, 2.5);
+
+    Eigen::Vector3d center(7.0, 11.0, 3.0);
+    std::vector<int> expected;
+    for (int i = 0; i < 2000; ++i) {
+        if ((points[i] - center).norm() <= 4.0) expected.push_back(i);
+    }
+    EXPECT_EQ(index.within(center, 4.0), expected);
+    // Radii far larger than the grid, and centers outside it, stay exact
+    EXPECT_EQ(index.within(center, 100.0).size(), 2000u);
+    EXPECT_TRUE(index.within(Eigen::Vector3d(-50, 0, 0), 10.0).empty());
+
+    std::vector<std::pair<double, int>> by_distance;
+    for (int i = 0; i < 2000; ++i) by_distance.emplace_back((points[i] - center).norm(), i);
+    std::sort(by_distance.begin(), by_distance.end());
+    auto nearest = index.nearest(center, 10);
+    ASSERT_EQ(nearest.size(), 10u);
+    for (int q = 0; q < 10; ++q) {
+        EXPECT_EQ(nearest[q].first, by_distance[q].second);
+        EXPECT_NEAR(nearest[q].second, by_distance[q].first, 1e-12);
+    }
+    EXPECT_EQ(index.nearest(Eigen::Vector3d(100, 100, 100), 5000).size(), 2000u);
+
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < 2000; ++i) {
+        for (int j = i + 1; j < 2000; ++j) {
+            if ((points[i] - points[j]).norm() <= 1.5) pairs.emplace_back(i, j);
+        }
+    }
+    EXPECT_EQ(index.pairs_within(1.5), pairs);
+    EXPECT_EQ(index.pairs_within(1.5, 4), pairs);
+}
+
+TEST(SpatialIndex, IncrementalUpdate) {
+    auto points = random_points(500, 10.0, 9);
+    SpatialIndex index(points, 2.0);
+
+    // Tiny moves rarely cross a cell boundary
+    std::mt19937 rng(1);
+    std::normal_distribution<double> gauss(0.0, 0.01);
+    for (auto& p : points) p += Eigen::Vector3d(gauss(rng), gauss(rng), gauss(rng));
+    for (auto& p : points) p = p.cwiseMax(Eigen::Vector3d::Zero()).cwiseMin(Eigen::Vector3d::Constant(9.99));
+    int moved = index.update(points);
+    EXPECT_LT(moved, 100);
+    EXPECT_EQ(index.pairs_within(1.0), SpatialIndex(points, 2.0).pairs_within(1.0));
+
+    // Large jumps land in cells that were not occupied before
+    points[0] = Eigen::Vector3d(30.0, 30.0, 30.0);
+    index.update(points);
+    EXPECT_EQ(index.nearest(Eigen::Vector3d(29.0, 30.0, 30.0), 1)[0].first, 0);
+    EXPECT_EQ(index.within(points[0], 0.5), std::vector<int>{0});
+
+    EXPECT_THROW(index.update(std::vector<Eigen::Vector3d>(3)), std::runtime_error);
+    EXPECT_THROW(SpatialIndex(points, 0.0), std::runtime_error);
+}
+
+TEST(SpatialIndex, DistantOutlierKeepsCells) {
+    auto points = random_points(3000, 15.0, 11);
+    points.push_back(Eigen::Vector3d(1e6, -1e6, 1e6));
+    SpatialIndex index(points, 2.0);
+    EXPECT_DOUBLE_EQ(index.cell_size(), 2.0);
+
+    int n = static_cast<int>(points.size());
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) {
+            if ((points[i] - points[j]).norm() <= 1.2) pairs.emplace_back(i, j);
+        }
+    }
+    EXPECT_EQ(index.pairs_within(1.2), pairs);
+
+    // Query boxes spanning the outlier walk occupied cells, not the box
+    EXPECT_EQ(index.within(Eigen::Vector3d::Zero(), 3e6).size(), points.size());
+    auto nearest = index.nearest(points.back(), 2);
+    ASSERT_EQ(nearest.size(), 2u);
+    EXPECT_EQ(nearest[0].first, n - 1);
+    EXPECT_GT(nearest[1].second, 1e6);
+}
+
+TEST(SpatialIndex, NonFinitePoints) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<Eigen::Vector3d> points = {
+        {0.0, 0.0, 0.0}, {nan, 0.0, 0.0}, {1.0, 0.0, 0.0}, {0.0, nan, nan}};
+    SpatialIndex index(points, 2.0);
+
+    // NaN points never match, so k past the finite points returns fewer
+    auto nearest = index.nearest(Eigen::Vector3d::Zero(), 4);
+    ASSERT_EQ(nearest.size(), 2u);
+    EXPECT_EQ(nearest[0].first, 0);
+    EXPECT_EQ(nearest[1].first, 2);
+    EXPECT_EQ(index.within(Eigen::Vector3d::Zero(), 10.0), (std::vector<int>{0, 2}));
+    EXPECT_EQ(index.pairs_within(1.5), (std::vector<std::pair<int, int>>{{0, 2}}));
+
+    Eigen::Vector3d nan_center(nan, 0.0, 0.0);
+    EXPECT_TRUE(index.nearest(nan_center, 2).empty());
+    EXPECT_TRUE(index.within(nan_center, 10.0).empty());
+}
@@ -6,6 +6,8 @@
 #include "chemsim/ff/uff_energy.h"
 #include "chemsim/ff/uff_typing.h"
 #include "chemsim/ff/uff_params.h"
+#include "chemsim/opt/optimizer.h"
+#include "chemsim/core/element_data.h"
 
 using namespace chemsim;
 
@@ -116,3 +118,250 @@ TEST(UFFEnergy, BenzeneEnergy) {
         EXPECT_TRUE(std::isfinite(grad[i]));
     }
 }
+
+TEST(UFFEnergy, PerceivedAromaticUsesTypingOrders) {
+    // perceive_bonds() leaves every order single; setup must build terms
+    // from the aromatic orders the C_R types were derived from
+    std::string text = read_file("data/test_molecules/benzene.xyz");
+    auto parsed = parse_xyz(text);
+    XYZOptions options;
+    options.perceive_bonds = false;
+    auto perceived = parse_xyz(text, options);
+    perceived.perceive_bonds();
+    ASSERT_EQ(perceived.num_bonds(), parsed.num_bonds());
+
+    UFFForceField ff_parsed, ff_perceived;
+    ff_parsed.setup(parsed, false);
+    ff_perceived.setup(perceived, false);
+    EXPECT_EQ(ff_perceived.atom_types()[0], "C_R");
+    for (int b = 0; b < perceived.num_bonds(); ++b) {
+        const auto& bond = perceived.bond(b);
+        if (perceived.atom(bond.atom_i).atomic_number != 6 ||
+            perceived.atom(bond.atom_j).atomic_number != 6) {
+            continue;
+        }
+        EXPECT_NEAR(ff_perceived.uff_bond_length(b, perceived), 1.379, 0.005);
+    }
+
+    OptSettings settings;
+    settings.grad_tolerance = 1e-4;
+    optimize_geometry(perceived, ff_perceived, settings);
+    double cc = (perceived.atom(0).position - perceived.atom(1).position).norm();
+    EXPECT_NEAR(cc, 1.40, 0.01);
+    optimize_geometry(parsed, ff_parsed, settings);
+    EXPECT_NEAR(ff_perceived.calculate_energy(perceived), ff_parsed.calculate_energy(parsed), 1e-4);
+}
+
+TEST(UFFEnergy, VdwMatchesPairSum) {
+    auto mol = parse_xyz(read_file("data/test_molecules/butane.xyz"));
+    UFFForceField ff;
+    ff.setup(mol, false);
+
+    // Direct sum over pairs three or more bonds apart
+    auto adj = mol.adjacency_list();
+    int n = mol.num_atoms();
+    double expected = 0.0;
+    size_t pairs = 0;
+    for (int i = 0; i < n; ++i) {
+        std::vector<bool> near(n, false);
+        for (int n1 : adj[i]) {
+            near[n1] = true;
+            for (int n2 : adj[n1]) near[n2] = true;
+        }
+        const auto& pi = get_uff_params(ff.atom_types()[i]);
+        for (int j = i + 1; j < n; ++j) {
+            if (near[j]) continue;
+            const auto& pj = get_uff_params(ff.atom_types()[j]);
+            double x = std::sqrt(pi.x1 * pj.x1) / (mol.atom(i).position - mol.atom(j).position).norm();
+            double x6 = std::pow(x, 6);
+            expected += std::sqrt(pi.D1 * pj.D1) * (x6 * x6 - 2.0 * x6);
+            pairs++;
+        }
+    }
+    EXPECT_EQ(ff.terms().num_vdw_pairs(), pairs);
+    EXPECT_NEAR(ff.calculate_energy_components(mol).vdw, expected, 1e-10);
+}
+
+TEST(UFFEnergy, HessianVectorProductFiniteDifference) {
+    // H*v should match a finite difference of the energy along v
+    auto mol = parse_xyz(read_file("data/test_molecules/ethanol.xyz"));
+    UFFForceField ff;
+    ff.setup(mol);
+
+    int n = mol.num_atoms() * 3;
+    Eigen::VectorXd v(n);
+    for (int i = 0; i < n; ++i) v[i] = std::sin(0.7 * i + 0.3);
+
+    Eigen::VectorXd hv = ff.hessian_vector_product(mol, v);
+    ASSERT_EQ(hv.size(), n);
+
+    // v^T H v = d^2 E / dt^2 along x + t*v
+    double h = 1e-4;
+    auto pos = mol.get_positions();
+    auto displaced = pos;
+    for (int i = 0; i < n; ++i) displaced[i] = pos[i] + h * v[i];
+    mol.set_positions(displaced);
+    double e_plus = ff.calculate_energy(mol);
+    for (int i = 0; i < n; ++i) displaced[i] = pos[i] - h * v[i];
+    mol.set_positions(displaced);
+    double e_minus = ff.calculate_energy(mol);
+    mol.set_positions(pos);
+    double e0 = ff.calculate_energy(mol);
+
+    double vhv_fd = (e_plus - 2.0 * e0 + e_minus) / (h * h);
+    double vhv = v.dot(hv);
+    EXPECT_NEAR(vhv, vhv_fd, 1e-2 * std::max(1.0, std::abs(vhv_fd)));
+}
+
+TEST(UFFEnergy, DihedralRestraintGradient) {
+    auto mol = parse_xyz(read_file("data/test_molecules/ethanol.xyz"));
+    UFFForceField ff;
+    ff.setup(mol);
+    double e_free = ff.calculate_energy(mol);
+
+    ff.add_dihedral_restraint(3, 0, 1, 2, 100.0, 50.0);
+    auto components = ff.calculate_energy_components(mol);
+    EXPECT_GT(components.restraint, 0.0);
+    EXPECT_NEAR(components.total - components.restraint, e_free, 1e-10);
+
+    // Restraint-only gradient against finite differences
+    auto grad_all = ff.calculate_gradient(mol);
+    UFFForceField unrestrained = ff;
+    unrestrained.clear_restraints();
+    Eigen::VectorXd grad = grad_all - unrestrained.calculate_gradient(mol);
+
+    double h = 1e-6;
+    auto pos = mol.get_positions();
+    for (int i = 0; i < mol.num_atoms() * 3; ++i) {
+        auto p = pos;
+        p[i] += h;
+        mol.set_positions(p);
+        double e_plus = ff.calculate_energy_components(mol).restraint;
+        p[i] -= 2.0 * h;
+        mol.set_positions(p);
+        double e_minus = ff.calculate_energy_components(mol).restraint;
+        EXPECT_NEAR(grad[i], (e_plus - e_minus) / (2.0 * h), 1e-4) << "index " << i;
+    }
+    mol.set_positions(pos);
+}
+
+TEST(UFFTermCache, SetupReusesTables) {
+    auto& cache = UFFTermCache::instance();
+    cache.clear();
+
+    auto mol = parse_xyz(read_file("data/test_molecules/ethanol.xyz"));
+    UFFForceField first, second, uncached;
+    first.setup(mol);
+    second.setup(mol);
+    uncached.setup(mol, false);
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_EQ(&first.terms(), &second.terms());
+    EXPECT_NE(&first.terms(), &uncached.terms());
+    EXPECT_DOUBLE_EQ(first.calculate_energy(mol), uncached.calculate_energy(mol));
+
+    // Same topology at a new geometry, bonds listed in another order
+    Molecule moved;
+    for (const auto& atom : mol.atoms()) {
+        Atom a = atom;
+        a.position += Eigen::Vector3d(0.1, -0.2, 0.05);
+        moved.add_atom(a);
+    }
+    for (int b = mol.num_bonds() - 1; b >= 0; --b) {
+        const auto& bond = mol.bond(b);
+        moved.add_bond(Bond(bond.atom_j, bond.atom_i, bond.order));
+    }
+    EXPECT_EQ(topology_hash(moved), topology_hash(mol));
+    second.setup(moved);
+    EXPECT_EQ(&first.terms(), &second.terms());
+    EXPECT_EQ(cache.stats().hits, 2u);
+
+    // Restraints stay per instance
+    second.add_dihedral_restraint(3, 0, 1, 2, 100.0, 50.0);
+    EXPECT_TRUE(first.dihedral_restraints().empty());
+}
+
+// Tetrahedral XY4 with explicit bonds; every such topology has equal-size tables
+static Molecule tetrahedral(int center, int ligand) {
+    Molecule mol;
+    mol.add_atom(Atom(center, element_by_number(center).symbol, Eigen::Vector3d::Zero()));
+    const double s = 0.63;
+    Eigen::Vector3d dirs[4] = {{s, s, s}, {s, -s, -s}, {-s, s, -s}, {-s, -s, s}};
+    for (const auto& d : dirs) {
+        mol.add_atom(Atom(ligand, element_by_number(ligand).symbol, d));
+        mol.add_bond(Bond(0, mol.num_atoms() - 1, 1));
+    }
+    return mol;
+}
+
+TEST(UFFTermCache, FormalChargeIsPartOfKey) {
+    auto& cache = UFFTermCache::instance();
+    cache.clear();
+
+    Molecule ammonia_like = tetrahedral(7, 1), ammonium = tetrahedral(7, 1);
+    ammonium.atom(0).formal_charge = 1;
+    EXPECT_NE(topology_hash(ammonium), topology_hash(ammonia_like));
+
+    UFFForceField ff;
+    ff.setup(ammonia_like);
+    ff.setup(ammonium);
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.entries, 2u);
+    cache.clear();
+}
+
+// Non-bonded tables hold per-atom data, not one record per pair
+TEST(UFFTermCache, TablesScaleWithAtoms) {
+    Molecule mol;
+    const int copies = 500;
+    for (int c = 0; c < copies; ++c) {
+        Molecule methane = tetrahedral(6, 1);
+        int base = mol.num_atoms();
+        for (Atom atom : methane.atoms()) {
+            atom.position += Eigen::Vector3d(4.0 * c, 0.0, 0.0);
+            mol.add_atom(atom);
+        }
+        for (const auto& bond : methane.bonds()) {
+            mol.add_bond(Bond(base + bond.atom_i, base + bond.atom_j, bond.order));
+        }
+    }
+    UFFForceField ff;
+    ff.setup(mol, false);
+
+    // 4 bonds and 6 H-C-H angles excluded per methane
+    size_t n = mol.num_atoms();
+    EXPECT_EQ(ff.terms().num_vdw_pairs(), n * (n - 1) / 2 - copies * 10);
+    EXPECT_LT(ff.terms().memory_bytes(), 1u << 20);
+}
+
+TEST(UFFTermCache, BudgetEvictsLeastRecentlyUsed) {
+    auto& cache = UFFTermCache::instance();
+    cache.clear();
+
+    Molecule methane = tetrahedral(6, 1), silane = tetrahedral(14, 1), cf4 = tetrahedral(6, 9);
+    UFFForceField ff;
+    ff.setup(methane);
+    ff.setup(silane);
+    size_t two_entries = cache.stats().memory_bytes;
+
+    cache.set_budget(two_entries);
+    ff.setup(methane); // methane becomes most recent
+    ff.setup(cf4);     // evicts silane
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.entries, 2u);
+    EXPECT_LE(stats.memory_bytes, two_entries);
+
+    size_t hits = stats.hits, misses = stats.misses;
+    ff.setup(methane);
+    EXPECT_EQ(cache.stats().hits, hits + 1);
+    ff.setup(silane);
+    EXPECT_EQ(cache.stats().misses, misses + 1);
+
+    cache.set_budget(256u << 20);
+    cache.clear();
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include "chemsim/io/xyz_parser.h"
+#include "chemsim/ff/uff_energy.h"
+#include "chemsim/opt/optimizer.h"
+#include "chemsim/analysis/vibrations.h"
+
+using namespace chemsim;
+
+static std::string read_file(const std::string& path) {
+    std::ifstream f(path);
+    if (!f.is_open()) throw std::runtime_error("Cannot open: " + path);
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+static Molecule optimized(const std::string& path, UFFForceField& ff) {
+    Molecule mol = parse_xyz(read_file(path));
+    ff.setup(mol);
+    OptSettings settings;
+    settings.store_trajectory = false;
+    settings.grad_tolerance = 1e-5;
+    settings.max_iterations = 2000;
+    optimize_geometry(mol, ff, settings);
+    return mol;
+}
+
+TEST(Vibrations, HessianMatchesHessianVectorProduct) {
+    UFFForceField ff;
+    Molecule mol = optimized("data/test_molecules/ethanol.xyz", ff);
+
+    Eigen::MatrixXd H = compute_hessian(mol, ff);
+    EXPECT_LT((H - H.transpose()).norm(), 1e-12);
+
+    Eigen::VectorXd v = Eigen::VectorXd::LinSpaced(H.rows(), -1.0, 1.0);
+    Eigen::VectorXd hv = ff.hessian_vector_product(mol, v);
+    EXPECT_LT((H * v - hv).norm(), 1e-2 * hv.norm());
+}
+
+TEST(Vibrations, WaterHasThreeRealModes) {
+    UFFForceField ff;
+    Molecule mol = optimized("data/test_molecules/water.xyz", ff);
+
+    VibrationalResult result = vibrational_analysis(mol, ff);
+    ASSERT_EQ(result.frequencies.size(), 3u);
+    EXPECT_EQ(result.num_imaginary, 0);
+    for (size_t m = 0; m < 3; ++m) {
+        EXPECT_GT(result.frequencies[m], 500.0);
+        EXPECT_LT(result.frequencies[m], 5000.0);
+        ASSERT_EQ(result.normal_modes[m].size(), 9u);
+    }
+    EXPECT_LE(result.frequencies[0], result.frequencies[1]);
+    EXPECT_LE(result.frequencies[1], result.frequencies[2]);
+}
+
+TEST(Vibrations, LanczosMatchesDenseLowestModes) {
+    UFFForceField ff;
+    Molecule mol = optimized("data/test_molecules/ethanol.xyz", ff);
+
+    VibrationalResult dense = vibrational_analysis(mol, ff);
+    ASSERT_EQ(dense.frequencies.size(), 21u);
+
+    VibrationalSettings settings;
+    settings.solver = "lanczos";
+    settings.num_modes = 4;
+    VibrationalResult lanczos = vibrational_analysis(mol, ff, settings);
+    ASSERT_EQ(lanczos.frequencies.size(), 4u);
+    for (size_t m = 0; m < 4; ++m) {
+        EXPECT_NEAR(lanczos.frequencies[m], dense.frequencies[m],
+                    0.02 * std::abs(dense.frequencies[m]) + 1.0);
+    }
+}
@@ -1,7 +1,11 @@
 #include <gtest/gtest.h>
+#include <cmath>
+#include <cstdlib>
 #include <fstream>
 #include <sstream>
+#include "chemsim/io/json_writer.h"
 #include "chemsim/io/xyz_parser.h"
+#include "chemsim/io/text_writer.h"
 
 using namespace chemsim;
 
@@ -63,4 +67,139 @@ TEST(XYZParser, InvalidInput) {
     EXPECT_THROW(parse_xyz(""), std::runtime_error);
     EXPECT_THROW(parse_xyz("abc\n"), std::runtime_error);
     EXPECT_THROW(parse_xyz("3\ncomment\nO 0 0\n"), std::runtime_error);
+    // A corrupt count is rejected before anything is allocated for it
+    EXPECT_THROW(parse_xyz("999999999\ncomment\nH 0 0 0\n"), std::runtime_error);
+    EXPECT_EQ(parse_xyz("1\ncomment\nH 0 0 0").num_atoms(), 1);
+}
+
+TEST(XYZParser, SkipBondPerception) {
+    XYZOptions options;
+    options.perceive_bonds = false;
+    auto mol = parse_xyz(read_file("data/test_molecules/benzene.xyz"), options);
+    EXPECT_EQ(mol.num_atoms(), 12);
+    EXPECT_EQ(mol.num_bonds(), 0);
+}
+
+TEST(XYZParser, StreamFrames) {
+    // CRLF endings, blank lines between frames, extra columns and '+' signs
+    std::string traj =
+        "2\r\nframe 0\r\nH 0 0 0\r\nH 0.74 0 0\r\n\r\n"
+        "2\nframe 1\nH 0 0 0 extra\nH +0.80 0 0\n"
+        "3\nframe 2\nO 0 0 0\nH 0.96 0 0\nH -0.24 0.93 1e-3\n\n";
+
+    XYZReader reader(traj);
+    std::vector<std::string> comments;
+    std::vector<double> last_x;
+    for (const auto& frame : reader) {
+        comments.emplace_back(frame.comment);
+        last_x.push_back(frame.positions[3 * (frame.num_atoms() - 1)]);
+    }
+    ASSERT_EQ(comments.size(), 3u);
+    EXPECT_EQ(comments[0], "frame 0");
+    EXPECT_EQ(comments[2], "frame 2");
+    EXPECT_DOUBLE_EQ(last_x[1], 0.80);
+    EXPECT_DOUBLE_EQ(last_x[2], -0.24);
+    EXPECT_EQ(reader.frames_read(), 3u);
+
+    // Frames convert to molecules on demand
+    reader.rewind();
+    XYZFrame frame;
+    ASSERT_TRUE(reader.next(frame));
+    ASSERT_TRUE(reader.next(frame));
+    ASSERT_TRUE(reader.next(frame));
+    EXPECT_EQ(frame.atomic_numbers, (std::vector<int>{8, 1, 1}));
+    auto water = frame.to_molecule();
+    EXPECT_EQ(water.atom(0).symbol, "O");
+    EXPECT_EQ(water.num_bonds(), 2);
+    EXPECT_FALSE(reader.next(frame));
+
+    // Errors name the frame
+    XYZReader bad("1\na\nH 0 0 0\n2\nb\nH 0 0 0\n");
+    ASSERT_TRUE(bad.next(frame));
+    try {
+        bad.next(frame);
+        FAIL() << "expected a truncated-frame error";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("frame 1"), std::string::npos);
+    }
+}
+
+TEST(XYZParser, MappedFile) {
+    std::string path = testing::TempDir() + "chemsim_traj.xyz";
+    std::string methane = read_file("data/test_molecules/methane.xyz");
+    {
+        std::ofstream out(path);
+        for (int f = 0; f < 50; ++f) out << methane;
+    }
+    auto reader = XYZReader::open(path);
+    int frames = 0;
+    for (const auto& frame : reader) {
+        EXPECT_EQ(frame.num_atoms(), 5);
+        frames++;
+    }
+    EXPECT_EQ(frames, 50);
+    std::remove(path.c_str());
+
+    EXPECT_THROW(XYZReader::open("data/test_molecules/missing.xyz"), std::runtime_error);
+}
+
+TEST(XYZParser, WriteFrames) {
+    auto mol = parse_xyz(read_file("data/test_molecules/ethanol.xyz"));
+    std::vector<std::vector<double>> frames;
+    for (int f = 0; f < 20; ++f) {
+        auto pos = mol.get_positions();
+        for (auto& x : pos) x += 0.125 * f - 1e-7;
+        frames.push_back(pos);
+    }
+
+    // Small chunks force many partial flushes
+    std::string path = testing::TempDir() + "chemsim_written.xyz";
+    {
+        auto out = TextWriter::open(path, 64);
+        write_xyz_frames(*out, mol, frames, {"first"});
+    }
+    auto reader = XYZReader::open(path);
+    XYZFrame frame;
+    for (size_t f = 0; f < frames.size(); ++f) {
+        ASSERT_TRUE(reader.next(frame));
+        EXPECT_EQ(frame.comment, f == 0 ? "first" : mol.comment);
+        for (size_t k = 0; k < frame.positions.size(); ++k) {
+            EXPECT_NEAR(frame.positions[k], frames[f][k], 1e-6);
+        }
+    }
+    EXPECT_FALSE(reader.next(frame));
+    std::remove(path.c_str());
+
+    frames[3].pop_back();
+    std::string text;
+    TextWriter out(text);
+    EXPECT_THROW(write_xyz_frames(out, mol, frames), std::runtime_error);
+}
+
+TEST(JSONWriter, MatchesMolecule) {
+    auto mol = parse_xyz(read_file("data/test_molecules/water.xyz"));
+    mol.name = "wa\"ter\n";
+    mol.comment = "tab\there\x01";
+    mol.atom(1).position.x() = 0.1 + 0.2; // needs all 17 digits
+
+    std::string json = write_json(mol);
+    EXPECT_EQ(json.rfind("{\"name\":\"wa\\\"ter\\n\",\"comment\":\"tab\\there\\u0001\",", 0), 0u);
+    EXPECT_NE(json.find("\"num_atoms\":3,\"num_bonds\":2,"), std::string::npos);
+    EXPECT_NE(json.find("{\"index\":0,\"symbol\":\"O\",\"atomic_number\":8,\"position\":["),
+              std::string::npos);
+    EXPECT_NE(json.find("{\"atom_i\":0,\"atom_j\":1,\"order\":1}"), std::string::npos);
+    EXPECT_EQ(json.back(), '}');
+
+    // Coordinates round-trip exactly
+    size_t at = json.find("{\"index\":1,");
+    at = json.find("\"position\":[", at) + 12;
+    EXPECT_EQ(std::strtod(json.c_str() + at, nullptr), mol.atom(1).position.x());
+
+    std::string streamed;
+    TextWriter out(streamed);
+    write_json(out, mol);
+    EXPECT_EQ(streamed, json);
+
+    mol.atom(2).position.z() = std::nan("");
+    EXPECT_THROW(write_json(mol), std::runtime_error);
 }
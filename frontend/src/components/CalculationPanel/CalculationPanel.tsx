@@ -128,6 +128,12 @@ export default function CalculationPanel() {
             {error}
           </div>
         )}
+
+        {calculationStatus === "cancelled" && (
+          <div className="text-yellow-400 text-xs bg-yellow-400/10 px-3 py-2 rounded-lg border border-yellow-400/20">
+            Calculation cancelled
+          </div>
+        )}
       </div>
 
       {/* Scrollable results */}
@@ -246,6 +252,9 @@ async function pollForResult(calcId: string) {
       } else if (result.status === "failed") {
         useStore.getState().failCalculation(result.error ?? "Calculation failed");
         return;
+      } else if (result.status === "cancelled") {
+        useStore.getState().cancelCalculation();
+        return;
       }
     } catch {
       // retry
@@ -71,6 +71,29 @@ export default function DFTSettingsPanel() {
           />
         </div>
       </div>
+      <div>
+        <label className="text-[10px] text-faint block mb-0.5">Optimizer</label>
+        <select
+          value={dftSettings.optimizer_driver}
+          onChange={(e) =>
+            setDFTSettings({ optimizer_driver: e.target.value as "geometric" | "engine" })
+          }
+          disabled={disabled}
+          className="w-full bg-input text-body rounded px-2 py-1.5 text-xs border border-border-default focus:outline-none focus:ring-1 focus:ring-blue-500/50"
+        >
+          <option value="geometric">geomeTRIC</option>
+          <option value="engine">Engine L-BFGS (UFF Hessian)</option>
+        </select>
+      </div>
+      <label className="flex items-center gap-1.5 text-[10px] text-faint">
+        <input
+          type="checkbox"
+          checked={dftSettings.uff_preoptimize}
+          onChange={(e) => setDFTSettings({ uff_preoptimize: e.target.checked })}
+          disabled={disabled}
+        />
+        Pre-optimize with UFF (geometry optimization)
+      </label>
     </div>
   );
 }
@@ -12,6 +12,7 @@ export function useCalculationWS() {
   const addProgress = useStore((s) => s.addProgress);
   const completeCalculation = useStore((s) => s.completeCalculation);
   const failCalculation = useStore((s) => s.failCalculation);
+  const cancelCalculation = useStore((s) => s.cancelCalculation);
 
   const connect = useCallback(
     (calcId: string) => {
@@ -44,6 +45,8 @@ export function useCalculationWS() {
           );
         } else if (msg.type === "error") {
           failCalculation(msg.error);
+        } else if (msg.type === "cancelled") {
+          cancelCalculation();
         }
       };
 
@@ -51,7 +54,7 @@ export function useCalculationWS() {
         failCalculation("WebSocket connection error");
       };
     },
-    [addProgress, completeCalculation, failCalculation]
+    [addProgress, completeCalculation, failCalculation, cancelCalculation]
   );
 
   const disconnect = useCallback(() => {
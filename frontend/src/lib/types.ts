@@ -41,6 +41,8 @@ export interface DFTSettings {
   basis_set: string;
   charge: number;
   spin: number;
+  uff_preoptimize: boolean;
+  optimizer_driver: "geometric" | "engine";
 }
 
 export interface DFTProperties {
@@ -74,11 +76,23 @@ export type CalculationMethodType =
   | "dft_optimize"
   | "dft_frequency";
 
+export interface PreoptimizationReport {
+  converged: boolean | null;
+  iterations: number | null;
+  initial_energy: number | null;
+  final_energy: number | null;
+  rms_displacement: number | null;
+  wall_time_s: number | null;
+  dft_iterations: number | null;
+  dft_wall_time_s: number | null;
+  error: string | null;
+}
+
 export interface CalculationResult {
   id: string;
   molecule_id: string;
   method: string;
-  status: "pending" | "running" | "completed" | "failed";
+  status: "pending" | "running" | "completed" | "failed" | "cancelled";
   energy: number | null;
   energy_components: EnergyComponents | null;
   dft_properties: DFTProperties | null;
@@ -87,6 +101,7 @@ export interface CalculationResult {
   iterations: number | null;
   final_grad_norm: number | null;
   optimized_positions: number[] | null;
+  preoptimization: PreoptimizationReport | null;
   error: string | null;
 }
 
@@ -108,6 +123,7 @@ export interface CompletionMessage {
   final_grad_norm: number;
   energy_components?: EnergyComponents;
   dft_properties?: DFTProperties;
+  preoptimization?: PreoptimizationReport | null;
   positions: number[];
 }
 
@@ -117,4 +133,14 @@ export interface ErrorMessage {
   error: string;
 }
 
-export type WSMessage = ProgressMessage | CompletionMessage | ErrorMessage | { type: "heartbeat" };
+export interface CancelledMessage {
+  type: "cancelled";
+  calculation_id: string;
+}
+
+export type WSMessage =
+  | ProgressMessage
+  | CompletionMessage
+  | ErrorMessage
+  | CancelledMessage
+  | { type: "heartbeat" };
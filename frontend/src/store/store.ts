@@ -24,7 +24,7 @@ interface AppState {
 
   // Calculation
   calculationId: string | null;
-  calculationStatus: "idle" | "running" | "completed" | "failed";
+  calculationStatus: "idle" | "running" | "completed" | "failed" | "cancelled";
   calculationMethod: CalculationMethodType;
   energyComponents: EnergyComponents | null;
   initialEnergy: number | null;
@@ -73,6 +73,7 @@ interface AppState {
     dftProperties?: DFTProperties | null,
   ) => void;
   failCalculation: (error: string) => void;
+  cancelCalculation: () => void;
   setTrajectoryIndex: (index: number) => void;
   setIsPlaying: (playing: boolean) => void;
   resetCalculation: () => void;
@@ -110,7 +111,14 @@ export const useStore = create<AppState>((set) => ({
   isPlaying: false,
 
   // DFT defaults
-  dftSettings: { functional: "b3lyp", basis_set: "6-31g*", charge: 0, spin: 0 },
+  dftSettings: {
+    functional: "b3lyp",
+    basis_set: "6-31g*",
+    charge: 0,
+    spin: 0,
+    uff_preoptimize: false,
+    optimizer_driver: "geometric",
+  },
   dftProperties: null,
   frequencies: null,
   orbitalData: null,
@@ -205,6 +213,8 @@ export const useStore = create<AppState>((set) => ({
   failCalculation: (error) =>
     set({ calculationStatus: "failed", error }),
 
+  cancelCalculation: () => set({ calculationStatus: "cancelled" }),
+
   setTrajectoryIndex: (index) => set({ trajectoryIndex: index }),
   setIsPlaying: (playing) => set({ isPlaying: playing }),
 